@@ -31,6 +31,15 @@ find_package(Git REQUIRED)
 # Add some paths
 list(APPEND CMAKE_PREFIX_PATH ${ROCM_PATH} ${ROCM_PATH}/hip)
 
+# HIP, without it only the host microbenchmarks can be built
+find_package(HIP QUIET)
+if(NOT HIP_FOUND)
+  if(NOT BUILD_BENCH)
+    message(FATAL_ERROR "HIP not found. Without ROCm, only the host microbenchmarks can be built (-DBUILD_BENCH=ON).")
+  endif()
+  message("-- HIP not found. Building the host microbenchmarks only.")
+endif()
+
 # Find OpenMP package
 find_package(OpenMP)
 if (NOT OPENMP_FOUND)
@@ -56,40 +65,49 @@ if(BUILD_TEST)
   find_package(GTest REQUIRED)
 endif()
 
-# libnuma if MPI is enabled
+# Google Benchmark
+if(BUILD_BENCH)
+  find_package(benchmark REQUIRED)
+endif()
+
+# libnuma if MPI is enabled, optional for the host microbenchmarks
 if(HPCG_MPI)
   find_package(LIBNUMA REQUIRED)
+elseif(BUILD_BENCH)
+  find_package(LIBNUMA QUIET)
 endif()
 
-# ROCm cmake package
-find_package(ROCM QUIET CONFIG PATHS ${CMAKE_PREFIX_PATH})
-if(NOT ROCM_FOUND)
-  set(PROJECT_EXTERN_DIR ${CMAKE_CURRENT_BINARY_DIR}/extern)
-  set(rocm_cmake_tag "master" CACHE STRING "rocm-cmake tag to download")
-  file(DOWNLOAD https://github.com/RadeonOpenCompute/rocm-cmake/archive/${rocm_cmake_tag}.zip
-       ${PROJECT_EXTERN_DIR}/rocm-cmake-${rocm_cmake_tag}.zip STATUS status LOG log)
+# ROCm cmake package, for versioning, installation and packaging of rocHPCG
+if(HIP_FOUND)
+  find_package(ROCM QUIET CONFIG PATHS ${CMAKE_PREFIX_PATH})
+  if(NOT ROCM_FOUND)
+    set(PROJECT_EXTERN_DIR ${CMAKE_CURRENT_BINARY_DIR}/extern)
+    set(rocm_cmake_tag "master" CACHE STRING "rocm-cmake tag to download")
+    file(DOWNLOAD https://github.com/RadeonOpenCompute/rocm-cmake/archive/${rocm_cmake_tag}.zip
+         ${PROJECT_EXTERN_DIR}/rocm-cmake-${rocm_cmake_tag}.zip STATUS status LOG log)
 
-  list(GET status 0 status_code)
-  list(GET status 1 status_string)
+    list(GET status 0 status_code)
+    list(GET status 1 status_string)
 
-  if(NOT status_code EQUAL 0)
-    message(FATAL_ERROR "error: downloading
-    'https://github.com/RadeonOpenCompute/rocm-cmake/archive/${rocm_cmake_tag}.zip' failed
-    status_code: ${status_code}
-    status_string: ${status_string}
-    log: ${log}
-    ")
-  endif()
+    if(NOT status_code EQUAL 0)
+      message(FATAL_ERROR "error: downloading
+      'https://github.com/RadeonOpenCompute/rocm-cmake/archive/${rocm_cmake_tag}.zip' failed
+      status_code: ${status_code}
+      status_string: ${status_string}
+      log: ${log}
+      ")
+    endif()
 
-  execute_process(COMMAND ${CMAKE_COMMAND} -E tar xzf ${PROJECT_EXTERN_DIR}/rocm-cmake-${rocm_cmake_tag}.zip
-                  WORKING_DIRECTORY ${PROJECT_EXTERN_DIR})
+    execute_process(COMMAND ${CMAKE_COMMAND} -E tar xzf ${PROJECT_EXTERN_DIR}/rocm-cmake-${rocm_cmake_tag}.zip
+                    WORKING_DIRECTORY ${PROJECT_EXTERN_DIR})
 
-  find_package(ROCM REQUIRED CONFIG PATHS ${PROJECT_EXTERN_DIR}/rocm-cmake-${rocm_cmake_tag})
-endif()
+    find_package(ROCM REQUIRED CONFIG PATHS ${PROJECT_EXTERN_DIR}/rocm-cmake-${rocm_cmake_tag})
+  endif()
 
-include(ROCMSetupVersion)
-include(ROCMCreatePackage)
-include(ROCMInstallTargets)
-include(ROCMPackageConfigHelpers)
-include(ROCMInstallSymlinks)
-include(ROCMCheckTargetIds OPTIONAL)
+  include(ROCMSetupVersion)
+  include(ROCMCreatePackage)
+  include(ROCMInstallTargets)
+  include(ROCMPackageConfigHelpers)
+  include(ROCMInstallSymlinks)
+  include(ROCMCheckTargetIds OPTIONAL)
+endif()
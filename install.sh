@@ -16,6 +16,7 @@ function display_help()
   echo "    [-r|--reference] reference mode"
   echo "    [-g|--debug] -DCMAKE_BUILD_TYPE=Debug (default: Release)"
   echo "    [-t|--test] build single GPU test"
+  echo "    [-b|--bench] build host reference kernel microbenchmarks"
   echo "    [--with-rocm=<dir>] Path to ROCm install (default: /opt/rocm)"
   echo "    [--with-mpi=<dir>] Path to external MPI install (Default: clone+build OpenMPI v4.1.0 in deps/)"
   echo "    [--with-openmp] compile with OpenMP support (default: enabled)"
@@ -223,6 +224,7 @@ install_prefix=rochpcg-install
 build_release=true
 build_reference=false
 build_test=false
+build_bench=false
 with_rocm=/opt/rocm
 with_mpi=deps/openmpi
 with_omp=ON
@@ -236,7 +238,7 @@ with_memdefrag=ON
 # check if we have a modern version of getopt that can handle whitespace and long parameters
 getopt -T
 if [[ $? -eq 4 ]]; then
-  GETOPT_PARSE=$(getopt --name "${0}" --longoptions help,install,dependencies,reference,debug,test,with-rocm:,with-mpi:,with-openmp:,with-memmgmt:,with-memdefrag: --options hidrgt -- "$@")
+  GETOPT_PARSE=$(getopt --name "${0}" --longoptions help,install,dependencies,reference,debug,test,bench,with-rocm:,with-mpi:,with-openmp:,with-memmgmt:,with-memdefrag: --options hidrgtb -- "$@")
 else
   echo "Need a new version of getopt"
   exit 1
@@ -270,6 +272,9 @@ while true; do
     -t|--test)
         build_test=true
         shift ;;
+    -b|--bench)
+        build_bench=true
+        shift ;;
     --with-rocm)
         with_rocm=${2}
         shift 2 ;;
@@ -368,6 +373,11 @@ pushd .
     cmake_common_options="${cmake_common_options} -DBUILD_TEST=ON"
   fi
 
+  # build microbenchmarks
+  if [[ "${build_bench}" == true ]]; then
+    cmake_common_options="${cmake_common_options} -DBUILD_BENCH=ON"
+  fi
+
   # Build library with AMD toolchain because of existense of device kernels
   ${cmake_executable} ${cmake_common_options} \
     -DCPACK_SET_DESTDIR=OFF \
@@ -0,0 +1,334 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file Autotune.cpp
+
+ Startup tuning of the kernel launch configurations
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <cfloat>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <hip/hip_runtime_api.h>
+
+#include "utils.hpp"
+#include "Autotune.hpp"
+#include "ComputeSPMV.hpp"
+#include "ComputeSYMGS.hpp"
+#include "ComputeDotProduct.hpp"
+#include "mytimer.hpp"
+
+// Number of timed repetitions of each candidate, after a single warmup call
+#define AUTOTUNE_NTIMES 10
+
+// Candidate block sizes, each of them is handled by DISPATCH_BLOCKSIZE
+static const int autotune_candidates[] = {128, 256, 512, 1024};
+static const int autotune_ncandidates = sizeof(autotune_candidates) / sizeof(autotune_candidates[0]);
+
+enum AutotuneKernel
+{
+    AUTOTUNE_SPMV,
+    AUTOTUNE_SYMGS,
+    AUTOTUNE_DOT1,
+    AUTOTUNE_DOT2
+};
+
+/*!
+  Builds the key of the tuning database entry. The launch configuration
+  depends on the device, the host driving it, the local problem size and the
+  number of processes sharing the interconnect.
+
+  @param[in] A the fine level matrix
+
+  @return the key, without whitespace
+ */
+static std::string TuningKey(const SparseMatrix& A)
+{
+    int device;
+    hipDeviceProp_t prop;
+
+    HIP_CHECK(hipGetDevice(&device));
+    HIP_CHECK(hipGetDeviceProperties(&prop, device));
+
+    // CPU model from the first processor entry
+    std::string cpu = "unknown";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+
+    while(std::getline(cpuinfo, line))
+    {
+        if(line.compare(0, 10, "model name") == 0)
+        {
+            size_t pos = line.find(':');
+
+            if(pos != std::string::npos && pos + 2 <= line.size())
+            {
+                cpu = line.substr(pos + 2);
+            }
+
+            break;
+        }
+    }
+
+    int levels = 0;
+    for(const SparseMatrix* level = &A; level != NULL; level = level->Ac)
+    {
+        ++levels;
+    }
+
+    std::ostringstream key;
+    key << prop.name << "/" << prop.gcnArchName << "/" << cpu << "/"
+        << A.geom->nx << "x" << A.geom->ny << "x" << A.geom->nz << "/"
+        << "np" << A.geom->size << "/levels" << levels;
+
+    std::string str = key.str();
+
+    for(size_t i = 0; i < str.size(); ++i)
+    {
+        if(str[i] == ' ' || str[i] == '\t')
+        {
+            str[i] = '_';
+        }
+    }
+
+    return str;
+}
+
+// Single call of the kernel, r has the length of the rows and x of the columns
+static int RunKernel(AutotuneKernel kernel, const SparseMatrix& A, Vector& r, Vector& x)
+{
+    double result;
+    double time_allreduce = 0.0;
+    bool isOptimized = true;
+
+    switch(kernel)
+    {
+        case AUTOTUNE_SPMV: return ComputeSPMV(A, x, r);
+        case AUTOTUNE_SYMGS: return ComputeSYMGS(A, r, x);
+        case AUTOTUNE_DOT1: return ComputeDotProduct(A.localNumberOfRows, r, r, result, time_allreduce, isOptimized);
+        case AUTOTUNE_DOT2: return ComputeDotProduct(A.localNumberOfRows, r, x, result, time_allreduce, isOptimized);
+    }
+
+    return 1;
+}
+
+/*!
+  Times the kernel with the current launch configuration. The slowest process
+  determines the time, as it determines the time of the benchmark.
+
+  @param[in]    kernel the kernel to be timed
+  @param[in]    A      the matrix of the level
+  @param[inout] r      vector with the length of the rows of A
+  @param[inout] x      vector with the length of the columns of A
+  @param[out]   time   the time of a single call in seconds
+
+  @return returns 0 upon success and non-zero otherwise
+ */
+static int TimeKernel(AutotuneKernel kernel, const SparseMatrix& A, Vector& r, Vector& x, double& time)
+{
+    int ierr = RunKernel(kernel, A, r, x);
+
+    HIP_CHECK(hipDeviceSynchronize());
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    double t0 = mytimer();
+
+    for(int i = 0; i < AUTOTUNE_NTIMES; ++i)
+    {
+        ierr += RunKernel(kernel, A, r, x);
+    }
+
+    HIP_CHECK(hipDeviceSynchronize());
+
+    double local_time = (mytimer() - t0) / AUTOTUNE_NTIMES;
+
+#ifndef HPCG_NO_MPI
+    MPI_Allreduce(&local_time, &time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#else
+    time = local_time;
+#endif
+
+    return ierr;
+}
+
+// Returns the fastest candidate block size of the kernel
+static int TuneKernel(AutotuneKernel kernel, int level, const SparseMatrix& A, Vector& r, Vector& x, int& ierr)
+{
+    int best = 0;
+    double best_time = DBL_MAX;
+
+    for(int i = 0; i < autotune_ncandidates; ++i)
+    {
+        int bs = autotune_candidates[i];
+
+        switch(kernel)
+        {
+            case AUTOTUNE_SPMV: kernel_config.SetSpMVBlocksize(level, bs); break;
+            case AUTOTUNE_SYMGS: kernel_config.SetSYMGSBlocksize(level, bs); break;
+            case AUTOTUNE_DOT1: kernel_config.SetDot1Blocksize(bs); break;
+            case AUTOTUNE_DOT2: kernel_config.SetDot2Blocksize(bs); break;
+        }
+
+        double time;
+        ierr += TimeKernel(kernel, A, r, x, time);
+
+        if(time < best_time)
+        {
+            best = bs;
+            best_time = time;
+        }
+    }
+
+    return best;
+}
+
+// Broadcasts the configuration of rank 0 to all processes
+static void BroadcastConfig(bool& found)
+{
+#ifndef HPCG_NO_MPI
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    char buffer[1024] = {0};
+    int flag = found;
+
+    if(rank == 0)
+    {
+        snprintf(buffer, sizeof(buffer), "%s", kernel_config.ToString().c_str());
+    }
+
+    MPI_Bcast(&flag, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(buffer, sizeof(buffer), MPI_CHAR, 0, MPI_COMM_WORLD);
+
+    found = flag != 0;
+
+    if(rank != 0 && found)
+    {
+        kernel_config.FromString(buffer);
+    }
+#endif
+}
+
+/*!
+  Selects the launch configurations of the SpMV, SYMGS and dot product kernels
+  of each multigrid level. The configuration is looked up in the tuning
+  database first. If there is no entry for this system and problem size, each
+  candidate block size is timed and the fastest one is selected and appended
+  to the database by rank 0.
+
+  @param[in]    A        the fine level matrix, after OptimizeProblem
+  @param[inout] data     CG work vectors, overwritten during tuning
+  @param[in]    database file name of the tuning database
+
+  @return returns 0 upon success and non-zero otherwise
+ */
+int Autotune(const SparseMatrix& A, CGData& data, const char* database)
+{
+    kernel_config.Reset();
+
+    // The tuned kernels are only instantiated for the 27 point stencil
+    if(A.ell_width != 27)
+    {
+        return 0;
+    }
+
+    std::string key = TuningKey(A);
+    bool found = false;
+
+    if(A.geom->rank == 0)
+    {
+        found = kernel_config.Load(database, key);
+    }
+
+    BroadcastConfig(found);
+
+    if(found)
+    {
+        kernel_config.SetSource("database");
+
+        if(A.geom->rank == 0) printf("\nLoaded kernel configuration from %s\n", database);
+
+        return 0;
+    }
+
+    if(A.geom->rank == 0) printf("\nTuning kernel configuration ...\n");
+
+    int ierr = 0;
+
+    HIPZeroVector(data.r);
+    HIPZeroVector(data.z);
+    HIPZeroVector(data.p);
+    HIPZeroVector(data.Ap);
+
+    // Level 0 uses the CG work vectors, coarser levels the multigrid vectors
+    const SparseMatrix* level = &A;
+    Vector* r = &data.Ap;
+    Vector* x = &data.p;
+
+    for(int i = 0; level != NULL && i < KERNEL_CONFIG_MAX_LEVELS; ++i)
+    {
+        kernel_config.SetSpMVBlocksize(i, TuneKernel(AUTOTUNE_SPMV, i, *level, *r, *x, ierr));
+        kernel_config.SetSYMGSBlocksize(i, TuneKernel(AUTOTUNE_SYMGS, i, *level, *r, *x, ierr));
+
+        if(level->mgData == NULL)
+        {
+            break;
+        }
+
+        r = level->mgData->rc;
+        x = level->mgData->xc;
+        level = level->Ac;
+    }
+
+    kernel_config.SetDot1Blocksize(TuneKernel(AUTOTUNE_DOT1, 0, A, data.r, data.z, ierr));
+    kernel_config.SetDot2Blocksize(TuneKernel(AUTOTUNE_DOT2, 0, A, data.r, data.z, ierr));
+
+    kernel_config.SetSource("tuned");
+
+    if(A.geom->rank == 0)
+    {
+        if(kernel_config.Store(database, key))
+        {
+            printf("Stored kernel configuration in %s\n", database);
+        }
+        else
+        {
+            fprintf(stderr, "Warning: could not write tuning database %s\n", database);
+        }
+    }
+
+    return ierr;
+}
@@ -0,0 +1,183 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file BandwidthProbe.cpp
+
+ STREAM-like measurement of the attainable device memory bandwidth
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cfloat>
+#include <hip/hip_runtime.h>
+
+#include "utils.hpp"
+#include "BandwidthProbe.hpp"
+
+// Number of repetitions, the first one is discarded
+#define PROBE_NTIMES 20
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_stream_copy(local_int_t size,
+                                   const double* __restrict__ a,
+                                   double* __restrict__ c)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= size)
+    {
+        return;
+    }
+
+    c[gid] = a[gid];
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_stream_triad(local_int_t size,
+                                    double scalar,
+                                    const double* __restrict__ b,
+                                    const double* __restrict__ c,
+                                    double* __restrict__ a)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= size)
+    {
+        return;
+    }
+
+    a[gid] = fma(scalar, c[gid], b[gid]);
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_stream_fill(local_int_t size, double value, double* __restrict__ a)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= size)
+    {
+        return;
+    }
+
+    a[gid] = value;
+}
+
+/*!
+  Measures copy and triad bandwidth on the CG work vectors, such that the probe
+  runs on exactly the memory the benchmark vectors live in. The contents of
+  the work vectors are overwritten.
+
+  @param[in]    A          The known system matrix, defines the vector length
+  @param[inout] data       The CG work vectors
+  @param[out]   probe_data Aggregated bandwidth of all processes
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int BandwidthProbe(const SparseMatrix& A, CGData& data, BandwidthProbeData& probe_data)
+{
+    local_int_t n = A.localNumberOfRows;
+
+    double* a = data.r.d_values;
+    double* b = data.z.d_values;
+    double* c = data.p.d_values;
+
+    dim3 blocks((n - 1) / 1024 + 1);
+    dim3 threads(1024);
+
+    // First touch
+    kernel_stream_fill<1024><<<blocks, threads>>>(n, 1.0, a);
+    kernel_stream_fill<1024><<<blocks, threads>>>(n, 2.0, b);
+    kernel_stream_fill<1024><<<blocks, threads>>>(n, 0.0, c);
+
+    hipEvent_t start, stop;
+    RETURN_IF_HIP_ERROR(hipEventCreate(&start));
+    RETURN_IF_HIP_ERROR(hipEventCreate(&stop));
+
+    float copy_ms = FLT_MAX;
+    float triad_ms = FLT_MAX;
+
+    for(int k = 0; k < PROBE_NTIMES; ++k)
+    {
+        float ms;
+
+        RETURN_IF_HIP_ERROR(hipEventRecord(start, NULL));
+        kernel_stream_copy<1024><<<blocks, threads>>>(n, a, c);
+        RETURN_IF_HIP_ERROR(hipEventRecord(stop, NULL));
+        RETURN_IF_HIP_ERROR(hipEventSynchronize(stop));
+        RETURN_IF_HIP_ERROR(hipEventElapsedTime(&ms, start, stop));
+
+        if(k > 0) copy_ms = std::min(copy_ms, ms);
+
+        RETURN_IF_HIP_ERROR(hipEventRecord(start, NULL));
+        kernel_stream_triad<1024><<<blocks, threads>>>(n, 3.0, b, c, a);
+        RETURN_IF_HIP_ERROR(hipEventRecord(stop, NULL));
+        RETURN_IF_HIP_ERROR(hipEventSynchronize(stop));
+        RETURN_IF_HIP_ERROR(hipEventElapsedTime(&ms, start, stop));
+
+        if(k > 0) triad_ms = std::min(triad_ms, ms);
+    }
+
+    RETURN_IF_HIP_ERROR(hipEventDestroy(start));
+    RETURN_IF_HIP_ERROR(hipEventDestroy(stop));
+
+    // Copy moves two, triad three vectors
+    double copy = 2.0 * sizeof(double) * n / (copy_ms * 1e-3) / 1e9;
+    double triad = 3.0 * sizeof(double) * n / (triad_ms * 1e-3) / 1e9;
+
+    probe_data.length = n;
+    probe_data.copy = copy;
+    probe_data.triad = triad;
+    probe_data.triad_min = triad;
+    probe_data.triad_max = triad;
+    probe_data.triad_min_rank = A.geom->rank;
+
+#ifndef HPCG_NO_MPI
+    struct
+    {
+        double value;
+        int rank;
+    } local_min = {triad, A.geom->rank}, global_min;
+
+    MPI_Allreduce(&copy, &probe_data.copy, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&triad, &probe_data.triad, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&triad, &probe_data.triad_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(&local_min, &global_min, 1, MPI_DOUBLE_INT, MPI_MINLOC, MPI_COMM_WORLD);
+
+    probe_data.triad_min = global_min.value;
+    probe_data.triad_min_rank = global_min.rank;
+#endif
+
+    return 0;
+}
@@ -54,6 +54,7 @@
 
 #include "CG.hpp"
 #include "mytimer.hpp"
+#include "utils.hpp"
 #include "ComputeSPMV.hpp"
 #include "ComputeMG.hpp"
 #include "ComputeDotProduct.hpp"
@@ -62,11 +63,15 @@
 
 // Use TICK and TOCK to time a code section in MATLAB-like fashion
 #ifndef HPCG_NO_MPI
-#define TICK()  hipDeviceSynchronize(); MPI_Barrier(MPI_COMM_WORLD); t0 = mytimer() //!< record current time in 't0'
+#define SYNC_TICK()  hipDeviceSynchronize(); MPI_Barrier(MPI_COMM_WORLD); t0 = mytimer_ticks() //!< record current time in 't0'
 #else
-#define TICK()  hipDeviceSynchronize(); t0 = mytimer() //!< record current time in 't0'
+#define SYNC_TICK()  hipDeviceSynchronize(); t0 = mytimer_ticks() //!< record current time in 't0'
 #endif
-#define TOCK(t) hipDeviceSynchronize(); t += mytimer() - t0 //!< store time difference in 't' using time in 't0'
+#define SYNC_TOCK(t) hipDeviceSynchronize(); t += mytimer_seconds(mytimer_ticks() - t0) //!< store time difference in 't' using time in 't0'
+
+// In event timing mode, sections are bracketed by HIP events instead and 't' is updated at the end of the CG set
+#define TICK()  if (eventTiming) { HIP_CHECK(cg_timer.Begin()); } else { SYNC_TICK(); }
+#define TOCK(t) if (eventTiming) { HIP_CHECK(cg_timer.End(&t)); } else { SYNC_TOCK(t); }
 
 /*!
   Routine to compute an approximate solution to Ax = b
@@ -92,12 +97,14 @@ int CG(const SparseMatrix & A, CGData & data, const Vector & b, Vector & x,
     const int max_iter, const double tolerance, int & niters, double & normr, double & normr0,
     double * times, bool doPreconditioning, bool verbose) {
 
-  double t_begin = mytimer();  // Start timing right away
+  ScopedTimer total(times[0]);  // Start timing right away, total time at return
+  bool eventTiming = cg_timer.GetMode() == CG_TIMING_EVENTS;
   normr = 0.0;
   double rtz = 0.0, oldrtz = 0.0, alpha = 0.0, beta = 0.0, pAp = 0.0;
 
 
-  double t0 = 0.0, t1 = 0.0, t2 = 0.0, t3 = 0.0, t4 = 0.0, t5 = 0.0;
+  mytimer_ticks_t t0 = 0;
+  double t1 = 0.0, t2 = 0.0, t3 = 0.0, t4 = 0.0, t5 = 0.0;
 //#ifndef HPCG_NO_MPI
 //  double t6 = 0.0;
 //#endif
@@ -168,6 +175,9 @@ int CG(const SparseMatrix & A, CGData & data, const Vector & b, Vector & x,
     niters = k;
   }
 
+  // Wait for the last section, this is the only synchronization in event timing mode
+  if (eventTiming) HIP_CHECK(cg_timer.Resolve());
+
   // Store times
   times[1] += t1; // dot-product time
   times[2] += t2; // WAXPBY time
@@ -177,6 +187,5 @@ int CG(const SparseMatrix & A, CGData & data, const Vector & b, Vector & x,
 //#ifndef HPCG_NO_MPI
 //  times[6] += t6; // exchange halo time
 //#endif
-  times[0] += mytimer() - t_begin;  // Total time. All done...
   return 0;
 }
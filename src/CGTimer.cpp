@@ -0,0 +1,174 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file CGTimer.cpp
+
+ Timing of the CG kernel sections
+ */
+
+#include <cstdio>
+
+#include "utils.hpp"
+#include "OutputFile.hpp"
+#include "CGTimer.hpp"
+
+// Number of event pairs that are allocated at once, sufficient for a CG set
+// of 50 iterations with 6 sections each
+#define CG_TIMER_POOL_SIZE 512
+
+hipCGTimer_t::hipCGTimer_t(void)
+{
+    this->mode_           = CG_TIMING_BARRIER;
+    this->pending_        = 0;
+    this->compared_       = false;
+    this->barrier_gflops_ = 0.0;
+    this->event_gflops_   = 0.0;
+}
+
+hipCGTimer_t::~hipCGTimer_t(void)
+{
+}
+
+hipError_t hipCGTimer_t::Initialize(int mode)
+{
+    this->mode_ = mode;
+
+    // Event mode may also be selected later on, allocate the pool lazily
+    // unless it is used right from the start
+    if(mode == CG_TIMING_EVENTS)
+    {
+        this->events_.resize(2 * CG_TIMER_POOL_SIZE);
+        this->targets_.resize(CG_TIMER_POOL_SIZE);
+
+        for(size_t i = 0; i < this->events_.size(); ++i)
+        {
+            RETURN_IF_HIP_ERROR(hipEventCreate(&this->events_[i]));
+        }
+    }
+
+    return hipSuccess;
+}
+
+hipError_t hipCGTimer_t::Clear(void)
+{
+    for(size_t i = 0; i < this->events_.size(); ++i)
+    {
+        RETURN_IF_HIP_ERROR(hipEventDestroy(this->events_[i]));
+    }
+
+    this->events_.clear();
+    this->targets_.clear();
+    this->pending_ = 0;
+
+    return hipSuccess;
+}
+
+hipError_t hipCGTimer_t::Begin(void)
+{
+    // Grow the pool if all event pairs are in use
+    if(2 * this->pending_ == this->events_.size())
+    {
+        size_t size = this->events_.size();
+
+        this->events_.resize(size + 2 * CG_TIMER_POOL_SIZE);
+        this->targets_.resize(this->targets_.size() + CG_TIMER_POOL_SIZE);
+
+        for(size_t i = size; i < this->events_.size(); ++i)
+        {
+            RETURN_IF_HIP_ERROR(hipEventCreate(&this->events_[i]));
+        }
+    }
+
+    return hipEventRecord(this->events_[2 * this->pending_], NULL);
+}
+
+hipError_t hipCGTimer_t::End(double* t)
+{
+    RETURN_IF_HIP_ERROR(hipEventRecord(this->events_[2 * this->pending_ + 1], NULL));
+
+    this->targets_[this->pending_++] = t;
+
+    return hipSuccess;
+}
+
+hipError_t hipCGTimer_t::Resolve(void)
+{
+    if(this->pending_ == 0)
+    {
+        return hipSuccess;
+    }
+
+    // Sections complete in order, waiting for the last one is sufficient
+    RETURN_IF_HIP_ERROR(hipEventSynchronize(this->events_[2 * this->pending_ - 1]));
+
+    for(size_t i = 0; i < this->pending_; ++i)
+    {
+        float ms;
+        RETURN_IF_HIP_ERROR(hipEventElapsedTime(&ms, this->events_[2 * i], this->events_[2 * i + 1]));
+
+        *this->targets_[i] += ms * 1e-3;
+    }
+
+    this->pending_ = 0;
+
+    return hipSuccess;
+}
+
+void hipCGTimer_t::SetComparison(double barrier_gflops, double event_gflops)
+{
+    this->compared_       = true;
+    this->barrier_gflops_ = barrier_gflops;
+    this->event_gflops_   = event_gflops;
+}
+
+void hipCGTimer_t::Report(OutputFile& doc)
+{
+    doc.add("CG Timing", "");
+    doc.get("CG Timing")->add("Mode", this->mode_ == CG_TIMING_EVENTS ? "events" : "barrier");
+
+    if(this->compared_)
+    {
+        doc.get("CG Timing")->add("GFLOP/s with barriers", this->barrier_gflops_);
+        doc.get("CG Timing")->add("GFLOP/s with events", this->event_gflops_);
+        doc.get("CG Timing")->add("Difference (%)", (this->event_gflops_ / this->barrier_gflops_ - 1.0) * 100.0);
+    }
+}
+
+void hipCGTimer_t::Print(void)
+{
+    if(!this->compared_)
+    {
+        return;
+    }
+
+    printf("\nCG timing overhead: %0.4lf GFlop/s with barriers, %0.4lf GFlop/s with events (%+0.2lf%%)\n",
+           this->barrier_gflops_,
+           this->event_gflops_,
+           (this->event_gflops_ / this->barrier_gflops_ - 1.0) * 100.0);
+}
@@ -0,0 +1,105 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file CGTimer.hpp
+
+ Timing of the CG kernel sections
+ */
+
+#ifndef CGTIMER_HPP
+#define CGTIMER_HPP
+
+#include <vector>
+#include <hip/hip_runtime_api.h>
+
+class OutputFile;
+
+/*!
+  Timing modes of the CG solver.
+ */
+enum CGTimingMode
+{
+    CG_TIMING_BARRIER = 0, //!< Device and MPI barrier around every section (default)
+    CG_TIMING_EVENTS       //!< HIP events around every section, resolved at the end of a CG set
+};
+
+/*!
+  Timer for the sections of the CG solver. In barrier mode, all sections are
+  timed on the host after synchronizing the device and all ranks, which
+  serializes the iteration. In event mode, each section is bracketed by a pair
+  of events on the default stream and the elapsed times are accumulated once
+  per CG set, such that the only host synchronization happens at the set
+  boundary.
+ */
+class hipCGTimer_t
+{
+    public:
+
+    hipCGTimer_t(void);
+    ~hipCGTimer_t(void);
+
+    hipError_t Initialize(int mode);
+    hipError_t Clear(void);
+
+    inline int GetMode(void) const { return this->mode_; }
+    inline void SetMode(int mode) { this->mode_ = mode; }
+
+    // Starts a section
+    hipError_t Begin(void);
+
+    // Ends the current section, its time in seconds is added to t on Resolve
+    hipError_t End(double* t);
+
+    // Waits for the last section and accumulates all pending times
+    hipError_t Resolve(void);
+
+    // Stores the performance measured in both modes
+    void SetComparison(double barrier_gflops, double event_gflops);
+
+    // Adds the timing mode to a YAML document
+    void Report(OutputFile& doc);
+
+    // Prints the comparison of both modes to stdout
+    void Print(void);
+
+    private:
+
+    int mode_;
+
+    // Event pairs of the pending sections and their accumulators
+    std::vector<hipEvent_t> events_;
+    std::vector<double*> targets_;
+    size_t pending_;
+
+    bool compared_;
+    double barrier_gflops_;
+    double event_gflops_;
+};
+
+#endif // CGTIMER_HPP
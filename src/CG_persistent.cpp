@@ -0,0 +1,545 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file CG_persistent.cpp
+
+ Host CG on one persistent thread team
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#include "ExchangeHalo.hpp"
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "CG_persistent.hpp"
+#include "ComputeSYMGS_ref.hpp"
+#include "ComputeSYMGS_level.hpp"
+
+#define HPCG_CACHE_LINE 64
+
+// Spins on the barrier before a thread yields its core
+#define HPCG_BARRIER_SPIN 256
+
+/*
+  Sense reversing spin barrier. The last thread to arrive resets the count and
+  flips the shared sense, which releases the threads spinning on it.
+*/
+struct SpinBarrier
+{
+    std::atomic<int> count;
+    char pad0[HPCG_CACHE_LINE - sizeof(std::atomic<int>)];
+    std::atomic<int> sense;
+    char pad1[HPCG_CACHE_LINE - sizeof(std::atomic<int>)];
+    int nthreads;
+    long long barriers; // completed barriers, counted by the last thread
+};
+
+// Partial sum of one thread, on a cache line of its own
+struct ReductionSlot
+{
+    double value;
+    char pad[HPCG_CACHE_LINE - sizeof(double)];
+};
+
+// State shared by the team. Reductions alternate between two sets of slots,
+// such that a thread can publish the next partial sum while others still read
+// the previous result.
+struct Team
+{
+    SpinBarrier barrier;
+    ReductionSlot* slots[2];
+    double result[2];
+};
+
+// State private to each thread of the team
+struct TeamThread
+{
+    Team* team;
+    int tid;
+    int nthreads;
+    int sense;          // sense of the next barrier
+    int generation;     // set of slots of the next reduction
+    std::vector<int> sweeps; // Gauss-Seidel sweeps completed by each level
+};
+
+static void Barrier(TeamThread& t)
+{
+    SpinBarrier& b = t.team->barrier;
+
+    t.sense = !t.sense;
+
+    if(b.count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        ++b.barriers;
+        b.count.store(b.nthreads, std::memory_order_relaxed);
+        b.sense.store(t.sense, std::memory_order_release);
+
+        return;
+    }
+
+    int spin = 0;
+
+    while(b.sense.load(std::memory_order_acquire) != t.sense)
+    {
+        if(++spin >= HPCG_BARRIER_SPIN)
+        {
+            std::this_thread::yield();
+            spin = 0;
+        }
+    }
+}
+
+// Rows [begin, end) of the thread in a static partition of n rows
+static inline void Range(const TeamThread& t, local_int_t n, local_int_t& begin, local_int_t& end)
+{
+    begin = (local_int_t)((long long)n * t.tid / t.nthreads);
+    end = (local_int_t)((long long)n * (t.tid + 1) / t.nthreads);
+}
+
+// Sum of the partial sums of all threads in thread order, the same value for
+// every thread. Contains a barrier.
+static double Reduce(TeamThread& t, double local_result)
+{
+    Team& team = *t.team;
+    ReductionSlot* slots = team.slots[t.generation];
+
+    slots[t.tid].value = local_result;
+
+    Barrier(t);
+
+#ifndef HPCG_NO_MPI
+    // One process wide sum, handed to the team through the shared result
+    if(t.tid == 0)
+    {
+        double sum = 0.0;
+
+        for(int i = 0; i < t.nthreads; ++i)
+        {
+            sum += slots[i].value;
+        }
+
+        MPI_Allreduce(&sum, &team.result[t.generation], 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    }
+
+    Barrier(t);
+
+    double result = team.result[t.generation];
+#else
+    double result = 0.0;
+
+    for(int i = 0; i < t.nthreads; ++i)
+    {
+        result += slots[i].value;
+    }
+#endif
+
+    t.generation = !t.generation;
+
+    return result;
+}
+
+// Halo exchange of x by the master thread, after a barrier that completed the
+// rows of x. The whole of x is complete on return.
+static void ExchangeHaloTeam(TeamThread& t, const SparseMatrix& A, Vector& x)
+{
+#ifndef HPCG_NO_MPI
+    if(t.tid == 0)
+    {
+        ExchangeHalo(A, x);
+    }
+
+    Barrier(t);
+#else
+    (void)t;
+    (void)A;
+    (void)x;
+#endif
+}
+
+static void ZeroRows(TeamThread& t, local_int_t n, Vector& x)
+{
+    local_int_t begin, end;
+    Range(t, n, begin, end);
+
+    double* xv = x.values;
+
+    for(local_int_t i = begin; i < end; ++i)
+    {
+        xv[i] = 0.0;
+    }
+}
+
+static void CopyRows(TeamThread& t, local_int_t n, const Vector& x, Vector& y)
+{
+    local_int_t begin, end;
+    Range(t, n, begin, end);
+
+    const double* xv = x.values;
+    double* yv = y.values;
+
+    for(local_int_t i = begin; i < end; ++i)
+    {
+        yv[i] = xv[i];
+    }
+}
+
+// Same cases as ComputeWAXPBY_ref
+static void WAXPBYRows(
+    TeamThread& t, local_int_t n, double alpha, const Vector& x, double beta, const Vector& y, Vector& w)
+{
+    local_int_t begin, end;
+    Range(t, n, begin, end);
+
+    const double* xv = x.values;
+    const double* yv = y.values;
+    double* wv = w.values;
+
+    if(alpha == 1.0)
+    {
+        for(local_int_t i = begin; i < end; ++i)
+        {
+            wv[i] = xv[i] + beta * yv[i];
+        }
+    }
+    else if(beta == 1.0)
+    {
+        for(local_int_t i = begin; i < end; ++i)
+        {
+            wv[i] = alpha * xv[i] + yv[i];
+        }
+    }
+    else
+    {
+        for(local_int_t i = begin; i < end; ++i)
+        {
+            wv[i] = alpha * xv[i] + beta * yv[i];
+        }
+    }
+}
+
+static double DotRows(TeamThread& t, local_int_t n, const Vector& x, const Vector& y)
+{
+    local_int_t begin, end;
+    Range(t, n, begin, end);
+
+    const double* xv = x.values;
+    const double* yv = y.values;
+
+    double local_result = 0.0;
+
+    for(local_int_t i = begin; i < end; ++i)
+    {
+        local_result += xv[i] * yv[i];
+    }
+
+    return Reduce(t, local_result);
+}
+
+// Rows of y of the thread, x has to be complete including its halo
+static void SPMVRows(TeamThread& t, const SparseMatrix& A, const Vector& x, Vector& y)
+{
+    local_int_t begin, end;
+    Range(t, A.localNumberOfRows, begin, end);
+
+    const double* xv = x.values;
+    double* yv = y.values;
+
+    for(local_int_t i = begin; i < end; ++i)
+    {
+        const double* cur_vals = A.matrixValues[i];
+        const local_int_t* cur_inds = A.mtxIndL[i];
+        int cur_nnz = A.nonzerosInRow[i];
+
+        double sum = 0.0;
+
+        for(int j = 0; j < cur_nnz; ++j)
+        {
+            sum += cur_vals[j] * xv[cur_inds[j]];
+        }
+
+        yv[i] = sum;
+    }
+}
+
+// Smoother on the level scheduled rows of the thread, or on the master thread
+// if there is no schedule
+static void SYMGSTeam(TeamThread& t, const SparseMatrix& A, const Vector& r, Vector& x)
+{
+    Barrier(t);
+
+    if(A.lowerLevelPtr != 0)
+    {
+        ExchangeHaloTeam(t, A, x);
+
+        int forward = t.sweeps[A.level] + 1;
+        t.sweeps[A.level] += 2;
+
+        ComputeSYMGS_level_thread(A, r, x, forward, t.tid, t.nthreads);
+    }
+    else if(t.tid == 0)
+    {
+        ComputeSYMGS_ref(A, r, x);
+    }
+
+    Barrier(t);
+}
+
+// V-cycle as ComputeMG_ref. It ends with the barrier of the last smoother
+// step, thus x is complete on return.
+static void MGTeam(TeamThread& t, const SparseMatrix& A, const Vector& r, Vector& x)
+{
+    assert(x.localLength == A.localNumberOfColumns);
+
+    ZeroRows(t, x.localLength, x);
+
+    if(A.mgData != 0)
+    {
+        for(int i = 0; i < A.mgData->numberOfPresmootherSteps; ++i)
+        {
+            SYMGSTeam(t, A, r, x);
+        }
+
+        ExchangeHaloTeam(t, A, x);
+        SPMVRows(t, A, x, *A.mgData->Axf);
+        Barrier(t);
+
+        // Restriction by injection, the coarse V-cycle zeroes xc before it reads rc
+        const double* Axfv = A.mgData->Axf->values;
+        const double* rfv = r.values;
+        double* rcv = A.mgData->rc->values;
+        const local_int_t* f2c = A.mgData->f2cOperator;
+
+        local_int_t begin, end;
+        Range(t, A.mgData->rc->localLength, begin, end);
+
+        for(local_int_t i = begin; i < end; ++i)
+        {
+            rcv[i] = rfv[f2c[i]] - Axfv[f2c[i]];
+        }
+
+        MGTeam(t, *A.Ac, *A.mgData->rc, *A.mgData->xc);
+
+        double* xfv = x.values;
+        const double* xcv = A.mgData->xc->values;
+
+        for(local_int_t i = begin; i < end; ++i)
+        {
+            xfv[f2c[i]] += xcv[i];
+        }
+
+        for(int i = 0; i < A.mgData->numberOfPostsmootherSteps; ++i)
+        {
+            SYMGSTeam(t, A, r, x);
+        }
+    }
+    else
+    {
+        SYMGSTeam(t, A, r, x);
+    }
+}
+
+// The whole solve of CG_persistent on one thread of the team
+static void CGTeam(TeamThread& t,
+                   const SparseMatrix& A,
+                   CGData& data,
+                   const Vector& b,
+                   Vector& x,
+                   int max_iter,
+                   double tolerance,
+                   int& niters,
+                   double& normr,
+                   double& normr0)
+{
+    local_int_t nrow = A.localNumberOfRows;
+
+    Vector& r = data.r;
+    Vector& z = data.z;
+    Vector& p = data.p;
+    Vector& Ap = data.Ap;
+
+    double rtz = 0.0;
+    double oldrtz = 0.0;
+
+    // p is of length ncols, copy x to p for sparse MV operation
+    CopyRows(t, x.localLength, x, p);
+    Barrier(t);
+    ExchangeHaloTeam(t, A, p);
+    SPMVRows(t, A, p, Ap);
+    WAXPBYRows(t, nrow, 1.0, b, -1.0, Ap, r);
+    normr = sqrt(DotRows(t, nrow, r, r));
+
+    normr0 = normr;
+
+    int k;
+
+    for(k = 1; k <= max_iter && normr / normr0 > tolerance; ++k)
+    {
+        MGTeam(t, A, r, z);
+
+        oldrtz = rtz;
+        rtz = DotRows(t, nrow, r, z);
+
+        if(k == 1)
+        {
+            CopyRows(t, z.localLength, z, p);
+        }
+        else
+        {
+            WAXPBYRows(t, nrow, 1.0, z, rtz / oldrtz, p, p);
+        }
+
+        Barrier(t);
+        ExchangeHaloTeam(t, A, p);
+        SPMVRows(t, A, p, Ap);
+
+        // Each thread reads its own rows of Ap only
+        double alpha = rtz / DotRows(t, nrow, p, Ap);
+
+        WAXPBYRows(t, nrow, 1.0, x, alpha, p, x);
+        WAXPBYRows(t, nrow, 1.0, r, -alpha, Ap, r);
+        normr = sqrt(DotRows(t, nrow, r, r));
+    }
+
+    niters = k - 1;
+}
+
+/*!
+  Preconditioned CG as CG_ref, with all kernels of the solve run by one thread
+  team instead of a parallel region per kernel. The kernels become phases of
+  the team, separated by a sense reversing spin barrier where a phase reads
+  rows written by other threads. Every thread works on the same static
+  partition of the rows in all vector kernels, thus a kernel reading only the
+  rows the thread wrote in the previous kernel needs no barrier. Dot products
+  are reduced through one padded slot per thread, summed in thread order, and
+  the scalars of the iteration are computed redundantly by every thread.
+
+  The smoother is level scheduled if the matrix has a schedule, otherwise it
+  runs on the master thread while the team waits. Halo exchanges and
+  reductions call MPI from the master thread only.
+
+  @param[in]    A         The known system matrix
+  @param[inout] data      The data structure with all necessary CG vectors preallocated
+  @param[in]    b         The known right hand side vector
+  @param[inout] x         On entry: the initial guess; on exit: the new approximate solution
+  @param[in]    max_iter  The maximum number of iterations to perform, even if tolerance is not met.
+  @param[in]    tolerance The stopping criterion to assert convergence: if norm of residual is <= to tolerance.
+  @param[out]   niters    The number of iterations actually performed.
+  @param[out]   normr     The 2-norm of the residual vector after the last iteration.
+  @param[out]   normr0    The 2-norm of the residual vector before the first iteration.
+  @param[out]   barriers  The number of barriers of the team during the solve.
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see CG_ref
+*/
+int CG_persistent(const SparseMatrix& A,
+                  CGData& data,
+                  const Vector& b,
+                  Vector& x,
+                  const int max_iter,
+                  const double tolerance,
+                  int& niters,
+                  double& normr,
+                  double& normr0,
+                  long long& barriers)
+{
+#ifndef HPCG_NO_OPENMP
+    int nthreads = omp_get_max_threads();
+#else
+    int nthreads = 1;
+#endif
+
+    Team team;
+    team.barrier.count.store(nthreads, std::memory_order_relaxed);
+    team.barrier.sense.store(0, std::memory_order_relaxed);
+    team.barrier.nthreads = nthreads;
+    team.barrier.barriers = 0;
+    team.slots[0] = new ReductionSlot[nthreads];
+    team.slots[1] = new ReductionSlot[nthreads];
+
+    // Sweeps completed so far by the level scheduled matrices
+    std::vector<int> sweeps;
+
+    for(const SparseMatrix* M = &A; M != 0; M = M->Ac)
+    {
+        sweeps.resize(M->level + 1, 0);
+
+        if(M->lowerLevelPtr != 0)
+        {
+            sweeps[M->level] = M->rowSweeps[0].load(std::memory_order_relaxed);
+        }
+    }
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        TeamThread t;
+        t.team = &team;
+#ifndef HPCG_NO_OPENMP
+        t.tid = omp_get_thread_num();
+#else
+        t.tid = 0;
+#endif
+        t.nthreads = nthreads;
+        t.sense = 0;
+        t.generation = 0;
+        t.sweeps = sweeps;
+
+        int thread_niters;
+        double thread_normr;
+        double thread_normr0;
+
+        CGTeam(t, A, data, b, x, max_iter, tolerance, thread_niters, thread_normr, thread_normr0);
+
+        if(t.tid == 0)
+        {
+            niters = thread_niters;
+            normr = thread_normr;
+            normr0 = thread_normr0;
+        }
+    }
+
+    barriers = team.barrier.barriers;
+
+    delete[] team.slots[0];
+    delete[] team.slots[1];
+
+    return 0;
+}
@@ -60,10 +60,6 @@
 #include "ComputeWAXPBY_ref.hpp"
 
 
-// Use TICK and TOCK to time a code section in MATLAB-like fashion
-#define TICK()  t0 = mytimer() //!< record current time in 't0'
-#define TOCK(t) t += mytimer() - t0 //!< store time difference in 't' using time in 't0'
-
 /*!
   Reference routine to compute an approximate solution to Ax = b
 
@@ -87,12 +83,12 @@ int CG_ref(const SparseMatrix & A, CGData & data, const Vector & b, Vector & x,
     const int max_iter, const double tolerance, int & niters, double & normr, double & normr0,
     double * times, bool doPreconditioning, bool verbose) {
 
-  double t_begin = mytimer();  // Start timing right away
+  ScopedTimer total(times[0]);  // Start timing right away, total time at return
   normr = 0.0;
   double rtz = 0.0, oldrtz = 0.0, alpha = 0.0, beta = 0.0, pAp = 0.0;
 
 
-  double t0 = 0.0, t1 = 0.0, t2 = 0.0, t3 = 0.0, t4 = 0.0, t5 = 0.0;
+  double t1 = 0.0, t2 = 0.0, t3 = 0.0, t4 = 0.0, t5 = 0.0;
 //#ifndef HPCG_NO_MPI
 //  double t6 = 0.0;
 //#endif
@@ -113,9 +109,9 @@ int CG_ref(const SparseMatrix & A, CGData & data, const Vector & b, Vector & x,
 #endif
   // p is of length ncols, copy x to p for sparse MV operation
   CopyVector(x, p);
-  TICK(); ComputeSPMV_ref(A, p, Ap);  TOCK(t3); // Ap = A*p
-  TICK(); ComputeWAXPBY_ref(nrow, 1.0, b, -1.0, Ap, r); TOCK(t2); // r = b - Ax (x stored in p)
-  TICK(); ComputeDotProduct_ref(nrow, r, r, normr, t4);  TOCK(t1);
+  { ScopedTimer timer(t3); ComputeSPMV_ref(A, p, Ap); } // Ap = A*p
+  { ScopedTimer timer(t2); ComputeWAXPBY_ref(nrow, 1.0, b, -1.0, Ap, r); } // r = b - Ax (x stored in p)
+  { ScopedTimer timer(t1); ComputeDotProduct_ref(nrow, r, r, normr, t4); }
   normr = sqrt(normr);
 #ifdef HPCG_DEBUG
   if (A.geom->rank==0) HPCG_fout << "Initial Residual = "<< normr << std::endl;
@@ -128,29 +124,33 @@ int CG_ref(const SparseMatrix & A, CGData & data, const Vector & b, Vector & x,
   // Start iterations
 
   for (int k=1; k<=max_iter && normr/normr0 > tolerance; k++ ) {
-    TICK();
-    if (doPreconditioning)
-      ComputeMG_ref(A, r, z); // Apply preconditioner
-    else
-      ComputeWAXPBY_ref(nrow, 1.0, r, 0.0, r, z); // copy r to z (no preconditioning)
-    TOCK(t5); // Preconditioner apply time
+    {
+      ScopedTimer timer(t5); // Preconditioner apply time
+      if (doPreconditioning)
+        ComputeMG_ref(A, r, z); // Apply preconditioner
+      else
+        ComputeWAXPBY_ref(nrow, 1.0, r, 0.0, r, z); // copy r to z (no preconditioning)
+    }
 
     if (k == 1) {
-      CopyVector(z, p); TOCK(t2); // Copy Mr to p
-      TICK(); ComputeDotProduct_ref(nrow, r, z, rtz, t4); TOCK(t1); // rtz = r'*z
+      { ScopedTimer timer(t2); CopyVector(z, p); } // Copy Mr to p
+      { ScopedTimer timer(t1); ComputeDotProduct_ref(nrow, r, z, rtz, t4); } // rtz = r'*z
     } else {
       oldrtz = rtz;
-      TICK(); ComputeDotProduct_ref(nrow, r, z, rtz, t4); TOCK(t1); // rtz = r'*z
+      { ScopedTimer timer(t1); ComputeDotProduct_ref(nrow, r, z, rtz, t4); } // rtz = r'*z
       beta = rtz/oldrtz;
-      TICK(); ComputeWAXPBY_ref(nrow, 1.0, z, beta, p, p);  TOCK(t2); // p = beta*p + z
+      { ScopedTimer timer(t2); ComputeWAXPBY_ref(nrow, 1.0, z, beta, p, p); } // p = beta*p + z
     }
 
-    TICK(); ComputeSPMV_ref(A, p, Ap); TOCK(t3); // Ap = A*p
-    TICK(); ComputeDotProduct_ref(nrow, p, Ap, pAp, t4); TOCK(t1); // alpha = p'*Ap
+    { ScopedTimer timer(t3); ComputeSPMV_ref(A, p, Ap); } // Ap = A*p
+    { ScopedTimer timer(t1); ComputeDotProduct_ref(nrow, p, Ap, pAp, t4); } // alpha = p'*Ap
     alpha = rtz/pAp;
-    TICK(); ComputeWAXPBY_ref(nrow, 1.0, x, alpha, p, x);// x = x + alpha*p
-            ComputeWAXPBY_ref(nrow, 1.0, r, -alpha, Ap, r);  TOCK(t2);// r = r - alpha*Ap
-    TICK(); ComputeDotProduct_ref(nrow, r, r, normr, t4); TOCK(t1);
+    {
+      ScopedTimer timer(t2);
+      ComputeWAXPBY_ref(nrow, 1.0, x, alpha, p, x);// x = x + alpha*p
+      ComputeWAXPBY_ref(nrow, 1.0, r, -alpha, Ap, r);// r = r - alpha*Ap
+    }
+    { ScopedTimer timer(t1); ComputeDotProduct_ref(nrow, r, r, normr, t4); }
     normr = sqrt(normr);
 #ifdef HPCG_DEBUG
     if (A.geom->rank==0 && (k%print_freq == 0 || k == max_iter))
@@ -169,7 +169,6 @@ int CG_ref(const SparseMatrix & A, CGData & data, const Vector & b, Vector & x,
 //#ifndef HPCG_NO_MPI
 //  times[6] += t6; // exchange halo time
 //#endif
-  times[0] += mytimer() - t_begin;  // Total time. All done...
   return 0;
 }
 
@@ -0,0 +1,148 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file CG_tasks.cpp
+
+ Host CG on task graphs of the iterations
+ */
+
+#include <cmath>
+
+#include "CG_tasks.hpp"
+#include "ComputeSPMV_ref.hpp"
+#include "ComputeDotProduct_ref.hpp"
+#include "ComputeWAXPBY_ref.hpp"
+
+/*!
+  Builds the task graphs of the CG iterations.
+
+  @param[out]   cg          The graphs and their runtime
+  @param[in]    A           The known system matrix, including its coarse levels
+  @param[inout] data        The CG vectors
+  @param[inout] x           The solution vector all later solves have to use
+  @param[in]    rowsPerTask The largest number of rows of a task
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int SetupTaskCG(HostTaskCG& cg, const SparseMatrix& A, CGData& data, Vector& x, local_int_t rowsPerTask)
+{
+    InitializeTaskRuntime(cg.runtime);
+
+    for(int i = 0; i < HPCG_TASK_NUMBER_OF_SCALARS; ++i)
+    {
+        cg.scalars[i] = 0.0;
+    }
+
+    InitializeTaskGraph(cg.first, rowsPerTask, cg.runtime.numberOfThreads);
+    AddCGIterationTasks(cg.first, A, data, x, cg.scalars, true);
+    FinalizeTaskGraph(cg.first);
+
+    InitializeTaskGraph(cg.iteration, rowsPerTask, cg.runtime.numberOfThreads);
+    AddCGIterationTasks(cg.iteration, A, data, x, cg.scalars, false);
+    FinalizeTaskGraph(cg.iteration);
+
+    return 0;
+}
+
+/*!
+  Preconditioned CG as CG_ref, with each iteration run as one task graph
+  instead of a parallel region per kernel. The initial residual is computed
+  with the reference kernels.
+
+  @param[inout] cg        The graphs set up for A, data and x
+  @param[in]    A         The known system matrix
+  @param[inout] data      The CG vectors
+  @param[in]    b         The known right hand side vector
+  @param[inout] x         On entry: the initial guess; on exit: the new approximate solution
+  @param[in]    max_iter  The maximum number of iterations to perform, even if tolerance is not met.
+  @param[in]    tolerance The stopping criterion to assert convergence: if norm of residual is <= to tolerance.
+  @param[out]   niters    The number of iterations actually performed.
+  @param[out]   normr     The 2-norm of the residual vector after the last iteration.
+  @param[out]   normr0    The 2-norm of the residual vector before the first iteration.
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see CG_ref
+*/
+int CG_tasks(HostTaskCG& cg,
+             const SparseMatrix& A,
+             CGData& data,
+             const Vector& b,
+             Vector& x,
+             const int max_iter,
+             const double tolerance,
+             int& niters,
+             double& normr,
+             double& normr0)
+{
+    local_int_t nrow = A.localNumberOfRows;
+    double t_allreduce = 0.0;
+    int ierr = 0;
+
+    niters = 0;
+
+    // p is of length ncols, copy x to p for sparse MV operation
+    CopyVector(x, data.p);
+    ComputeSPMV_ref(A, data.p, data.Ap);
+    ComputeWAXPBY_ref(nrow, 1.0, b, -1.0, data.Ap, data.r);
+    ComputeDotProduct_ref(nrow, data.r, data.r, normr, t_allreduce);
+    normr = sqrt(normr);
+
+    normr0 = normr;
+
+    for(int k = 1; k <= max_iter && normr / normr0 > tolerance; ++k)
+    {
+        if(k == 1)
+        {
+            ierr += RunTaskGraph(cg.runtime, cg.first, true);
+        }
+        else
+        {
+            cg.scalars[HPCG_TASK_OLDRTZ] = cg.scalars[HPCG_TASK_RTZ];
+            ierr += RunTaskGraph(cg.runtime, cg.iteration, true);
+        }
+
+        normr = sqrt(cg.scalars[HPCG_TASK_RR]);
+        niters = k;
+    }
+
+    return ierr;
+}
+
+/*!
+  Releases the graphs and the runtime.
+
+  @param[inout] cg The graphs and their runtime
+*/
+void DeleteTaskCG(HostTaskCG& cg)
+{
+    DeleteTaskGraph(cg.first);
+    DeleteTaskGraph(cg.iteration);
+    DeleteTaskRuntime(cg.runtime);
+}
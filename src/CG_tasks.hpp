@@ -0,0 +1,68 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file CG_tasks.hpp
+
+ Host CG on task graphs of the iterations
+ */
+
+#ifndef CG_TASKS_HPP
+#define CG_TASKS_HPP
+
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+#include "CGData.hpp"
+#include "TaskGraph.hpp"
+#include "TaskRuntime.hpp"
+
+struct HostTaskCG_STRUCT
+{
+    HostTaskGraph first;                         //!< tasks of the first iteration
+    HostTaskGraph iteration;                     //!< tasks of the following iterations
+    HostTaskRuntime runtime;                     //!< runtime running both graphs
+    double scalars[HPCG_TASK_NUMBER_OF_SCALARS]; //!< scalars shared by both graphs
+};
+typedef struct HostTaskCG_STRUCT HostTaskCG;
+
+int SetupTaskCG(HostTaskCG& cg, const SparseMatrix& A, CGData& data, Vector& x, local_int_t rowsPerTask);
+
+int CG_tasks(HostTaskCG& cg,
+             const SparseMatrix& A,
+             CGData& data,
+             const Vector& b,
+             Vector& x,
+             const int max_iter,
+             const double tolerance,
+             int& niters,
+             double& normr,
+             double& normr0);
+
+void DeleteTaskCG(HostTaskCG& cg);
+
+#endif // CG_TASKS_HPP
@@ -62,7 +62,14 @@ using std::endl;
 #include <cassert>
 
 #include "CheckProblem.hpp"
+#include "ProblemCoefficients.hpp"
 
+// Values of the reference problem are exact, others are generated on the
+// device and may differ in the last bits
+static bool ValueMatches(int problem, double value, double expected) {
+  if (problem == HPCG_PROBLEM_LAPLACE) return value == expected;
+  return std::fabs(value - expected) <= 1.0e-12 * std::fabs(expected);
+}
 
 /*!
   Check the contents of the generated sparse matrix to see if values match expected contents.
@@ -88,6 +95,7 @@ void CheckProblem(SparseMatrix & A, Vector * b, Vector * x, Vector * xexact) {
   global_int_t gix0 = A.geom->gix0;
   global_int_t giy0 = A.geom->giy0;
   global_int_t giz0 = A.geom->giz0;
+  int problem = A.geom->problem;
 
   local_int_t localNumberOfRows = nx*ny*nz; // This is the size of our subblock
   global_int_t totalNumberOfRows = gnx*gny*gnz; // Total number of grid points in mesh
@@ -128,9 +136,9 @@ void CheckProblem(SparseMatrix & A, Vector * b, Vector * x, Vector * xexact) {
                     global_int_t curcol = currentGlobalRow+sz*gnx*gny+sy*gnx+sx;
                     if (curcol==currentGlobalRow) {
                       assert(A.matrixDiagonal[currentLocalRow] == currentValuePointer);
-                      assert(*currentValuePointer++ == 26.0);
+                      assert(ValueMatches(problem, *currentValuePointer++, ComputeDiagonal(problem, gix, giy, giz, gnx, gny, gnz)));
                     } else {
-                      assert(*currentValuePointer++ == -1.0);
+                      assert(ValueMatches(problem, *currentValuePointer++, -ComputeCoupling(problem, gix, giy, giz, sx, sy, sz, gnx, gny, gnz)));
                     }
                     assert(*currentIndexPointerG++ == curcol);
                     numberOfNonzerosInRow++;
@@ -145,7 +153,7 @@ void CheckProblem(SparseMatrix & A, Vector * b, Vector * x, Vector * xexact) {
         #pragma omp critical
 #endif
         localNumberOfNonzeros += numberOfNonzerosInRow; // Protect this with an atomic
-        if (b!=0)      assert(bv[currentLocalRow] == 26.0 - ((double) (numberOfNonzerosInRow-1)));
+        if (b!=0)      assert(ValueMatches(problem, bv[currentLocalRow], ComputeRowSum(problem, gix, giy, giz, gnx, gny, gnz)));
         if (x!=0)      assert(xv[currentLocalRow] == 0.0);
         if (xexact!=0) assert(xexactv[currentLocalRow] == 1.0);
       } // end ix loop
@@ -0,0 +1,301 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file CompressELL.cpp
+
+ ELL storage with 16-bit column offsets relative to a per-chunk base
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cfloat>
+#include <hip/hip_runtime.h>
+
+#include "utils.hpp"
+#include "mytimer.hpp"
+#include "CompressELL.hpp"
+#include "ComputeSPMV.hpp"
+#include "ComputeSYMGS.hpp"
+
+// Number of timed calls of each kernel and format
+#define ELL_REL_NTIMES 10
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_ell_rel_base(local_int_t m,
+                                    local_int_t nchunks,
+                                    local_int_t ell_width,
+                                    const local_int_t* __restrict__ ell_col_ind,
+                                    local_int_t* __restrict__ ell_col_base)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= nchunks * ell_width)
+    {
+        return;
+    }
+
+    local_int_t chunk = gid / ell_width;
+    local_int_t p = gid % ell_width;
+
+    local_int_t begin = chunk * ELL_REL_CHUNK;
+    local_int_t end = min(begin + ELL_REL_CHUNK, m);
+
+    // Smallest local column of the chunk, such that all offsets are non-negative
+    local_int_t base = m;
+
+    for(local_int_t row = begin; row < end; ++row)
+    {
+        local_int_t col = ell_col_ind[p * m + row];
+
+        if(col >= 0 && col < m)
+        {
+            base = min(base, col);
+        }
+    }
+
+    ell_col_base[gid] = (base == m) ? 0 : base;
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_ell_rel_compress(local_int_t m,
+                                        local_int_t ell_width,
+                                        const local_int_t* __restrict__ ell_col_ind,
+                                        const local_int_t* __restrict__ ell_col_base,
+                                        unsigned short* __restrict__ ell_col_rel,
+                                        local_int_t* __restrict__ escapes)
+{
+    local_int_t idx = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(idx >= m * ell_width)
+    {
+        return;
+    }
+
+    local_int_t row = idx % m;
+    local_int_t p = idx / m;
+    local_int_t col = ell_col_ind[idx];
+
+    if(col < 0)
+    {
+        ell_col_rel[idx] = ELL_REL_SKIP;
+        return;
+    }
+
+    local_int_t rel = col - ell_col_base[(row / ELL_REL_CHUNK) * ell_width + p];
+
+    // Halo columns and columns out of range of the base are escaped
+    if(col >= m || rel < 0 || rel >= ELL_REL_ESCAPE)
+    {
+        ell_col_rel[idx] = ELL_REL_ESCAPE;
+        atomicAdd(escapes, 1);
+        return;
+    }
+
+    ell_col_rel[idx] = (unsigned short)rel;
+}
+
+/*!
+  Builds the index compressed ELL arrays of all levels of the hierarchy. Rows
+  are grouped into chunks of ELL_REL_CHUNK consecutive rows. Each chunk stores
+  one 32-bit column base per ELL column, and every entry a 16-bit offset to
+  that base. Due to the multicolor ordering, the columns of a chunk are close
+  to each other, while the distance to the row itself is not. Unused entries
+  are marked ELL_REL_SKIP. Halo columns and columns too far from the base are
+  marked ELL_REL_ESCAPE; the kernels read those from the plain ell_col_ind,
+  which serves as escape table.
+
+  @param[inout] A the fine level matrix, after OptimizeProblem
+
+  @return returns 0 upon success and non-zero otherwise
+ */
+int CompressELL(SparseMatrix& A)
+{
+    for(SparseMatrix* level = &A; level != NULL; level = level->Ac)
+    {
+        local_int_t m = level->localNumberOfRows;
+        local_int_t nchunks = (m - 1) / ELL_REL_CHUNK + 1;
+        local_int_t ell_width = level->ell_width;
+
+        RETURN_IF_HIP_ERROR(deviceMalloc((void**)&level->ell_col_base, sizeof(local_int_t) * nchunks * ell_width));
+        RETURN_IF_HIP_ERROR(deviceMalloc((void**)&level->ell_col_rel, sizeof(unsigned short) * m * ell_width));
+
+        local_int_t* d_escapes = reinterpret_cast<local_int_t*>(workspace);
+        RETURN_IF_HIP_ERROR(hipMemset(d_escapes, 0, sizeof(local_int_t)));
+
+        kernel_ell_rel_base<1024><<<(nchunks * ell_width - 1) / 1024 + 1, 1024>>>(
+            m,
+            nchunks,
+            ell_width,
+            level->ell_col_ind,
+            level->ell_col_base);
+
+        kernel_ell_rel_compress<1024><<<(m * ell_width - 1) / 1024 + 1, 1024>>>(
+            m,
+            ell_width,
+            level->ell_col_ind,
+            level->ell_col_base,
+            level->ell_col_rel,
+            d_escapes);
+
+        RETURN_IF_HIP_ERROR(hipMemcpy(&level->ell_escapes, d_escapes, sizeof(local_int_t), hipMemcpyDeviceToHost));
+    }
+
+    return 0;
+}
+
+// Time of a single SpMV or SYMGS call of the slowest process
+static double TimeKernel(const SparseMatrix& A, CGData& data, bool symgs)
+{
+    // Warm up
+    if(symgs) ComputeSYMGS(A, data.r, data.z);
+    else ComputeSPMV(A, data.p, data.Ap);
+
+    HIP_CHECK(hipDeviceSynchronize());
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    double t0 = mytimer();
+
+    for(int i = 0; i < ELL_REL_NTIMES; ++i)
+    {
+        if(symgs) ComputeSYMGS(A, data.r, data.z);
+        else ComputeSPMV(A, data.p, data.Ap);
+    }
+
+    HIP_CHECK(hipDeviceSynchronize());
+
+    double local_time = (mytimer() - t0) / ELL_REL_NTIMES;
+    double time = local_time;
+
+#ifndef HPCG_NO_MPI
+    MPI_Allreduce(&local_time, &time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+
+    return time;
+}
+
+// Adds the index bytes and the throughput of both formats to the report
+static void ReportCompressedELL(const CompressedELLData& ell_data, ReportSections& sections)
+{
+    OutputFile* report = sections.add(REPORT_COMPRESSED_ELL, "Compressed ELL");
+
+    report->add("Index bytes per nonzero (ELL)", ell_data.plain_index_bytes);
+    report->add("Index bytes per nonzero (compressed)", ell_data.rel_index_bytes);
+    report->add("Index bytes per nonzero saved", ell_data.plain_index_bytes - ell_data.rel_index_bytes);
+    report->add("Fraction of escaped entries", ell_data.escape_ratio);
+    report->add("SpMV GFLOP/s (ELL)", ell_data.plain_spmv_gflops);
+    report->add("SpMV GFLOP/s (compressed)", ell_data.rel_spmv_gflops);
+    report->add("SpMV speedup", ell_data.rel_spmv_gflops / ell_data.plain_spmv_gflops);
+    report->add("SYMGS GFLOP/s (ELL)", ell_data.plain_symgs_gflops);
+    report->add("SYMGS GFLOP/s (compressed)", ell_data.rel_symgs_gflops);
+    report->add("SYMGS speedup", ell_data.rel_symgs_gflops / ell_data.plain_symgs_gflops);
+
+    sections.print("Compressed ELL: %0.2lf instead of %0.2lf index bytes per nonzero (%0.2lf%% escaped)\n",
+                   ell_data.rel_index_bytes,
+                   ell_data.plain_index_bytes,
+                   ell_data.escape_ratio * 100.0);
+    sections.print("SpMV   %7.1lf GFlop/s   %5.2lfx vs ELL\n",
+                   ell_data.rel_spmv_gflops,
+                   ell_data.rel_spmv_gflops / ell_data.plain_spmv_gflops);
+    sections.print("SYMGS  %7.1lf GFlop/s   %5.2lfx vs ELL\n",
+                   ell_data.rel_symgs_gflops,
+                   ell_data.rel_symgs_gflops / ell_data.plain_symgs_gflops);
+}
+
+/*!
+  Compares the index traffic and the throughput of SpMV and SYMGS on the
+  finest level with the plain and the index compressed ELL format.
+
+  @param[inout] A        the fine level matrix, after CompressELL
+  @param[inout] data     CG work vectors, overwritten by the measurement
+  @param[inout] sections the measured bytes per nonzero and GFLOP/s are added
+
+  @return returns 0 upon success and non-zero otherwise
+ */
+int TestCompressedELL(SparseMatrix& A, CGData& data, ReportSections& sections)
+{
+    if(A.ell_col_rel == NULL)
+    {
+        return 0;
+    }
+
+    CompressedELLData ell_data;
+
+    // Index bytes of both formats, summed over all processes
+    local_int_t m = A.localNumberOfRows;
+    local_int_t nchunks = (m - 1) / ELL_REL_CHUNK + 1;
+
+    double local_bytes[4];
+    local_bytes[0] = sizeof(local_int_t) * (double)m * A.ell_width;
+    local_bytes[1] = sizeof(unsigned short) * (double)m * A.ell_width
+                   + sizeof(local_int_t) * ((double)nchunks * A.ell_width + A.ell_escapes);
+    local_bytes[2] = A.ell_escapes;
+    local_bytes[3] = (double)m * A.ell_width;
+
+    double bytes[4];
+    std::copy(local_bytes, local_bytes + 4, bytes);
+
+#ifndef HPCG_NO_MPI
+    MPI_Allreduce(local_bytes, bytes, 4, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+#endif
+
+    double nnz = A.totalNumberOfNonzeros;
+
+    ell_data.plain_index_bytes = bytes[0] / nnz;
+    ell_data.rel_index_bytes = bytes[1] / nnz;
+    ell_data.escape_ratio = bytes[2] / bytes[3];
+
+    HIPZeroVector(data.r);
+    HIPZeroVector(data.z);
+    HIPZeroVector(data.p);
+    HIPZeroVector(data.Ap);
+
+    // SpMV performs 2 and SYMGS 4 flops per nonzero
+    ell_data.rel_spmv_gflops = 2.0 * nnz / TimeKernel(A, data, false) / 1e9;
+    ell_data.rel_symgs_gflops = 4.0 * nnz / TimeKernel(A, data, true) / 1e9;
+
+    // Temporarily fall back to the plain format
+    unsigned short* ell_col_rel = A.ell_col_rel;
+    A.ell_col_rel = NULL;
+
+    ell_data.plain_spmv_gflops = 2.0 * nnz / TimeKernel(A, data, false) / 1e9;
+    ell_data.plain_symgs_gflops = 4.0 * nnz / TimeKernel(A, data, true) / 1e9;
+
+    A.ell_col_rel = ell_col_rel;
+
+    ReportCompressedELL(ell_data, sections);
+
+    return 0;
+}
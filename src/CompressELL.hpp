@@ -0,0 +1,66 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file CompressELL.hpp
+
+ ELL storage with 16-bit column offsets relative to a per-chunk base
+ */
+
+#ifndef COMPRESSELL_HPP
+#define COMPRESSELL_HPP
+
+#include "SparseMatrix.hpp"
+#include "CGData.hpp"
+#include "ReportSections.hpp"
+
+//! Number of consecutive rows sharing the column bases, one wavefront
+#define ELL_REL_CHUNK 64
+
+//! Relative column marking an unused ELL entry
+#define ELL_REL_SKIP 0xFFFF
+
+//! Relative column marking an entry whose column is read from ell_col_ind
+#define ELL_REL_ESCAPE 0xFFFE
+
+struct CompressedELLData_STRUCT
+{
+    double plain_index_bytes;  //!< index bytes per nonzero of the ELL format on the finest level
+    double rel_index_bytes;    //!< index bytes per nonzero of the compressed format on the finest level
+    double escape_ratio;       //!< fraction of ELL entries of the finest level that are escaped
+    double plain_spmv_gflops;  //!< SpMV GFLOP/s with the ELL format
+    double rel_spmv_gflops;    //!< SpMV GFLOP/s with the compressed format
+    double plain_symgs_gflops; //!< SYMGS GFLOP/s with the ELL format
+    double rel_symgs_gflops;   //!< SYMGS GFLOP/s with the compressed format
+};
+typedef struct CompressedELLData_STRUCT CompressedELLData;
+
+int CompressELL(SparseMatrix& A);
+int TestCompressedELL(SparseMatrix& A, CGData& data, ReportSections& sections);
+
+#endif // COMPRESSELL_HPP
@@ -0,0 +1,284 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file CompressValues.cpp
+
+ ELL storage of the off-diagonal values as indices into a value dictionary
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <hip/hip_runtime.h>
+
+#include "utils.hpp"
+#include "CompressValues.hpp"
+
+// Bit pattern of an empty hash table slot, a NaN that is never generated
+#define VALUE_DICT_EMPTY 0xFFFFFFFFFFFFFFFFULL
+
+__device__ unsigned int value_dict_hash(unsigned long long key)
+{
+    return (unsigned int)(((key ^ (key >> 29)) * 0x9E3779B97F4A7C15ULL) >> 54) & (VALUE_DICT_TABLE - 1);
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_value_dict_insert(local_int_t m,
+                                         local_int_t ell_width,
+                                         const local_int_t* __restrict__ ell_col_ind,
+                                         const double* __restrict__ ell_val,
+                                         unsigned long long* __restrict__ table,
+                                         int* __restrict__ count)
+{
+    local_int_t idx = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(idx >= m * ell_width)
+    {
+        return;
+    }
+
+    // Stop early once the dictionary has overflown
+    if(*((volatile int*)count) > VALUE_DICT_MAX)
+    {
+        return;
+    }
+
+    local_int_t row = idx % m;
+    local_int_t col = ell_col_ind[idx];
+
+    // Only off-diagonal entries are stored in the dictionary
+    if(col < 0 || col == row)
+    {
+        return;
+    }
+
+    unsigned long long key = __double_as_longlong(ell_val[idx]);
+    unsigned int slot = value_dict_hash(key);
+
+    for(int i = 0; i < VALUE_DICT_TABLE; ++i)
+    {
+        unsigned long long prev = table[slot];
+
+        if(prev == VALUE_DICT_EMPTY)
+        {
+            prev = atomicCAS(table + slot, VALUE_DICT_EMPTY, key);
+
+            if(prev == VALUE_DICT_EMPTY)
+            {
+                atomicAdd(count, 1);
+                return;
+            }
+        }
+
+        if(prev == key)
+        {
+            return;
+        }
+
+        slot = (slot + 1) & (VALUE_DICT_TABLE - 1);
+    }
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_value_dict_encode(local_int_t m,
+                                         local_int_t ell_width,
+                                         const local_int_t* __restrict__ ell_col_ind,
+                                         const double* __restrict__ ell_val,
+                                         const unsigned long long* __restrict__ table,
+                                         const unsigned char* __restrict__ slot_to_idx,
+                                         unsigned char* __restrict__ ell_val_idx)
+{
+    local_int_t idx = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(idx >= m * ell_width)
+    {
+        return;
+    }
+
+    local_int_t row = idx % m;
+    local_int_t col = ell_col_ind[idx];
+
+    if(col < 0 || col == row)
+    {
+        ell_val_idx[idx] = 0;
+        return;
+    }
+
+    unsigned long long key = __double_as_longlong(ell_val[idx]);
+    unsigned int slot = value_dict_hash(key);
+
+    while(table[slot] != key)
+    {
+        slot = (slot + 1) & (VALUE_DICT_TABLE - 1);
+    }
+
+    ell_val_idx[idx] = slot_to_idx[slot];
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_extract_diag(local_int_t m,
+                                    const double* __restrict__ ell_val,
+                                    const local_int_t* __restrict__ diag_idx,
+                                    double* __restrict__ ell_diag)
+{
+    local_int_t row = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(row >= m)
+    {
+        return;
+    }
+
+    ell_diag[row] = ell_val[diag_idx[row] * m + row];
+}
+
+/*!
+  Builds the value compressed ELL arrays of all levels of the hierarchy. The
+  distinct off-diagonal values of a level are collected into a dictionary of at
+  most VALUE_DICT_MAX values, and each ELL entry stores its 8-bit dictionary
+  index. If all off-diagonal values are equal, the indices are dropped. The
+  diagonal is stored separately, one value per row. Levels with more distinct
+  values keep using the full ELL values.
+
+  @param[inout] A the fine level matrix, after OptimizeProblem
+
+  @return returns 0 upon success and non-zero otherwise
+ */
+int CompressValues(SparseMatrix& A)
+{
+    for(SparseMatrix* level = &A; level != NULL; level = level->Ac)
+    {
+        local_int_t m = level->localNumberOfRows;
+        local_int_t ell_width = level->ell_width;
+
+        // The hash table fills the device workspace, the counter is allocated separately
+        unsigned long long* d_table = reinterpret_cast<unsigned long long*>(workspace);
+        int* d_count;
+
+        RETURN_IF_HIP_ERROR(deviceMalloc((void**)&d_count, sizeof(int)));
+        RETURN_IF_HIP_ERROR(hipMemset(d_table, 0xFF, sizeof(unsigned long long) * VALUE_DICT_TABLE));
+        RETURN_IF_HIP_ERROR(hipMemset(d_count, 0, sizeof(int)));
+
+        kernel_value_dict_insert<1024><<<(m * ell_width - 1) / 1024 + 1, 1024>>>(
+            m,
+            ell_width,
+            level->ell_col_ind,
+            level->ell_val,
+            d_table,
+            d_count);
+
+        int count;
+        RETURN_IF_HIP_ERROR(hipMemcpy(&count, d_count, sizeof(int), hipMemcpyDeviceToHost));
+        RETURN_IF_HIP_ERROR(deviceFree(d_count));
+
+        // Fall back to the full values
+        if(count > VALUE_DICT_MAX)
+        {
+            level->ell_val_dict_size = -1;
+            continue;
+        }
+
+        // Number the occupied slots of the table
+        std::vector<unsigned long long> table(VALUE_DICT_TABLE);
+        std::vector<unsigned char> slot_to_idx(VALUE_DICT_TABLE, 0);
+        std::vector<double> dict(VALUE_DICT_MAX, 0.0);
+
+        RETURN_IF_HIP_ERROR(hipMemcpy(table.data(),
+                                      d_table,
+                                      sizeof(unsigned long long) * VALUE_DICT_TABLE,
+                                      hipMemcpyDeviceToHost));
+
+        int size = 0;
+        for(int i = 0; i < VALUE_DICT_TABLE; ++i)
+        {
+            if(table[i] != VALUE_DICT_EMPTY)
+            {
+                slot_to_idx[i] = size;
+                memcpy(&dict[size], &table[i], sizeof(double));
+                ++size;
+            }
+        }
+
+        RETURN_IF_HIP_ERROR(deviceMalloc((void**)&level->ell_val_dict, sizeof(double) * VALUE_DICT_MAX));
+        RETURN_IF_HIP_ERROR(deviceMalloc((void**)&level->ell_diag, sizeof(double) * m));
+        RETURN_IF_HIP_ERROR(hipMemcpy(level->ell_val_dict,
+                                      dict.data(),
+                                      sizeof(double) * VALUE_DICT_MAX,
+                                      hipMemcpyHostToDevice));
+
+        kernel_extract_diag<1024><<<(m - 1) / 1024 + 1, 1024>>>(
+            m,
+            level->ell_val,
+            level->diag_idx,
+            level->ell_diag);
+
+        // A single value does not require indices
+        if(size > 1)
+        {
+            unsigned char* d_slot_to_idx;
+
+            RETURN_IF_HIP_ERROR(deviceMalloc((void**)&d_slot_to_idx, sizeof(unsigned char) * VALUE_DICT_TABLE));
+            RETURN_IF_HIP_ERROR(deviceMalloc((void**)&level->ell_val_idx, sizeof(unsigned char) * m * ell_width));
+            RETURN_IF_HIP_ERROR(hipMemcpy(d_slot_to_idx,
+                                          slot_to_idx.data(),
+                                          sizeof(unsigned char) * VALUE_DICT_TABLE,
+                                          hipMemcpyHostToDevice));
+
+            kernel_value_dict_encode<1024><<<(m * ell_width - 1) / 1024 + 1, 1024>>>(
+                m,
+                ell_width,
+                level->ell_col_ind,
+                level->ell_val,
+                d_table,
+                d_slot_to_idx,
+                level->ell_val_idx);
+
+            RETURN_IF_HIP_ERROR(deviceFree(d_slot_to_idx));
+        }
+
+        level->ell_val_dict_size = size;
+    }
+
+    if(A.geom->rank == 0)
+    {
+        printf("\nValue compression:");
+
+        for(SparseMatrix* level = &A; level != NULL; level = level->Ac)
+        {
+            if(level->ell_val_dict_size < 0) printf(" [level %d: full values]", level->level);
+            else printf(" [level %d: %d values]", level->level, level->ell_val_dict_size);
+        }
+
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -52,10 +52,46 @@
 #endif
 
 #include "utils.hpp"
+#include "ReproducibleSum.hpp"
 #include "ComputeDotProduct.hpp"
 
 #include <hip/hip_runtime.h>
 
+// The binned sums of the blocks fill the device workspace of 1024 doubles
+static_assert(HPCG_REPRO_BLOCKS * sizeof(ReproducibleSum) <= 1024 * sizeof(double),
+              "reproducible partial sums exceed the device workspace");
+
+// The grid consists of as many blocks as threads per block, such that the
+// partial results can be reduced by a single block
+#define LAUNCH_DOT1(blocksize, unused)                                              \
+    {                                                                               \
+        kernel_dot1_part1<blocksize><<<blocksize, blocksize>>>(n, x.d_values, tmp); \
+        kernel_dot_part2<blocksize><<<1, blocksize>>>(tmp);                         \
+    }
+
+#define LAUNCH_DOT2(blocksize, unused)                                                          \
+    {                                                                                           \
+        kernel_dot2_part1<blocksize><<<blocksize, blocksize>>>(n, x.d_values, y.d_values, tmp); \
+        kernel_dot_part2<blocksize><<<1, blocksize>>>(tmp);                                     \
+    }
+
+template <unsigned int BLOCKSIZE>
+__device__ void reduce_sum(local_int_t tid, double* data)
+{
+    __syncthreads();
+
+    if(BLOCKSIZE > 512) { if(tid < 512 && tid + 512 < BLOCKSIZE) { data[tid] += data[tid + 512]; } __syncthreads(); }
+    if(BLOCKSIZE > 256) { if(tid < 256 && tid + 256 < BLOCKSIZE) { data[tid] += data[tid + 256]; } __syncthreads(); }
+    if(BLOCKSIZE > 128) { if(tid < 128 && tid + 128 < BLOCKSIZE) { data[tid] += data[tid + 128]; } __syncthreads(); }
+    if(BLOCKSIZE >  64) { if(tid <  64 && tid +  64 < BLOCKSIZE) { data[tid] += data[tid +  64]; } __syncthreads(); }
+    if(BLOCKSIZE >  32) { if(tid <  32 && tid +  32 < BLOCKSIZE) { data[tid] += data[tid +  32]; } __syncthreads(); }
+    if(BLOCKSIZE >  16) { if(tid <  16 && tid +  16 < BLOCKSIZE) { data[tid] += data[tid +  16]; } __syncthreads(); }
+    if(BLOCKSIZE >   8) { if(tid <   8 && tid +   8 < BLOCKSIZE) { data[tid] += data[tid +   8]; } __syncthreads(); }
+    if(BLOCKSIZE >   4) { if(tid <   4 && tid +   4 < BLOCKSIZE) { data[tid] += data[tid +   4]; } __syncthreads(); }
+    if(BLOCKSIZE >   2) { if(tid <   2 && tid +   2 < BLOCKSIZE) { data[tid] += data[tid +   2]; } __syncthreads(); }
+    if(BLOCKSIZE >   1) { if(tid <   1 && tid +   1 < BLOCKSIZE) { data[tid] += data[tid +   1]; } __syncthreads(); }
+}
+
 template <unsigned int BLOCKSIZE>
 __launch_bounds__(BLOCKSIZE)
 __global__ void kernel_dot1_part1(local_int_t n, const double* x, double* workspace)
@@ -73,21 +109,11 @@ __global__ void kernel_dot1_part1(local_int_t n, const double* x, double* worksp
     __shared__ double sdata[BLOCKSIZE];
     sdata[threadIdx.x] = sum;
 
-    __syncthreads();
-
-    if(threadIdx.x < 512) sdata[threadIdx.x] += sdata[threadIdx.x + 512]; __syncthreads();
-    if(threadIdx.x < 256) sdata[threadIdx.x] += sdata[threadIdx.x + 256]; __syncthreads();
-    if(threadIdx.x < 128) sdata[threadIdx.x] += sdata[threadIdx.x + 128]; __syncthreads();
-    if(threadIdx.x <  64) sdata[threadIdx.x] += sdata[threadIdx.x +  64]; __syncthreads();
-    if(threadIdx.x <  32) sdata[threadIdx.x] += sdata[threadIdx.x +  32]; __syncthreads();
-    if(threadIdx.x <  16) sdata[threadIdx.x] += sdata[threadIdx.x +  16]; __syncthreads();
-    if(threadIdx.x <   8) sdata[threadIdx.x] += sdata[threadIdx.x +   8]; __syncthreads();
-    if(threadIdx.x <   4) sdata[threadIdx.x] += sdata[threadIdx.x +   4]; __syncthreads();
-    if(threadIdx.x <   2) sdata[threadIdx.x] += sdata[threadIdx.x +   2]; __syncthreads();
+    reduce_sum<BLOCKSIZE>(threadIdx.x, sdata);
 
     if(threadIdx.x == 0)
     {
-        workspace[blockIdx.x] = sdata[0] + sdata[1];
+        workspace[blockIdx.x] = sdata[0];
     }
 }
 
@@ -110,19 +136,11 @@ __global__ void kernel_dot2_part1(local_int_t n,
     __shared__ double sdata[BLOCKSIZE];
     sdata[threadIdx.x] = sum;
 
-    __syncthreads();
-
-    if(threadIdx.x < 128) sdata[threadIdx.x] += sdata[threadIdx.x + 128]; __syncthreads();
-    if(threadIdx.x <  64) sdata[threadIdx.x] += sdata[threadIdx.x +  64]; __syncthreads();
-    if(threadIdx.x <  32) sdata[threadIdx.x] += sdata[threadIdx.x +  32]; __syncthreads();
-    if(threadIdx.x <  16) sdata[threadIdx.x] += sdata[threadIdx.x +  16]; __syncthreads();
-    if(threadIdx.x <   8) sdata[threadIdx.x] += sdata[threadIdx.x +   8]; __syncthreads();
-    if(threadIdx.x <   4) sdata[threadIdx.x] += sdata[threadIdx.x +   4]; __syncthreads();
-    if(threadIdx.x <   2) sdata[threadIdx.x] += sdata[threadIdx.x +   2]; __syncthreads();
+    reduce_sum<BLOCKSIZE>(threadIdx.x, sdata);
 
     if(threadIdx.x == 0)
     {
-        workspace[blockIdx.x] = sdata[0] + sdata[1];
+        workspace[blockIdx.x] = sdata[0];
     }
 }
 
@@ -133,22 +151,95 @@ __global__ void kernel_dot_part2(double* workspace)
     __shared__ double sdata[BLOCKSIZE];
     sdata[threadIdx.x] = workspace[threadIdx.x];
 
-    __syncthreads();
+    reduce_sum<BLOCKSIZE>(threadIdx.x, sdata);
+
+    if(threadIdx.x == 0)
+    {
+        workspace[0] = sdata[0];
+    }
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_dot_repro_part1(local_int_t n,
+                                       const double* x,
+                                       const double* y,
+                                       ReproducibleSum* workspace)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t inc = gridDim.x * BLOCKSIZE;
+
+    ReproducibleAccumulator acc;
+    ReproducibleInitialize(acc);
+
+    for(local_int_t idx = gid; idx < n; idx += inc)
+    {
+        ReproducibleDeposit(acc, x[idx] * y[idx]);
+    }
+
+    __shared__ ReproducibleSum sdata[BLOCKSIZE];
+    ReproducibleFinalize(acc, sdata[threadIdx.x]);
+
+    ReproducibleBlockReduce<BLOCKSIZE>(threadIdx.x, sdata);
+
+    if(threadIdx.x == 0)
+    {
+        workspace[blockIdx.x] = sdata[0];
+    }
+}
 
-    if(threadIdx.x < 512) sdata[threadIdx.x] += sdata[threadIdx.x + 512]; __syncthreads();
-    if(threadIdx.x < 256) sdata[threadIdx.x] += sdata[threadIdx.x + 256]; __syncthreads();
-    if(threadIdx.x < 128) sdata[threadIdx.x] += sdata[threadIdx.x + 128]; __syncthreads();
-    if(threadIdx.x <  64) sdata[threadIdx.x] += sdata[threadIdx.x +  64]; __syncthreads();
-    if(threadIdx.x <  32) sdata[threadIdx.x] += sdata[threadIdx.x +  32]; __syncthreads();
-    if(threadIdx.x <  16) sdata[threadIdx.x] += sdata[threadIdx.x +  16]; __syncthreads();
-    if(threadIdx.x <   8) sdata[threadIdx.x] += sdata[threadIdx.x +   8]; __syncthreads();
-    if(threadIdx.x <   4) sdata[threadIdx.x] += sdata[threadIdx.x +   4]; __syncthreads();
-    if(threadIdx.x <   2) sdata[threadIdx.x] += sdata[threadIdx.x +   2]; __syncthreads();
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_dot_repro_part2(ReproducibleSum* workspace)
+{
+    __shared__ ReproducibleSum sdata[BLOCKSIZE];
+    sdata[threadIdx.x] = workspace[threadIdx.x];
+
+    ReproducibleBlockReduce<BLOCKSIZE>(threadIdx.x, sdata);
 
     if(threadIdx.x == 0)
     {
-        workspace[0] = sdata[0] + sdata[1];
+        workspace[0] = sdata[0];
+    }
+}
+
+/*!
+  Completes a reproducible dot product from the binned sums of the
+  HPCG_REPRO_BLOCKS blocks in the device workspace, merging them on the device
+  and across ranks before rounding.
+
+  @param[out] result         The dot product
+  @param[out] time_allreduce The time of the reduction across ranks is added
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int ReduceReproducibleDot(double& result, double& time_allreduce)
+{
+    ReproducibleSum* tmp = reinterpret_cast<ReproducibleSum*>(workspace);
+
+    kernel_dot_repro_part2<HPCG_REPRO_BLOCKS><<<1, HPCG_REPRO_BLOCKS>>>(tmp);
+
+    ReproducibleSum sum;
+    RETURN_IF_HIP_ERROR(hipMemcpy(&sum, tmp, sizeof(ReproducibleSum), hipMemcpyDeviceToHost));
+
+#ifndef HPCG_NO_MPI
+    double t0 = mytimer();
+
+    profiler.Begin(PROFILE_ALLREDUCE, 0);
+    int ierr = AllreduceReproducibleSum(sum, MPI_COMM_WORLD);
+    profiler.End(0.0);
+
+    time_allreduce += mytimer() - t0;
+
+    if(ierr)
+    {
+        return ierr;
     }
+#endif
+
+    result = ReproducibleValue(sum);
+
+    return 0;
 }
 
 /*!
@@ -178,17 +269,29 @@ int ComputeDotProduct(local_int_t n,
     assert(x.localLength >= n);
     assert(y.localLength >= n);
 
+    bool repro = GetReproducibleDot();
+
+    hipProfileScope_t scope(repro ? PROFILE_DOT_REPRO : PROFILE_DOT,
+                            0,
+                            (x.d_values == y.d_values ? 1.0 : 2.0) * n * sizeof(double));
+
+    if(repro)
+    {
+        kernel_dot_repro_part1<HPCG_REPRO_BLOCKSIZE><<<HPCG_REPRO_BLOCKS, HPCG_REPRO_BLOCKSIZE>>>(
+            n, x.d_values, y.d_values, reinterpret_cast<ReproducibleSum*>(workspace));
+
+        return ReduceReproducibleDot(result, time_allreduce);
+    }
+
     double* tmp = reinterpret_cast<double*>(workspace);
 
     if(x.d_values == y.d_values)
     {
-        kernel_dot1_part1<1024><<<1024, 1024>>>(n, x.d_values, tmp);
-        kernel_dot_part2<1024><<<1, 1024>>>(tmp);
+        DISPATCH_BLOCKSIZE(kernel_config.GetDot1Blocksize(), LAUNCH_DOT1, 0);
     }
     else
     {
-        kernel_dot2_part1<256><<<256, 256>>>(n, x.d_values, y.d_values, tmp);
-        kernel_dot_part2<256><<<1, 256>>>(tmp);
+        DISPATCH_BLOCKSIZE(kernel_config.GetDot2Blocksize(), LAUNCH_DOT2, 0);
     }
 
     double local_result;
@@ -198,7 +301,9 @@ int ComputeDotProduct(local_int_t n,
     double t0 = mytimer();
     double global_result = 0.0;
 
+    profiler.Begin(PROFILE_ALLREDUCE, 0);
     MPI_Allreduce(&local_result, &global_result, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    profiler.End(0.0);
 
     result = global_result;
     time_allreduce += mytimer() - t0;
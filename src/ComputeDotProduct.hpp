@@ -17,5 +17,6 @@
 #include "Vector.hpp"
 int ComputeDotProduct(const local_int_t n, const Vector & x, const Vector & y,
     double & result, double & time_allreduce, bool & isOptimized);
+int ReduceReproducibleDot(double & result, double & time_allreduce);
 
 #endif // COMPUTEDOTPRODUCT_HPP
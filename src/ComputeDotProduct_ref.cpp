@@ -27,6 +27,7 @@
 #endif
 #include <cassert>
 #include "ComputeDotProduct_ref.hpp"
+#include "ReproducibleSum.hpp"
 
 /*!
   Routine to compute the dot product of two vectors where:
@@ -48,6 +49,10 @@ int ComputeDotProduct_ref(const local_int_t n, const Vector & x, const Vector &
   assert(x.localLength>=n); // Test vector lengths
   assert(y.localLength>=n);
 
+  // Binned summation, independent of the number of threads and ranks
+  if (GetReproducibleDot())
+    return ComputeReproducibleDotProduct_host(n, x, y, result, time_allreduce);
+
   double local_result = 0.0;
   double * xv = x.values;
   double * yv = y.values;
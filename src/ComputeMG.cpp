@@ -65,6 +65,8 @@ int ComputeMG(const SparseMatrix& A, const Vector& r, Vector& x)
 {
     assert(x.localLength == A.localNumberOfColumns);
 
+    hipProfileScope_t scope(PROFILE_MG, A.level);
+
     if(A.mgData != 0)
     {
         RETURN_IF_HPCG_ERROR(ComputeSYMGSZeroGuess(A, r, x));
@@ -23,6 +23,7 @@
 #include "ComputeSPMV_ref.hpp"
 #include "ComputeRestriction_ref.hpp"
 #include "ComputeProlongation_ref.hpp"
+#include "Profiler.hpp"
 #include <cassert>
 #include <iostream>
 
@@ -39,6 +40,8 @@
 int ComputeMG_ref(const SparseMatrix & A, const Vector & r, Vector & x) {
   assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
 
+  hipProfileScope_t scope(PROFILE_MG_REF, A.level);
+
   ZeroVector(x); // initialize x to zero
 
   int ierr = 0;
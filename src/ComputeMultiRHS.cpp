@@ -0,0 +1,1290 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ComputeMultiRHS.cpp
+
+ Kernels operating on multiple right hand sides at once. Vectors are stored
+ interleaved (see MultiVector), and K consecutive threads process the K right
+ hand sides of a single row. Matrix entries are thus loaded once and applied to
+ all right hand sides, raising the arithmetic intensity roughly K-fold.
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#include "mytimer.hpp"
+#endif
+
+#include "ComputeMultiRHS.hpp"
+
+#include <hip/hip_runtime.h>
+
+//! Number of blocks used for the first stage of the batched dot product
+#define MULTI_DOT_BLOCKS 256
+
+// Instantiate a launch macro for the supported numbers of right hand sides
+#define DISPATCH_MULTI_RHS(k, LAUNCH) \
+    switch(k)                         \
+    {                                 \
+        case  1: LAUNCH( 1); break;   \
+        case  2: LAUNCH( 2); break;   \
+        case  4: LAUNCH( 4); break;   \
+        case  8: LAUNCH( 8); break;   \
+        case 16: LAUNCH(16); break;   \
+        default: return -1;           \
+    }
+
+#define LAUNCH_SPMM_ELL(K)                                                         \
+    kernel_spmm_ell<1024, 27, K><<<(A.localNumberOfRows * K - 1) / 1024 + 1,       \
+                                   1024,                                           \
+                                   0,                                              \
+                                   stream_interior>>>(A.localNumberOfRows,         \
+                                                      A.ell_col_ind,               \
+                                                      A.ell_val,                   \
+                                                      x.d_values,                  \
+                                                      y.d_values)
+
+#define LAUNCH_SPMM_HALO(K)                                                        \
+    kernel_spmm_halo<1024, 27, K><<<(A.halo_rows * K - 1) / 1024 + 1, 1024>>>(    \
+        A.halo_rows,                                                               \
+        A.localNumberOfColumns,                                                    \
+        A.halo_row_ind,                                                            \
+        A.halo_col_ind,                                                            \
+        A.halo_val,                                                                \
+        A.perm,                                                                    \
+        x.d_values,                                                                \
+        y.d_values)
+
+#define LAUNCH_MULTI_SYMGS_SWEEP(K)                                                \
+    kernel_multi_symgs_sweep<1024, 27, K><<<(A.sizes[i] * K - 1) / 1024 + 1,      \
+                                            1024>>>(A.localNumberOfRows,           \
+                                                    A.localNumberOfColumns,        \
+                                                    A.sizes[i],                    \
+                                                    A.offsets[i],                  \
+                                                    A.ell_col_ind,                 \
+                                                    A.ell_val,                     \
+                                                    A.inv_diag,                    \
+                                                    r.d_values,                    \
+                                                    x.d_values)
+
+#define LAUNCH_MULTI_SYMGS_INTERIOR(K)                                             \
+    kernel_multi_symgs_interior<1024, 27, K><<<(A.sizes[0] * K - 1) / 1024 + 1,   \
+                                               1024,                               \
+                                               0,                                  \
+                                               stream_interior>>>(                 \
+        A.localNumberOfRows,                                                       \
+        A.sizes[0],                                                                \
+        A.ell_col_ind,                                                             \
+        A.ell_val,                                                                 \
+        A.inv_diag,                                                                \
+        r.d_values,                                                                \
+        x.d_values)
+
+#define LAUNCH_MULTI_SYMGS_HALO(K)                                                 \
+    kernel_multi_symgs_halo<256, 27, K><<<(A.halo_rows * K - 1) / 256 + 1, 256>>>( \
+        A.halo_rows,                                                               \
+        A.localNumberOfColumns,                                                    \
+        A.sizes[0],                                                                \
+        A.halo_row_ind,                                                            \
+        A.halo_col_ind,                                                            \
+        A.halo_val,                                                                \
+        A.inv_diag,                                                                \
+        A.perm,                                                                    \
+        r.d_values,                                                                \
+        x.d_values)
+
+#define LAUNCH_MULTI_POINTWISE_MULT(K)                                             \
+    kernel_multi_pointwise_mult<256, K><<<(A.sizes[0] * K - 1) / 256 + 1, 256>>>(  \
+        A.sizes[0],                                                                \
+        r.d_values,                                                                \
+        A.inv_diag,                                                                \
+        x.d_values)
+
+#define LAUNCH_MULTI_FORWARD_SWEEP_0(K)                                            \
+    kernel_multi_forward_sweep_0<1024, K><<<(A.sizes[i] * K - 1) / 1024 + 1,      \
+                                            1024>>>(A.localNumberOfRows,           \
+                                                    A.sizes[i],                    \
+                                                    A.offsets[i],                  \
+                                                    A.ell_col_ind,                 \
+                                                    A.ell_val,                     \
+                                                    A.diag_idx,                    \
+                                                    r.d_values,                    \
+                                                    x.d_values)
+
+#define LAUNCH_MULTI_BACKWARD_SWEEP_0(K)                                           \
+    kernel_multi_backward_sweep_0<1024, K><<<(A.sizes[i] * K - 1) / 1024 + 1,     \
+                                             1024>>>(A.localNumberOfRows,          \
+                                                     A.sizes[i],                   \
+                                                     A.offsets[i],                 \
+                                                     A.ell_width,                  \
+                                                     A.ell_col_ind,                \
+                                                     A.ell_val,                    \
+                                                     A.diag_idx,                   \
+                                                     x.d_values)
+
+#define LAUNCH_MULTI_FUSED_RESTRICT_SPMM(K)                                        \
+    kernel_multi_fused_restrict_spmm<1024, 27, K><<<(nc * K - 1) / 1024 + 1,       \
+                                                    1024,                          \
+                                                    0,                             \
+                                                    stream_interior>>>(            \
+        nc,                                                                        \
+        A.mgData->d_f2cOperator,                                                   \
+        rf.d_values,                                                               \
+        A.localNumberOfRows,                                                       \
+        A.ell_col_ind,                                                             \
+        A.ell_val,                                                                 \
+        xf.d_values,                                                               \
+        rc.d_values,                                                               \
+        A.perm,                                                                    \
+        A.Ac->perm)
+
+#define LAUNCH_MULTI_FUSED_RESTRICT_SPMM_HALO(K)                                   \
+    kernel_multi_fused_restrict_spmm_halo<128, K><<<(A.halo_rows * K - 1) / 128 + 1, \
+                                                    128>>>(A.halo_rows,            \
+                                                           A.localNumberOfColumns, \
+                                                           A.mgData->d_c2fOperator, \
+                                                           A.ell_width,            \
+                                                           A.halo_row_ind,         \
+                                                           A.halo_col_ind,         \
+                                                           A.halo_val,             \
+                                                           xf.d_values,            \
+                                                           rc.d_values,            \
+                                                           A.Ac->perm)
+
+#define LAUNCH_MULTI_PROLONGATION(K)                                               \
+    kernel_multi_prolongation<128, K><<<(nc * K - 1) / 128 + 1, 128>>>(            \
+        nc,                                                                        \
+        A.mgData->d_f2cOperator,                                                   \
+        xc.d_values,                                                               \
+        xf.d_values,                                                               \
+        A.perm,                                                                    \
+        A.Ac->perm)
+
+#define LAUNCH_MULTI_DOT(K)                                                                 \
+    {                                                                                       \
+        kernel_multi_dot_part1<256, K><<<MULTI_DOT_BLOCKS, 256>>>(n * K,                    \
+                                                                  x.d_values,               \
+                                                                  y.d_values,               \
+                                                                  data.d_workspace);        \
+        kernel_multi_dot_part2<MULTI_DOT_BLOCKS, K><<<1, MULTI_DOT_BLOCKS>>>(data.d_workspace); \
+    }
+
+#define LAUNCH_MULTI_WAXPBY(K)                                                     \
+    kernel_multi_waxpby<1024, K><<<(n * K - 1) / 1024 + 1, 1024>>>(n * K,          \
+                                                                   a,              \
+                                                                   x.d_values,     \
+                                                                   b,              \
+                                                                   y.d_values,     \
+                                                                   w.d_values)
+
+//! Per right hand side scalars, passed to the kernels by value
+struct MultiScalars
+{
+    double v[MAX_MULTI_RHS];
+};
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_spmm_ell(local_int_t m,
+                                const local_int_t* __restrict__ ell_col_ind,
+                                const double* __restrict__ ell_val,
+                                const double* __restrict__ x,
+                                double* __restrict__ y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t row = gid / K;
+    local_int_t j   = gid % K;
+
+    if(row >= m)
+    {
+        return;
+    }
+
+    double sum = 0.0;
+    local_int_t idx = row;
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col = ell_col_ind[idx];
+
+        if(col >= 0 && col < m)
+        {
+            sum = fma(ell_val[idx], x[col * K + j], sum);
+        }
+
+        idx += m;
+    }
+
+    y[row * K + j] = sum;
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_spmm_halo(local_int_t m,
+                                 local_int_t n,
+                                 const local_int_t* __restrict__ halo_row_ind,
+                                 const local_int_t* __restrict__ halo_col_ind,
+                                 const double* __restrict__ halo_val,
+                                 const local_int_t* __restrict__ perm,
+                                 const double* __restrict__ x,
+                                 double* __restrict__ y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t row = gid / K;
+    local_int_t j   = gid % K;
+
+    if(row >= m)
+    {
+        return;
+    }
+
+    double sum = 0.0;
+    local_int_t idx = row;
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col = halo_col_ind[idx];
+
+        if(col >= 0 && col < n)
+        {
+            sum = fma(halo_val[idx], x[col * K + j], sum);
+        }
+
+        idx += m;
+    }
+
+    y[perm[halo_row_ind[row]] * K + j] += sum;
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_symgs_sweep(local_int_t m,
+                                         local_int_t n,
+                                         local_int_t block_nrow,
+                                         local_int_t offset,
+                                         const local_int_t* __restrict__ ell_col_ind,
+                                         const double* __restrict__ ell_val,
+                                         const double* __restrict__ inv_diag,
+                                         const double* __restrict__ x,
+                                         double* __restrict__ y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t j   = gid % K;
+
+    if(gid / K >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t row = gid / K + offset;
+    local_int_t idx = row;
+
+    double sum = x[row * K + j];
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col = ell_col_ind[idx];
+
+        if(col >= 0 && col < n && col != row)
+        {
+            sum = fma(-ell_val[idx], y[col * K + j], sum);
+        }
+
+        idx += m;
+    }
+
+    y[row * K + j] = sum * inv_diag[row];
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_symgs_interior(local_int_t m,
+                                            local_int_t block_nrow,
+                                            const local_int_t* __restrict__ ell_col_ind,
+                                            const double* __restrict__ ell_val,
+                                            const double* __restrict__ inv_diag,
+                                            const double* __restrict__ x,
+                                            double* __restrict__ y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t row = gid / K;
+    local_int_t j   = gid % K;
+
+    if(row >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t idx = row;
+
+    double sum = x[row * K + j];
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col = ell_col_ind[idx];
+
+        if(col >= 0 && col < m && col != row)
+        {
+            sum = fma(-ell_val[idx], y[col * K + j], sum);
+        }
+
+        idx += m;
+    }
+
+    y[row * K + j] = sum * inv_diag[row];
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_symgs_halo(local_int_t m,
+                                        local_int_t n,
+                                        local_int_t block_nrow,
+                                        const local_int_t* __restrict__ halo_row_ind,
+                                        const local_int_t* __restrict__ halo_col_ind,
+                                        const double* __restrict__ halo_val,
+                                        const double* __restrict__ inv_diag,
+                                        const local_int_t* __restrict__ perm,
+                                        const double* __restrict__ x,
+                                        double* __restrict__ y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t row = gid / K;
+    local_int_t j   = gid % K;
+
+    if(row >= m)
+    {
+        return;
+    }
+
+    local_int_t halo_idx = halo_row_ind[row];
+    local_int_t perm_idx = perm[halo_idx];
+
+    if(perm_idx >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t idx = row;
+
+    double sum = 0.0;
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col = halo_col_ind[idx];
+
+        if(col >= 0 && col < n)
+        {
+            sum = fma(-halo_val[idx], y[col * K + j], sum);
+        }
+
+        idx += m;
+    }
+
+    y[perm_idx * K + j] = fma(sum, inv_diag[halo_idx], y[perm_idx * K + j]);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_pointwise_mult(local_int_t size,
+                                            const double* __restrict__ x,
+                                            const double* __restrict__ diag,
+                                            double* __restrict__ out)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= size * K)
+    {
+        return;
+    }
+
+    out[gid] = x[gid] * diag[gid / K];
+}
+
+template <unsigned int BLOCKSIZE, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_forward_sweep_0(local_int_t m,
+                                             local_int_t block_nrow,
+                                             local_int_t offset,
+                                             const local_int_t* __restrict__ ell_col_ind,
+                                             const double* __restrict__ ell_val,
+                                             const local_int_t* __restrict__ diag_idx,
+                                             const double* __restrict__ x,
+                                             double* __restrict__ y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t j   = gid % K;
+
+    if(gid / K >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t row  = gid / K + offset;
+    local_int_t idx  = row;
+    local_int_t diag = diag_idx[row];
+
+    double sum = x[row * K + j];
+
+    for(local_int_t p = 0; p < diag; ++p)
+    {
+        local_int_t col = ell_col_ind[idx];
+
+        // Every entry above offset is zero
+        if(col >= 0 && col < offset)
+        {
+            sum = fma(-ell_val[idx], y[col * K + j], sum);
+        }
+
+        idx += m;
+    }
+
+    y[row * K + j] = sum * __drcp_rn(ell_val[idx]);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_backward_sweep_0(local_int_t m,
+                                              local_int_t block_nrow,
+                                              local_int_t offset,
+                                              local_int_t ell_width,
+                                              const local_int_t* __restrict__ ell_col_ind,
+                                              const double* __restrict__ ell_val,
+                                              const local_int_t* __restrict__ diag_idx,
+                                              double* __restrict__ x)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t j   = gid % K;
+
+    if(gid / K >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t row  = gid / K + offset;
+    local_int_t diag = diag_idx[row];
+    local_int_t idx  = diag * m + row;
+
+    double diag_val = ell_val[idx];
+    idx += m;
+
+    // Scale result with diagonal entry
+    double sum = x[row * K + j] * diag_val;
+
+    for(local_int_t p = diag + 1; p < ell_width; ++p)
+    {
+        local_int_t col = ell_col_ind[idx];
+
+        // Every entry below offset should not be taken into account
+        if(col >= offset && col < m)
+        {
+            sum = fma(-ell_val[idx], x[col * K + j], sum);
+        }
+
+        idx += m;
+    }
+
+    x[row * K + j] = sum * __drcp_rn(diag_val);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_fused_restrict_spmm(local_int_t size,
+                                                 const local_int_t* __restrict__ f2cOperator,
+                                                 const double* __restrict__ fine,
+                                                 local_int_t m,
+                                                 const local_int_t* __restrict__ ell_col_ind,
+                                                 const double* __restrict__ ell_val,
+                                                 const double* __restrict__ xf,
+                                                 double* __restrict__ coarse,
+                                                 const local_int_t* __restrict__ perm_fine,
+                                                 const local_int_t* __restrict__ perm_coarse)
+{
+    local_int_t gid        = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t idx_coarse = gid / K;
+    local_int_t j          = gid % K;
+
+    if(idx_coarse >= size)
+    {
+        return;
+    }
+
+    local_int_t idx_perm_fine   = perm_fine[f2cOperator[idx_coarse]];
+    local_int_t idx_perm_coarse = perm_coarse[idx_coarse];
+
+    double sum = fine[idx_perm_fine * K + j];
+
+    local_int_t idx = idx_perm_fine;
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col = ell_col_ind[idx];
+
+        if(col >= 0 && col < m)
+        {
+            sum = fma(-ell_val[idx], xf[col * K + j], sum);
+        }
+
+        idx += m;
+    }
+
+    coarse[idx_perm_coarse * K + j] = sum;
+}
+
+template <unsigned int BLOCKSIZE, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_fused_restrict_spmm_halo(local_int_t m,
+                                                      local_int_t n,
+                                                      const local_int_t* __restrict__ c2fOperator,
+                                                      local_int_t halo_width,
+                                                      const local_int_t* __restrict__ halo_row_ind,
+                                                      const local_int_t* __restrict__ halo_col_ind,
+                                                      const double* __restrict__ halo_val,
+                                                      const double* __restrict__ xf,
+                                                      double* __restrict__ coarse,
+                                                      const local_int_t* __restrict__ perm_coarse)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t row = gid / K;
+    local_int_t j   = gid % K;
+
+    if(row >= m)
+    {
+        return;
+    }
+
+    local_int_t idx_coarse = c2fOperator[halo_row_ind[row]];
+
+    // Check if halo row contributes to coarse vector, else discard it
+    if(idx_coarse == -1)
+    {
+        return;
+    }
+
+    double sum = 0.0;
+
+    for(local_int_t p = 0; p < halo_width; ++p)
+    {
+        local_int_t idx = p * m + row;
+        local_int_t col = halo_col_ind[idx];
+
+        if(col >= 0 && col < n)
+        {
+            sum = fma(halo_val[idx], xf[col * K + j], sum);
+        }
+    }
+
+    coarse[perm_coarse[idx_coarse] * K + j] -= sum;
+}
+
+template <unsigned int BLOCKSIZE, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_prolongation(local_int_t size,
+                                          const local_int_t* __restrict__ f2cOperator,
+                                          const double* __restrict__ coarse,
+                                          double* __restrict__ fine,
+                                          const local_int_t* __restrict__ perm_fine,
+                                          const local_int_t* __restrict__ perm_coarse)
+{
+    local_int_t gid        = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t idx_coarse = gid / K;
+    local_int_t j          = gid % K;
+
+    if(idx_coarse >= size)
+    {
+        return;
+    }
+
+    local_int_t idx_fine = perm_fine[f2cOperator[idx_coarse]];
+
+    fine[idx_fine * K + j] += coarse[perm_coarse[idx_coarse] * K + j];
+}
+
+template <unsigned int BLOCKSIZE, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_dot_part1(local_int_t size,
+                                       const double* __restrict__ x,
+                                       const double* __restrict__ y,
+                                       double* __restrict__ workspace)
+{
+    // BLOCKSIZE and the grid stride are multiples of K, thus each thread
+    // accumulates entries of the single right hand side threadIdx.x % K
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t inc = gridDim.x * BLOCKSIZE;
+
+    double sum = 0.0;
+    for(local_int_t idx = gid; idx < size; idx += inc)
+    {
+        sum = fma(y[idx], x[idx], sum);
+    }
+
+    __shared__ double sdata[BLOCKSIZE];
+    sdata[threadIdx.x] = sum;
+
+    __syncthreads();
+
+#pragma unroll
+    for(unsigned int s = BLOCKSIZE >> 1; s >= K; s >>= 1)
+    {
+        if(threadIdx.x < s) sdata[threadIdx.x] += sdata[threadIdx.x + s];
+        __syncthreads();
+    }
+
+    if(threadIdx.x < K)
+    {
+        workspace[blockIdx.x * K + threadIdx.x] = sdata[threadIdx.x];
+    }
+}
+
+template <unsigned int BLOCKSIZE, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_dot_part2(double* workspace)
+{
+    // BLOCKSIZE partial sums of K right hand sides each
+    double sum = 0.0;
+    for(unsigned int idx = threadIdx.x; idx < BLOCKSIZE * K; idx += BLOCKSIZE)
+    {
+        sum += workspace[idx];
+    }
+
+    __shared__ double sdata[BLOCKSIZE];
+    sdata[threadIdx.x] = sum;
+
+    __syncthreads();
+
+#pragma unroll
+    for(unsigned int s = BLOCKSIZE >> 1; s >= K; s >>= 1)
+    {
+        if(threadIdx.x < s) sdata[threadIdx.x] += sdata[threadIdx.x + s];
+        __syncthreads();
+    }
+
+    if(threadIdx.x < K)
+    {
+        workspace[threadIdx.x] = sdata[threadIdx.x];
+    }
+}
+
+template <unsigned int BLOCKSIZE, unsigned int K>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_waxpby(local_int_t size,
+                                    MultiScalars alpha,
+                                    const double* __restrict__ x,
+                                    MultiScalars beta,
+                                    const double* __restrict__ y,
+                                    double* w)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= size)
+    {
+        return;
+    }
+
+    local_int_t j = gid % K;
+
+    w[gid] = fma(alpha.v[j], x[gid], beta.v[j] * y[gid]);
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_fill(local_int_t size,
+                                  int k,
+                                  const double* __restrict__ b,
+                                  double* __restrict__ B)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= size * k)
+    {
+        return;
+    }
+
+    B[gid] = (1.0 + gid % k) * b[gid / k];
+}
+
+#ifndef HPCG_NO_MPI
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_multi_gather(local_int_t size,
+                                    int k,
+                                    const double* __restrict__ in,
+                                    const local_int_t* __restrict__ map,
+                                    const local_int_t* __restrict__ perm,
+                                    double* __restrict__ out)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= size * k)
+    {
+        return;
+    }
+
+    out[gid] = in[perm[map[gid / k]] * k + gid % k];
+}
+
+/*!
+  Gathers the boundary entries of all right hand sides into the send buffer of
+  the level of A and starts the transfer to the host.
+*/
+static void PrepareSendBufferMulti(const SparseMatrix& A, MultiRHSData& data, const MultiVector& x)
+{
+    int k = x.numberOfVectors;
+
+    dim3 blocks((A.totalToBeSent * k - 1) / 128 + 1);
+    dim3 threads(128);
+
+    kernel_multi_gather<128><<<blocks, threads>>>(A.totalToBeSent,
+                                                  k,
+                                                  x.d_values,
+                                                  A.d_elementsToSend,
+                                                  A.perm,
+                                                  data.d_send_buffer[A.level]);
+
+    HIP_CHECK(hipMemcpyAsync(data.send_buffer[A.level],
+                             data.d_send_buffer[A.level],
+                             sizeof(double) * A.totalToBeSent * k,
+                             hipMemcpyDeviceToHost,
+                             stream_halo));
+}
+
+/*!
+  Posts the boundary transfers of all right hand sides, a single message per
+  neighbor carries the interleaved values of all right hand sides.
+*/
+static void ExchangeHaloAsyncMulti(const SparseMatrix& A, MultiRHSData& data)
+{
+    int k = data.numberOfVectors;
+    int num_neighbors = A.numberOfSendNeighbors;
+    int MPI_MY_TAG = 99;
+
+    local_int_t offset = 0;
+
+    for(int n = 0; n < num_neighbors; ++n)
+    {
+        local_int_t nrecv = A.receiveLength[n] * k;
+
+        MPI_Irecv(data.recv_buffer[A.level] + offset,
+                  nrecv,
+                  MPI_DOUBLE,
+                  A.neighbors[n],
+                  MPI_MY_TAG,
+                  MPI_COMM_WORLD,
+                  A.recv_request + n);
+
+        offset += nrecv;
+    }
+
+    // Synchronize stream to make sure that send buffer is available
+    HIP_CHECK(hipStreamSynchronize(stream_halo));
+
+    offset = 0;
+
+    for(int n = 0; n < num_neighbors; ++n)
+    {
+        local_int_t nsend = A.sendLength[n] * k;
+
+        MPI_Isend(data.send_buffer[A.level] + offset,
+                  nsend,
+                  MPI_DOUBLE,
+                  A.neighbors[n],
+                  MPI_MY_TAG,
+                  MPI_COMM_WORLD,
+                  A.send_request + n);
+
+        offset += nsend;
+    }
+}
+
+/*!
+  Waits for the boundary transfers and copies the received values behind the
+  local entries of x.
+*/
+static void ObtainRecvBufferMulti(const SparseMatrix& A, MultiRHSData& data, MultiVector& x)
+{
+    int k = x.numberOfVectors;
+    int num_neighbors = A.numberOfSendNeighbors;
+
+    EXIT_IF_HPCG_ERROR(MPI_Waitall(num_neighbors, A.recv_request, MPI_STATUSES_IGNORE));
+    EXIT_IF_HPCG_ERROR(MPI_Waitall(num_neighbors, A.send_request, MPI_STATUSES_IGNORE));
+
+    HIP_CHECK(hipMemcpyAsync(x.d_values + A.localNumberOfRows * k,
+                             data.recv_buffer[A.level],
+                             sizeof(double) * A.totalToBeSent * k,
+                             hipMemcpyHostToDevice,
+                             stream_halo));
+}
+#endif
+
+/*!
+  Allocates the block vectors of a multiple right hand side CG solve, including
+  the coarse level blocks and halo buffers of the multigrid hierarchy.
+
+  @param[in]  A               The known system matrix, including its coarse levels
+  @param[in]  numberOfVectors The number of right hand sides, one of 1, 2, 4, 8, 16
+  @param[out] data            The block vectors and buffers
+
+  @return hipSuccess or the error of the first failing allocation. Data that
+          has been allocated up to the failure is released with
+          HIPDeleteMultiRHSData().
+*/
+hipError_t HIPInitializeMultiRHSData(const SparseMatrix& A, int numberOfVectors, MultiRHSData& data)
+{
+    int k = numberOfVectors;
+
+    data.numberOfVectors = k;
+    data.numberOfLevels = 1;
+
+    for(const SparseMatrix* M = &A; M->mgData != 0; M = M->Ac)
+    {
+        ++data.numberOfLevels;
+    }
+
+    int nlevels = data.numberOfLevels;
+
+    data.r.d_values = NULL;
+    data.z.d_values = NULL;
+    data.p.d_values = NULL;
+    data.Ap.d_values = NULL;
+    data.d_workspace = NULL;
+
+    data.rc = new MultiVector[nlevels];
+    data.xc = new MultiVector[nlevels];
+    data.recv_buffer = new double*[nlevels];
+    data.send_buffer = new double*[nlevels];
+    data.d_send_buffer = new double*[nlevels];
+
+    for(int l = 0; l < nlevels; ++l)
+    {
+        data.rc[l].d_values = NULL;
+        data.xc[l].d_values = NULL;
+        data.recv_buffer[l] = NULL;
+        data.send_buffer[l] = NULL;
+        data.d_send_buffer[l] = NULL;
+    }
+
+    if(k < 1 || k > MAX_MULTI_RHS || (k & (k - 1)) != 0)
+    {
+        return hipErrorInvalidValue;
+    }
+
+    RETURN_IF_HIP_ERROR(HIPInitializeMultiVector(data.r, A.localNumberOfRows, k));
+    RETURN_IF_HIP_ERROR(HIPInitializeMultiVector(data.z, A.localNumberOfColumns, k));
+    RETURN_IF_HIP_ERROR(HIPInitializeMultiVector(data.p, A.localNumberOfColumns, k));
+    RETURN_IF_HIP_ERROR(HIPInitializeMultiVector(data.Ap, A.localNumberOfRows, k));
+
+    RETURN_IF_HIP_ERROR(hipMalloc((void**)&data.d_workspace, sizeof(double) * MULTI_DOT_BLOCKS * k));
+
+    for(const SparseMatrix* M = &A; M != 0; M = M->Ac)
+    {
+        int l = M->level;
+
+        if(M->mgData != 0)
+        {
+            RETURN_IF_HIP_ERROR(HIPInitializeMultiVector(data.rc[l], M->Ac->localNumberOfRows, k));
+            RETURN_IF_HIP_ERROR(HIPInitializeMultiVector(data.xc[l], M->Ac->localNumberOfColumns, k));
+        }
+
+#ifndef HPCG_NO_MPI
+        if(M->geom->size > 1 && M->totalToBeSent > 0)
+        {
+            size_t size = sizeof(double) * M->totalToBeSent * k;
+
+            RETURN_IF_HIP_ERROR(hipHostMalloc((void**)&data.recv_buffer[l], size, hipHostMallocDefault));
+            RETURN_IF_HIP_ERROR(hipHostMalloc((void**)&data.send_buffer[l], size, hipHostMallocDefault));
+            RETURN_IF_HIP_ERROR(hipMalloc((void**)&data.d_send_buffer[l], size));
+        }
+#endif
+    }
+
+    return hipSuccess;
+}
+
+/*!
+  Deallocates the block vectors and buffers of a multiple right hand side solve.
+
+  @param[inout] data The block vectors and buffers
+*/
+void HIPDeleteMultiRHSData(MultiRHSData& data)
+{
+    HIPDeleteMultiVector(data.r);
+    HIPDeleteMultiVector(data.z);
+    HIPDeleteMultiVector(data.p);
+    HIPDeleteMultiVector(data.Ap);
+
+    if(data.d_workspace != NULL) HIP_CHECK(hipFree(data.d_workspace));
+
+    for(int l = 0; l < data.numberOfLevels; ++l)
+    {
+        HIPDeleteMultiVector(data.rc[l]);
+        HIPDeleteMultiVector(data.xc[l]);
+
+        if(data.recv_buffer[l] != NULL) HIP_CHECK(hipHostFree(data.recv_buffer[l]));
+        if(data.send_buffer[l] != NULL) HIP_CHECK(hipHostFree(data.send_buffer[l]));
+        if(data.d_send_buffer[l] != NULL) HIP_CHECK(hipFree(data.d_send_buffer[l]));
+    }
+
+    delete[] data.rc;
+    delete[] data.xc;
+    delete[] data.recv_buffer;
+    delete[] data.send_buffer;
+    delete[] data.d_send_buffer;
+
+    data.d_workspace = NULL;
+    data.numberOfLevels = 0;
+}
+
+/*!
+  Routine to compute the sparse matrix block product Y = AX for multiple right
+  hand sides.
+
+  @param[in]    A    the known system matrix
+  @param[inout] data the halo buffers
+  @param[in]    x    the known block of vectors, halo entries are updated
+  @param[out]   y    on exit contains the result AX
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSPMV
+*/
+int ComputeSPMM(const SparseMatrix& A, MultiRHSData& data, const MultiVector& x, MultiVector& y)
+{
+    assert(x.localLength >= A.localNumberOfColumns);
+    assert(y.localLength >= A.localNumberOfRows);
+    assert(x.numberOfVectors == y.numberOfVectors);
+
+    if(A.ell_width != 27) return -1;
+
+#ifndef HPCG_NO_MPI
+    if(A.geom->size > 1)
+    {
+        PrepareSendBufferMulti(A, data, x);
+    }
+#endif
+
+    DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_SPMM_ELL);
+
+#ifndef HPCG_NO_MPI
+    if(A.geom->size > 1)
+    {
+        ExchangeHaloAsyncMulti(A, data);
+        ObtainRecvBufferMulti(A, data, const_cast<MultiVector&>(x));
+
+        DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_SPMM_HALO);
+    }
+#endif
+
+    return 0;
+}
+
+/*!
+  Routine to compute one step of symmetric Gauss-Seidel for multiple right hand
+  sides, using the multicoloring of the single right hand side smoother.
+
+  @param[in]    A    the known system matrix
+  @param[inout] data the halo buffers
+  @param[in]    r    the input block of vectors
+  @param[inout] x    on exit contains the result of one symmetric GS sweep with r as the RHS
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSYMGS
+*/
+int ComputeMultiSYMGS(const SparseMatrix& A, MultiRHSData& data, const MultiVector& r, MultiVector& x)
+{
+    assert(x.localLength == A.localNumberOfColumns);
+    assert(x.numberOfVectors == r.numberOfVectors);
+
+    if(A.ell_width != 27 || A.tile_rows > 0) return -1;
+
+    local_int_t i = 0;
+
+#ifndef HPCG_NO_MPI
+    if(A.geom->size > 1)
+    {
+        PrepareSendBufferMulti(A, data, x);
+
+        DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_MULTI_SYMGS_INTERIOR);
+
+        ExchangeHaloAsyncMulti(A, data);
+        ObtainRecvBufferMulti(A, data, x);
+
+        DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_MULTI_SYMGS_HALO);
+
+        ++i;
+    }
+#endif
+
+    // Solve L
+    for(; i < A.nblocks; ++i)
+    {
+        DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_MULTI_SYMGS_SWEEP);
+    }
+
+    // Solve U
+    for(i = A.ublocks; i >= 0; --i)
+    {
+        DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_MULTI_SYMGS_SWEEP);
+    }
+
+    return 0;
+}
+
+/*!
+  Symmetric Gauss-Seidel step for multiple right hand sides with zero initial
+  guess.
+
+  @see ComputeSYMGSZeroGuess
+*/
+int ComputeMultiSYMGSZeroGuess(const SparseMatrix& A, const MultiVector& r, MultiVector& x)
+{
+    assert(x.localLength == A.localNumberOfColumns);
+    assert(x.numberOfVectors == r.numberOfVectors);
+
+    if(A.tile_rows > 0) return -1;
+
+    // Solve L
+    DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_MULTI_POINTWISE_MULT);
+
+    for(local_int_t i = 1; i < A.nblocks; ++i)
+    {
+        DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_MULTI_FORWARD_SWEEP_0);
+    }
+
+    // Solve U
+    for(local_int_t i = A.ublocks; i >= 0; --i)
+    {
+        DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_MULTI_BACKWARD_SWEEP_0);
+    }
+
+    return 0;
+}
+
+/*!
+  Computes the coarse residual blocks from the fine residual of the rows that
+  are injected into the coarse level.
+*/
+static int ComputeMultiFusedSpMMRestriction(const SparseMatrix& A,
+                                            MultiRHSData& data,
+                                            const MultiVector& rf,
+                                            MultiVector& xf)
+{
+    MultiVector& rc = data.rc[A.level];
+    local_int_t nc = rc.localLength;
+
+#ifndef HPCG_NO_MPI
+    if(A.geom->size > 1)
+    {
+        PrepareSendBufferMulti(A, data, xf);
+    }
+#endif
+
+    DISPATCH_MULTI_RHS(xf.numberOfVectors, LAUNCH_MULTI_FUSED_RESTRICT_SPMM);
+
+#ifndef HPCG_NO_MPI
+    if(A.geom->size > 1)
+    {
+        ExchangeHaloAsyncMulti(A, data);
+        ObtainRecvBufferMulti(A, data, xf);
+
+        DISPATCH_MULTI_RHS(xf.numberOfVectors, LAUNCH_MULTI_FUSED_RESTRICT_SPMM_HALO);
+    }
+#endif
+
+    return 0;
+}
+
+/*!
+  Adds the coarse grid correction blocks to the fine grid blocks.
+*/
+static int ComputeMultiProlongation(const SparseMatrix& A, MultiRHSData& data, MultiVector& xf)
+{
+    const MultiVector& xc = data.xc[A.level];
+    local_int_t nc = data.rc[A.level].localLength;
+
+    DISPATCH_MULTI_RHS(xf.numberOfVectors, LAUNCH_MULTI_PROLONGATION);
+
+    return 0;
+}
+
+/*!
+  Multigrid V-cycle for multiple right hand sides.
+
+  @param[in]    A    the known system matrix
+  @param[inout] data the coarse level blocks and halo buffers
+  @param[in]    r    the input block of vectors
+  @param[inout] x    on exit contains the result of the multigrid V-cycle with r as the RHS
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeMG
+*/
+int ComputeMultiMG(const SparseMatrix& A, MultiRHSData& data, const MultiVector& r, MultiVector& x)
+{
+    assert(x.localLength == A.localNumberOfColumns);
+
+    if(A.mgData != 0)
+    {
+        RETURN_IF_HPCG_ERROR(ComputeMultiSYMGSZeroGuess(A, r, x));
+
+        int numberOfPresmootherSteps = A.mgData->numberOfPresmootherSteps;
+
+        for(int i = 1; i < numberOfPresmootherSteps; ++i)
+        {
+            RETURN_IF_HPCG_ERROR(ComputeMultiSYMGS(A, data, r, x));
+        }
+
+        RETURN_IF_HPCG_ERROR(ComputeMultiFusedSpMMRestriction(A, data, r, x));
+        RETURN_IF_HPCG_ERROR(ComputeMultiMG(*A.Ac, data, data.rc[A.level], data.xc[A.level]));
+        RETURN_IF_HPCG_ERROR(ComputeMultiProlongation(A, data, x));
+
+        int numberOfPostsmootherSteps = A.mgData->numberOfPostsmootherSteps;
+
+        for(int i = 0; i < numberOfPostsmootherSteps; ++i)
+        {
+            RETURN_IF_HPCG_ERROR(ComputeMultiSYMGS(A, data, r, x));
+        }
+    }
+    else
+    {
+        RETURN_IF_HPCG_ERROR(ComputeMultiSYMGSZeroGuess(A, r, x));
+    }
+
+    return 0;
+}
+
+/*!
+  Routine to compute the dot products of the corresponding vectors of two
+  blocks. The partial results of all right hand sides are reduced across
+  processes with a single allreduce.
+
+  @param[in]  n              the number of vector elements (on this processor)
+  @param[in]  data           the reduction workspace
+  @param[in]  x, y           the input blocks
+  @param[out] result         array of numberOfVectors dot products
+  @param[out] time_allreduce the time it took to perform the communication between processes
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeDotProduct
+*/
+int ComputeMultiDotProduct(local_int_t n,
+                           MultiRHSData& data,
+                           const MultiVector& x,
+                           const MultiVector& y,
+                           double* result,
+                           double& time_allreduce)
+{
+    assert(x.localLength >= n);
+    assert(y.localLength >= n);
+    assert(x.numberOfVectors == y.numberOfVectors);
+
+    int k = x.numberOfVectors;
+
+    DISPATCH_MULTI_RHS(k, LAUNCH_MULTI_DOT);
+
+    double local_result[MAX_MULTI_RHS];
+    HIP_CHECK(hipMemcpy(local_result, data.d_workspace, sizeof(double) * k, hipMemcpyDeviceToHost));
+
+#ifndef HPCG_NO_MPI
+    double t0 = mytimer();
+    MPI_Allreduce(local_result, result, k, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    time_allreduce += mytimer() - t0;
+#else
+    for(int j = 0; j < k; ++j)
+    {
+        result[j] = local_result[j];
+    }
+#endif
+
+    return 0;
+}
+
+/*!
+  Routine to compute W = alpha X + beta Y with individual scalars for each
+  right hand side.
+
+  @param[in]  n           the number of vector elements (on this processor)
+  @param[in]  alpha, beta arrays of numberOfVectors scalars applied to x and y respectively
+  @param[in]  x, y        the input blocks
+  @param[out] w           the output block
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeWAXPBY
+*/
+int ComputeMultiWAXPBY(local_int_t n,
+                       const double* alpha,
+                       const MultiVector& x,
+                       const double* beta,
+                       const MultiVector& y,
+                       MultiVector& w)
+{
+    assert(x.localLength >= n);
+    assert(y.localLength >= n);
+    assert(w.localLength >= n);
+
+    MultiScalars a;
+    MultiScalars b;
+
+    for(int j = 0; j < MAX_MULTI_RHS; ++j)
+    {
+        a.v[j] = j < x.numberOfVectors ? alpha[j] : 0.0;
+        b.v[j] = j < x.numberOfVectors ? beta[j] : 0.0;
+    }
+
+    DISPATCH_MULTI_RHS(x.numberOfVectors, LAUNCH_MULTI_WAXPBY);
+
+    return 0;
+}
+
+/*!
+  Fills a block of right hand sides with scaled copies of b, vector j of the
+  block is (j + 1) b.
+
+  @param[in]  b the right hand side of the benchmark
+  @param[out] B the block of right hand sides
+
+  @return returns 0 upon success and non-zero otherwise
+*/
+int ComputeMultiRHSFill(const Vector& b, MultiVector& B)
+{
+    assert(B.localLength <= b.localLength);
+
+    dim3 blocks((B.localLength * B.numberOfVectors - 1) / 1024 + 1);
+    dim3 threads(1024);
+
+    kernel_multi_fill<1024><<<blocks, threads>>>(B.localLength, B.numberOfVectors, b.d_values, B.d_values);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ComputeMultiRHS.hpp
+
+ Kernels operating on multiple right hand sides at once
+ */
+
+#ifndef COMPUTEMULTIRHS_HPP
+#define COMPUTEMULTIRHS_HPP
+
+#include "SparseMatrix.hpp"
+#include "MultiVector.hpp"
+
+//! Largest supported number of right hand sides
+#define MAX_MULTI_RHS 16
+
+struct MultiRHSData_STRUCT
+{
+    int numberOfVectors; //!< number of right hand sides, one of 1, 2, 4, 8, 16
+    int numberOfLevels;  //!< number of multigrid levels
+
+    MultiVector r;  //!< residual block
+    MultiVector z;  //!< preconditioned residual block
+    MultiVector p;  //!< direction block, includes halo entries
+    MultiVector Ap; //!< A times direction block
+
+    MultiVector* rc; //!< coarse residual blocks, rc[l] belongs to the matrix of level l
+    MultiVector* xc; //!< coarse correction blocks, xc[l] belongs to the matrix of level l
+
+    double* d_workspace; //!< partial sums of the batched dot products
+
+    double** recv_buffer;   //!< halo receive buffers (host) of each level
+    double** send_buffer;   //!< halo send buffers (host) of each level
+    double** d_send_buffer; //!< halo send buffers (device) of each level
+};
+typedef struct MultiRHSData_STRUCT MultiRHSData;
+
+hipError_t HIPInitializeMultiRHSData(const SparseMatrix& A, int numberOfVectors, MultiRHSData& data);
+void HIPDeleteMultiRHSData(MultiRHSData& data);
+
+int ComputeSPMM(const SparseMatrix& A, MultiRHSData& data, const MultiVector& x, MultiVector& y);
+int ComputeMultiSYMGS(const SparseMatrix& A, MultiRHSData& data, const MultiVector& r, MultiVector& x);
+int ComputeMultiSYMGSZeroGuess(const SparseMatrix& A, const MultiVector& r, MultiVector& x);
+int ComputeMultiMG(const SparseMatrix& A, MultiRHSData& data, const MultiVector& r, MultiVector& x);
+int ComputeMultiDotProduct(local_int_t n,
+                           MultiRHSData& data,
+                           const MultiVector& x,
+                           const MultiVector& y,
+                           double* result,
+                           double& time_allreduce);
+int ComputeMultiWAXPBY(local_int_t n,
+                       const double* alpha,
+                       const MultiVector& x,
+                       const double* beta,
+                       const MultiVector& y,
+                       MultiVector& w);
+int ComputeMultiRHSFill(const Vector& b, MultiVector& B);
+
+#endif // COMPUTEMULTIRHS_HPP
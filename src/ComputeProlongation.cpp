@@ -71,6 +71,8 @@ __global__ void kernel_prolongation(local_int_t size,
 */
 int ComputeProlongation(const SparseMatrix& Af, Vector& xf)
 {
+    hipProfileScope_t scope(PROFILE_PROLONGATION, Af.level, 3.0 * Af.mgData->rc->localLength * sizeof(double));
+
     dim3 blocks((Af.mgData->rc->localLength - 1) / 128 + 1);
     dim3 threads(128);
 
@@ -181,6 +181,8 @@ __global__ void kernel_fused_restrict_spmv_halo(local_int_t m,
 */
 int ComputeRestriction(const SparseMatrix& A, const Vector& rf)
 {
+    hipProfileScope_t scope(PROFILE_RESTRICTION, A.level, 3.0 * A.mgData->rc->localLength * sizeof(double));
+
     dim3 blocks((A.mgData->rc->localLength - 1) / 128 + 1);
     dim3 threads(128);
 
@@ -197,6 +199,12 @@ int ComputeRestriction(const SparseMatrix& A, const Vector& rf)
 
 int ComputeFusedSpMVRestriction(const SparseMatrix& A, const Vector& rf, Vector& xf)
 {
+    // Residual is computed for the rows that are injected into the coarse level only
+    hipProfileScope_t scope(PROFILE_RESTRICTION,
+                            A.level,
+                            A.mgData->rc->localLength * (A.ell_width * (sizeof(double) + sizeof(local_int_t))
+                            + 3.0 * sizeof(double)));
+
 #ifndef HPCG_NO_MPI
     if(A.geom->size > 1)
     {
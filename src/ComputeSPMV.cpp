@@ -48,23 +48,73 @@
 
 #include "ComputeSPMV.hpp"
 #include "ExchangeHalo.hpp"
+#include "CompressELL.hpp"
 
 #include <hip/hip_runtime.h>
 
-#define LAUNCH_SPMV_ELL(blocksize, width)                                                \
-    {                                                                                    \
-        dim3 blocks(A.nblocks, (A.localNumberOfRows - 1) / (A.nblocks * blocksize) + 1); \
-        dim3 threads(blocksize);                                                         \
-                                                                                         \
-        kernel_spmv_ell<blocksize, width><<<blocks, threads, 0, stream_interior>>>(      \
-            A.localNumberOfRows,                                                         \
-            A.localNumberOfRows / A.nblocks,                                             \
-            A.ell_col_ind,                                                               \
-            A.ell_val,                                                                   \
-            x.d_values,                                                                  \
-            y.d_values);                                                                 \
+#define LAUNCH_SPMV_ELL_T(blocksize, width, val)                                              \
+    {                                                                                         \
+        local_int_t rows_per_block = A.localNumberOfRows / A.nblocks;                         \
+        local_int_t last_block_rows = A.localNumberOfRows - (A.nblocks - 1) * rows_per_block; \
+        dim3 blocks(A.nblocks, (last_block_rows - 1) / blocksize + 1);                        \
+        dim3 threads(blocksize);                                                              \
+                                                                                              \
+        kernel_spmv_ell<blocksize, width><<<blocks, threads, 0, stream_interior>>>(           \
+            A.localNumberOfRows,                                                              \
+            rows_per_block,                                                                   \
+            A.ell_col_ind,                                                                    \
+            val,                                                                              \
+            x.d_values,                                                                       \
+            y.d_values);                                                                      \
     }
 
+#define LAUNCH_SPMV_ELL(blocksize, width) LAUNCH_SPMV_ELL_T(blocksize, width, A.ell_val)
+#define LAUNCH_SPMV_ELL_F32(blocksize, width) LAUNCH_SPMV_ELL_T(blocksize, width, A.ell_val_f32)
+
+#define LAUNCH_SPMV_ELL_REL_T(blocksize, width, val)                                          \
+    {                                                                                         \
+        local_int_t rows_per_block = A.localNumberOfRows / A.nblocks;                         \
+        local_int_t last_block_rows = A.localNumberOfRows - (A.nblocks - 1) * rows_per_block; \
+        dim3 blocks(A.nblocks, (last_block_rows - 1) / blocksize + 1);                        \
+        dim3 threads(blocksize);                                                              \
+                                                                                              \
+        kernel_spmv_ell_rel<blocksize, width><<<blocks, threads, 0, stream_interior>>>(       \
+            A.localNumberOfRows,                                                              \
+            rows_per_block,                                                                   \
+            A.ell_col_rel,                                                                    \
+            A.ell_col_base,                                                                   \
+            A.ell_col_ind,                                                                    \
+            val,                                                                              \
+            x.d_values,                                                                       \
+            y.d_values);                                                                      \
+    }
+
+#define LAUNCH_SPMV_ELL_REL(blocksize, width) LAUNCH_SPMV_ELL_REL_T(blocksize, width, A.ell_val)
+#define LAUNCH_SPMV_ELL_REL_F32(blocksize, width) LAUNCH_SPMV_ELL_REL_T(blocksize, width, A.ell_val_f32)
+
+#define LAUNCH_SPMV_ELL_DICT(blocksize, width, rel)                                           \
+    {                                                                                         \
+        local_int_t rows_per_block = A.localNumberOfRows / A.nblocks;                         \
+        local_int_t last_block_rows = A.localNumberOfRows - (A.nblocks - 1) * rows_per_block; \
+        dim3 blocks(A.nblocks, (last_block_rows - 1) / blocksize + 1);                        \
+        dim3 threads(blocksize);                                                              \
+                                                                                              \
+        kernel_spmv_ell_dict<blocksize, width, rel><<<blocks, threads, 0, stream_interior>>>( \
+            A.localNumberOfRows,                                                              \
+            rows_per_block,                                                                   \
+            A.ell_col_rel,                                                                    \
+            A.ell_col_base,                                                                   \
+            A.ell_col_ind,                                                                    \
+            A.ell_val_idx,                                                                    \
+            A.ell_val_dict,                                                                   \
+            A.ell_diag,                                                                       \
+            x.d_values,                                                                       \
+            y.d_values);                                                                      \
+    }
+
+#define LAUNCH_SPMV_ELL_DICT_IDX(blocksize, width) LAUNCH_SPMV_ELL_DICT(blocksize, width, false)
+#define LAUNCH_SPMV_ELL_DICT_REL(blocksize, width) LAUNCH_SPMV_ELL_DICT(blocksize, width, true)
+
 #define LAUNCH_SPMV_HALO(blocksize, width)                       \
     {                                                            \
         dim3 blocks((A.halo_rows - 1) / blocksize + 1);          \
@@ -124,12 +174,12 @@ __global__ void kernel_spmv_ell_coarse(local_int_t size,
     __builtin_nontemporal_store(sum, y + row);
 }
 
-template <unsigned int BLOCKSIZE, unsigned int WIDTH>
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, typename T>
 __launch_bounds__(BLOCKSIZE)
 __global__ void kernel_spmv_ell(local_int_t m,
                                 local_int_t rows_per_block,
                                 const local_int_t* ell_col_ind,
-                                const double* ell_val,
+                                const T* ell_val,
                                 const double* x,
                                 double* y)
 {
@@ -157,7 +207,116 @@ __global__ void kernel_spmv_ell(local_int_t m,
 
         if(col >= 0 && col < m)
         {
-            sum = fma(__builtin_nontemporal_load(ell_val + idx), x[col], sum);
+            sum = fma(static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), x[col], sum);
+        }
+
+        idx += m;
+    }
+
+    __builtin_nontemporal_store(sum, y + row);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, typename T>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_spmv_ell_rel(local_int_t m,
+                                    local_int_t rows_per_block,
+                                    const unsigned short* ell_col_rel,
+                                    const local_int_t* ell_col_base,
+                                    const local_int_t* ell_col_ind,
+                                    const T* ell_val,
+                                    const double* x,
+                                    double* y)
+{
+    local_int_t color_block_offset = BLOCKSIZE * blockIdx.y;
+    local_int_t thread_block_offset = blockIdx.x * rows_per_block;
+
+    local_int_t row = color_block_offset + thread_block_offset + threadIdx.x;
+
+    if(row >= m)
+    {
+        return;
+    }
+
+    const local_int_t* base = ell_col_base + (row / ELL_REL_CHUNK) * WIDTH;
+
+    double sum = 0.0;
+    local_int_t idx = row;
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        unsigned short rel = __builtin_nontemporal_load(ell_col_rel + idx);
+
+        if(rel != ELL_REL_SKIP)
+        {
+            local_int_t col = (rel == ELL_REL_ESCAPE) ? ell_col_ind[idx] : base[p] + rel;
+
+            if(col < m)
+            {
+                sum = fma(static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), x[col], sum);
+            }
+        }
+
+        idx += m;
+    }
+
+    __builtin_nontemporal_store(sum, y + row);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, bool REL>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_spmv_ell_dict(local_int_t m,
+                                     local_int_t rows_per_block,
+                                     const unsigned short* ell_col_rel,
+                                     const local_int_t* ell_col_base,
+                                     const local_int_t* ell_col_ind,
+                                     const unsigned char* ell_val_idx,
+                                     const double* ell_val_dict,
+                                     const double* ell_diag,
+                                     const double* x,
+                                     double* y)
+{
+    local_int_t color_block_offset = BLOCKSIZE * blockIdx.y;
+    local_int_t thread_block_offset = blockIdx.x * rows_per_block;
+
+    local_int_t row = color_block_offset + thread_block_offset + threadIdx.x;
+
+    if(row >= m)
+    {
+        return;
+    }
+
+    const local_int_t* base = REL ? ell_col_base + (row / ELL_REL_CHUNK) * WIDTH : NULL;
+
+    // Without indices, all off-diagonal values equal the first dictionary value
+    double diag = __builtin_nontemporal_load(ell_diag + row);
+    double uniform = __ldg(ell_val_dict);
+
+    double sum = 0.0;
+    local_int_t idx = row;
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col;
+
+        if(REL)
+        {
+            unsigned short rel = __builtin_nontemporal_load(ell_col_rel + idx);
+            col = (rel == ELL_REL_SKIP) ? -1 : (rel == ELL_REL_ESCAPE) ? ell_col_ind[idx] : base[p] + rel;
+        }
+        else
+        {
+            col = __builtin_nontemporal_load(ell_col_ind + idx);
+        }
+
+        if(col >= 0 && col < m)
+        {
+            double val = (col == row) ? diag
+                       : (ell_val_idx == NULL) ? uniform
+                       : __ldg(ell_val_dict + __builtin_nontemporal_load(ell_val_idx + idx));
+
+            sum = fma(val, x[col], sum);
         }
 
         idx += m;
@@ -225,6 +384,14 @@ int ComputeSPMV(const SparseMatrix& A, Vector& x, Vector& y)
     assert(x.localLength >= A.localNumberOfColumns);
     assert(y.localLength >= A.localNumberOfRows);
 
+    // Fused SpMV and restriction, if y is the fine level residual of the hierarchy
+    bool coarse = (A.mgData != NULL && &y == A.mgData->Axf);
+
+    hipProfileScope_t scope(PROFILE_SPMV,
+                            A.level,
+                            A.localNumberOfNonzeros * (sizeof(double) + sizeof(local_int_t))
+                            + 2.0 * A.localNumberOfRows * sizeof(double));
+
 #ifndef HPCG_NO_MPI
     if(A.geom->size > 1)
     {
@@ -232,9 +399,34 @@ int ComputeSPMV(const SparseMatrix& A, Vector& x, Vector& y)
     }
 #endif
 
-    if(&y != A.mgData->Axf)
+    if(!coarse)
     {
-        if(A.ell_width == 27) LAUNCH_SPMV_ELL(1024, 27);
+        int blocksize = kernel_config.GetSpMVBlocksize(A.level);
+
+        if(A.ell_width == 27 && A.ell_val_dict != NULL && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SPMV_ELL_DICT_REL, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_dict != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SPMV_ELL_DICT_IDX, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_f32 != NULL && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SPMV_ELL_REL_F32, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_f32 != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SPMV_ELL_F32, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SPMV_ELL_REL, 27);
+        }
+        else if(A.ell_width == 27)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SPMV_ELL, 27);
+        }
     }
 
 #ifndef HPCG_NO_MPI
@@ -243,14 +435,14 @@ int ComputeSPMV(const SparseMatrix& A, Vector& x, Vector& y)
         ExchangeHaloAsync(A);
         ObtainRecvBuffer(A, x);
 
-        if(&y != A.mgData->Axf)
+        if(!coarse)
         {
             if(A.ell_width == 27) LAUNCH_SPMV_HALO(1024, 27);
         }
     }
 #endif
 
-    if(&y == A.mgData->Axf)
+    if(coarse)
     {
         dim3 blocks((A.mgData->rc->localLength - 1) / 1024 + 1);
         dim3 threads(1024);
@@ -19,6 +19,7 @@
  */
 
 #include "ComputeSPMV_ref.hpp"
+#include "Profiler.hpp"
 
 #ifndef HPCG_NO_MPI
 #include "ExchangeHalo.hpp"
@@ -49,6 +50,9 @@ int ComputeSPMV_ref( const SparseMatrix & A, Vector & x, Vector & y) {
   assert(x.localLength>=A.localNumberOfColumns); // Test vector lengths
   assert(y.localLength>=A.localNumberOfRows);
 
+  hipProfileScope_t scope(PROFILE_SPMV_REF, A.level,
+      A.localNumberOfNonzeros*(sizeof(double)+sizeof(local_int_t)) + 2.0*A.localNumberOfRows*sizeof(double));
+
 #ifndef HPCG_NO_MPI
     ExchangeHalo(A,x);
 #endif
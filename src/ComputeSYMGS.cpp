@@ -48,10 +48,11 @@
 
 #include "ComputeSYMGS.hpp"
 #include "ExchangeHalo.hpp"
+#include "CompressELL.hpp"
 
 #include <hip/hip_runtime.h>
 
-#define LAUNCH_SYMGS_SWEEP(blocksize, width)                        \
+#define LAUNCH_SYMGS_SWEEP_T(blocksize, width, val)                 \
     {                                                               \
         dim3 blocks((A.sizes[i] - 1) / blocksize + 1);              \
         dim3 threads(blocksize);                                    \
@@ -62,13 +63,16 @@
             A.sizes[i],                                             \
             A.offsets[i],                                           \
             A.ell_col_ind,                                          \
-            A.ell_val,                                              \
+            val,                                                    \
             A.inv_diag,                                             \
             r.d_values,                                             \
             x.d_values);                                            \
     }
 
-#define LAUNCH_SYMGS_INTERIOR(blocksize, width)                      \
+#define LAUNCH_SYMGS_SWEEP(blocksize, width) LAUNCH_SYMGS_SWEEP_T(blocksize, width, A.ell_val)
+#define LAUNCH_SYMGS_SWEEP_F32(blocksize, width) LAUNCH_SYMGS_SWEEP_T(blocksize, width, A.ell_val_f32)
+
+#define LAUNCH_SYMGS_INTERIOR_T(blocksize, width, val)               \
     {                                                                \
         dim3 blocks((A.sizes[0] - 1) / blocksize + 1);               \
         dim3 threads(blocksize);                                     \
@@ -80,12 +84,138 @@
             A.localNumberOfRows,                                     \
             A.sizes[0],                                              \
             A.ell_col_ind,                                           \
-            A.ell_val,                                               \
+            val,                                                     \
             A.inv_diag,                                              \
             r.d_values,                                              \
             x.d_values);                                             \
     }
 
+#define LAUNCH_SYMGS_INTERIOR(blocksize, width) LAUNCH_SYMGS_INTERIOR_T(blocksize, width, A.ell_val)
+#define LAUNCH_SYMGS_INTERIOR_F32(blocksize, width) LAUNCH_SYMGS_INTERIOR_T(blocksize, width, A.ell_val_f32)
+
+#define LAUNCH_SYMGS_SWEEP_REL_T(blocksize, width, val)                \
+    {                                                                  \
+        dim3 blocks((A.sizes[i] - 1) / blocksize + 1);                 \
+        dim3 threads(blocksize);                                       \
+                                                                       \
+        kernel_symgs_sweep_rel<blocksize, width><<<blocks, threads>>>( \
+            A.localNumberOfRows,                                       \
+            A.localNumberOfColumns,                                    \
+            A.sizes[i],                                                \
+            A.offsets[i],                                              \
+            A.ell_col_rel,                                             \
+            A.ell_col_base,                                            \
+            A.ell_col_ind,                                             \
+            val,                                                       \
+            A.inv_diag,                                                \
+            r.d_values,                                                \
+            x.d_values);                                               \
+    }
+
+#define LAUNCH_SYMGS_SWEEP_REL(blocksize, width) LAUNCH_SYMGS_SWEEP_REL_T(blocksize, width, A.ell_val)
+#define LAUNCH_SYMGS_SWEEP_REL_F32(blocksize, width) LAUNCH_SYMGS_SWEEP_REL_T(blocksize, width, A.ell_val_f32)
+
+#define LAUNCH_SYMGS_INTERIOR_REL_T(blocksize, width, val)               \
+    {                                                                    \
+        dim3 blocks((A.sizes[0] - 1) / blocksize + 1);                   \
+        dim3 threads(blocksize);                                         \
+                                                                         \
+        kernel_symgs_interior_rel<blocksize, width><<<blocks,            \
+                                                     threads,            \
+                                                     0,                  \
+                                                     stream_interior>>>( \
+            A.localNumberOfRows,                                         \
+            A.sizes[0],                                                  \
+            A.ell_col_rel,                                               \
+            A.ell_col_base,                                              \
+            A.ell_col_ind,                                               \
+            val,                                                         \
+            A.inv_diag,                                                  \
+            r.d_values,                                                  \
+            x.d_values);                                                 \
+    }
+
+#define LAUNCH_SYMGS_INTERIOR_REL(blocksize, width) LAUNCH_SYMGS_INTERIOR_REL_T(blocksize, width, A.ell_val)
+#define LAUNCH_SYMGS_INTERIOR_REL_F32(blocksize, width) LAUNCH_SYMGS_INTERIOR_REL_T(blocksize, width, A.ell_val_f32)
+
+#define LAUNCH_SYMGS_SWEEP_DICT(blocksize, width, rel)                       \
+    {                                                                        \
+        dim3 blocks((A.sizes[i] - 1) / blocksize + 1);                       \
+        dim3 threads(blocksize);                                             \
+                                                                             \
+        kernel_symgs_sweep_dict<blocksize, width, rel><<<blocks, threads>>>( \
+            A.localNumberOfRows,                                             \
+            A.localNumberOfColumns,                                          \
+            A.sizes[i],                                                      \
+            A.offsets[i],                                                    \
+            A.ell_col_rel,                                                   \
+            A.ell_col_base,                                                  \
+            A.ell_col_ind,                                                   \
+            A.ell_val_idx,                                                   \
+            A.ell_val_dict,                                                  \
+            A.inv_diag,                                                      \
+            r.d_values,                                                      \
+            x.d_values);                                                     \
+    }
+
+#define LAUNCH_SYMGS_INTERIOR_DICT(blocksize, width, rel)                       \
+    {                                                                           \
+        dim3 blocks((A.sizes[0] - 1) / blocksize + 1);                          \
+        dim3 threads(blocksize);                                                \
+                                                                                \
+        kernel_symgs_interior_dict<blocksize, width, rel><<<blocks,             \
+                                                            threads,            \
+                                                            0,                  \
+                                                            stream_interior>>>( \
+            A.localNumberOfRows,                                                \
+            A.sizes[0],                                                         \
+            A.ell_col_rel,                                                      \
+            A.ell_col_base,                                                     \
+            A.ell_col_ind,                                                      \
+            A.ell_val_idx,                                                      \
+            A.ell_val_dict,                                                     \
+            A.inv_diag,                                                         \
+            r.d_values,                                                         \
+            x.d_values);                                                        \
+    }
+
+#define LAUNCH_SYMGS_SWEEP_DICT_IDX(blocksize, width) LAUNCH_SYMGS_SWEEP_DICT(blocksize, width, false)
+#define LAUNCH_SYMGS_SWEEP_DICT_REL(blocksize, width) LAUNCH_SYMGS_SWEEP_DICT(blocksize, width, true)
+#define LAUNCH_SYMGS_INTERIOR_DICT_IDX(blocksize, width) LAUNCH_SYMGS_INTERIOR_DICT(blocksize, width, false)
+#define LAUNCH_SYMGS_INTERIOR_DICT_REL(blocksize, width) LAUNCH_SYMGS_INTERIOR_DICT(blocksize, width, true)
+
+#define LAUNCH_FORWARD_SWEEP_0_DICT(blocksize, unused)                             \
+    {                                                                              \
+        kernel_forward_sweep_0_dict<blocksize><<<(A.sizes[i] - 1) / blocksize + 1, \
+                                                 blocksize>>>(                     \
+            A.localNumberOfRows,                                                   \
+            A.sizes[i],                                                            \
+            A.offsets[i],                                                          \
+            A.ell_col_ind,                                                         \
+            A.ell_val_idx,                                                         \
+            A.ell_val_dict,                                                        \
+            A.ell_diag,                                                            \
+            A.diag_idx,                                                            \
+            r.d_values,                                                            \
+            x.d_values);                                                           \
+    }
+
+#define LAUNCH_BACKWARD_SWEEP_0_DICT(blocksize, unused)                             \
+    {                                                                               \
+        kernel_backward_sweep_0_dict<blocksize><<<(A.sizes[i] - 1) / blocksize + 1, \
+                                                  blocksize>>>(                     \
+            A.localNumberOfRows,                                                    \
+            A.sizes[i],                                                             \
+            A.offsets[i],                                                           \
+            A.ell_width,                                                            \
+            A.ell_col_ind,                                                          \
+            A.ell_val_idx,                                                          \
+            A.ell_val_dict,                                                         \
+            A.ell_diag,                                                             \
+            A.diag_idx,                                                             \
+            x.d_values);                                                            \
+    }
+
 #define LAUNCH_SYMGS_HALO(blocksize, width)                       \
     {                                                             \
         dim3 blocks((A.halo_rows - 1) / blocksize + 1);           \
@@ -104,14 +234,71 @@
             x.d_values);                                          \
     }
 
-template <unsigned int BLOCKSIZE, unsigned int WIDTH>
+#define LAUNCH_FORWARD_SWEEP_0_T(blocksize, unused, val)                      \
+    {                                                                         \
+        kernel_forward_sweep_0<blocksize><<<(A.sizes[i] - 1) / blocksize + 1, \
+                                            blocksize>>>(                     \
+            A.localNumberOfRows,                                              \
+            A.sizes[i],                                                       \
+            A.offsets[i],                                                     \
+            A.ell_col_ind,                                                    \
+            val,                                                              \
+            A.diag_idx,                                                       \
+            r.d_values,                                                       \
+            x.d_values);                                                      \
+    }
+
+#define LAUNCH_FORWARD_SWEEP_0(blocksize, unused) LAUNCH_FORWARD_SWEEP_0_T(blocksize, unused, A.ell_val)
+#define LAUNCH_FORWARD_SWEEP_0_F32(blocksize, unused) LAUNCH_FORWARD_SWEEP_0_T(blocksize, unused, A.ell_val_f32)
+
+#define LAUNCH_BACKWARD_SWEEP_0_T(blocksize, unused, val)                      \
+    {                                                                          \
+        kernel_backward_sweep_0<blocksize><<<(A.sizes[i] - 1) / blocksize + 1, \
+                                             blocksize>>>(                     \
+            A.localNumberOfRows,                                               \
+            A.sizes[i],                                                        \
+            A.offsets[i],                                                      \
+            A.ell_width,                                                       \
+            A.ell_col_ind,                                                     \
+            val,                                                               \
+            A.diag_idx,                                                        \
+            x.d_values);                                                       \
+    }
+
+#define LAUNCH_BACKWARD_SWEEP_0(blocksize, unused) LAUNCH_BACKWARD_SWEEP_0_T(blocksize, unused, A.ell_val)
+#define LAUNCH_BACKWARD_SWEEP_0_F32(blocksize, unused) LAUNCH_BACKWARD_SWEEP_0_T(blocksize, unused, A.ell_val_f32)
+
+#define LAUNCH_SYMGS_TILE_T(blocksize, width, forward, val)                          \
+    {                                                                                \
+        local_int_t ntiles = A.sizes[i] / A.tile_rows;                               \
+                                                                                     \
+        kernel_symgs_tile<blocksize, width, forward><<<(ntiles - 1) / blocksize + 1, \
+                                                       blocksize>>>(                 \
+            A.localNumberOfRows,                                                     \
+            A.localNumberOfColumns,                                                  \
+            ntiles,                                                                  \
+            A.tile_rows,                                                             \
+            A.offsets[i],                                                            \
+            A.ell_col_ind,                                                           \
+            val,                                                                     \
+            A.inv_diag,                                                              \
+            r.d_values,                                                              \
+            x.d_values);                                                             \
+    }
+
+#define LAUNCH_SYMGS_TILE_FORWARD(blocksize, width) LAUNCH_SYMGS_TILE_T(blocksize, width, true, A.ell_val)
+#define LAUNCH_SYMGS_TILE_BACKWARD(blocksize, width) LAUNCH_SYMGS_TILE_T(blocksize, width, false, A.ell_val)
+#define LAUNCH_SYMGS_TILE_FORWARD_F32(blocksize, width) LAUNCH_SYMGS_TILE_T(blocksize, width, true, A.ell_val_f32)
+#define LAUNCH_SYMGS_TILE_BACKWARD_F32(blocksize, width) LAUNCH_SYMGS_TILE_T(blocksize, width, false, A.ell_val_f32)
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, typename T>
 __launch_bounds__(BLOCKSIZE)
 __global__ void kernel_symgs_sweep(local_int_t m,
                                    local_int_t n,
                                    local_int_t block_nrow,
                                    local_int_t offset,
                                    const local_int_t* ell_col_ind,
-                                   const double* ell_val,
+                                   const T* ell_val,
                                    const double* inv_diag,
                                    const double* x,
                                    double* y)
@@ -135,7 +322,7 @@ __global__ void kernel_symgs_sweep(local_int_t m,
 
         if(col >= 0 && col < n && col != row)
         {
-            sum = fma(-__builtin_nontemporal_load(ell_val + idx), y[col], sum);
+            sum = fma(-static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), y[col], sum);
         }
 
         idx += m;
@@ -144,12 +331,59 @@ __global__ void kernel_symgs_sweep(local_int_t m,
     __builtin_nontemporal_store(sum * __builtin_nontemporal_load(inv_diag + row), y + row);
 }
 
-template <unsigned int BLOCKSIZE, unsigned int WIDTH>
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, bool FORWARD, typename T>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_symgs_tile(local_int_t m,
+                                  local_int_t n,
+                                  local_int_t ntiles,
+                                  local_int_t tile_rows,
+                                  local_int_t offset,
+                                  const local_int_t* ell_col_ind,
+                                  const T* ell_val,
+                                  const double* inv_diag,
+                                  const double* x,
+                                  double* y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= ntiles)
+    {
+        return;
+    }
+
+    // Each thread sweeps the rows of a single block in order, row p of
+    // all blocks of the color is stored contiguously
+    for(local_int_t k = 0; k < tile_rows; ++k)
+    {
+        local_int_t pos = FORWARD ? k : tile_rows - 1 - k;
+        local_int_t row = offset + pos * ntiles + gid;
+        local_int_t idx = row;
+
+        double sum = __builtin_nontemporal_load(x + row);
+
+#pragma unroll
+        for(local_int_t p = 0; p < WIDTH; ++p)
+        {
+            local_int_t col = __builtin_nontemporal_load(ell_col_ind + idx);
+
+            if(col >= 0 && col < n && col != row)
+            {
+                sum = fma(-static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), y[col], sum);
+            }
+
+            idx += m;
+        }
+
+        y[row] = sum * __builtin_nontemporal_load(inv_diag + row);
+    }
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, typename T>
 __launch_bounds__(BLOCKSIZE)
 __global__ void kernel_symgs_interior(local_int_t m,
                                       local_int_t block_nrow,
                                       const local_int_t* ell_col_ind,
-                                      const double* ell_val,
+                                      const T* ell_val,
                                       const double* inv_diag,
                                       const double* x,
                                       double* y)
@@ -172,7 +406,217 @@ __global__ void kernel_symgs_interior(local_int_t m,
 
         if(col >= 0 && col < m && col != row)
         {
-            sum = fma(-__builtin_nontemporal_load(ell_val + idx), __ldg(y + col), sum);
+            sum = fma(-static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), __ldg(y + col), sum);
+        }
+
+        idx += m;
+    }
+
+    __builtin_nontemporal_store(sum * __builtin_nontemporal_load(inv_diag + row), y + row);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, typename T>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_symgs_sweep_rel(local_int_t m,
+                                       local_int_t n,
+                                       local_int_t block_nrow,
+                                       local_int_t offset,
+                                       const unsigned short* ell_col_rel,
+                                       const local_int_t* ell_col_base,
+                                       const local_int_t* ell_col_ind,
+                                       const T* ell_val,
+                                       const double* inv_diag,
+                                       const double* x,
+                                       double* y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t row = gid + offset;
+    local_int_t idx = row;
+
+    const local_int_t* base = ell_col_base + (row / ELL_REL_CHUNK) * WIDTH;
+
+    double sum = __builtin_nontemporal_load(x + row);
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        unsigned short rel = __builtin_nontemporal_load(ell_col_rel + idx);
+
+        if(rel != ELL_REL_SKIP)
+        {
+            local_int_t col = (rel == ELL_REL_ESCAPE) ? ell_col_ind[idx] : base[p] + rel;
+
+            if(col < n && col != row)
+            {
+                sum = fma(-static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), y[col], sum);
+            }
+        }
+
+        idx += m;
+    }
+
+    __builtin_nontemporal_store(sum * __builtin_nontemporal_load(inv_diag + row), y + row);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, typename T>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_symgs_interior_rel(local_int_t m,
+                                          local_int_t block_nrow,
+                                          const unsigned short* ell_col_rel,
+                                          const local_int_t* ell_col_base,
+                                          const local_int_t* ell_col_ind,
+                                          const T* ell_val,
+                                          const double* inv_diag,
+                                          const double* x,
+                                          double* y)
+{
+    local_int_t row = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(row >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t idx = row;
+
+    const local_int_t* base = ell_col_base + (row / ELL_REL_CHUNK) * WIDTH;
+
+    double sum = __builtin_nontemporal_load(x + row);
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        unsigned short rel = __builtin_nontemporal_load(ell_col_rel + idx);
+
+        if(rel != ELL_REL_SKIP)
+        {
+            local_int_t col = (rel == ELL_REL_ESCAPE) ? ell_col_ind[idx] : base[p] + rel;
+
+            if(col < m && col != row)
+            {
+                sum = fma(-static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), __ldg(y + col), sum);
+            }
+        }
+
+        idx += m;
+    }
+
+    __builtin_nontemporal_store(sum * __builtin_nontemporal_load(inv_diag + row), y + row);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, bool REL>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_symgs_sweep_dict(local_int_t m,
+                                        local_int_t n,
+                                        local_int_t block_nrow,
+                                        local_int_t offset,
+                                        const unsigned short* ell_col_rel,
+                                        const local_int_t* ell_col_base,
+                                        const local_int_t* ell_col_ind,
+                                        const unsigned char* ell_val_idx,
+                                        const double* ell_val_dict,
+                                        const double* inv_diag,
+                                        const double* x,
+                                        double* y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t row = gid + offset;
+    local_int_t idx = row;
+
+    const local_int_t* base = REL ? ell_col_base + (row / ELL_REL_CHUNK) * WIDTH : NULL;
+
+    double uniform = __ldg(ell_val_dict);
+    double sum = __builtin_nontemporal_load(x + row);
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col;
+
+        if(REL)
+        {
+            unsigned short rel = __builtin_nontemporal_load(ell_col_rel + idx);
+            col = (rel == ELL_REL_SKIP) ? -1 : (rel == ELL_REL_ESCAPE) ? ell_col_ind[idx] : base[p] + rel;
+        }
+        else
+        {
+            col = __builtin_nontemporal_load(ell_col_ind + idx);
+        }
+
+        if(col >= 0 && col < n && col != row)
+        {
+            double val = (ell_val_idx == NULL) ? uniform
+                       : __ldg(ell_val_dict + __builtin_nontemporal_load(ell_val_idx + idx));
+
+            sum = fma(-val, y[col], sum);
+        }
+
+        idx += m;
+    }
+
+    __builtin_nontemporal_store(sum * __builtin_nontemporal_load(inv_diag + row), y + row);
+}
+
+template <unsigned int BLOCKSIZE, unsigned int WIDTH, bool REL>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_symgs_interior_dict(local_int_t m,
+                                           local_int_t block_nrow,
+                                           const unsigned short* ell_col_rel,
+                                           const local_int_t* ell_col_base,
+                                           const local_int_t* ell_col_ind,
+                                           const unsigned char* ell_val_idx,
+                                           const double* ell_val_dict,
+                                           const double* inv_diag,
+                                           const double* x,
+                                           double* y)
+{
+    local_int_t row = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(row >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t idx = row;
+
+    const local_int_t* base = REL ? ell_col_base + (row / ELL_REL_CHUNK) * WIDTH : NULL;
+
+    double uniform = __ldg(ell_val_dict);
+    double sum = __builtin_nontemporal_load(x + row);
+
+#pragma unroll
+    for(local_int_t p = 0; p < WIDTH; ++p)
+    {
+        local_int_t col;
+
+        if(REL)
+        {
+            unsigned short rel = __builtin_nontemporal_load(ell_col_rel + idx);
+            col = (rel == ELL_REL_SKIP) ? -1 : (rel == ELL_REL_ESCAPE) ? ell_col_ind[idx] : base[p] + rel;
+        }
+        else
+        {
+            col = __builtin_nontemporal_load(ell_col_ind + idx);
+        }
+
+        if(col >= 0 && col < m && col != row)
+        {
+            double val = (ell_val_idx == NULL) ? uniform
+                       : __ldg(ell_val_dict + __builtin_nontemporal_load(ell_val_idx + idx));
+
+            sum = fma(-val, __ldg(y + col), sum);
         }
 
         idx += m;
@@ -246,13 +690,13 @@ __global__ void kernel_pointwise_mult(local_int_t size,
     out[gid] = x[gid] * y[gid];
 }
 
-template <unsigned int BLOCKSIZE>
+template <unsigned int BLOCKSIZE, typename T>
 __launch_bounds__(BLOCKSIZE)
 __global__ void kernel_forward_sweep_0(local_int_t m,
                                        local_int_t block_nrow,
                                        local_int_t offset,
                                        const local_int_t* ell_col_ind,
-                                       const double* ell_val,
+                                       const T* ell_val,
                                        const local_int_t* diag_idx,
                                        const double* x,
                                        double* y)
@@ -277,25 +721,25 @@ __global__ void kernel_forward_sweep_0(local_int_t m,
         // Every entry above offset is zero
         if(col >= 0 && col < offset)
         {
-            sum = fma(-__builtin_nontemporal_load(ell_val + idx), y[col], sum);
+            sum = fma(-static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), y[col], sum);
         }
 
         idx += m;
     }
 
-    sum *= __drcp_rn(__builtin_nontemporal_load(ell_val + idx));
+    sum *= __drcp_rn(static_cast<double>(__builtin_nontemporal_load(ell_val + idx)));
 
     __builtin_nontemporal_store(sum, y + row);
 }
 
-template <unsigned int BLOCKSIZE>
+template <unsigned int BLOCKSIZE, typename T>
 __launch_bounds__(BLOCKSIZE)
 __global__ void kernel_backward_sweep_0(local_int_t m,
                                         local_int_t block_nrow,
                                         local_int_t offset,
                                         local_int_t ell_width,
                                         const local_int_t* ell_col_ind,
-                                        const double* ell_val,
+                                        const T* ell_val,
                                         const local_int_t* diag_idx,
                                         double* x)
 {
@@ -310,7 +754,7 @@ __global__ void kernel_backward_sweep_0(local_int_t m,
     local_int_t diag = __builtin_nontemporal_load(diag_idx + row);
     local_int_t idx  = diag * m + row;
 
-    double diag_val = __builtin_nontemporal_load(ell_val + idx);
+    double diag_val = static_cast<double>(__builtin_nontemporal_load(ell_val + idx));
     idx += m;
 
     // Scale result with diagonal entry
@@ -323,7 +767,7 @@ __global__ void kernel_backward_sweep_0(local_int_t m,
         // Every entry below offset should not be taken into account
         if(col >= offset && col < m)
         {
-            sum = fma(-__builtin_nontemporal_load(ell_val + idx), x[col], sum);
+            sum = fma(-static_cast<double>(__builtin_nontemporal_load(ell_val + idx)), x[col], sum);
         }
 
         idx += m;
@@ -334,6 +778,170 @@ __global__ void kernel_backward_sweep_0(local_int_t m,
     __builtin_nontemporal_store(sum, x + row);
 }
 
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_forward_sweep_0_dict(local_int_t m,
+                                            local_int_t block_nrow,
+                                            local_int_t offset,
+                                            const local_int_t* ell_col_ind,
+                                            const unsigned char* ell_val_idx,
+                                            const double* ell_val_dict,
+                                            const double* ell_diag,
+                                            const local_int_t* diag_idx,
+                                            const double* x,
+                                            double* y)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t row  = gid + offset;
+    local_int_t idx  = row;
+    local_int_t diag = __builtin_nontemporal_load(diag_idx + row);
+
+    double uniform = __ldg(ell_val_dict);
+    double sum = __builtin_nontemporal_load(x + row);
+
+    for(local_int_t p = 0; p < diag; ++p)
+    {
+        local_int_t col = __builtin_nontemporal_load(ell_col_ind + idx);
+
+        // Every entry above offset is zero
+        if(col >= 0 && col < offset)
+        {
+            double val = (ell_val_idx == NULL) ? uniform
+                       : __ldg(ell_val_dict + __builtin_nontemporal_load(ell_val_idx + idx));
+
+            sum = fma(-val, y[col], sum);
+        }
+
+        idx += m;
+    }
+
+    sum *= __drcp_rn(__builtin_nontemporal_load(ell_diag + row));
+
+    __builtin_nontemporal_store(sum, y + row);
+}
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_backward_sweep_0_dict(local_int_t m,
+                                             local_int_t block_nrow,
+                                             local_int_t offset,
+                                             local_int_t ell_width,
+                                             const local_int_t* ell_col_ind,
+                                             const unsigned char* ell_val_idx,
+                                             const double* ell_val_dict,
+                                             const double* ell_diag,
+                                             const local_int_t* diag_idx,
+                                             double* x)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= block_nrow)
+    {
+        return;
+    }
+
+    local_int_t row  = gid + offset;
+    local_int_t diag = __builtin_nontemporal_load(diag_idx + row);
+    local_int_t idx  = (diag + 1) * m + row;
+
+    double uniform = __ldg(ell_val_dict);
+    double diag_val = __builtin_nontemporal_load(ell_diag + row);
+
+    // Scale result with diagonal entry
+    double sum = x[row] * diag_val;
+
+    for(local_int_t p = diag + 1; p < ell_width; ++p)
+    {
+        local_int_t col = __builtin_nontemporal_load(ell_col_ind + idx);
+
+        // Every entry below offset should not be taken into account
+        if(col >= offset && col < m)
+        {
+            double val = (ell_val_idx == NULL) ? uniform
+                       : __ldg(ell_val_dict + __builtin_nontemporal_load(ell_val_idx + idx));
+
+            sum = fma(-val, x[col], sum);
+        }
+
+        idx += m;
+    }
+
+    sum *= __drcp_rn(diag_val);
+
+    __builtin_nontemporal_store(sum, x + row);
+}
+
+/*!
+  Symmetric Gauss-Seidel step of a block colored matrix, see BlockColoring.
+  The rows of a block depend on each other, thus the halo is exchanged before
+  the first color instead of being overlapped with it.
+
+  @param[in]    A        the known system matrix
+  @param[in]    r        the input vector
+  @param[inout] x        the solution vector
+  @param[in]    exchange exchange the halo of x, not required if it is zero
+
+  @return returns 0 upon success and non-zero otherwise
+*/
+static int ComputeSYMGSBlockColored(const SparseMatrix& A, const Vector& r, Vector& x, bool exchange)
+{
+    double sweep_bytes = A.localNumberOfNonzeros * (sizeof(double) + sizeof(local_int_t))
+                       + 2.0 * A.localNumberOfRows * sizeof(double);
+
+    local_int_t i = 0;
+    int blocksize = kernel_config.GetSYMGSBlocksize(A.level);
+
+    profiler.Begin(PROFILE_SYMGS_FORWARD, A.level);
+
+#ifndef HPCG_NO_MPI
+    if(exchange && A.geom->size > 1)
+    {
+        PrepareSendBuffer(A, x);
+        ExchangeHaloAsync(A);
+        ObtainRecvBuffer(A, x);
+    }
+#endif
+
+    // Solve L
+    for(; i < A.nblocks; ++i)
+    {
+        if(A.ell_val_f32 != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_TILE_FORWARD_F32, 27);
+        }
+        else
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_TILE_FORWARD, 27);
+        }
+    }
+
+    profiler.End(sweep_bytes);
+    profiler.Begin(PROFILE_SYMGS_BACKWARD, A.level);
+
+    // Solve U
+    for(i = A.ublocks; i >= 0; --i)
+    {
+        if(A.ell_val_f32 != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_TILE_BACKWARD_F32, 27);
+        }
+        else
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_TILE_BACKWARD, 27);
+        }
+    }
+
+    profiler.End(sweep_bytes);
+
+    return 0;
+}
+
 /*!
   Routine to compute one step of symmetric Gauss-Seidel:
 
@@ -364,14 +972,51 @@ int ComputeSYMGS(const SparseMatrix& A, const Vector& r, Vector& x)
 {
     assert(x.localLength == A.localNumberOfColumns);
 
+    // Bytes moved by a single sweep
+    double sweep_bytes = A.localNumberOfNonzeros * (sizeof(double) + sizeof(local_int_t))
+                       + 2.0 * A.localNumberOfRows * sizeof(double);
+
+    hipProfileScope_t scope(PROFILE_SYMGS, A.level, 2.0 * sweep_bytes);
+
+    if(A.tile_rows > 0)
+    {
+        return ComputeSYMGSBlockColored(A, r, x, true);
+    }
+
     local_int_t i = 0;
+    int blocksize = kernel_config.GetSYMGSBlocksize(A.level);
+
+    profiler.Begin(PROFILE_SYMGS_FORWARD, A.level);
 
 #ifndef HPCG_NO_MPI
     if(A.geom->size > 1)
     {
         PrepareSendBuffer(A, x);
 
-        if(A.ell_width == 27) LAUNCH_SYMGS_INTERIOR(1024, 27);
+        if(A.ell_width == 27 && A.ell_val_dict != NULL && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_INTERIOR_DICT_REL, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_dict != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_INTERIOR_DICT_IDX, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_f32 != NULL && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_INTERIOR_REL_F32, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_f32 != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_INTERIOR_F32, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_INTERIOR_REL, 27);
+        }
+        else if(A.ell_width == 27)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_INTERIOR, 27);
+        }
 
         ExchangeHaloAsync(A);
         ObtainRecvBuffer(A, x);
@@ -385,15 +1030,66 @@ int ComputeSYMGS(const SparseMatrix& A, const Vector& r, Vector& x)
     // Solve L
     for(; i < A.nblocks; ++i)
     {
-        if(A.ell_width == 27) LAUNCH_SYMGS_SWEEP(1024, 27);
+        if(A.ell_width == 27 && A.ell_val_dict != NULL && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_DICT_REL, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_dict != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_DICT_IDX, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_f32 != NULL && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_REL_F32, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_f32 != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_F32, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_REL, 27);
+        }
+        else if(A.ell_width == 27)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP, 27);
+        }
     }
 
+    profiler.End(sweep_bytes);
+    profiler.Begin(PROFILE_SYMGS_BACKWARD, A.level);
+
     // Solve U
     for(i = A.ublocks; i >= 0; --i)
     {
-        if(A.ell_width == 27) LAUNCH_SYMGS_SWEEP(1024, 27);
+        if(A.ell_width == 27 && A.ell_val_dict != NULL && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_DICT_REL, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_dict != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_DICT_IDX, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_f32 != NULL && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_REL_F32, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_val_f32 != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_F32, 27);
+        }
+        else if(A.ell_width == 27 && A.ell_col_rel != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP_REL, 27);
+        }
+        else if(A.ell_width == 27)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_SYMGS_SWEEP, 27);
+        }
     }
 
+    profiler.End(sweep_bytes);
+
     return 0;
 }
 
@@ -401,6 +1097,24 @@ int ComputeSYMGSZeroGuess(const SparseMatrix& A, const Vector& r, Vector& x)
 {
     assert(x.localLength == A.localNumberOfColumns);
 
+    // Bytes moved by a single sweep
+    double sweep_bytes = A.localNumberOfNonzeros * (sizeof(double) + sizeof(local_int_t))
+                       + 2.0 * A.localNumberOfRows * sizeof(double);
+
+    hipProfileScope_t scope(PROFILE_SYMGS, A.level, 2.0 * sweep_bytes);
+
+    // Blocks are swept in order, starting from a zero vector including the halo
+    if(A.tile_rows > 0)
+    {
+        HIP_CHECK(hipMemset(x.d_values, 0, sizeof(double) * x.localLength));
+
+        return ComputeSYMGSBlockColored(A, r, x, false);
+    }
+
+    int blocksize = kernel_config.GetSYMGSBlocksize(A.level);
+
+    profiler.Begin(PROFILE_SYMGS_FORWARD, A.level);
+
     // Solve L
     kernel_pointwise_mult<256><<<(A.sizes[0] - 1) / 256 + 1, 256>>>(
         A.sizes[0],
@@ -410,30 +1124,41 @@ int ComputeSYMGSZeroGuess(const SparseMatrix& A, const Vector& r, Vector& x)
 
     for(local_int_t i = 1; i < A.nblocks; ++i)
     {
-        kernel_forward_sweep_0<1024><<<(A.sizes[i] - 1) / 1024 + 1, 1024>>>(
-            A.localNumberOfRows,
-            A.sizes[i],
-            A.offsets[i],
-            A.ell_col_ind,
-            A.ell_val,
-            A.diag_idx,
-            r.d_values,
-            x.d_values);
+        if(A.ell_val_dict != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_FORWARD_SWEEP_0_DICT, 0);
+        }
+        else if(A.ell_val_f32 != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_FORWARD_SWEEP_0_F32, 0);
+        }
+        else
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_FORWARD_SWEEP_0, 0);
+        }
     }
 
+    profiler.End(sweep_bytes);
+    profiler.Begin(PROFILE_SYMGS_BACKWARD, A.level);
+
     // Solve U
     for(local_int_t i = A.ublocks; i >= 0; --i)
     {
-        kernel_backward_sweep_0<1024><<<(A.sizes[i] - 1) / 1024 + 1, 1024>>>(
-            A.localNumberOfRows,
-            A.sizes[i],
-            A.offsets[i],
-            A.ell_width,
-            A.ell_col_ind,
-            A.ell_val,
-            A.diag_idx,
-            x.d_values);
+        if(A.ell_val_dict != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_BACKWARD_SWEEP_0_DICT, 0);
+        }
+        else if(A.ell_val_f32 != NULL)
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_BACKWARD_SWEEP_0_F32, 0);
+        }
+        else
+        {
+            DISPATCH_BLOCKSIZE(blocksize, LAUNCH_BACKWARD_SWEEP_0, 0);
+        }
     }
 
+    profiler.End(sweep_bytes);
+
     return 0;
 }
@@ -0,0 +1,247 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ComputeSYMGS_level.cpp
+
+ Level scheduled host symmetric Gauss-Seidel
+ */
+
+#ifndef HPCG_NO_MPI
+#include "ExchangeHalo.hpp"
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <cassert>
+#include <thread>
+
+#include "ComputeSYMGS_level.hpp"
+
+// Upper bound of the pause instructions between two polls of a row, beyond it
+// a waiting thread yields its core
+#define HPCG_WAIT_PAUSE_MAX 64
+
+// Hints the core that the calling thread is spinning
+static inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#elif defined(__powerpc__) || defined(__powerpc64__)
+    __asm__ __volatile__("or 27,27,27");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/*
+  Waits until a row has completed the given number of sweeps. The pauses
+  between two polls double up to HPCG_WAIT_PAUSE_MAX, afterwards the thread
+  yields on every poll, such that a preempted thread that owns the row gets
+  the core when there are more threads than cores.
+*/
+static inline void WaitForRow(const std::atomic<int>& sweeps, int target)
+{
+    int pause = 1;
+
+    while(sweeps.load(std::memory_order_acquire) < target)
+    {
+        if(pause <= HPCG_WAIT_PAUSE_MAX)
+        {
+            for(int k = 0; k < pause; ++k)
+            {
+                CpuRelax();
+            }
+
+            pause <<= 1;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Gauss-Seidel update of a single row, identical to ComputeSYMGS_ref
+static inline void UpdateRow(const SparseMatrix& A, const double* rv, double* xv, local_int_t i)
+{
+    const double* currentValues = A.matrixValues[i];
+    const local_int_t* currentColIndices = A.mtxIndL[i];
+    int currentNumberOfNonzeros = A.nonzerosInRow[i];
+    double currentDiagonal = A.matrixDiagonal[i][0];
+    double sum = rv[i];
+
+    for(int j = 0; j < currentNumberOfNonzeros; ++j)
+    {
+        sum -= currentValues[j] * xv[currentColIndices[j]];
+    }
+
+    // Remove diagonal contribution from the loop above
+    sum += xv[i] * currentDiagonal;
+
+    xv[i] = sum / currentDiagonal;
+}
+
+/*!
+  Share of one thread of a team in ComputeSYMGS_level. All threads of the team
+  have to call it with the same sweep number, the halo of x has to be
+  exchanged before.
+
+  @param[in]    A        the known system matrix, with level schedule
+  @param[in]    r        the input vector
+  @param[inout] x        On entry, x should contain relevant values, on exit x contains the result of one symmetric GS sweep with r as the RHS.
+  @param[in]    forward  the number of sweeps all rows have completed so far plus one
+  @param[in]    tid      the thread number within the team
+  @param[in]    nthreads the number of threads of the team
+
+  @see ComputeSYMGS_level
+*/
+void ComputeSYMGS_level_thread(
+    const SparseMatrix& A, const Vector& r, Vector& x, int forward, int tid, int nthreads)
+{
+    const local_int_t nrow = A.localNumberOfRows;
+    const double* rv = r.values;
+    double* xv = x.values;
+
+    std::atomic<int>* rowSweeps = A.rowSweeps;
+
+    int backward = forward + 1;
+
+    // Forward sweep, rows wait for their lower neighbors
+    for(local_int_t level = 0; level < A.numberOfLowerLevels; ++level)
+    {
+        local_int_t first = A.lowerLevelPtr[level];
+        local_int_t size = A.lowerLevelPtr[level + 1] - first;
+
+        local_int_t begin = first + (local_int_t)((long long)size * tid / nthreads);
+        local_int_t end = first + (local_int_t)((long long)size * (tid + 1) / nthreads);
+
+        for(local_int_t k = begin; k < end; ++k)
+        {
+            local_int_t i = A.lowerLevelRows[k];
+
+            for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+            {
+                local_int_t col = A.mtxIndL[i][j];
+
+                if(col < i)
+                {
+                    WaitForRow(rowSweeps[col], forward);
+                }
+            }
+
+            UpdateRow(A, rv, xv, i);
+
+            rowSweeps[i].store(forward, std::memory_order_release);
+        }
+    }
+
+    // Backward sweep, rows wait for their own forward sweep and their upper neighbors
+    for(local_int_t level = 0; level < A.numberOfUpperLevels; ++level)
+    {
+        local_int_t first = A.upperLevelPtr[level];
+        local_int_t size = A.upperLevelPtr[level + 1] - first;
+
+        local_int_t begin = first + (local_int_t)((long long)size * tid / nthreads);
+        local_int_t end = first + (local_int_t)((long long)size * (tid + 1) / nthreads);
+
+        for(local_int_t k = begin; k < end; ++k)
+        {
+            local_int_t i = A.upperLevelRows[k];
+
+            WaitForRow(rowSweeps[i], forward);
+
+            for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+            {
+                local_int_t col = A.mtxIndL[i][j];
+
+                if(col > i && col < nrow)
+                {
+                    WaitForRow(rowSweeps[col], backward);
+                }
+            }
+
+            UpdateRow(A, rv, xv, i);
+
+            rowSweeps[i].store(backward, std::memory_order_release);
+        }
+    }
+}
+
+/*!
+  Computes one step of symmetric Gauss-Seidel in natural ordering, with the
+  rows of each level of the lower (forward sweep) and upper (backward sweep)
+  dependency graph updated in parallel.
+
+  Instead of a barrier after every level, each row publishes the number of
+  sweeps it has completed, and a thread only waits for the rows that the row
+  it is about to update depends on. Every thread processes its share of the
+  levels in increasing order, so the thread working on the lowest level never
+  waits. The backward sweep of a row starts as soon as its own forward sweep
+  and the backward sweeps of its upper neighbors are complete, without a
+  barrier between both sweeps.
+
+  Every row reads exactly the values the sequential sweep reads, thus the
+  result matches ComputeSYMGS_ref bitwise, as does the convergence of CG.
+
+  @param[in]    A the known system matrix, with level schedule
+  @param[in]    r the input vector
+  @param[inout] x On entry, x should contain relevant values, on exit x contains the result of one symmetric GS sweep with r as the RHS.
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSYMGS_ref
+  @see BuildLevelSchedule
+*/
+int ComputeSYMGS_level(const SparseMatrix& A, const Vector& r, Vector& x)
+{
+    assert(x.localLength == A.localNumberOfColumns);
+    assert(A.lowerLevelPtr != 0);
+
+#ifndef HPCG_NO_MPI
+    ExchangeHalo(A, x);
+#endif
+
+    // All rows have completed the same number of sweeps between two calls
+    int forward = A.rowSweeps[0].load(std::memory_order_relaxed) + 1;
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp parallel
+    {
+        ComputeSYMGS_level_thread(A, r, x, forward, omp_get_thread_num(), omp_get_num_threads());
+    }
+#else
+    ComputeSYMGS_level_thread(A, r, x, forward, 0, 1);
+#endif
+
+    return 0;
+}
@@ -22,6 +22,8 @@
 #include "ExchangeHalo.hpp"
 #endif
 #include "ComputeSYMGS_ref.hpp"
+#include "ComputeSYMGS_level.hpp"
+#include "Profiler.hpp"
 #include <cassert>
 
 /*!
@@ -55,6 +57,13 @@ int ComputeSYMGS_ref( const SparseMatrix & A, const Vector & r, Vector & x) {
 
   assert(x.localLength==A.localNumberOfColumns); // Make sure x contain space for halo values
 
+  // Forward and backward sweep, each reading the matrix and r and writing x
+  hipProfileScope_t scope(PROFILE_SYMGS_REF, A.level,
+      2.0*(A.localNumberOfNonzeros*(sizeof(double)+sizeof(local_int_t)) + 2.0*A.localNumberOfRows*sizeof(double)));
+
+  // Parallel sweeps in the same order, with identical results
+  if (A.lowerLevelPtr!=0) return ComputeSYMGS_level(A, r, x);
+
 #ifndef HPCG_NO_MPI
   ExchangeHalo(A,x);
 #endif
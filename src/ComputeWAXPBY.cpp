@@ -54,6 +54,8 @@
 #include <cassert>
 #include <hip/hip_runtime.h>
 
+#include "ReproducibleSum.hpp"
+#include "ComputeDotProduct.hpp"
 #include "ComputeWAXPBY.hpp"
 
 template <unsigned int BLOCKSIZE>
@@ -116,6 +118,8 @@ int ComputeWAXPBY(local_int_t n,
     assert(y.localLength >= n);
     assert(w.localLength >= n);
 
+    hipProfileScope_t scope(PROFILE_WAXPBY, 0, 3.0 * n * sizeof(double));
+
     dim3 blocks((n - 1) / 1024 + 1);
     dim3 threads(1024);
 
@@ -190,6 +194,39 @@ __global__ void kernel_fused_waxpby_dot_part2(double* workspace)
     }
 }
 
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_fused_waxpby_dot_repro_part1(local_int_t size,
+                                                    double alpha,
+                                                    const double* x,
+                                                    double* y,
+                                                    ReproducibleSum* workspace)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+    local_int_t inc = gridDim.x * blockDim.x;
+
+    ReproducibleAccumulator acc;
+    ReproducibleInitialize(acc);
+
+    for(local_int_t idx = gid; idx < size; idx += inc)
+    {
+        double val = fma(alpha, x[idx], y[idx]);
+
+        y[idx] = val;
+        ReproducibleDeposit(acc, val * val);
+    }
+
+    __shared__ ReproducibleSum sdata[BLOCKSIZE];
+    ReproducibleFinalize(acc, sdata[threadIdx.x]);
+
+    ReproducibleBlockReduce<BLOCKSIZE>(threadIdx.x, sdata);
+
+    if(threadIdx.x == 0)
+    {
+        workspace[blockIdx.x] = sdata[0];
+    }
+}
+
 int ComputeFusedWAXPBYDot(local_int_t n,
                           double alpha,
                           const Vector& x,
@@ -200,6 +237,21 @@ int ComputeFusedWAXPBYDot(local_int_t n,
     assert(x.localLength >= n);
     assert(y.localLength >= n);
 
+    bool repro = GetReproducibleDot();
+
+    hipProfileScope_t scope(repro ? PROFILE_FUSED_WAXPBY_DOT_REPRO : PROFILE_FUSED_WAXPBY_DOT,
+                            0,
+                            3.0 * n * sizeof(double));
+
+    if(repro)
+    {
+        kernel_fused_waxpby_dot_repro_part1<HPCG_REPRO_BLOCKSIZE>
+            <<<HPCG_REPRO_BLOCKS, HPCG_REPRO_BLOCKSIZE>>>(
+                n, alpha, x.d_values, y.d_values, reinterpret_cast<ReproducibleSum*>(workspace));
+
+        return ReduceReproducibleDot(result, time_allreduce);
+    }
+
     double* tmp = reinterpret_cast<double*>(workspace);
 
     kernel_fused_waxpby_dot_part1<256><<<256, 256>>>(n, alpha, x.d_values, y.d_values, tmp);
@@ -212,7 +264,9 @@ int ComputeFusedWAXPBYDot(local_int_t n,
     double t0 = mytimer();
     double global_result = 0.0;
 
+    profiler.Begin(PROFILE_ALLREDUCE, 0);
     MPI_Allreduce(&local_result, &global_result, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    profiler.End(0.0);
 
     result = global_result;
     time_allreduce += mytimer() - t0;
@@ -158,6 +158,11 @@ __global__ void kernel_gather(local_int_t size,
 
 void PrepareSendBuffer(const SparseMatrix& A, const Vector& x)
 {
+    // The copy on the halo stream is the last operation, the interior kernel
+    // on stream_interior must not wait for it
+    hipProfileScope_t scope(
+        PROFILE_HALO_PACK, A.level, 2.0 * A.totalToBeSent * sizeof(double), stream_halo);
+
     // Prepare send buffer
     dim3 blocks((A.totalToBeSent - 1) / 128 + 1);
     dim3 threads(128);
@@ -178,6 +183,8 @@ void PrepareSendBuffer(const SparseMatrix& A, const Vector& x)
 
 void ExchangeHaloAsync(const SparseMatrix& A)
 {
+    hipProfileScope_t scope(PROFILE_HALO_SEND, A.level, 2.0 * A.totalToBeSent * sizeof(double));
+
     int num_neighbors = A.numberOfSendNeighbors;
     int MPI_MY_TAG = 99;
 
@@ -226,8 +233,10 @@ void ObtainRecvBuffer(const SparseMatrix& A, Vector& x)
     int num_neighbors = A.numberOfSendNeighbors;
 
     // Synchronize boundary transfers
+    profiler.Begin(PROFILE_HALO_WAIT, A.level);
     EXIT_IF_HPCG_ERROR(MPI_Waitall(num_neighbors, A.recv_request, MPI_STATUSES_IGNORE));
     EXIT_IF_HPCG_ERROR(MPI_Waitall(num_neighbors, A.send_request, MPI_STATUSES_IGNORE));
+    profiler.End(0.0);
 
     // Update boundary values
     HIP_CHECK(hipMemcpyAsync(x.d_values + A.localNumberOfRows,
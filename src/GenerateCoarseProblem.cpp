@@ -162,8 +162,12 @@ void GenerateCoarseProblem(const SparseMatrix & Af) {
 
     GenerateGeometry(Af.geom->size, Af.geom->rank, Af.geom->numThreads, Af.geom->pz, zlc, zuc, nxc, nyc, nzc, Af.geom->npx, Af.geom->npy, Af.geom->npz, geomc);
 
+    // Coarse levels discretize the same problem
+    geomc->problem = Af.geom->problem;
+
     SparseMatrix* Ac = new SparseMatrix;
     InitializeSparseMatrix(*Ac, geomc);
+    Ac->level = Af.level + 1;
     GenerateProblem(*Ac, 0, 0, 0);
     SetupHalo(*Ac);
     Vector* rc = new Vector;
@@ -164,6 +164,8 @@ void GenerateGeometry(int size, int rank, int numThreads,
   geom->gix0 = gix0;
   geom->giy0 = giy0;
   geom->giz0 = giz0;
+  geom->problem = 0;
+  geom->rowBlockOffsets = 0;
 
   return;
 }
@@ -54,6 +54,7 @@
 
 #include "utils.hpp"
 #include "GenerateProblem.hpp"
+#include "ProblemCoefficients.hpp"
 
 #define LAUNCH_GENERATE_PROBLEM(blocksizex, blocksizey)                                  \
     {                                                                                    \
@@ -66,6 +67,7 @@
            nx, ny, nz, nx * ny,                                                          \
            gnx, gny, gnz, gnx * gny,                                                     \
            gix0, giy0, giz0,                                                             \
+           A.geom->problem,                                                              \
            numberOfNonzerosPerRow,                                                       \
            A.d_nonzerosInRow,                                                            \
            A.d_mtxIndG,                                                                  \
@@ -109,6 +111,7 @@ __global__ void kernel_generate_problem(local_int_t m,
                                         global_int_t gix0,
                                         global_int_t giy0,
                                         global_int_t giz0,
+                                        int problem,
                                         local_int_t numberOfNonzerosPerRow,
                                         char* __restrict__ nonzerosInRow,
                                         global_int_t* __restrict__ mtxIndG,
@@ -171,6 +174,11 @@ __global__ void kernel_generate_problem(local_int_t m,
     // Compute current global column for neighboring vertex
     global_int_t curcol = nb_giz * gnx_gny + nb_giy * gnx + nb_gix;
 
+    // Matrix value for the current neighboring offset
+    double value = (curcol == currentGlobalRow)
+                   ? ComputeDiagonal(problem, gix, giy, giz, gnx, gny, gnz)
+                   : -ComputeCoupling(problem, gix, giy, giz, nb_gix - gix, nb_giy - giy, nb_giz - giz, gnx, gny, gnz);
+
     // Check if current vertex is an interior or boundary vertex
     bool interior = (nb_giz > -1 && nb_giz < gnz &&
                      nb_giy > -1 && nb_giy < gny &&
@@ -225,16 +233,12 @@ __global__ void kernel_generate_problem(local_int_t m,
         {
             // Store diagonal entry index
             __builtin_nontemporal_store(threadIdx.x, matrixDiagonal + currentLocalRow);
-
-            // Diagonal matrix values are 26
-            __builtin_nontemporal_store(26.0, matrixValues + idx);
-        }
-        else
-        {
-            // Off-diagonal matrix values are -1
-            __builtin_nontemporal_store(-1.0, matrixValues + idx);
         }
 
+        // Store matrix value, for the reference problem 26 on the diagonal
+        // and -1 off-diagonal
+        __builtin_nontemporal_store(value, matrixValues + idx);
+
         // Store current global column
         __builtin_nontemporal_store(curcol, mtxIndG + idx);
 
@@ -260,16 +264,11 @@ __global__ void kernel_generate_problem(local_int_t m,
             {
                 // Store diagonal entry index
                 __builtin_nontemporal_store(offset, matrixDiagonal + currentLocalRow);
-
-                // Diagonal matrix values are 26
-                __builtin_nontemporal_store(26.0, matrixValues + idx);
-            }
-            else
-            {
-                // Off-diagonal matrix values are -1
-                __builtin_nontemporal_store(-1.0, matrixValues + idx);
             }
 
+            // Store matrix value
+            __builtin_nontemporal_store(value, matrixValues + idx);
+
             // Store current global column
             __builtin_nontemporal_store(curcol, mtxIndG + idx);
         }
@@ -297,7 +296,12 @@ __global__ void kernel_generate_problem(local_int_t m,
 
         if(b != NULL)
         {
-            __builtin_nontemporal_store(26.0 - (numberOfNonzerosInRow - 1.0), b + currentLocalRow);
+            // Row sum, such that the exact solution is one
+            double rhs = (problem == HPCG_PROBLEM_LAPLACE)
+                         ? 26.0 - (numberOfNonzerosInRow - 1.0)
+                         : ComputeRowSum(problem, gix, giy, giz, gnx, gny, gnz);
+
+            __builtin_nontemporal_store(rhs, b + currentLocalRow);
         }
     }
 }
@@ -500,9 +504,9 @@ void CopyProblemToHost(SparseMatrix& A, Vector* b, Vector* x, Vector* xexact)
     A.localToGlobalMap.resize(A.localNumberOfRows);
 
     // Now allocate the arrays pointed to
-    A.mtxIndL[0] = new local_int_t[A.localNumberOfRows * A.numberOfNonzerosPerRow];
-    A.matrixValues[0] = new double[A.localNumberOfRows * A.numberOfNonzerosPerRow];
-    A.mtxIndG[0] = new global_int_t[A.localNumberOfRows * A.numberOfNonzerosPerRow];
+    A.mtxIndL[0] = (local_int_t*)hostMalloc(sizeof(local_int_t) * A.localNumberOfRows * A.numberOfNonzerosPerRow);
+    A.matrixValues[0] = (double*)hostMalloc(sizeof(double) * A.localNumberOfRows * A.numberOfNonzerosPerRow);
+    A.mtxIndG[0] = (global_int_t*)hostMalloc(sizeof(global_int_t) * A.localNumberOfRows * A.numberOfNonzerosPerRow);
 
     // Copy GPU data to host
     HIP_CHECK(hipMemcpy(A.nonzerosInRow, A.d_nonzerosInRow, sizeof(char) * A.localNumberOfRows, hipMemcpyDeviceToHost));
@@ -34,6 +34,7 @@ using std::endl;
 #include <cassert>
 
 #include "GenerateProblem_ref.hpp"
+#include "ProblemCoefficients.hpp"
 
 
 /*!
@@ -112,9 +113,9 @@ void GenerateProblem_ref(SparseMatrix & A, Vector * b, Vector * x, Vector * xexa
 
 #else
   // Now allocate the arrays pointed to
-  mtxIndL[0] = new local_int_t[localNumberOfRows * numberOfNonzerosPerRow];
-  matrixValues[0] = new double[localNumberOfRows * numberOfNonzerosPerRow];
-  mtxIndG[0] = new global_int_t[localNumberOfRows * numberOfNonzerosPerRow];
+  mtxIndL[0] = (local_int_t*)hostMalloc(sizeof(local_int_t) * localNumberOfRows * numberOfNonzerosPerRow);
+  matrixValues[0] = (double*)hostMalloc(sizeof(double) * localNumberOfRows * numberOfNonzerosPerRow);
+  mtxIndG[0] = (global_int_t*)hostMalloc(sizeof(global_int_t) * localNumberOfRows * numberOfNonzerosPerRow);
 
   for (local_int_t i=1; i< localNumberOfRows; ++i) {
   mtxIndL[i] = mtxIndL[0] + i * numberOfNonzerosPerRow;
@@ -158,9 +159,9 @@ void GenerateProblem_ref(SparseMatrix & A, Vector * b, Vector * x, Vector * xexa
                     global_int_t curcol = currentGlobalRow+sz*gnx*gny+sy*gnx+sx;
                     if (curcol==currentGlobalRow) {
                       matrixDiagonal[currentLocalRow] = currentValuePointer;
-                      *currentValuePointer++ = 26.0;
+                      *currentValuePointer++ = ComputeDiagonal(A.geom->problem, gix, giy, giz, gnx, gny, gnz);
                     } else {
-                      *currentValuePointer++ = -1.0;
+                      *currentValuePointer++ = -ComputeCoupling(A.geom->problem, gix, giy, giz, sx, sy, sz, gnx, gny, gnz);
                     }
                     *currentIndexPointerG++ = curcol;
                     numberOfNonzerosInRow++;
@@ -175,7 +176,7 @@ void GenerateProblem_ref(SparseMatrix & A, Vector * b, Vector * x, Vector * xexa
         #pragma omp critical
 #endif
         localNumberOfNonzeros += numberOfNonzerosInRow; // Protect this with an atomic
-        if (b!=0)      bv[currentLocalRow] = 26.0 - ((double) (numberOfNonzerosInRow-1));
+        if (b!=0)      bv[currentLocalRow] = ComputeRowSum(A.geom->problem, gix, giy, giz, gnx, gny, gnz);
         if (x!=0)      xv[currentLocalRow] = 0.0;
         if (xexact!=0) xexactv[currentLocalRow] = 1.0;
       } // end ix loop
@@ -67,6 +67,8 @@ struct Geometry_STRUCT {
   global_int_t gix0;  //!< Base global x index for this rank in the npx by npy by npz processor grid
   global_int_t giy0;  //!< Base global y index for this rank in the npx by npy by npz processor grid
   global_int_t giz0;  //!< Base global z index for this rank in the npx by npy by npz processor grid
+  int problem; //!< Type of the generated problem, see ProblemType
+  global_int_t * rowBlockOffsets; //!< For imported matrices, array of length size+1 containing the first global row of each rank, 0 otherwise
 
 };
 typedef struct Geometry_STRUCT Geometry;
@@ -81,6 +83,16 @@ typedef struct Geometry_STRUCT Geometry;
   @return Returns the MPI rank of the process assigned the row
 */
 inline int ComputeRankOfMatrixRow(const Geometry & geom, global_int_t index) {
+  // Imported matrices are distributed in contiguous blocks of rows
+  if (geom.rowBlockOffsets) {
+    int lo = 0, hi = geom.size;
+    while (hi - lo > 1) {
+      int mid = (lo + hi)/2;
+      if (geom.rowBlockOffsets[mid] <= index) lo = mid; else hi = mid;
+    }
+    return lo;
+  }
+
   global_int_t gnx = geom.gnx;
   global_int_t gny = geom.gny;
 
@@ -125,6 +137,7 @@ inline void DeleteGeometry(Geometry & geom) {
 
   delete [] geom.partz_nz;
   delete [] geom.partz_ids;
+  if (geom.rowBlockOffsets) delete [] geom.rowBlockOffsets;
 
   return;
 }
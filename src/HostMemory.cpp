@@ -0,0 +1,346 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file HostMemory.cpp
+
+ Page size policy of the large host arrays
+ */
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "HostMemory.hpp"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#define HUGE_PAGE_2M (2UL << 20)
+#define HUGE_PAGE_1G (1UL << 30)
+
+struct HostArray
+{
+    size_t size;   // requested size
+    size_t length; // size of the mapping
+    int kind;      // page size granted, see HostPagePolicy
+    bool fallback; // smaller pages than requested
+};
+
+static int host_page_policy = HPCG_PAGES_DEFAULT;
+
+// Large arrays by address
+static std::map<uintptr_t, HostArray> host_arrays;
+static std::mutex host_arrays_mutex;
+
+static inline size_t RoundUp(size_t size, size_t page)
+{
+    return (size + page - 1) / page * page;
+}
+
+#ifdef __linux__
+// Explicit huge pages, fails if the pool has not enough free pages left
+static void* MapHugeTLB(size_t length, int page_shift)
+{
+    void* ptr = mmap(NULL,
+                     length,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (page_shift << MAP_HUGE_SHIFT),
+                     -1,
+                     0);
+
+    return (ptr == MAP_FAILED) ? NULL : ptr;
+}
+
+// Anonymous mapping aligned to 2 MB, such that all of it can be backed by
+// transparent huge pages
+static void* MapTHP(size_t length)
+{
+    size_t padded = length + HUGE_PAGE_2M;
+
+    char* base = (char*)mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(base == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    char* start = (char*)RoundUp((uintptr_t)base, HUGE_PAGE_2M);
+
+    // Release the unaligned head and the remaining tail
+    if(start > base)
+    {
+        munmap(base, start - base);
+    }
+
+    munmap(start + length, (base + padded) - (start + length));
+
+    madvise(start, length, MADV_HUGEPAGE);
+
+    return start;
+}
+
+// Bytes of the mappings overlapping the given ranges that are backed by
+// transparent huge pages. Neighboring mappings of equal flags are merged by
+// the kernel, thus huge pages are counted per merged mapping.
+static size_t AnonHugePageBytes(const std::vector<std::pair<uintptr_t, uintptr_t>>& ranges)
+{
+    FILE* file = fopen("/proc/self/smaps", "r");
+
+    if(file == NULL)
+    {
+        return 0;
+    }
+
+    char line[512];
+    bool overlaps = false;
+    size_t bytes = 0;
+
+    while(fgets(line, sizeof(line), file))
+    {
+        unsigned long start;
+        unsigned long end;
+        size_t kb;
+
+        if(sscanf(line, "%lx-%lx", &start, &end) == 2)
+        {
+            overlaps = false;
+
+            for(size_t i = 0; i < ranges.size(); ++i)
+            {
+                overlaps |= (ranges[i].first < end && start < ranges[i].second);
+            }
+        }
+        else if(overlaps && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1)
+        {
+            bytes += kb << 10;
+        }
+    }
+
+    fclose(file);
+
+    return bytes;
+}
+#endif // __linux__
+
+/*!
+  Sets the page size policy of host arrays allocated from now on.
+
+  @param[in] policy The policy, see HostPagePolicy
+*/
+void SetHostPagePolicy(int policy)
+{
+    host_page_policy = policy;
+}
+
+int GetHostPagePolicy(void)
+{
+    return host_page_policy;
+}
+
+const char* HostPagePolicyName(int policy)
+{
+    switch(policy)
+    {
+        case HPCG_PAGES_DEFAULT: return "default";
+        case HPCG_PAGES_THP:     return "thp";
+        case HPCG_PAGES_2M:      return "2m";
+        case HPCG_PAGES_1G:      return "1g";
+    }
+
+    return "unknown";
+}
+
+/*!
+  Allocates a host array. Arrays of at least HPCG_LARGE_HOST_ARRAY bytes are
+  mapped with the page size of the current policy if possible, falling back to
+  smaller pages otherwise. Smaller arrays are taken from the heap.
+
+  @param[in] size The size in bytes
+
+  @return The array, throws std::bad_alloc like new[] if out of memory.
+*/
+void* hostMalloc(size_t size)
+{
+    if(size < HPCG_LARGE_HOST_ARRAY)
+    {
+        void* ptr = malloc(size);
+
+        if(ptr == NULL)
+        {
+            throw std::bad_alloc();
+        }
+
+        return ptr;
+    }
+
+    int policy = host_page_policy;
+
+    // 1 GB pages are not worth rounding up smaller arrays
+    int expected = (policy == HPCG_PAGES_1G && size < HUGE_PAGE_1G) ? HPCG_PAGES_2M : policy;
+
+    HostArray array;
+    array.size = size;
+
+    void* ptr = NULL;
+
+#ifdef __linux__
+    if(policy == HPCG_PAGES_1G && size >= HUGE_PAGE_1G)
+    {
+        array.length = RoundUp(size, HUGE_PAGE_1G);
+        array.kind = HPCG_PAGES_1G;
+        ptr = MapHugeTLB(array.length, 30);
+    }
+
+    if(ptr == NULL && policy >= HPCG_PAGES_2M)
+    {
+        array.length = RoundUp(size, HUGE_PAGE_2M);
+        array.kind = HPCG_PAGES_2M;
+        ptr = MapHugeTLB(array.length, 21);
+    }
+
+    if(ptr == NULL && policy >= HPCG_PAGES_THP)
+    {
+        array.length = RoundUp(size, HUGE_PAGE_2M);
+        array.kind = HPCG_PAGES_THP;
+        ptr = MapTHP(array.length);
+    }
+#endif
+
+    if(ptr == NULL)
+    {
+        array.length = size;
+        array.kind = HPCG_PAGES_DEFAULT;
+        ptr = malloc(size);
+
+        if(ptr == NULL)
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    array.fallback = (array.kind != expected);
+
+    std::lock_guard<std::mutex> lock(host_arrays_mutex);
+
+    host_arrays[(uintptr_t)ptr] = array;
+
+    return ptr;
+}
+
+/*!
+  Deallocates a host array allocated with hostMalloc.
+
+  @param[in] ptr The array, may be NULL
+*/
+void hostFree(void* ptr)
+{
+    if(ptr == NULL)
+    {
+        return;
+    }
+
+    HostArray array;
+    array.kind = HPCG_PAGES_DEFAULT;
+
+    {
+        std::lock_guard<std::mutex> lock(host_arrays_mutex);
+
+        std::map<uintptr_t, HostArray>::iterator it = host_arrays.find((uintptr_t)ptr);
+
+        if(it != host_arrays.end())
+        {
+            array = it->second;
+            host_arrays.erase(it);
+        }
+    }
+
+#ifdef __linux__
+    if(array.kind != HPCG_PAGES_DEFAULT)
+    {
+        munmap(ptr, array.length);
+        return;
+    }
+#endif
+
+    free(ptr);
+}
+
+/*!
+  Summarizes the page sizes of the live large host arrays. Transparent huge
+  pages are only advised, the bytes actually backed by huge pages are read
+  from /proc/self/smaps.
+
+  @param[out] stats The summary
+*/
+void GetHostMemoryStats(HostMemoryStats& stats)
+{
+    std::vector<std::pair<uintptr_t, uintptr_t>> thp_ranges;
+
+    stats.policy = host_page_policy;
+    stats.thp_bytes = 0;
+    stats.fallbacks = 0;
+
+    for(int i = 0; i < HPCG_PAGES_NUMBER_OF_POLICIES; ++i)
+    {
+        stats.bytes[i] = 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(host_arrays_mutex);
+
+        for(std::map<uintptr_t, HostArray>::const_iterator it = host_arrays.begin(); it != host_arrays.end(); ++it)
+        {
+            stats.bytes[it->second.kind] += it->second.size;
+            stats.fallbacks += it->second.fallback;
+
+            if(it->second.kind == HPCG_PAGES_THP)
+            {
+                thp_ranges.push_back(std::make_pair(it->first, it->first + it->second.length));
+            }
+        }
+    }
+
+#ifdef __linux__
+    if(!thp_ranges.empty())
+    {
+        stats.thp_bytes = std::min(AnonHugePageBytes(thp_ranges), stats.bytes[HPCG_PAGES_THP]);
+    }
+#endif
+}
@@ -0,0 +1,73 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file HostMemory.hpp
+
+ Page size policy of the large host arrays
+ */
+
+#ifndef HOSTMEMORY_HPP
+#define HOSTMEMORY_HPP
+
+#include <cstddef>
+
+/*!
+  Page size of host arrays of at least HPCG_LARGE_HOST_ARRAY bytes. Each policy
+  falls back to the next smaller page size if the pages cannot be obtained.
+ */
+enum HostPagePolicy
+{
+    HPCG_PAGES_DEFAULT = 0, //!< heap allocation, page size left to the system
+    HPCG_PAGES_THP,         //!< anonymous mapping advised for transparent huge pages
+    HPCG_PAGES_2M,          //!< 2 MB pages from the hugetlbfs pool
+    HPCG_PAGES_1G,          //!< 1 GB pages from the hugetlbfs pool, for arrays of at least 1 GB
+    HPCG_PAGES_NUMBER_OF_POLICIES
+};
+
+#define HPCG_LARGE_HOST_ARRAY (2UL << 20)
+
+struct HostMemoryStats_STRUCT
+{
+    int policy;                                  //!< requested policy
+    size_t bytes[HPCG_PAGES_NUMBER_OF_POLICIES]; //!< bytes of the live large arrays by the page size they got
+    size_t thp_bytes;                            //!< bytes of the THP advised arrays backed by huge pages
+    int fallbacks;                               //!< live large arrays that did not get the requested page size
+};
+typedef struct HostMemoryStats_STRUCT HostMemoryStats;
+
+void SetHostPagePolicy(int policy);
+int GetHostPagePolicy(void);
+const char* HostPagePolicyName(int policy);
+
+void* hostMalloc(size_t size);
+void hostFree(void* ptr);
+
+void GetHostMemoryStats(HostMemoryStats& stats);
+
+#endif // HOSTMEMORY_HPP
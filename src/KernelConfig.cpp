@@ -0,0 +1,230 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file KernelConfig.cpp
+
+ Launch configurations of the device kernels
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "KernelConfig.hpp"
+#include "OutputFile.hpp"
+
+hipKernelConfig_t::hipKernelConfig_t(void)
+{
+    this->Reset();
+}
+
+void hipKernelConfig_t::Reset(void)
+{
+    this->dot1_ = 1024;
+    this->dot2_ = 256;
+
+    for(int i = 0; i < KERNEL_CONFIG_MAX_LEVELS; ++i)
+    {
+        this->spmv_[i] = KERNEL_CONFIG_DEFAULT_BLOCKSIZE;
+        this->symgs_[i] = KERNEL_CONFIG_DEFAULT_BLOCKSIZE;
+    }
+
+    this->nlevels_ = 0;
+    this->source_ = "default";
+}
+
+void hipKernelConfig_t::SetSpMVBlocksize(int level, int bs)
+{
+    if(level < KERNEL_CONFIG_MAX_LEVELS)
+    {
+        this->spmv_[level] = bs;
+        this->nlevels_ = std::max(this->nlevels_, level + 1);
+    }
+}
+
+void hipKernelConfig_t::SetSYMGSBlocksize(int level, int bs)
+{
+    if(level < KERNEL_CONFIG_MAX_LEVELS)
+    {
+        this->symgs_[level] = bs;
+        this->nlevels_ = std::max(this->nlevels_, level + 1);
+    }
+}
+
+std::string hipKernelConfig_t::ToString(void) const
+{
+    std::ostringstream str;
+
+    str << "dot1=" << this->dot1_ << " dot2=" << this->dot2_ << " spmv=";
+
+    for(int i = 0; i < this->nlevels_; ++i)
+    {
+        str << (i > 0 ? "," : "") << this->spmv_[i];
+    }
+
+    str << " symgs=";
+
+    for(int i = 0; i < this->nlevels_; ++i)
+    {
+        str << (i > 0 ? "," : "") << this->symgs_[i];
+    }
+
+    return str.str();
+}
+
+// Parses a comma separated list of block sizes
+static int ParseBlocksizes(const std::string& list, int* bs)
+{
+    std::istringstream str(list);
+    std::string item;
+    int n = 0;
+
+    while(std::getline(str, item, ',') && n < KERNEL_CONFIG_MAX_LEVELS)
+    {
+        bs[n++] = atoi(item.c_str());
+    }
+
+    return n;
+}
+
+// Valid block sizes are those that can be dispatched
+static bool IsValidBlocksize(int bs)
+{
+    return bs == 128 || bs == 256 || bs == 512 || bs == 1024;
+}
+
+bool hipKernelConfig_t::FromString(const std::string& str)
+{
+    hipKernelConfig_t config;
+
+    std::istringstream tokens(str);
+    std::string token;
+
+    int nspmv = 0;
+    int nsymgs = 0;
+
+    while(tokens >> token)
+    {
+        size_t pos = token.find('=');
+
+        if(pos == std::string::npos)
+        {
+            return false;
+        }
+
+        std::string name = token.substr(0, pos);
+        std::string value = token.substr(pos + 1);
+
+        if(name == "dot1") config.dot1_ = atoi(value.c_str());
+        else if(name == "dot2") config.dot2_ = atoi(value.c_str());
+        else if(name == "spmv") nspmv = ParseBlocksizes(value, config.spmv_);
+        else if(name == "symgs") nsymgs = ParseBlocksizes(value, config.symgs_);
+        else return false;
+    }
+
+    if(!IsValidBlocksize(config.dot1_) || !IsValidBlocksize(config.dot2_) || nspmv != nsymgs)
+    {
+        return false;
+    }
+
+    for(int i = 0; i < nspmv; ++i)
+    {
+        if(!IsValidBlocksize(config.spmv_[i]) || !IsValidBlocksize(config.symgs_[i]))
+        {
+            return false;
+        }
+    }
+
+    config.nlevels_ = nspmv;
+    config.source_ = this->source_;
+
+    *this = config;
+
+    return true;
+}
+
+bool hipKernelConfig_t::Load(const char* filename, const std::string& key)
+{
+    std::ifstream file(filename);
+
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    // Entries are "<key> <configuration>", later entries replace earlier ones
+    std::string line;
+    std::string entry;
+    bool found = false;
+
+    while(std::getline(file, line))
+    {
+        if(line.compare(0, key.size() + 1, key + " ") == 0)
+        {
+            entry = line.substr(key.size() + 1);
+            found = true;
+        }
+    }
+
+    return found && this->FromString(entry);
+}
+
+bool hipKernelConfig_t::Store(const char* filename, const std::string& key) const
+{
+    std::ofstream file(filename, std::ios::app);
+
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    file << key << " " << this->ToString() << std::endl;
+
+    return file.good();
+}
+
+void hipKernelConfig_t::Report(OutputFile& doc) const
+{
+    doc.add("Kernel Configuration", "");
+    doc.get("Kernel Configuration")->add("Source", this->source_);
+    doc.get("Kernel Configuration")->add("DDOT block size (x)", this->dot1_);
+    doc.get("Kernel Configuration")->add("DDOT block size (x,y)", this->dot2_);
+
+    for(int i = 0; i < this->nlevels_; ++i)
+    {
+        char level[32];
+        sprintf(level, "Level %d", i);
+
+        doc.get("Kernel Configuration")->add(level, "");
+        doc.get("Kernel Configuration")->get(level)->add("SpMV block size", this->spmv_[i]);
+        doc.get("Kernel Configuration")->get(level)->add("SYMGS block size", this->symgs_[i]);
+    }
+}
@@ -0,0 +1,117 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file KernelConfig.hpp
+
+ Launch configurations of the device kernels
+ */
+
+#ifndef KERNELCONFIG_HPP
+#define KERNELCONFIG_HPP
+
+#include <string>
+
+class OutputFile;
+
+//! Number of multigrid levels with individual launch configurations
+#define KERNEL_CONFIG_MAX_LEVELS 8
+
+//! Default block size of the SpMV and SYMGS kernels
+#define KERNEL_CONFIG_DEFAULT_BLOCKSIZE 1024
+
+// Instantiate a launch macro for the block size bs, one of 128, 256, 512 or 1024
+#define DISPATCH_BLOCKSIZE(bs, LAUNCH, width) \
+    switch(bs)                                \
+    {                                         \
+        case 128: LAUNCH(128, width); break;  \
+        case 256: LAUNCH(256, width); break;  \
+        case 512: LAUNCH(512, width); break;  \
+        default: LAUNCH(1024, width); break;  \
+    }
+
+/*!
+  Block sizes of the kernels whose launch configuration is tuned. The dot
+  product kernels use a grid of as many blocks as threads per block. The
+  configuration can be serialized to a single line of text, which is stored in
+  the tuning database.
+ */
+class hipKernelConfig_t
+{
+    public:
+
+    hipKernelConfig_t(void);
+
+    // Restores the default configuration
+    void Reset(void);
+
+    inline int GetDot1Blocksize(void) const { return this->dot1_; }
+    inline int GetDot2Blocksize(void) const { return this->dot2_; }
+    inline int GetSpMVBlocksize(int level) const
+    {
+        return level < KERNEL_CONFIG_MAX_LEVELS ? this->spmv_[level] : KERNEL_CONFIG_DEFAULT_BLOCKSIZE;
+    }
+    inline int GetSYMGSBlocksize(int level) const
+    {
+        return level < KERNEL_CONFIG_MAX_LEVELS ? this->symgs_[level] : KERNEL_CONFIG_DEFAULT_BLOCKSIZE;
+    }
+
+    inline void SetDot1Blocksize(int bs) { this->dot1_ = bs; }
+    inline void SetDot2Blocksize(int bs) { this->dot2_ = bs; }
+    void SetSpMVBlocksize(int level, int bs);
+    void SetSYMGSBlocksize(int level, int bs);
+
+    // Origin of the configuration, "default", "database" or "tuned"
+    inline const std::string& GetSource(void) const { return this->source_; }
+    inline void SetSource(const std::string& source) { this->source_ = source; }
+
+    // Serialization, e.g. "dot1=1024 dot2=256 spmv=1024,512 symgs=1024,256"
+    std::string ToString(void) const;
+    bool FromString(const std::string& str);
+
+    // Looks up the last entry of key in the database file
+    bool Load(const char* filename, const std::string& key);
+
+    // Appends an entry for key to the database file
+    bool Store(const char* filename, const std::string& key) const;
+
+    // Adds the configuration to a YAML document
+    void Report(OutputFile& doc) const;
+
+    private:
+
+    int dot1_;
+    int dot2_;
+    int spmv_[KERNEL_CONFIG_MAX_LEVELS];
+    int symgs_[KERNEL_CONFIG_MAX_LEVELS];
+    int nlevels_;
+
+    std::string source_;
+};
+
+#endif // KERNELCONFIG_HPP
@@ -0,0 +1,171 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file LevelSchedule.cpp
+
+ Level schedule of the host symmetric Gauss-Seidel smoother
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "LevelSchedule.hpp"
+
+// Sorts the rows by level, rows of a level keep the order of the sweep
+static void SortRowsByLevel(const std::vector<local_int_t>& level,
+                            local_int_t nlevels,
+                            bool reverse,
+                            local_int_t* ptr,
+                            local_int_t* rows)
+{
+    local_int_t nrow = level.size();
+
+    std::fill(ptr, ptr + nlevels + 1, 0);
+
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        ++ptr[level[i] + 1];
+    }
+
+    for(local_int_t l = 0; l < nlevels; ++l)
+    {
+        ptr[l + 1] += ptr[l];
+    }
+
+    std::vector<local_int_t> pos(ptr, ptr + nlevels);
+
+    for(local_int_t k = 0; k < nrow; ++k)
+    {
+        local_int_t i = reverse ? nrow - 1 - k : k;
+        rows[pos[level[i]]++] = i;
+    }
+}
+
+/*!
+  Computes the levels of the lower and upper triangular dependency graph of
+  the natural ordering. A row of lower level l depends on lower neighbors of
+  levels < l only, thus all rows of a level can be updated in parallel in
+  the forward sweep; the upper levels are used for the backward sweep. Halo
+  columns do not impose dependencies.
+
+  @param[inout] A the known system matrix, the level schedule is attached on exit
+
+  @return returns 0 upon success and non-zero otherwise
+
+  @see ComputeSYMGS_level
+*/
+int BuildLevelSchedule(SparseMatrix& A)
+{
+    local_int_t nrow = A.localNumberOfRows;
+
+    std::vector<local_int_t> level(nrow);
+
+    // Lower triangular levels, in forward order
+    local_int_t nlower = 0;
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        local_int_t l = 0;
+
+        for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+        {
+            local_int_t col = A.mtxIndL[i][j];
+
+            if(col < i)
+            {
+                l = std::max(l, level[col] + 1);
+            }
+        }
+
+        level[i] = l;
+        nlower = std::max(nlower, l + 1);
+    }
+
+    A.numberOfLowerLevels = nlower;
+    A.lowerLevelPtr = new local_int_t[nlower + 1];
+    A.lowerLevelRows = new local_int_t[nrow];
+
+    SortRowsByLevel(level, nlower, false, A.lowerLevelPtr, A.lowerLevelRows);
+
+    // Upper triangular levels, in backward order
+    local_int_t nupper = 0;
+    for(local_int_t i = nrow - 1; i >= 0; --i)
+    {
+        local_int_t l = 0;
+
+        for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+        {
+            local_int_t col = A.mtxIndL[i][j];
+
+            if(col > i && col < nrow)
+            {
+                l = std::max(l, level[col] + 1);
+            }
+        }
+
+        level[i] = l;
+        nupper = std::max(nupper, l + 1);
+    }
+
+    A.numberOfUpperLevels = nupper;
+    A.upperLevelPtr = new local_int_t[nupper + 1];
+    A.upperLevelRows = new local_int_t[nrow];
+
+    SortRowsByLevel(level, nupper, true, A.upperLevelPtr, A.upperLevelRows);
+
+    A.rowSweeps = new std::atomic<int>[nrow];
+
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        A.rowSweeps[i].store(0, std::memory_order_relaxed);
+    }
+
+    return 0;
+}
+
+/*!
+  Releases the level schedule of a matrix, if any.
+
+  @param[inout] A the matrix
+*/
+void DeleteLevelSchedule(SparseMatrix& A)
+{
+    delete[] A.lowerLevelPtr;
+    delete[] A.lowerLevelRows;
+    delete[] A.upperLevelPtr;
+    delete[] A.upperLevelRows;
+    delete[] A.rowSweeps;
+
+    A.numberOfLowerLevels = 0;
+    A.numberOfUpperLevels = 0;
+    A.lowerLevelPtr = 0;
+    A.lowerLevelRows = 0;
+    A.upperLevelPtr = 0;
+    A.upperLevelRows = 0;
+    A.rowSweeps = 0;
+}
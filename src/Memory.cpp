@@ -111,6 +111,68 @@ hipError_t hipAllocator_t::Clear(void)
     return hipSuccess;
 }
 
+/*!
+  Marks all current allocations as persistent, such that they are kept by
+  Reset().
+*/
+void hipAllocator_t::Checkpoint(void)
+{
+    this->persistent_.clear();
+
+    for(std::list<hipMemObject_t*>::iterator it = this->objects_.begin(); it != this->objects_.end(); ++it)
+    {
+        this->persistent_.push_back((*it)->address);
+    }
+}
+
+/*!
+  Releases all allocations that have been made since the last Checkpoint() and
+  clears the free memory, leaving the buffer in the state of a fresh
+  Initialize() without reallocating it. Used to run several problems in a
+  single process.
+*/
+hipError_t hipAllocator_t::Reset(void)
+{
+    std::list<hipMemObject_t*>::iterator it = this->objects_.begin();
+
+    while(it != this->objects_.end())
+    {
+        if(std::find(this->persistent_.begin(), this->persistent_.end(), (*it)->address)
+           == this->persistent_.end())
+        {
+            this->free_mem_ += (*it)->size;
+            this->used_mem_ -= (*it)->size;
+
+            delete *it;
+            it = this->objects_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Clear the gaps between the remaining objects
+    char* begin = this->buffer_;
+
+    for(it = this->objects_.begin(); it != this->objects_.end(); ++it)
+    {
+        if((*it)->address > begin)
+        {
+            RETURN_IF_HIP_ERROR(hipMemset(begin, 0, (*it)->address - begin));
+        }
+
+        begin = (*it)->address + (*it)->size;
+    }
+
+    if(this->buffer_ + this->total_mem_ > begin)
+    {
+        RETURN_IF_HIP_ERROR(hipMemset(begin, 0, this->buffer_ + this->total_mem_ - begin));
+    }
+
+    return hipSuccess;
+}
+
 hipError_t hipAllocator_t::Alloc(void** ptr, size_t size)
 {
     // Align by 2MB
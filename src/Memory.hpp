@@ -38,6 +38,7 @@
 #include <cstdlib>
 #include <list>
 #include <string>
+#include <vector>
 #include <hip/hip_runtime_api.h>
 
 #include "Geometry.hpp"
@@ -62,6 +63,9 @@ class hipAllocator_t
                           local_int_t nz);
     hipError_t Clear(void);
 
+    void Checkpoint(void);
+    hipError_t Reset(void);
+
     hipError_t Alloc(void** ptr, size_t size);
     hipError_t Realloc(void* ptr, size_t size);
     hipError_t Free(void* ptr);
@@ -95,6 +99,9 @@ class hipAllocator_t
 
     // List to keep track of allocations
     std::list<hipMemObject_t*> objects_;
+
+    // Allocations that are kept by Reset()
+    std::vector<char*> persistent_;
 };
 
 hipError_t deviceMalloc(void** ptr, size_t size);
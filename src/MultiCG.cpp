@@ -0,0 +1,177 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file MultiCG.cpp
+
+ CG solve of multiple right hand sides
+ */
+
+#include <cmath>
+
+#include "MultiCG.hpp"
+
+/*!
+  Routine to compute approximate solutions to AX = B for a block of right hand
+  sides with the preconditioned CG method.
+
+  Every right hand side is iterated independently, with its own step lengths,
+  but the SpMV, multigrid and vector kernels as well as the global reductions
+  process all right hand sides at once. Iterations stop after max_iter steps or
+  once all right hand sides have met the tolerance.
+
+  @param[in]    A              The known system matrix
+  @param[inout] data           The preallocated block vectors of the solve
+  @param[in]    B              The known block of right hand sides
+  @param[inout] X              On entry: the initial guesses; on exit: the new approximate solutions
+  @param[in]    max_iter       The maximum number of iterations to perform, even if tolerance is not met.
+  @param[in]    tolerance      The stopping criterion to assert convergence of each right hand side
+  @param[out]   niters         The number of iterations actually performed.
+  @param[out]   normr          The 2-norms of the residuals after the last iteration, one per right hand side.
+  @param[out]   normr0         The 2-norms of the residuals before the first iteration, one per right hand side.
+  @param[inout] time_allreduce The accumulated time spent in global reductions
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see CG()
+*/
+int MultiCG(const SparseMatrix& A,
+            MultiRHSData& data,
+            const MultiVector& B,
+            MultiVector& X,
+            const int max_iter,
+            const double tolerance,
+            int& niters,
+            double* normr,
+            double* normr0,
+            double& time_allreduce)
+{
+    int nrhs = X.numberOfVectors;
+    local_int_t nrow = A.localNumberOfRows;
+
+    assert(nrhs <= MAX_MULTI_RHS);
+    assert(data.numberOfVectors == nrhs);
+
+    double rtz[MAX_MULTI_RHS];
+    double oldrtz[MAX_MULTI_RHS];
+    double pAp[MAX_MULTI_RHS];
+    double alpha[MAX_MULTI_RHS];
+    double beta[MAX_MULTI_RHS];
+    double minus_alpha[MAX_MULTI_RHS];
+    double one[MAX_MULTI_RHS];
+    double zero[MAX_MULTI_RHS];
+    double minus_one[MAX_MULTI_RHS];
+
+    for(int j = 0; j < nrhs; ++j)
+    {
+        one[j] = 1.0;
+        zero[j] = 0.0;
+        minus_one[j] = -1.0;
+    }
+
+    MultiVector& r = data.r;
+    MultiVector& z = data.z;
+    MultiVector& p = data.p;
+    MultiVector& Ap = data.Ap;
+
+    niters = 0;
+
+    // p is of length ncols, copy X to p for the sparse block product
+    HIPCopyMultiVector(X, p);
+    RETURN_IF_HPCG_ERROR(ComputeSPMM(A, data, p, Ap));
+    RETURN_IF_HPCG_ERROR(ComputeMultiWAXPBY(nrow, one, B, minus_one, Ap, r));
+    RETURN_IF_HPCG_ERROR(ComputeMultiDotProduct(nrow, data, r, r, normr, time_allreduce));
+
+    for(int j = 0; j < nrhs; ++j)
+    {
+        normr[j] = sqrt(normr[j]);
+        normr0[j] = normr[j];
+    }
+
+    for(int k = 1; k <= max_iter; ++k)
+    {
+        // Stop once every right hand side has converged
+        bool converged = true;
+
+        for(int j = 0; j < nrhs; ++j)
+        {
+            converged = converged && normr[j] / normr0[j] <= tolerance;
+        }
+
+        if(converged)
+        {
+            break;
+        }
+
+        RETURN_IF_HPCG_ERROR(ComputeMultiMG(A, data, r, z));
+
+        if(k == 1)
+        {
+            RETURN_IF_HPCG_ERROR(ComputeMultiWAXPBY(nrow, one, z, zero, z, p));
+            RETURN_IF_HPCG_ERROR(ComputeMultiDotProduct(nrow, data, r, z, rtz, time_allreduce));
+        }
+        else
+        {
+            for(int j = 0; j < nrhs; ++j)
+            {
+                oldrtz[j] = rtz[j];
+            }
+
+            RETURN_IF_HPCG_ERROR(ComputeMultiDotProduct(nrow, data, r, z, rtz, time_allreduce));
+
+            for(int j = 0; j < nrhs; ++j)
+            {
+                beta[j] = rtz[j] / oldrtz[j];
+            }
+
+            RETURN_IF_HPCG_ERROR(ComputeMultiWAXPBY(nrow, one, z, beta, p, p));
+        }
+
+        RETURN_IF_HPCG_ERROR(ComputeSPMM(A, data, p, Ap));
+        RETURN_IF_HPCG_ERROR(ComputeMultiDotProduct(nrow, data, p, Ap, pAp, time_allreduce));
+
+        for(int j = 0; j < nrhs; ++j)
+        {
+            alpha[j] = rtz[j] / pAp[j];
+            minus_alpha[j] = -alpha[j];
+        }
+
+        RETURN_IF_HPCG_ERROR(ComputeMultiWAXPBY(nrow, one, X, alpha, p, X));
+        RETURN_IF_HPCG_ERROR(ComputeMultiWAXPBY(nrow, one, r, minus_alpha, Ap, r));
+        RETURN_IF_HPCG_ERROR(ComputeMultiDotProduct(nrow, data, r, r, normr, time_allreduce));
+
+        for(int j = 0; j < nrhs; ++j)
+        {
+            normr[j] = sqrt(normr[j]);
+        }
+
+        niters = k;
+    }
+
+    return 0;
+}
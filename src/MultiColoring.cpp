@@ -38,6 +38,8 @@
 #include <hip/hip_runtime.h>
 #include <rocprim/rocprim.hpp>
 
+#include <vector>
+
 #define LAUNCH_JPL(blocksizex, blocksizey)                             \
     {                                                                  \
         dim3 blocks((m - 1) / blocksizey + 1);                         \
@@ -351,3 +353,107 @@ void JPLColoring(SparseMatrix& A)
     --A.ublocks;
 #endif
 }
+
+/*!
+  Colors blocks of BLOCK_COLORING_DIM^3 grid points instead of single points.
+
+  Blocks are colored by the parity of their block coordinates, such that two
+  blocks of the same color are at least one block apart and not coupled by
+  the 27 point stencil, which requires at most 8 colors. The Gauss-Seidel
+  sweep updates the rows of each block in lexicographic order, while all
+  blocks of a color are processed in parallel.
+
+  Row p of block t of a color with T blocks is permuted to position
+  offset + p * T + t, so threads processing consecutive blocks access
+  consecutive rows. Levels whose local dimensions are not a multiple of
+  BLOCK_COLORING_DIM, or without geometry, fall back to JPLColoring.
+
+  @param[inout] A the known system matrix, on exit contains the permutation
+                  and the rows of each color
+*/
+void BlockColoring(SparseMatrix& A)
+{
+    const local_int_t dim = BLOCK_COLORING_DIM;
+
+    local_int_t nx = A.geom->nx;
+    local_int_t ny = A.geom->ny;
+    local_int_t nz = A.geom->nz;
+    local_int_t m = A.localNumberOfRows;
+
+    if(nx % dim != 0 || ny % dim != 0 || nz % dim != 0 || nx * ny * nz != m)
+    {
+        JPLColoring(A);
+        return;
+    }
+
+    // Number of blocks in each direction
+    local_int_t tx = nx / dim;
+    local_int_t ty = ny / dim;
+    local_int_t tz = nz / dim;
+
+    // Number of blocks with even (0) and odd (1) coordinate in each direction
+    local_int_t cx[2] = {(tx + 1) / 2, tx / 2};
+    local_int_t cy[2] = {(ty + 1) / 2, ty / 2};
+    local_int_t cz[2] = {(tz + 1) / 2, tz / 2};
+
+    A.tile_rows = dim * dim * dim;
+    A.nblocks = 0;
+
+    A.sizes = new local_int_t[MAX_COLORS];
+    A.offsets = new local_int_t[MAX_COLORS];
+    A.offsets[0] = 0;
+
+    // Color of each parity combination, colors without blocks are skipped
+    int color[8];
+
+    for(int c = 0; c < 8; ++c)
+    {
+        local_int_t ntiles = cx[c & 1] * cy[(c >> 1) & 1] * cz[c >> 2];
+
+        color[c] = A.nblocks;
+
+        if(ntiles > 0)
+        {
+            A.sizes[A.nblocks] = ntiles * A.tile_rows;
+            A.offsets[A.nblocks + 1] = A.offsets[A.nblocks] + A.sizes[A.nblocks];
+            ++A.nblocks;
+        }
+    }
+
+    // Rows within a block are not independent, the last color has to be
+    // swept backwards as well
+    A.ublocks = A.nblocks - 1;
+
+    std::vector<local_int_t> perm(m);
+
+    for(local_int_t iz = 0; iz < nz; ++iz)
+    {
+        for(local_int_t iy = 0; iy < ny; ++iy)
+        {
+            for(local_int_t ix = 0; ix < nx; ++ix)
+            {
+                local_int_t bx = ix / dim;
+                local_int_t by = iy / dim;
+                local_int_t bz = iz / dim;
+
+                int parity = (bx & 1) | ((by & 1) << 1) | ((bz & 1) << 2);
+                int c = color[parity];
+
+                // Index of the block within its color, and of the row within its block
+                local_int_t px = cx[bx & 1];
+                local_int_t py = cy[by & 1];
+                local_int_t tile = (bx >> 1) + px * ((by >> 1) + py * (bz >> 1));
+                local_int_t pos = (ix % dim) + dim * ((iy % dim) + dim * (iz % dim));
+
+                local_int_t ntiles = A.sizes[c] / A.tile_rows;
+
+                perm[ix + nx * (iy + ny * iz)] = A.offsets[c] + pos * ntiles + tile;
+            }
+        }
+    }
+
+    HIP_CHECK(deviceMalloc((void**)&A.perm, sizeof(local_int_t) * m));
+    HIP_CHECK(hipMemcpy(A.perm, perm.data(), sizeof(local_int_t) * m, hipMemcpyHostToDevice));
+
+    HIP_CHECK(deviceFree(A.d_rowHash));
+}
@@ -31,6 +31,10 @@
 
 #include "SparseMatrix.hpp"
 
+// Edge length of the blocks of grid points colored by BlockColoring
+#define BLOCK_COLORING_DIM 4
+
 void JPLColoring(SparseMatrix& A);
+void BlockColoring(SparseMatrix& A);
 
 #endif // MULTICOLORING_HPP
@@ -0,0 +1,120 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file MultiVector.hpp
+
+ HPCG data structure for a block of vectors (multiple right hand sides)
+ */
+
+#ifndef MULTIVECTOR_HPP
+#define MULTIVECTOR_HPP
+
+#include <cassert>
+#include <hip/hip_runtime_api.h>
+
+#include "Geometry.hpp"
+#include "utils.hpp"
+
+/*!
+  Block of vectors of equal length. Values are stored interleaved, i.e. entry i
+  of vector j is stored at d_values[i * numberOfVectors + j], such that a single
+  matrix entry is applied to all vectors with contiguous memory accesses.
+ */
+struct MultiVector_STRUCT {
+  local_int_t localLength; //!< length of the local portion of each vector
+  int numberOfVectors; //!< number of vectors in the block
+  double* d_values; //!< interleaved values on device
+};
+typedef struct MultiVector_STRUCT MultiVector;
+
+/*!
+  Allocates the device storage of a block of vectors.
+
+  The block is allocated outside of the memory pool of the benchmark, which is
+  sized for a single right hand side.
+
+  @param[out] v               The block of vectors
+  @param[in]  localLength     Length of local portion of each vector
+  @param[in]  numberOfVectors Number of vectors in the block
+
+  @return hipSuccess or the error of the allocation
+ */
+inline hipError_t HIPInitializeMultiVector(MultiVector& v, local_int_t localLength, int numberOfVectors)
+{
+    v.localLength = localLength;
+    v.numberOfVectors = numberOfVectors;
+    v.d_values = NULL;
+
+    return hipMalloc((void**)&v.d_values, sizeof(double) * localLength * numberOfVectors);
+}
+
+/*!
+  Fill all vectors of the block with zero values.
+
+  @param[inout] v The block of vectors
+ */
+inline void HIPZeroMultiVector(MultiVector& v)
+{
+    HIP_CHECK(hipMemset(v.d_values, 0, sizeof(double) * v.localLength * v.numberOfVectors));
+}
+
+/*!
+  Copy the local entries of one block of vectors to another.
+
+  @param[in]  v Source block
+  @param[out] w Destination block
+ */
+inline void HIPCopyMultiVector(const MultiVector& v, MultiVector& w)
+{
+    assert(w.localLength >= v.localLength);
+    assert(w.numberOfVectors == v.numberOfVectors);
+
+    HIP_CHECK(hipMemcpy(w.d_values,
+                        v.d_values,
+                        sizeof(double) * v.localLength * v.numberOfVectors,
+                        hipMemcpyDeviceToDevice));
+}
+
+/*!
+  Deallocates the device storage of a block of vectors.
+
+  @param[inout] v The block of vectors
+ */
+inline void HIPDeleteMultiVector(MultiVector& v)
+{
+    if(v.d_values != NULL)
+    {
+        HIP_CHECK(hipFree(v.d_values));
+    }
+
+    v.d_values = NULL;
+    v.localLength = 0;
+}
+
+#endif // MULTIVECTOR_HPP
@@ -0,0 +1,609 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file NumaDomains.cpp
+
+ Decomposition of the local subdomain into sub-boxes owned by the host thread
+ teams of the NUMA nodes
+ */
+
+#ifdef HPCG_NUMA
+#include <numa.h>
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "ComputeOptimalShapeXYZ.hpp"
+#include "NumaDomains.hpp"
+#include "mytimer.hpp"
+
+// Allocates an array on the given NUMA node, or from the heap if the node is unknown
+template <typename T>
+static T* AllocateOnNode(local_int_t count, int node)
+{
+#ifdef HPCG_NUMA
+    if(node >= 0)
+    {
+        return (T*)numa_alloc_onnode(sizeof(T) * std::max(count, (local_int_t)1), node);
+    }
+#endif
+
+    return new T[std::max(count, (local_int_t)1)];
+}
+
+template <typename T>
+static void FreeOnNode(T* ptr, local_int_t count, int node)
+{
+    if(ptr == NULL)
+    {
+        return;
+    }
+
+#ifdef HPCG_NUMA
+    if(node >= 0)
+    {
+        numa_free(ptr, sizeof(T) * std::max(count, (local_int_t)1));
+        return;
+    }
+#endif
+
+    delete[] ptr;
+}
+
+// NUMA nodes with CPUs that the process is allowed to run on, empty if unknown
+static std::vector<int> AvailableNodes(void)
+{
+    std::vector<int> nodes;
+
+#ifdef HPCG_NUMA
+    if(numa_available() < 0)
+    {
+        return nodes;
+    }
+
+    struct bitmask* run = numa_get_run_node_mask();
+    struct bitmask* cpus = numa_allocate_cpumask();
+
+    for(int n = 0; n <= numa_max_node(); ++n)
+    {
+        if(numa_bitmask_isbitset(run, n) && numa_node_to_cpus(n, cpus) == 0 && numa_bitmask_weight(cpus) > 0)
+        {
+            nodes.push_back(n);
+        }
+    }
+
+    numa_free_cpumask(cpus);
+    numa_bitmask_free(run);
+#endif
+
+    return nodes;
+}
+
+static inline void BindToNode(int node)
+{
+#ifdef HPCG_NUMA
+    if(node >= 0)
+    {
+        numa_run_on_node(node);
+    }
+#endif
+}
+
+// First index of part p of n entries split into np balanced parts
+static inline local_int_t PartBegin(local_int_t p, local_int_t n, local_int_t np)
+{
+    return (local_int_t)((long long)p * n / np);
+}
+
+// Copies the share of the ghost entries of one team thread from their owners
+static void GatherGhosts(NumaDomain& D, const NumaDomain* domain, const double* halo, int rank, int size)
+{
+    local_int_t begin = PartBegin(rank, D.numberOfGhosts, size);
+    local_int_t end = PartBegin(rank + 1, D.numberOfGhosts, size);
+
+    double* ghost = D.x + D.numberOfRows;
+
+    for(local_int_t g = begin; g < end; ++g)
+    {
+        int owner = D.ghostDomain[g];
+        ghost[g] = (owner < 0) ? halo[D.ghostIndex[g]] : domain[owner].x[D.ghostIndex[g]];
+    }
+}
+
+// Computes the share of the owned rows of one team thread
+static void MultiplyRows(NumaDomain& D, int rank, int size)
+{
+    local_int_t begin = PartBegin(rank, D.numberOfRows, size);
+    local_int_t end = PartBegin(rank + 1, D.numberOfRows, size);
+
+    const local_int_t* const rowPtr = D.rowPtr;
+    const local_int_t* const colInd = D.colInd;
+    const double* const values = D.values;
+    const double* const xv = D.x;
+    double* const yv = D.y;
+
+    for(local_int_t i = begin; i < end; ++i)
+    {
+        const double* const cur_vals = values + rowPtr[i];
+        const local_int_t* const cur_inds = colInd + rowPtr[i];
+        const int cur_nnz = rowPtr[i + 1] - rowPtr[i];
+
+        double sum = 0.0;
+
+        for(int j = 0; j < cur_nnz; ++j)
+        {
+            sum += cur_vals[j] * xv[cur_inds[j]];
+        }
+
+        yv[i] = sum;
+    }
+}
+
+/*!
+  Splits the local grid of the host reference matrix into a grid of sub-boxes,
+  one per thread team. Each sub-box gets a private copy of its rows in CSR
+  format and of its entries of x and y, allocated on the NUMA node of its team.
+  Entries of x owned by another sub-box or by another process are ghost
+  entries, only these are read across domains.
+
+  @param[in]  A               The known system matrix, the host arrays are required
+  @param[in]  numberOfDomains The number of sub-boxes, 0 for one per NUMA node
+  @param[out] nd              The decomposition
+
+  @return Returns zero on success and a non-zero value otherwise, e.g. if A is
+          not a generated problem or the host arrays are missing.
+*/
+int SetupNumaDomains(const SparseMatrix& A, int numberOfDomains, NumaDomains& nd)
+{
+    nd.numberOfDomains = 0;
+    nd.numberOfNodes = 0;
+    nd.teamBegin = NULL;
+    nd.domain = NULL;
+
+    const Geometry& geom = *A.geom;
+
+    local_int_t nx = geom.nx;
+    local_int_t ny = geom.ny;
+    local_int_t nz = geom.nz;
+    local_int_t nrow = A.localNumberOfRows;
+
+    // Sub-boxes are defined on the grid of a generated problem
+    if(A.mtxIndL == NULL || nrow != nx * ny * nz || (local_int_t)A.localToGlobalMap.size() != nrow)
+    {
+        return -1;
+    }
+
+    std::vector<int> nodes = AvailableNodes();
+
+#ifndef HPCG_NO_OPENMP
+    int nthreads = omp_get_max_threads();
+#else
+    int nthreads = 1;
+#endif
+
+    if(numberOfDomains <= 0)
+    {
+        numberOfDomains = std::max((int)nodes.size(), 1);
+    }
+
+    // Every team needs at least one thread
+    numberOfDomains = std::min(numberOfDomains, nthreads);
+
+    int shape[3];
+    ComputeOptimalShapeXYZ(numberOfDomains, shape[0], shape[1], shape[2]);
+
+    // Most cuts across the longest dimension keep the shared boundaries small
+    std::sort(shape, shape + 3);
+
+    int dims[3] = {0, 1, 2};
+    local_int_t n[3] = {nx, ny, nz};
+    for(int i = 0; i < 3; ++i)
+    {
+        for(int j = i + 1; j < 3; ++j)
+        {
+            if(n[dims[j]] < n[dims[i]])
+            {
+                std::swap(dims[i], dims[j]);
+            }
+        }
+    }
+
+    int np[3];
+    for(int k = 0; k < 3; ++k)
+    {
+        np[dims[k]] = shape[k];
+    }
+
+    int npx = np[0];
+    int npy = np[1];
+    int npz = np[2];
+
+    if(npx > nx || npy > ny || npz > nz)
+    {
+        return -1;
+    }
+
+    // Sub-box of each grid coordinate
+    std::vector<int> bx(nx);
+    std::vector<int> by(ny);
+    std::vector<int> bz(nz);
+
+    for(int b = 0; b < npx; ++b)
+        for(local_int_t i = PartBegin(b, nx, npx); i < PartBegin(b + 1, nx, npx); ++i)
+            bx[i] = b;
+    for(int b = 0; b < npy; ++b)
+        for(local_int_t i = PartBegin(b, ny, npy); i < PartBegin(b + 1, ny, npy); ++i)
+            by[i] = b;
+    for(int b = 0; b < npz; ++b)
+        for(local_int_t i = PartBegin(b, nz, npz); i < PartBegin(b + 1, nz, npz); ++i)
+            bz[i] = b;
+
+    // Domain and lexicographic index inside the sub-box of each row, the rows
+    // may have been reordered, thus coordinates are taken from the global index
+    std::vector<int> domainOf(nrow);
+    std::vector<local_int_t> localOf(nrow);
+    std::vector<local_int_t> count(numberOfDomains, 0);
+
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        global_int_t g = A.localToGlobalMap[i];
+
+        local_int_t ix = (local_int_t)(g % geom.gnx - geom.gix0);
+        local_int_t iy = (local_int_t)((g / geom.gnx) % geom.gny - geom.giy0);
+        local_int_t iz = (local_int_t)(g / (geom.gnx * geom.gny) - geom.giz0);
+
+        local_int_t x0 = PartBegin(bx[ix], nx, npx);
+        local_int_t y0 = PartBegin(by[iy], ny, npy);
+        local_int_t z0 = PartBegin(bz[iz], nz, npz);
+        local_int_t sx = PartBegin(bx[ix] + 1, nx, npx) - x0;
+        local_int_t sy = PartBegin(by[iy] + 1, ny, npy) - y0;
+
+        domainOf[i] = bx[ix] + npx * (by[iy] + npy * bz[iz]);
+        localOf[i] = (ix - x0) + sx * ((iy - y0) + sy * (iz - z0));
+
+        ++count[domainOf[i]];
+    }
+
+    nd.numberOfDomains = numberOfDomains;
+    nd.npx = npx;
+    nd.npy = npy;
+    nd.npz = npz;
+    nd.numberOfThreads = nthreads;
+    nd.teamBegin = new int[numberOfDomains + 1];
+    nd.domain = new NumaDomain[numberOfDomains];
+
+    for(int d = 0; d <= numberOfDomains; ++d)
+    {
+        nd.teamBegin[d] = (int)PartBegin(d, nthreads, numberOfDomains);
+    }
+
+    // Neighboring sub-boxes share a node if there are more domains than nodes
+    for(int d = 0; d < numberOfDomains; ++d)
+    {
+        NumaDomain& D = nd.domain[d];
+
+        D.node = nodes.empty() ? -1 : nodes[PartBegin(d, nodes.size(), numberOfDomains)];
+        D.numberOfRows = count[d];
+        D.numberOfGhosts = 0;
+        D.numberOfBoundaryRows = 0;
+        D.numberOfNonzeros = 0;
+        D.rows = AllocateOnNode<local_int_t>(D.numberOfRows, D.node);
+        D.ghostDomain = NULL;
+        D.ghostIndex = NULL;
+        D.rowPtr = NULL;
+        D.colInd = NULL;
+        D.values = NULL;
+        D.x = NULL;
+        D.y = NULL;
+        D.time = 0.0;
+
+        if(D.node >= 0 && (d == 0 || D.node != nd.domain[d - 1].node))
+        {
+            ++nd.numberOfNodes;
+        }
+    }
+
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        nd.domain[domainOf[i]].rows[localOf[i]] = i;
+    }
+
+    // Ghost entry of each column of the current domain, -1 if none
+    std::vector<local_int_t> ghostOf(A.localNumberOfColumns, -1);
+    std::vector<local_int_t> ghosts;
+
+    for(int d = 0; d < numberOfDomains; ++d)
+    {
+        NumaDomain& D = nd.domain[d];
+
+        ghosts.clear();
+
+        for(local_int_t k = 0; k < D.numberOfRows; ++k)
+        {
+            local_int_t i = D.rows[k];
+            bool boundary = false;
+
+            for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+            {
+                local_int_t col = A.mtxIndL[i][j];
+
+                if(col < nrow && domainOf[col] == d)
+                {
+                    continue;
+                }
+
+                boundary = true;
+
+                if(ghostOf[col] < 0)
+                {
+                    ghostOf[col] = ghosts.size();
+                    ghosts.push_back(col);
+                }
+            }
+
+            D.numberOfBoundaryRows += boundary;
+            D.numberOfNonzeros += A.nonzerosInRow[i];
+        }
+
+        D.numberOfGhosts = ghosts.size();
+        D.ghostDomain = AllocateOnNode<int>(D.numberOfGhosts, D.node);
+        D.ghostIndex = AllocateOnNode<local_int_t>(D.numberOfGhosts, D.node);
+        D.rowPtr = AllocateOnNode<local_int_t>(D.numberOfRows + 1, D.node);
+        D.colInd = AllocateOnNode<local_int_t>(D.numberOfNonzeros, D.node);
+        D.values = AllocateOnNode<double>(D.numberOfNonzeros, D.node);
+        D.x = AllocateOnNode<double>(D.numberOfRows + D.numberOfGhosts, D.node);
+        D.y = AllocateOnNode<double>(D.numberOfRows, D.node);
+
+        for(local_int_t g = 0; g < D.numberOfGhosts; ++g)
+        {
+            local_int_t col = ghosts[g];
+
+            D.ghostDomain[g] = (col < nrow) ? domainOf[col] : -1;
+            D.ghostIndex[g] = (col < nrow) ? localOf[col] : col;
+        }
+
+        D.rowPtr[0] = 0;
+
+        for(local_int_t k = 0; k < D.numberOfRows; ++k)
+        {
+            local_int_t i = D.rows[k];
+            local_int_t idx = D.rowPtr[k];
+
+            for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+            {
+                local_int_t col = A.mtxIndL[i][j];
+
+                D.colInd[idx] = (col < nrow && domainOf[col] == d) ? localOf[col] : D.numberOfRows + ghostOf[col];
+                D.values[idx] = A.matrixValues[i][j];
+                ++idx;
+            }
+
+            D.rowPtr[k + 1] = idx;
+        }
+
+        for(local_int_t k = 0; k < D.numberOfRows + D.numberOfGhosts; ++k)
+        {
+            D.x[k] = 0.0;
+        }
+
+        for(local_int_t k = 0; k < D.numberOfRows; ++k)
+        {
+            D.y[k] = 0.0;
+        }
+
+        for(local_int_t g = 0; g < D.numberOfGhosts; ++g)
+        {
+            ghostOf[ghosts[g]] = -1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+  Copies the owned entries of a process local vector into the domains.
+
+  @param[inout] nd The decomposition
+  @param[in]    x  The vector, indexed by process local rows
+*/
+void CopyToNumaDomains(NumaDomains& nd, const Vector& x)
+{
+    for(int d = 0; d < nd.numberOfDomains; ++d)
+    {
+        NumaDomain& D = nd.domain[d];
+
+        for(local_int_t k = 0; k < D.numberOfRows; ++k)
+        {
+            D.x[k] = x.values[D.rows[k]];
+        }
+    }
+}
+
+/*!
+  Copies the result of ComputeSPMV_numa into a process local vector.
+
+  @param[in]  nd The decomposition
+  @param[out] y  The vector, indexed by process local rows
+*/
+void CopyFromNumaDomains(const NumaDomains& nd, Vector& y)
+{
+    for(int d = 0; d < nd.numberOfDomains; ++d)
+    {
+        const NumaDomain& D = nd.domain[d];
+
+        for(local_int_t k = 0; k < D.numberOfRows; ++k)
+        {
+            y.values[D.rows[k]] = D.y[k];
+        }
+    }
+}
+
+/*!
+  Computes y = Ax on the domains. Each team binds its threads to the node of
+  its domain, copies its ghost entries from the neighboring domains and from
+  the halo of x, and multiplies its rows. The accumulated time of each team is
+  updated, excluding synchronization.
+
+  @param[inout] nd The decomposition, x of the domains is read and y written
+  @param[in]    x  The process local vector, only its halo entries are read,
+                   they have to be exchanged before
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int ComputeSPMV_numa(NumaDomains& nd, const Vector& x)
+{
+    if(nd.numberOfDomains == 0)
+    {
+        return -1;
+    }
+
+    const double* halo = x.values;
+
+    std::vector<double> busy(nd.numberOfThreads, 0.0);
+    bool serial = false;
+
+#ifdef HPCG_NUMA
+    // Teams bind their threads, the calling thread gets its affinity back
+    struct bitmask* affinity = numa_allocate_cpumask();
+    numa_sched_getaffinity(0, affinity);
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp parallel num_threads(nd.numberOfThreads)
+#endif
+    {
+#ifndef HPCG_NO_OPENMP
+        int t = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+#else
+        int t = 0;
+        int nthreads = 1;
+#endif
+
+        if(nthreads == nd.numberOfThreads)
+        {
+            int d = 0;
+            while(t >= nd.teamBegin[d + 1])
+            {
+                ++d;
+            }
+
+            int rank = t - nd.teamBegin[d];
+            int size = nd.teamBegin[d + 1] - nd.teamBegin[d];
+
+            NumaDomain& D = nd.domain[d];
+
+            BindToNode(D.node);
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp barrier
+#endif
+            double t0 = mytimer();
+            GatherGhosts(D, nd.domain, halo, rank, size);
+            busy[t] = mytimer() - t0;
+
+            // Only the own team reads the ghost entries, but teams cannot
+            // synchronize separately
+#ifndef HPCG_NO_OPENMP
+#pragma omp barrier
+#endif
+            t0 = mytimer();
+            MultiplyRows(D, rank, size);
+            busy[t] += mytimer() - t0;
+        }
+        else if(t == 0)
+        {
+            // Fewer threads than teams, domains are processed one by one
+            for(int d = 0; d < nd.numberOfDomains; ++d)
+            {
+                double t0 = mytimer();
+                GatherGhosts(nd.domain[d], nd.domain, halo, 0, 1);
+                MultiplyRows(nd.domain[d], 0, 1);
+                nd.domain[d].time += mytimer() - t0;
+            }
+
+            serial = true;
+        }
+    }
+
+#ifdef HPCG_NUMA
+    numa_sched_setaffinity(0, affinity);
+    numa_free_cpumask(affinity);
+#endif
+
+    // A team is as fast as its slowest thread
+    for(int d = 0; d < nd.numberOfDomains && !serial; ++d)
+    {
+        double time = 0.0;
+
+        for(int t = nd.teamBegin[d]; t < nd.teamBegin[d + 1]; ++t)
+        {
+            time = std::max(time, busy[t]);
+        }
+
+        nd.domain[d].time += time;
+    }
+
+    return 0;
+}
+
+/*!
+  Deallocates the domains.
+
+  @param[inout] nd The decomposition
+*/
+void DeleteNumaDomains(NumaDomains& nd)
+{
+    for(int d = 0; d < nd.numberOfDomains; ++d)
+    {
+        NumaDomain& D = nd.domain[d];
+
+        FreeOnNode(D.rows, D.numberOfRows, D.node);
+        FreeOnNode(D.ghostDomain, D.numberOfGhosts, D.node);
+        FreeOnNode(D.ghostIndex, D.numberOfGhosts, D.node);
+        FreeOnNode(D.rowPtr, D.numberOfRows + 1, D.node);
+        FreeOnNode(D.colInd, D.numberOfNonzeros, D.node);
+        FreeOnNode(D.values, D.numberOfNonzeros, D.node);
+        FreeOnNode(D.x, D.numberOfRows + D.numberOfGhosts, D.node);
+        FreeOnNode(D.y, D.numberOfRows, D.node);
+    }
+
+    delete[] nd.domain;
+    delete[] nd.teamBegin;
+
+    nd.numberOfDomains = 0;
+    nd.domain = NULL;
+    nd.teamBegin = NULL;
+}
@@ -0,0 +1,85 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file NumaDomains.hpp
+
+ Decomposition of the local subdomain into sub-boxes owned by the host thread
+ teams of the NUMA nodes
+ */
+
+#ifndef NUMADOMAINS_HPP
+#define NUMADOMAINS_HPP
+
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+
+/*!
+  Sub-box of the local grid owned by one thread team. The owned entries of x
+  are followed by ghost entries, which are copies of the sub-box boundaries of
+  other domains and of the halo of the process.
+*/
+struct NumaDomain_STRUCT
+{
+    int node;                         //!< NUMA node the arrays are allocated on, -1 if unknown
+    local_int_t numberOfRows;         //!< number of owned rows
+    local_int_t numberOfGhosts;       //!< number of ghost entries of x
+    local_int_t numberOfBoundaryRows; //!< number of owned rows referencing ghost entries
+    local_int_t numberOfNonzeros;     //!< number of nonzeros of the owned rows
+    local_int_t* rows;                //!< process local index of each owned row
+    int* ghostDomain;                 //!< domain owning each ghost entry, -1 for the halo of the process
+    local_int_t* ghostIndex;          //!< index of each ghost entry in its owner
+    local_int_t* rowPtr;              //!< CSR row offsets of the owned rows
+    local_int_t* colInd;              //!< CSR column indices, domain local
+    double* values;                   //!< CSR values
+    double* x;                        //!< owned and ghost entries of the input vector
+    double* y;                        //!< owned entries of the output vector
+    double time;                      //!< accumulated time of the team in ComputeSPMV_numa
+};
+typedef struct NumaDomain_STRUCT NumaDomain;
+
+struct NumaDomains_STRUCT
+{
+    int numberOfDomains; //!< number of domains, 0 if not decomposed
+    int numberOfNodes;   //!< number of distinct NUMA nodes of the domains, 0 if unknown
+    int npx;             //!< number of domains in x direction
+    int npy;             //!< number of domains in y direction
+    int npz;             //!< number of domains in z direction
+    int numberOfThreads; //!< number of host threads of all teams
+    int* teamBegin;      //!< first thread of each team, numberOfDomains + 1 entries
+    NumaDomain* domain;  //!< the domains
+};
+typedef struct NumaDomains_STRUCT NumaDomains;
+
+int SetupNumaDomains(const SparseMatrix& A, int numberOfDomains, NumaDomains& nd);
+void CopyToNumaDomains(NumaDomains& nd, const Vector& x);
+void CopyFromNumaDomains(const NumaDomains& nd, Vector& y);
+int ComputeSPMV_numa(NumaDomains& nd, const Vector& x);
+void DeleteNumaDomains(NumaDomains& nd);
+
+#endif // NUMADOMAINS_HPP
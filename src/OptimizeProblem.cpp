@@ -50,6 +50,7 @@
 #include "OptimizeProblem.hpp"
 #include "Permute.hpp"
 #include "MultiColoring.hpp"
+#include "LevelSchedule.hpp"
 
 /*!
   Optimizes the data structures used for CG iteration to increase the
@@ -69,7 +70,14 @@
 int OptimizeProblem(SparseMatrix & A, CGData & data, Vector & b, Vector & x, Vector & xexact)
 {
     // Perform matrix coloring
-    JPLColoring(A);
+    if(A.useBlockColoring)
+    {
+        BlockColoring(A);
+    }
+    else
+    {
+        JPLColoring(A);
+    }
 
     // Permute matrix columns
     PermuteColumns(A);
@@ -86,6 +94,18 @@ int OptimizeProblem(SparseMatrix & A, CGData & data, Vector & b, Vector & x, Vec
     // Extract diagonal indices and inverse values
     ExtractDiagonal(A);
 
+    // Single precision copy of the matrix values
+    if(A.useFloatValues)
+    {
+        ConvertToSinglePrecision(A);
+    }
+
+    // Host level schedule of the natural ordering
+    if(A.useLevelSchedule)
+    {
+        BuildLevelSchedule(A);
+    }
+
     // Defrag
     HIP_CHECK(deviceDefrag((void**)&A.diag_idx, sizeof(local_int_t) * A.localNumberOfRows));
     HIP_CHECK(deviceDefrag((void**)&A.inv_diag, sizeof(double) * A.localNumberOfRows));
@@ -107,7 +127,14 @@ int OptimizeProblem(SparseMatrix & A, CGData & data, Vector & b, Vector & x, Vec
     while(M != NULL)
     {
         // Perform matrix coloring
-        JPLColoring(*M);
+        if(M->useBlockColoring)
+        {
+            BlockColoring(*M);
+        }
+        else
+        {
+            JPLColoring(*M);
+        }
 
         // Permute matrix columns
         PermuteColumns(*M);
@@ -126,6 +153,18 @@ int OptimizeProblem(SparseMatrix & A, CGData & data, Vector & b, Vector & x, Vec
         // Extract diagonal indices and inverse values
         ExtractDiagonal(*M);
 
+        // Single precision copy of the matrix values
+        if(M->useFloatValues)
+        {
+            ConvertToSinglePrecision(*M);
+        }
+
+        // Host level schedule of the natural ordering
+        if(M->useLevelSchedule)
+        {
+            BuildLevelSchedule(*M);
+        }
+
         // Defrag
         HIP_CHECK(deviceDefrag((void**)&M->diag_idx, sizeof(local_int_t) * M->localNumberOfRows));
         HIP_CHECK(deviceDefrag((void**)&M->inv_diag, sizeof(double) * M->localNumberOfRows));
@@ -13,6 +13,10 @@
 //@HEADER
 
 
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
 #include <fstream>
 #include <list>
 #include <sstream>
@@ -73,6 +77,11 @@ OutputFile::add(const string & key_arg, size_t value_arg) {
   descendants.push_back(allocKeyVal(key_arg, ss.str()));
 }
 
+void
+OutputFile::add(OutputFile * element) {
+  descendants.push_back(element);
+}
+
 void
 OutputFile::setKeyValue(const string & key_arg, const string & value_arg) {
   key = key_arg;
@@ -110,16 +119,141 @@ OutputFile::generate(void) {
     result += (*it)->generateRecursive("");
   }
 
-  time_t rawtime;
-  time(&rawtime);
-  tm * ptm = localtime(&rawtime);
-  char sdate[25];
-  //use tm_mon+1 because tm_mon is 0 .. 11 instead of 1 .. 12
-  sprintf (sdate,"%04d-%02d-%02d_%02d-%02d-%02d",ptm->tm_year + 1900, ptm->tm_mon+1,
-        ptm->tm_mday, ptm->tm_hour, ptm->tm_min,ptm->tm_sec);
+  string filename = generateFileName(".txt");
 
-  string filename = name + "_" + version + "_";
-  filename += string(sdate) + ".txt";
+  ofstream myfile(filename.c_str());
+  myfile << result;
+  myfile.close();
+
+  return result;
+}
+
+// Escape a string for use as JSON string literal
+static string
+jsonString(const string & str) {
+  string result = "\"";
+
+  for (string::const_iterator it = str.begin(); it != str.end(); ++it) {
+    char c = *it;
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if ((unsigned char)c < 0x20) {
+      char esc[8];
+      sprintf(esc, "\\u%04x", (unsigned char)c);
+      result += esc;
+    } else {
+      result += c;
+    }
+  }
+
+  return result + "\"";
+}
+
+// Matches the JSON number grammar -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool
+isJSONNumber(const string & str) {
+  size_t i = 0;
+  size_t n = str.size();
+
+  if (i < n && str[i] == '-') ++i;
+
+  if (i < n && str[i] == '0') {
+    ++i;
+  } else if (i < n && str[i] >= '1' && str[i] <= '9') {
+    while (i < n && isdigit((unsigned char)str[i])) ++i;
+  } else {
+    return false;
+  }
+
+  if (i < n && str[i] == '.') {
+    size_t digits = ++i;
+    while (i < n && isdigit((unsigned char)str[i])) ++i;
+    if (i == digits) return false;
+  }
+
+  if (i < n && (str[i] == 'e' || str[i] == 'E')) {
+    ++i;
+    if (i < n && (str[i] == '+' || str[i] == '-')) ++i;
+    size_t digits = i;
+    while (i < n && isdigit((unsigned char)str[i])) ++i;
+    if (i == digits) return false;
+  }
+
+  return i == n;
+}
+
+// Write values that are valid JSON numbers as such and everything else as strings
+static string
+jsonValue(const string & str) {
+  if (isJSONNumber(str))
+    return str;
+
+  return jsonString(str);
+}
+
+string
+OutputFile::generateJSONValue(string indent) {
+  if (descendants.empty())
+    return jsonValue(value);
+
+  string result = "{" + eol;
+
+  if (!value.empty())
+    result += indent + "  " + jsonString("value") + ": " + jsonValue(value) + "," + eol;
+
+  return result + generateJSONMembers(indent + "  ") + eol + indent + "}";
+}
+
+string
+OutputFile::generateJSONMembers(string indent) {
+  string result;
+  string sep;
+
+  for (list<OutputFile*>::iterator it = descendants.begin(); it != descendants.end(); ++it) {
+    // Keys repeated among siblings, e.g. one entry per grid level, form a single
+    // member at the first occurrence whose value is the array of all their values
+    bool first = true;
+    int count = 0;
+    for (list<OutputFile*>::iterator jt = descendants.begin(); jt != descendants.end(); ++jt) {
+      if ((*jt)->key != (*it)->key) continue;
+      if (jt == it) first = (count == 0);
+      ++count;
+    }
+    if (!first) continue;
+
+    result += sep + indent + jsonString((*it)->key) + ": ";
+    sep = "," + eol;
+
+    if (count == 1) {
+      result += (*it)->generateJSONValue(indent);
+      continue;
+    }
+
+    result += "[";
+    string item_sep = eol;
+    for (list<OutputFile*>::iterator jt = it; jt != descendants.end(); ++jt) {
+      if ((*jt)->key != (*it)->key) continue;
+      result += item_sep + indent + "  " + (*jt)->generateJSONValue(indent + "  ");
+      item_sep = "," + eol;
+    }
+    result += eol + indent + "]";
+  }
+
+  return result;
+}
+
+string
+OutputFile::generateJSON(void) {
+  string result = "{" + eol + "  " + jsonString("name") + ": " + jsonString(name) + "," + eol
+                + "  " + jsonString("version") + ": " + jsonString(version);
+
+  if (!descendants.empty())
+    result += "," + eol + generateJSONMembers("  ");
+
+  result += eol + "}" + eol;
+
+  string filename = generateFileName(".json");
 
   ofstream myfile(filename.c_str());
   myfile << result;
@@ -128,6 +262,26 @@ OutputFile::generate(void) {
   return result;
 }
 
+string
+OutputFile::generateFileName(const string & extension) {
+  // All result files of a run share the time stamp of the first one
+  if (timestamp.empty()) {
+    time_t rawtime;
+    time(&rawtime);
+    tm * ptm = localtime(&rawtime);
+    char sdate[25];
+    //use tm_mon+1 because tm_mon is 0 .. 11 instead of 1 .. 12
+    sprintf (sdate,"%04d-%02d-%02d_%02d-%02d-%02d",ptm->tm_year + 1900, ptm->tm_mon+1,
+          ptm->tm_mday, ptm->tm_hour, ptm->tm_min,ptm->tm_sec);
+    timestamp = sdate;
+  }
+
+  string filename = name + "_" + version + "_";
+  filename += timestamp + extension;
+
+  return filename;
+}
+
 OutputFile * OutputFile::allocKeyVal(const std::string & key_arg, const std::string & value_arg) {
   OutputFile * of = new OutputFile();
   of->setKeyValue(key_arg, value_arg);
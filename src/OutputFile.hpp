@@ -57,10 +57,20 @@ protected:
   std::string value; //!< the value of the stored element
   std::string eol; //!< end-of-line character sequence in the output file
   std::string keySeparator; //!< character sequence to separate keys in the output file
+  std::string timestamp; //!< time stamp of the result files, fixed by the first one written
 
   //! Recursively generate output string from descendant list, and their descendants and so on
   std::string generateRecursive(std::string prefix);
 
+  //! Generate the JSON value of this element, an object if it has descendants
+  std::string generateJSONValue(std::string indent);
+
+  //! Recursively generate JSON members from descendant list, and their descendants and so on
+  std::string generateJSONMembers(std::string indent);
+
+  //! Generate time stamped file name with the given extension, the same stamp for all extensions
+  std::string generateFileName(const std::string & extension);
+
 public:
   static OutputFile * allocKeyVal(const std::string & key, const std::string & value);
 
@@ -141,6 +151,15 @@ public:
   */
    void add(const std::string & key, size_t value);
 
+  //! Add a descendant element that has been filled elsewhere
+  /*!
+  The element is added at the end of a list of previously added elements and is
+  deleted with this element.
+
+  @param[in] element The added element
+  */
+  void add(OutputFile * element);
+
   //! Key-Value setter method
   /*!
   Set the key and the value of this element.
@@ -155,6 +174,19 @@ public:
 
   //! Generate output string with results based on the stored key-value hierarchy
   std::string generate(void);
+
+  //! Generate JSON document with results based on the stored key-value hierarchy
+  /*!
+  Elements without descendants become JSON members, elements with descendants
+  become nested objects (their own value, if any, is stored as "value").
+  Keys that occur more than once among siblings become a single member whose
+  value is the array of their values, in the order they were added.
+  Values that parse as numbers are written as JSON numbers, all other values
+  as strings. The document is written to a .json file next to the .txt file.
+
+  @return The JSON document
+  */
+  std::string generateJSON(void);
 };
 
 #endif // OUTPUTFILE_HPP
@@ -0,0 +1,471 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file PerfCounters.cpp
+
+ Linux perf_event hardware counters for host kernels
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include "PerfCounters.hpp"
+
+static const char* counter_names[PERF_NUMBER_OF_COUNTERS] =
+{
+    "cycles",
+    "instructions",
+    "LLC misses",
+    "loads",
+    "stores",
+    "dTLB misses",
+    "DRAM read",
+    "DRAM write"
+};
+
+#ifdef __linux__
+
+#define PERF_SYSFS_PATH "/sys/bus/event_source/devices"
+
+static int perf_event_open(struct perf_event_attr* attr, pid_t pid, int cpu, int group_fd)
+{
+    return (int)syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+static bool read_sysfs(const std::string& path, std::string& value)
+{
+    FILE* f = fopen(path.c_str(), "r");
+
+    if(f == NULL)
+    {
+        return false;
+    }
+
+    char buf[256];
+    bool ok = fgets(buf, sizeof(buf), f) != NULL;
+    fclose(f);
+
+    if(ok)
+    {
+        value = buf;
+        value.erase(value.find_last_not_of(" \n") + 1);
+    }
+
+    return ok;
+}
+
+// Sets a term such as umask=0x03 in the attribute, using the bit range given
+// by the PMU format description, e.g. config:8-15
+static bool set_event_term(const std::string& pmu, const std::string& term, struct perf_event_attr& attr)
+{
+    size_t eq = term.find('=');
+    std::string key = term.substr(0, eq);
+    uint64_t value = eq == std::string::npos ? 1 : strtoull(term.c_str() + eq + 1, NULL, 0);
+
+    std::string format;
+    if(!read_sysfs(pmu + "/format/" + key, format))
+    {
+        return false;
+    }
+
+    size_t colon = format.find(':');
+    std::string field = format.substr(0, colon);
+
+    int lo, hi;
+    int n = sscanf(format.c_str() + colon + 1, "%d-%d", &lo, &hi);
+    if(n < 1)
+    {
+        return false;
+    }
+    if(n == 1)
+    {
+        hi = lo;
+    }
+
+    uint64_t mask = (hi - lo == 63) ? ~0ULL : ((1ULL << (hi - lo + 1)) - 1);
+    uint64_t bits = (value & mask) << lo;
+
+    if(field == "config")       attr.config |= bits;
+    else if(field == "config1") attr.config1 |= bits;
+    else if(field == "config2") attr.config2 |= bits;
+    else return false;
+
+    return true;
+}
+
+// Parses a named uncore event from sysfs and returns its scale to bytes
+static bool parse_uncore_event(const std::string& pmu,
+                               const char* name,
+                               struct perf_event_attr& attr,
+                               double& scale)
+{
+    std::string type, event;
+    if(!read_sysfs(pmu + "/type", type) || !read_sysfs(pmu + "/events/" + name, event))
+    {
+        return false;
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = atoi(type.c_str());
+
+    size_t pos = 0;
+    while(pos < event.size())
+    {
+        size_t end = event.find(',', pos);
+        if(end == std::string::npos)
+        {
+            end = event.size();
+        }
+
+        if(!set_event_term(pmu, event.substr(pos, end - pos), attr))
+        {
+            return false;
+        }
+
+        pos = end + 1;
+    }
+
+    // Each CAS transfers one cache line unless the PMU provides a scale
+    std::string s, unit;
+    scale = 64.0;
+    if(read_sysfs(pmu + "/events/" + name + ".scale", s))
+    {
+        scale = atof(s.c_str());
+
+        if(read_sysfs(pmu + "/events/" + name + ".unit", unit) && unit == "MiB")
+        {
+            scale *= 1048576.0;
+        }
+    }
+
+    return true;
+}
+
+#endif // __linux__
+
+hipHostCounters_t::hipHostCounters_t(void)
+{
+    for(int i = 0; i < PERF_NUMBER_OF_COUNTERS; ++i)
+    {
+        this->available_[i] = false;
+    }
+
+    this->num_available_ = 0;
+    this->status_ = "disabled";
+}
+
+hipHostCounters_t::~hipHostCounters_t(void)
+{
+    this->Clear();
+}
+
+int hipHostCounters_t::Initialize(void)
+{
+    this->Clear();
+
+#ifdef __linux__
+    struct perf_event_attr core[PERF_DRAM_READ_BYTES];
+    memset(core, 0, sizeof(core));
+
+    core[PERF_CYCLES].type          = PERF_TYPE_HARDWARE;
+    core[PERF_CYCLES].config        = PERF_COUNT_HW_CPU_CYCLES;
+    core[PERF_INSTRUCTIONS].type    = PERF_TYPE_HARDWARE;
+    core[PERF_INSTRUCTIONS].config  = PERF_COUNT_HW_INSTRUCTIONS;
+    core[PERF_LLC_MISSES].type      = PERF_TYPE_HARDWARE;
+    core[PERF_LLC_MISSES].config    = PERF_COUNT_HW_CACHE_MISSES;
+    core[PERF_LOADS].type           = PERF_TYPE_HW_CACHE;
+    core[PERF_LOADS].config         = PERF_COUNT_HW_CACHE_L1D
+                                      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                      | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16);
+    core[PERF_STORES].type          = PERF_TYPE_HW_CACHE;
+    core[PERF_STORES].config        = PERF_COUNT_HW_CACHE_L1D
+                                      | (PERF_COUNT_HW_CACHE_OP_WRITE << 8)
+                                      | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16);
+    core[PERF_DTLB_MISSES].type     = PERF_TYPE_HW_CACHE;
+    core[PERF_DTLB_MISSES].config   = PERF_COUNT_HW_CACHE_DTLB
+                                      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    for(int i = 0; i < PERF_DRAM_READ_BYTES; ++i)
+    {
+        core[i].size           = sizeof(struct perf_event_attr);
+        core[i].exclude_kernel = 1;
+        core[i].exclude_hv     = 1;
+        core[i].read_format    = PERF_FORMAT_GROUP
+                                 | PERF_FORMAT_TOTAL_TIME_ENABLED
+                                 | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    }
+
+    // Core counters count the calling thread only, thus each thread opens its own group
+    int nthreads = 1;
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp parallel
+#endif
+    {
+        hipHostCounterGroup_t group;
+        group.leader = -1;
+
+        for(int i = 0; i < PERF_DRAM_READ_BYTES; ++i)
+        {
+            int fd = perf_event_open(&core[i], 0, -1, group.leader);
+
+            if(fd < 0)
+            {
+                continue;
+            }
+
+            if(group.leader < 0)
+            {
+                group.leader = fd;
+            }
+
+            group.fds.push_back(fd);
+            group.counters.push_back(i);
+            group.scales.push_back(1.0);
+        }
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp critical
+#endif
+        {
+#ifndef HPCG_NO_OPENMP
+            nthreads = omp_get_num_threads();
+            bool master = omp_get_thread_num() == 0;
+#else
+            bool master = true;
+#endif
+            // Availability is determined by the master thread
+            if(master)
+            {
+                for(size_t i = 0; i < group.counters.size(); ++i)
+                {
+                    this->available_[group.counters[i]] = true;
+                }
+            }
+
+            if(group.leader >= 0)
+            {
+                this->groups_.push_back(group);
+            }
+        }
+    }
+
+    // Uncore memory controllers, system wide and thus only readable with
+    // perf_event_paranoid <= 0 or CAP_PERFMON
+    int nimc = 0;
+    DIR* dir = opendir(PERF_SYSFS_PATH);
+
+    while(dir != NULL)
+    {
+        struct dirent* entry = readdir(dir);
+
+        if(entry == NULL)
+        {
+            closedir(dir);
+            break;
+        }
+
+        if(strncmp(entry->d_name, "uncore_imc", 10) != 0)
+        {
+            continue;
+        }
+
+        std::string pmu = std::string(PERF_SYSFS_PATH "/") + entry->d_name;
+
+        struct perf_event_attr attr[2];
+        double scale[2];
+        std::string cpumask;
+
+        if(!parse_uncore_event(pmu, "cas_count_read", attr[0], scale[0])
+           || !parse_uncore_event(pmu, "cas_count_write", attr[1], scale[1])
+           || !read_sysfs(pmu + "/cpumask", cpumask))
+        {
+            continue;
+        }
+
+        // One counter per socket, the cpumask lists a representative CPU of each
+        const char* cpus = cpumask.c_str();
+        while(*cpus != '\0')
+        {
+            int cpu = atoi(cpus);
+
+            hipHostCounterGroup_t group;
+            group.leader = -1;
+
+            for(int i = 0; i < 2; ++i)
+            {
+                attr[i].read_format = PERF_FORMAT_GROUP
+                                      | PERF_FORMAT_TOTAL_TIME_ENABLED
+                                      | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                int fd = perf_event_open(&attr[i], -1, cpu, group.leader);
+
+                if(fd < 0)
+                {
+                    break;
+                }
+
+                if(group.leader < 0)
+                {
+                    group.leader = fd;
+                }
+
+                group.fds.push_back(fd);
+                group.counters.push_back(PERF_DRAM_READ_BYTES + i);
+                group.scales.push_back(scale[i]);
+            }
+
+            // Both directions are required
+            if(group.fds.size() == 2)
+            {
+                this->groups_.push_back(group);
+                this->available_[PERF_DRAM_READ_BYTES] = true;
+                this->available_[PERF_DRAM_WRITE_BYTES] = true;
+                ++nimc;
+            }
+            else
+            {
+                for(size_t i = 0; i < group.fds.size(); ++i)
+                {
+                    close(group.fds[i]);
+                }
+            }
+
+            while(*cpus != '\0' && *cpus != ',')
+            {
+                ++cpus;
+            }
+            if(*cpus == ',')
+            {
+                ++cpus;
+            }
+        }
+    }
+
+    this->num_available_ = 0;
+    this->status_.clear();
+
+    for(int i = 0; i < PERF_NUMBER_OF_COUNTERS; ++i)
+    {
+        if(this->available_[i])
+        {
+            this->status_ += this->status_.empty() ? "" : ", ";
+            this->status_ += counter_names[i];
+            ++this->num_available_;
+        }
+    }
+
+    if(this->num_available_ == 0)
+    {
+        std::string paranoid;
+        read_sysfs("/proc/sys/kernel/perf_event_paranoid", paranoid);
+
+        this->status_ = "unavailable (perf_event_paranoid = " + paranoid + ")";
+    }
+    else
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), " (%d threads, %d memory controllers)", nthreads, nimc);
+        this->status_ += buf;
+    }
+#else
+    this->status_ = "unavailable";
+#endif
+
+    return this->num_available_;
+}
+
+void hipHostCounters_t::Clear(void)
+{
+    for(size_t i = 0; i < this->groups_.size(); ++i)
+    {
+        for(size_t j = 0; j < this->groups_[i].fds.size(); ++j)
+        {
+            close(this->groups_[i].fds[j]);
+        }
+    }
+
+    this->groups_.clear();
+
+    for(int i = 0; i < PERF_NUMBER_OF_COUNTERS; ++i)
+    {
+        this->available_[i] = false;
+    }
+
+    this->num_available_ = 0;
+    this->status_ = "disabled";
+}
+
+void hipHostCounters_t::ReadGroup_(const hipHostCounterGroup_t& group, double* values) const
+{
+    // Layout of PERF_FORMAT_GROUP: nr, time enabled, time running, values
+    uint64_t buf[3 + PERF_NUMBER_OF_COUNTERS];
+
+    ssize_t size = (3 + group.fds.size()) * sizeof(uint64_t);
+    if(read(group.leader, buf, size) != size || buf[2] == 0)
+    {
+        return;
+    }
+
+    // Extrapolate if the group was multiplexed
+    double ratio = (double)buf[1] / (double)buf[2];
+
+    for(size_t i = 0; i < group.counters.size(); ++i)
+    {
+        values[group.counters[i]] += buf[3 + i] * ratio * group.scales[i];
+    }
+}
+
+void hipHostCounters_t::Read(double* values) const
+{
+    for(int i = 0; i < PERF_NUMBER_OF_COUNTERS; ++i)
+    {
+        values[i] = 0.0;
+    }
+
+    for(size_t i = 0; i < this->groups_.size(); ++i)
+    {
+        this->ReadGroup_(this->groups_[i], values);
+    }
+}
@@ -0,0 +1,105 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file PerfCounters.hpp
+
+ Linux perf_event hardware counters for host kernels
+ */
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <string>
+#include <vector>
+
+/*!
+  Hardware counters. Core counters are collected per thread and summed over
+  all OpenMP threads of the process. DRAM traffic is read from the uncore
+  memory controllers and covers the whole socket, including other processes.
+ */
+enum PerfCounter
+{
+    PERF_CYCLES = 0,       //!< Core cycles
+    PERF_INSTRUCTIONS,     //!< Retired instructions
+    PERF_LLC_MISSES,       //!< Last level cache misses
+    PERF_LOADS,            //!< L1 data cache read accesses
+    PERF_STORES,           //!< L1 data cache write accesses
+    PERF_DTLB_MISSES,      //!< Data TLB read misses
+    PERF_DRAM_READ_BYTES,  //!< Bytes read from DRAM (uncore)
+    PERF_DRAM_WRITE_BYTES, //!< Bytes written to DRAM (uncore)
+    PERF_NUMBER_OF_COUNTERS
+};
+
+struct hipHostCounterGroup_t
+{
+    int leader;
+    std::vector<int> fds;
+    std::vector<int> counters;
+    std::vector<double> scales;
+};
+
+/*!
+  Set of perf_event counters. Counters that cannot be opened, e.g. because the
+  PMU is not exposed or perf_event_paranoid is too restrictive, are reported
+  as unavailable and read as zero.
+ */
+class hipHostCounters_t
+{
+    public:
+
+    hipHostCounters_t(void);
+    ~hipHostCounters_t(void);
+
+    // Opens all counters that are accessible, returns the number of available counters
+    int Initialize(void);
+    void Clear(void);
+
+    inline bool IsAvailable(int counter) const { return this->available_[counter]; }
+    inline bool IsAnyAvailable(void) const { return this->num_available_ > 0; }
+
+    // Reads the current values of all counters
+    void Read(double* values) const;
+
+    // Short description of the counter setup
+    inline const std::string& GetStatus(void) const { return this->status_; }
+
+    private:
+
+    void ReadGroup_(const hipHostCounterGroup_t& group, double* values) const;
+
+    bool available_[PERF_NUMBER_OF_COUNTERS];
+    int num_available_;
+
+    // One group of core counters per thread and one group per uncore PMU
+    std::vector<hipHostCounterGroup_t> groups_;
+
+    std::string status_;
+};
+
+#endif // PERFCOUNTERS_HPP
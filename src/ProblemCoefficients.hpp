@@ -0,0 +1,184 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+
+/*!
+ @file ProblemCoefficients.hpp
+
+ Matrix coefficients of the generated 27-point problems
+ */
+
+#ifndef PROBLEMCOEFFICIENTS_HPP
+#define PROBLEMCOEFFICIENTS_HPP
+
+#include <cmath>
+
+#include "Geometry.hpp"
+#include "hpcg.hpp"
+
+// Coupling strength of pure z neighbors for the anisotropic problem
+#define HPCG_ANISOTROPY 100.0
+
+/*!
+  Problem types that can be generated. All of them share the 27-point sparsity
+  pattern of the HPCG problem and are symmetric and diagonally dominant.
+ */
+enum ProblemType
+{
+    HPCG_PROBLEM_LAPLACE = 0, //!< Reference HPCG problem, 26 on the diagonal and -1 off-diagonal
+    HPCG_PROBLEM_VARCOEF = 1, //!< Variable coefficient diffusion with a smooth, high contrast coefficient field
+    HPCG_PROBLEM_ANISO   = 2  //!< Anisotropic problem with strong coupling in z direction
+};
+
+/*!
+  Diffusion coefficient of the cell at global grid point (gix, giy, giz). The
+  field is defined on the unit cube, such that all multigrid levels see the same
+  coefficients. Its contrast is roughly 1:100.
+ */
+HPCG_HOST_DEVICE inline double CellCoefficient(global_int_t gix,
+                                               global_int_t giy,
+                                               global_int_t giz,
+                                               global_int_t gnx,
+                                               global_int_t gny,
+                                               global_int_t gnz)
+{
+    const double two_pi = 6.283185307179586;
+
+    double x = (gix + 0.5) / gnx;
+    double y = (giy + 0.5) / gny;
+    double z = (giz + 0.5) / gnz;
+
+    return exp(2.3 * sin(two_pi * x) * sin(two_pi * y) * sin(two_pi * z));
+}
+
+/*!
+  Coupling strength between the grid point (gix, giy, giz) and its neighbor at
+  offset (sx, sy, sz). The corresponding off-diagonal matrix entry is the negative
+  coupling strength. Couplings are symmetric, e.g. the coupling from a point to
+  its neighbor equals the coupling from the neighbor back to the point.
+ */
+HPCG_HOST_DEVICE inline double ComputeCoupling(int problem,
+                                               global_int_t gix,
+                                               global_int_t giy,
+                                               global_int_t giz,
+                                               int sx,
+                                               int sy,
+                                               int sz,
+                                               global_int_t gnx,
+                                               global_int_t gny,
+                                               global_int_t gnz)
+{
+    if(problem == HPCG_PROBLEM_VARCOEF)
+    {
+        return 0.5 * (CellCoefficient(gix, giy, giz, gnx, gny, gnz)
+                    + CellCoefficient(gix + sx, giy + sy, giz + sz, gnx, gny, gnz));
+    }
+    else if(problem == HPCG_PROBLEM_ANISO)
+    {
+        return (sx == 0 && sy == 0) ? HPCG_ANISOTROPY : 1.0;
+    }
+
+    return 1.0;
+}
+
+/*!
+  Diagonal entry of the row that belongs to grid point (gix, giy, giz). As in
+  the reference problem, the diagonal is the sum of the couplings to all 26
+  neighbors, including those that lie outside of the domain. Thus, boundary
+  rows are strictly diagonally dominant.
+ */
+HPCG_HOST_DEVICE inline double ComputeDiagonal(int problem,
+                                               global_int_t gix,
+                                               global_int_t giy,
+                                               global_int_t giz,
+                                               global_int_t gnx,
+                                               global_int_t gny,
+                                               global_int_t gnz)
+{
+    if(problem == HPCG_PROBLEM_LAPLACE)
+    {
+        return 26.0;
+    }
+
+    double diag = 0.0;
+
+    for(int sz = -1; sz <= 1; ++sz)
+    {
+        for(int sy = -1; sy <= 1; ++sy)
+        {
+            for(int sx = -1; sx <= 1; ++sx)
+            {
+                if(sx != 0 || sy != 0 || sz != 0)
+                {
+                    diag += ComputeCoupling(problem, gix, giy, giz, sx, sy, sz, gnx, gny, gnz);
+                }
+            }
+        }
+    }
+
+    return diag;
+}
+
+/*!
+  Right hand side entry of the row that belongs to grid point (gix, giy, giz),
+  such that the exact solution is one, e.g. the row sum of the matrix.
+ */
+HPCG_HOST_DEVICE inline double ComputeRowSum(int problem,
+                                             global_int_t gix,
+                                             global_int_t giy,
+                                             global_int_t giz,
+                                             global_int_t gnx,
+                                             global_int_t gny,
+                                             global_int_t gnz)
+{
+    double sum = ComputeDiagonal(problem, gix, giy, giz, gnx, gny, gnz);
+
+    for(int sz = -1; sz <= 1; ++sz)
+    {
+        if(giz + sz < 0 || giz + sz >= gnz) continue;
+
+        for(int sy = -1; sy <= 1; ++sy)
+        {
+            if(giy + sy < 0 || giy + sy >= gny) continue;
+
+            for(int sx = -1; sx <= 1; ++sx)
+            {
+                if(gix + sx < 0 || gix + sx >= gnx) continue;
+
+                if(sx != 0 || sy != 0 || sz != 0)
+                {
+                    sum -= ComputeCoupling(problem, gix, giy, giz, sx, sy, sz, gnx, gny, gnz);
+                }
+            }
+        }
+    }
+
+    return sum;
+}
+
+#endif // PROBLEMCOEFFICIENTS_HPP
@@ -0,0 +1,587 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+
+/*!
+ @file Profiler.cpp
+
+ Runtime profiling of kernels and communication
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cstdio>
+#include <string>
+
+#include "utils.hpp"
+#include "mytimer.hpp"
+#include "OutputFile.hpp"
+#include "Profiler.hpp"
+
+// Number of event pairs that are allocated at once
+#define PROFILE_POOL_SIZE 1024
+
+// Maximum nesting depth of regions
+#define PROFILE_MAX_DEPTH 64
+
+static const char* region_names[PROFILE_NUMBER_OF_REGIONS] =
+{
+    "MG",
+    "SYMGS",
+    "SYMGS forward sweep",
+    "SYMGS backward sweep",
+    "SpMV",
+    "Restriction",
+    "Prolongation",
+    "DDOT",
+    "WAXPBY",
+    "Fused WAXPBY and DDOT",
+    "DDOT (reproducible)",
+    "Fused WAXPBY and DDOT (reproducible)",
+    "Halo pack",
+    "Halo send",
+    "Halo wait",
+    "Allreduce",
+    "MG (reference)",
+    "SYMGS (reference)",
+    "SpMV (reference)"
+};
+
+static const bool region_on_device[PROFILE_NUMBER_OF_REGIONS] =
+{
+    true,  // MG
+    true,  // SYMGS
+    true,  // SYMGS forward sweep
+    true,  // SYMGS backward sweep
+    true,  // SpMV
+    true,  // Restriction
+    true,  // Prolongation
+    true,  // DDOT
+    true,  // WAXPBY
+    true,  // Fused WAXPBY and DDOT
+    true,  // DDOT (reproducible)
+    true,  // Fused WAXPBY and DDOT (reproducible)
+    true,  // Halo pack
+    false, // Halo send
+    false, // Halo wait
+    false, // Allreduce
+    false, // MG (reference)
+    false, // SYMGS (reference)
+    false  // SpMV (reference)
+};
+
+// Reference regions collect hardware counters and survive Reset()
+static const bool region_is_reference[PROFILE_NUMBER_OF_REGIONS] =
+{
+    false, // MG
+    false, // SYMGS
+    false, // SYMGS forward sweep
+    false, // SYMGS backward sweep
+    false, // SpMV
+    false, // Restriction
+    false, // Prolongation
+    false, // DDOT
+    false, // WAXPBY
+    false, // Fused WAXPBY and DDOT
+    false, // DDOT (reproducible)
+    false, // Fused WAXPBY and DDOT (reproducible)
+    false, // Halo pack
+    false, // Halo send
+    false, // Halo wait
+    false, // Allreduce
+    true,  // MG (reference)
+    true,  // SYMGS (reference)
+    true   // SpMV (reference)
+};
+
+hipProfiler_t::hipProfiler_t(void)
+{
+    this->enabled_ = false;
+    this->overhead_ = 0.0;
+}
+
+hipProfiler_t::~hipProfiler_t(void)
+{
+    this->Clear();
+}
+
+hipError_t hipProfiler_t::Initialize(bool enabled)
+{
+    this->enabled_ = enabled;
+
+    if(enabled == false)
+    {
+        return hipSuccess;
+    }
+
+    this->stack_.reserve(PROFILE_MAX_DEPTH);
+    this->nodes_.reserve(256);
+
+    // Event pool, timing is required
+    this->records_.resize(PROFILE_POOL_SIZE);
+
+    for(int i = 0; i < PROFILE_POOL_SIZE; ++i)
+    {
+        RETURN_IF_HIP_ERROR(hipEventCreate(&this->records_[i].start));
+        RETURN_IF_HIP_ERROR(hipEventCreate(&this->records_[i].stop));
+
+        this->free_.push_back(PROFILE_POOL_SIZE - 1 - i);
+    }
+
+    this->pending_.reserve(PROFILE_POOL_SIZE);
+
+    // Hardware counters are optional
+    this->counters_.Initialize();
+
+    return hipSuccess;
+}
+
+hipError_t hipProfiler_t::Clear(void)
+{
+    for(size_t i = 0; i < this->records_.size(); ++i)
+    {
+        RETURN_IF_HIP_ERROR(hipEventDestroy(this->records_[i].start));
+        RETURN_IF_HIP_ERROR(hipEventDestroy(this->records_[i].stop));
+    }
+
+    this->records_.clear();
+    this->free_.clear();
+    this->pending_.clear();
+    this->stack_.clear();
+    this->nodes_.clear();
+    this->roots_.clear();
+
+    this->counters_.Clear();
+
+    this->enabled_ = false;
+
+    return hipSuccess;
+}
+
+hipError_t hipProfiler_t::Reset(void)
+{
+    assert(this->stack_.empty());
+
+    // Wait for outstanding events, their results are discarded
+    RETURN_IF_HIP_ERROR(this->Flush());
+
+    std::vector<hipProfileNode_t> nodes;
+    std::vector<int> roots;
+
+    nodes.swap(this->nodes_);
+    roots.swap(this->roots_);
+
+    // Keep the reference regions
+    for(size_t i = 0; i < roots.size(); ++i)
+    {
+        if(region_is_reference[nodes[roots[i]].region])
+        {
+            this->roots_.push_back(this->KeepNode_(nodes, roots[i]));
+        }
+    }
+
+    this->overhead_ = 0.0;
+
+    return hipSuccess;
+}
+
+int hipProfiler_t::KeepNode_(const std::vector<hipProfileNode_t>& nodes, int node)
+{
+    int index = this->nodes_.size();
+
+    this->nodes_.push_back(nodes[node]);
+    this->nodes_[index].children.clear();
+
+    for(size_t i = 0; i < nodes[node].children.size(); ++i)
+    {
+        int child = this->KeepNode_(nodes, nodes[node].children[i]);
+        this->nodes_[index].children.push_back(child);
+    }
+
+    return index;
+}
+
+hipError_t hipProfiler_t::Flush(void)
+{
+    for(size_t i = 0; i < this->pending_.size(); ++i)
+    {
+        hipProfileRecord_t& rec = this->records_[this->pending_[i]];
+
+        float ms;
+        RETURN_IF_HIP_ERROR(hipEventSynchronize(rec.stop));
+        RETURN_IF_HIP_ERROR(hipEventElapsedTime(&ms, rec.start, rec.stop));
+
+        this->Accumulate_(rec.node, ms * 1e-3, rec.bytes);
+        this->free_.push_back(this->pending_[i]);
+    }
+
+    this->pending_.clear();
+
+    return hipSuccess;
+}
+
+int hipProfiler_t::AcquireRecord_(void)
+{
+    // Resolve finished regions if the pool is exhausted
+    if(this->free_.empty())
+    {
+        HIP_CHECK(this->Flush());
+    }
+
+    // All events belong to open regions, grow the pool
+    if(this->free_.empty())
+    {
+        size_t size = this->records_.size();
+        this->records_.resize(size + PROFILE_POOL_SIZE);
+
+        for(size_t i = size; i < this->records_.size(); ++i)
+        {
+            HIP_CHECK(hipEventCreate(&this->records_[i].start));
+            HIP_CHECK(hipEventCreate(&this->records_[i].stop));
+
+            this->free_.push_back(i);
+        }
+    }
+
+    int rec = this->free_.back();
+    this->free_.pop_back();
+
+    return rec;
+}
+
+void hipProfiler_t::Accumulate_(int node, double time, double bytes)
+{
+    hipProfileNode_t& n = this->nodes_[node];
+
+    ++n.calls;
+    n.time += time;
+    n.bytes += bytes;
+    n.min_time = std::min(n.min_time, time);
+    n.max_time = std::max(n.max_time, time);
+}
+
+void hipProfiler_t::Begin_(int region, int level, hipStream_t stream)
+{
+    assert(region >= 0 && region < PROFILE_NUMBER_OF_REGIONS);
+
+    ScopedTimer timer(this->overhead_);
+
+    // Children of the currently open region
+    std::vector<int>* children = this->stack_.empty() ? &this->roots_
+                                                      : &this->nodes_[this->stack_.back().node].children;
+
+    // Look up node, there are only a few children per node
+    int node = -1;
+
+    for(size_t i = 0; i < children->size(); ++i)
+    {
+        const hipProfileNode_t& n = this->nodes_[(*children)[i]];
+
+        if(n.region == region && n.level == level)
+        {
+            node = (*children)[i];
+            break;
+        }
+    }
+
+    // First call of this region in the current context
+    if(node == -1)
+    {
+        hipProfileNode_t n;
+
+        n.region = region;
+        n.level = level;
+        n.calls = 0;
+        n.time = 0.0;
+        n.min_time = DBL_MAX;
+        n.max_time = 0.0;
+        n.bytes = 0.0;
+        n.counted = false;
+
+        for(int i = 0; i < PERF_NUMBER_OF_COUNTERS; ++i)
+        {
+            n.counters[i] = 0.0;
+        }
+
+        node = this->nodes_.size();
+
+        // Register the child first, as growing nodes_ invalidates children
+        children->push_back(node);
+        this->nodes_.push_back(n);
+    }
+
+    hipProfileFrame_t frame;
+
+    frame.node = node;
+    frame.record = -1;
+    frame.stream = stream;
+    frame.start = 0.0;
+
+    if(region_on_device[region])
+    {
+        frame.record = this->AcquireRecord_();
+        HIP_CHECK(hipEventRecord(this->records_[frame.record].start, stream));
+    }
+    else
+    {
+        if(region_is_reference[region] && this->counters_.IsAnyAvailable())
+        {
+            this->counters_.Read(frame.counters);
+        }
+
+        frame.start = mytimer();
+    }
+
+    this->stack_.push_back(frame);
+}
+
+void hipProfiler_t::End_(double bytes)
+{
+    assert(!this->stack_.empty());
+
+    ScopedTimer timer(this->overhead_);
+
+    hipProfileFrame_t frame = this->stack_.back();
+    this->stack_.pop_back();
+
+    if(frame.record >= 0)
+    {
+        hipProfileRecord_t& rec = this->records_[frame.record];
+
+        HIP_CHECK(hipEventRecord(rec.stop, frame.stream));
+
+        rec.node = frame.node;
+        rec.bytes = bytes;
+
+        this->pending_.push_back(frame.record);
+    }
+    else
+    {
+        this->Accumulate_(frame.node, mytimer() - frame.start, bytes);
+
+        hipProfileNode_t& n = this->nodes_[frame.node];
+
+        if(region_is_reference[n.region] && this->counters_.IsAnyAvailable())
+        {
+            double counters[PERF_NUMBER_OF_COUNTERS];
+            this->counters_.Read(counters);
+
+            for(int i = 0; i < PERF_NUMBER_OF_COUNTERS; ++i)
+            {
+                n.counters[i] += counters[i] - frame.counters[i];
+            }
+
+            n.counted = true;
+        }
+    }
+}
+
+bool hipProfiler_t::GetRegion(int region, int level, long long& calls, double& time, double* counters)
+{
+    HIP_CHECK(this->Flush());
+
+    calls = 0;
+    time = 0.0;
+
+    for(int i = 0; i < PERF_NUMBER_OF_COUNTERS; ++i)
+    {
+        counters[i] = 0.0;
+    }
+
+    for(size_t i = 0; i < this->nodes_.size(); ++i)
+    {
+        const hipProfileNode_t& n = this->nodes_[i];
+
+        if(n.region == region && n.level == level)
+        {
+            calls += n.calls;
+            time += n.time;
+
+            for(int j = 0; j < PERF_NUMBER_OF_COUNTERS; ++j)
+            {
+                counters[j] += n.counters[j];
+            }
+        }
+    }
+
+    return calls > 0;
+}
+
+void hipProfiler_t::ReportNode_(OutputFile* parent, int node)
+{
+    const hipProfileNode_t& n = this->nodes_[node];
+
+    char key[64];
+    snprintf(key, sizeof(key), "%s level %d", region_names[n.region], n.level);
+
+    parent->add(key, "");
+    OutputFile* entry = parent->get(key);
+
+    entry->add("Calls", n.calls);
+    entry->add("Total time", n.time);
+    entry->add("Min time", n.min_time);
+    entry->add("Avg time", n.time / n.calls);
+    entry->add("Max time", n.max_time);
+
+    if(n.bytes > 0.0)
+    {
+        entry->add("GB/s", n.bytes / n.time / 1e9);
+    }
+
+    if(n.counted)
+    {
+        const hipHostCounters_t& c = this->counters_;
+
+        if(c.IsAvailable(PERF_CYCLES) && c.IsAvailable(PERF_INSTRUCTIONS))
+        {
+            entry->add("IPC", n.counters[PERF_INSTRUCTIONS] / n.counters[PERF_CYCLES]);
+        }
+        if(c.IsAvailable(PERF_LLC_MISSES))
+        {
+            entry->add("LLC misses per call", n.counters[PERF_LLC_MISSES] / n.calls);
+        }
+        if(c.IsAvailable(PERF_LOADS))
+        {
+            entry->add("Loads per call", n.counters[PERF_LOADS] / n.calls);
+        }
+        if(c.IsAvailable(PERF_STORES))
+        {
+            entry->add("Stores per call", n.counters[PERF_STORES] / n.calls);
+        }
+        if(c.IsAvailable(PERF_DTLB_MISSES))
+        {
+            entry->add("dTLB misses per call", n.counters[PERF_DTLB_MISSES] / n.calls);
+        }
+        if(c.IsAvailable(PERF_DRAM_READ_BYTES))
+        {
+            entry->add("DRAM GB/s", (n.counters[PERF_DRAM_READ_BYTES] + n.counters[PERF_DRAM_WRITE_BYTES]) / n.time / 1e9);
+        }
+    }
+
+    for(size_t i = 0; i < n.children.size(); ++i)
+    {
+        this->ReportNode_(entry, n.children[i]);
+    }
+}
+
+void hipProfiler_t::Report(OutputFile& doc)
+{
+    if(this->enabled_ == false)
+    {
+        return;
+    }
+
+    HIP_CHECK(this->Flush());
+
+    doc.add("Profiling Summary (times in sec)", "");
+    OutputFile* summary = doc.get("Profiling Summary (times in sec)");
+
+    summary->add("Hardware counters", this->counters_.GetStatus());
+    summary->add("Host time in Begin / End", this->overhead_);
+
+    for(size_t i = 0; i < this->roots_.size(); ++i)
+    {
+        this->ReportNode_(summary, this->roots_[i]);
+    }
+}
+
+void hipProfiler_t::PrintNode_(int node, int depth)
+{
+    const hipProfileNode_t& n = this->nodes_[node];
+
+    char name[64];
+    snprintf(name, sizeof(name), "%*s%s (%d)", 2 * depth, "", region_names[n.region], n.level);
+
+    printf("%-36s %10lld %12.6lf %12.3lf %12.3lf %12.3lf",
+           name,
+           n.calls,
+           n.time,
+           n.min_time * 1e6,
+           n.time / n.calls * 1e6,
+           n.max_time * 1e6);
+
+    if(n.bytes > 0.0)
+    {
+        printf(" %10.1lf", n.bytes / n.time / 1e9);
+    }
+    else
+    {
+        printf(" %10s", "");
+    }
+
+    if(n.counted && n.counters[PERF_CYCLES] > 0.0)
+    {
+        printf(" %6.2lf", n.counters[PERF_INSTRUCTIONS] / n.counters[PERF_CYCLES]);
+    }
+
+    printf("\n");
+
+    for(size_t i = 0; i < n.children.size(); ++i)
+    {
+        this->PrintNode_(n.children[i], depth + 1);
+    }
+}
+
+void hipProfiler_t::Print(void)
+{
+    if(this->enabled_ == false)
+    {
+        return;
+    }
+
+    HIP_CHECK(this->Flush());
+
+    printf("\n%-36s %10s %12s %12s %12s %12s %10s %6s\n",
+           "Region (level)",
+           "Calls",
+           "Total [s]",
+           "Min [us]",
+           "Avg [us]",
+           "Max [us]",
+           "GB/s",
+           "IPC");
+
+    for(size_t i = 0; i < this->roots_.size(); ++i)
+    {
+        this->PrintNode_(this->roots_[i], 0);
+    }
+
+    printf("\nHost time in Begin / End: %0.6lf s\n", this->overhead_);
+}
+
+hipProfileScope_t::hipProfileScope_t(int region, int level, double bytes, hipStream_t stream)
+{
+    this->bytes_ = bytes;
+    profiler.Begin(region, level, stream);
+}
+
+hipProfileScope_t::~hipProfileScope_t(void)
+{
+    profiler.End(this->bytes_);
+}
@@ -0,0 +1,214 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+
+/*!
+ @file Profiler.hpp
+
+ Runtime profiling of kernels and communication
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <vector>
+#include <hip/hip_runtime_api.h>
+
+#include "PerfCounters.hpp"
+
+class OutputFile;
+
+/*!
+  Profiled regions. Device regions are timed using HIP events on the default
+  stream, such that the host is not synchronized. Host regions (e.g. MPI calls)
+  are timed on the host. Reference kernels run on the host and additionally
+  collect hardware counters, if available.
+ */
+enum ProfileRegion
+{
+    PROFILE_MG = 0,                 //!< Multigrid V-cycle of one level (device)
+    PROFILE_SYMGS,                  //!< Symmetric Gauss-Seidel smoother (device)
+    PROFILE_SYMGS_FORWARD,          //!< Forward sweep of the smoother (device)
+    PROFILE_SYMGS_BACKWARD,         //!< Backward sweep of the smoother (device)
+    PROFILE_SPMV,                   //!< Sparse matrix vector product (device)
+    PROFILE_RESTRICTION,            //!< Fused residual and restriction (device)
+    PROFILE_PROLONGATION,           //!< Prolongation (device)
+    PROFILE_DOT,                    //!< Dot product including reduction (device)
+    PROFILE_WAXPBY,                 //!< Vector update (device)
+    PROFILE_FUSED_WAXPBY_DOT,       //!< Fused vector update and dot product (device)
+    PROFILE_DOT_REPRO,              //!< Reproducible dot product including reduction (device)
+    PROFILE_FUSED_WAXPBY_DOT_REPRO, //!< Fused vector update and reproducible dot product (device)
+    PROFILE_HALO_PACK,              //!< Gather of the send buffer (device)
+    PROFILE_HALO_SEND,              //!< Posting of halo receives and sends (host)
+    PROFILE_HALO_WAIT,              //!< Completion of halo communication (host)
+    PROFILE_ALLREDUCE,              //!< MPI_Allreduce (host)
+    PROFILE_MG_REF,                 //!< Reference multigrid V-cycle of one level (host)
+    PROFILE_SYMGS_REF,              //!< Reference symmetric Gauss-Seidel smoother (host)
+    PROFILE_SPMV_REF,               //!< Reference sparse matrix vector product (host)
+    PROFILE_NUMBER_OF_REGIONS
+};
+
+struct hipProfileNode_t
+{
+    int region;
+    int level;
+    std::vector<int> children;
+
+    long long calls;
+    double time;
+    double min_time;
+    double max_time;
+    double bytes;
+
+    bool counted;
+    double counters[PERF_NUMBER_OF_COUNTERS];
+};
+
+struct hipProfileRecord_t
+{
+    int node;
+    double bytes;
+    hipEvent_t start;
+    hipEvent_t stop;
+};
+
+struct hipProfileFrame_t
+{
+    int node;
+    int record;
+    hipStream_t stream;
+    double start;
+    double counters[PERF_NUMBER_OF_COUNTERS];
+};
+
+/*!
+  Hierarchical profiling registry. Regions are identified by their type and
+  multigrid level and are nested according to the order in which they are
+  entered, e.g. SYMGS on level 1 shows up below MG level 1, which in turn shows
+  up below MG level 0.
+
+  The profiler is disabled by default and Begin / End return immediately. When
+  enabled, device regions record a pair of events on the stream their work
+  runs on, which are resolved lazily when the event pool runs full or results
+  are requested. The default stream is the legacy null stream, which waits for
+  all streams, thus regions that only run on one of the blocking streams have
+  to pass it, otherwise they serialize it with the other streams.
+
+  Reference regions only run during validation, before the benchmark phase.
+  They are thus kept when the profiler is reset.
+ */
+class hipProfiler_t
+{
+    public:
+
+    hipProfiler_t(void);
+    ~hipProfiler_t(void);
+
+    hipError_t Initialize(bool enabled);
+    hipError_t Clear(void);
+
+    // Discards all collected data, except for reference regions
+    hipError_t Reset(void);
+
+    // Resolves all pending device timings
+    hipError_t Flush(void);
+
+    inline bool IsEnabled(void) const { return this->enabled_; }
+
+    inline void Begin(int region, int level, hipStream_t stream = 0)
+    {
+        if(this->enabled_) this->Begin_(region, level, stream);
+    }
+
+    inline void End(double bytes)
+    {
+        if(this->enabled_) this->End_(bytes);
+    }
+
+    // Sums calls, time and hardware counters of all nodes of a region and level,
+    // returns false if the region has not been called
+    bool GetRegion(int region, int level, long long& calls, double& time, double* counters);
+
+    inline const hipHostCounters_t& GetCounters(void) const { return this->counters_; }
+
+    // Adds the profiling summary to a YAML document
+    void Report(OutputFile& doc);
+
+    // Prints the profiling summary to stdout
+    void Print(void);
+
+    private:
+
+    void Begin_(int region, int level, hipStream_t stream);
+    void End_(double bytes);
+
+    int AcquireRecord_(void);
+    void Accumulate_(int node, double time, double bytes);
+
+    int KeepNode_(const std::vector<hipProfileNode_t>& nodes, int node);
+
+    void ReportNode_(OutputFile* parent, int node);
+    void PrintNode_(int node, int depth);
+
+    bool enabled_;
+
+    // Host time spent in Begin / End since the last reset
+    double overhead_;
+
+    // Nodes of the region tree
+    std::vector<hipProfileNode_t> nodes_;
+    std::vector<int> roots_;
+
+    // Currently open regions
+    std::vector<hipProfileFrame_t> stack_;
+
+    // Hardware counters of host regions
+    hipHostCounters_t counters_;
+
+    // Event pool
+    std::vector<hipProfileRecord_t> records_;
+    std::vector<int> free_;
+    std::vector<int> pending_;
+};
+
+/*!
+  Scoped profiling region, the region ends when the object goes out of scope.
+ */
+class hipProfileScope_t
+{
+    public:
+
+    hipProfileScope_t(int region, int level, double bytes = 0.0, hipStream_t stream = 0);
+    ~hipProfileScope_t(void);
+
+    private:
+
+    double bytes_;
+};
+
+#endif // PROFILER_HPP
@@ -0,0 +1,724 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ReadMatrixMarket.cpp
+
+ HPCG routine
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#include <numa.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <hip/hip_runtime_api.h>
+
+#include "utils.hpp"
+#include "hpcg.hpp"
+#include "mytimer.hpp"
+#include "SetupHalo_ref.hpp"
+#include "ReadMatrixMarket.hpp"
+
+// Size of the chunks that are read by each process
+#define MTX_CHUNK_SIZE (16 << 20)
+
+struct MatrixMarketHeader
+{
+    global_int_t nrows;
+    global_int_t ncols;
+    global_int_t nnz;
+    long long data_offset; //!< Byte offset of the first entry
+    long long file_size;
+    int symmetric;
+    int pattern;
+};
+
+struct MatrixMarketEntry
+{
+    global_int_t row;
+    global_int_t col;
+    double val;
+};
+
+static bool operator<(const MatrixMarketEntry& a, const MatrixMarketEntry& b)
+{
+    return a.row < b.row || (a.row == b.row && a.col < b.col);
+}
+
+// Combines the error flags of all processes, such that all processes bail out together
+static int GlobalError(int ierr)
+{
+#ifndef HPCG_NO_MPI
+    int gerr = 0;
+    MPI_Allreduce(&ierr, &gerr, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    return gerr;
+#else
+    return ierr;
+#endif
+}
+
+/*!
+  Parses the banner and size line of a MatrixMarket file. Only real or integer
+  coordinate matrices (general or symmetric) are supported.
+
+  @param[in]  filename Name of the MatrixMarket file
+  @param[out] header   The parsed header
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int ParseMatrixMarketHeader(const char* filename, MatrixMarketHeader& header)
+{
+    FILE* f = fopen(filename, "r");
+
+    if(f == NULL)
+    {
+        return -1;
+    }
+
+    char line[1024];
+    char object[64], format[64], field[64], symmetry[64];
+
+    if(fgets(line, sizeof(line), f) == NULL
+       || sscanf(line, "%%%%MatrixMarket %63s %63s %63s %63s", object, format, field, symmetry) != 4
+       || strcasecmp(object, "matrix") != 0
+       || strcasecmp(format, "coordinate") != 0)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    if(strcasecmp(field, "real") != 0 && strcasecmp(field, "integer") != 0 && strcasecmp(field, "pattern") != 0)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    if(strcasecmp(symmetry, "general") != 0 && strcasecmp(symmetry, "symmetric") != 0)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    header.pattern = strcasecmp(field, "pattern") == 0;
+    header.symmetric = strcasecmp(symmetry, "symmetric") == 0;
+
+    // Skip comments
+    do
+    {
+        if(fgets(line, sizeof(line), f) == NULL)
+        {
+            fclose(f);
+            return -1;
+        }
+    } while(line[0] == '%');
+
+    long long nrows, ncols, nnz;
+    if(sscanf(line, "%lld %lld %lld", &nrows, &ncols, &nnz) != 3 || nrows != ncols || nrows <= 0)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    header.nrows = nrows;
+    header.ncols = ncols;
+    header.nnz = nnz;
+    header.data_offset = ftell(f);
+
+    fseek(f, 0, SEEK_END);
+    header.file_size = ftell(f);
+
+    fclose(f);
+
+    return 0;
+}
+
+/*!
+  Reads the header of a MatrixMarket file on rank 0 and broadcasts it to all
+  processes.
+
+  @param[in]  filename Name of the MatrixMarket file
+  @param[out] header   The parsed header
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int BroadcastMatrixMarketHeader(const char* filename, MatrixMarketHeader& header)
+{
+    int rank = 0;
+#ifndef HPCG_NO_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+    int ierr = 0;
+    if(rank == 0)
+    {
+        ierr = ParseMatrixMarketHeader(filename, header);
+    }
+
+#ifndef HPCG_NO_MPI
+    MPI_Bcast(&ierr, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&header, sizeof(MatrixMarketHeader), MPI_BYTE, 0, MPI_COMM_WORLD);
+#endif
+
+    return ierr;
+}
+
+/*!
+  Reads the size of the matrix stored in a MatrixMarket file.
+
+  @param[in]  filename Name of the MatrixMarket file
+  @param[out] nrows    Number of rows (and columns) of the matrix
+  @param[out] nnz      Number of entries stored in the file
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int ReadMatrixMarketHeader(const char* filename, global_int_t& nrows, global_int_t& nnz)
+{
+    MatrixMarketHeader header;
+    RETURN_IF_HPCG_ERROR(BroadcastMatrixMarketHeader(filename, header));
+
+    nrows = header.nrows;
+    nnz = header.nnz;
+
+    return 0;
+}
+
+/*!
+  Parses a single entry line. Symmetric files only store the lower triangular
+  part, thus the transposed entry is added as well.
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int ParseMatrixMarketLine(const char* line,
+                                 const char* end,
+                                 const MatrixMarketHeader& header,
+                                 std::vector<MatrixMarketEntry>& entries)
+{
+    // Skip blank lines and comments
+    while(line < end && (*line == ' ' || *line == '\t' || *line == '\r'))
+    {
+        ++line;
+    }
+
+    if(line == end || *line == '%')
+    {
+        return 0;
+    }
+
+    char* pos;
+    MatrixMarketEntry entry;
+
+    entry.row = strtoll(line, &pos, 10) - 1;
+    entry.col = strtoll(pos, &pos, 10) - 1;
+    entry.val = header.pattern ? 1.0 : strtod(pos, &pos);
+
+    if(pos > end || entry.row < 0 || entry.row >= header.nrows || entry.col < 0 || entry.col >= header.ncols)
+    {
+        return -1;
+    }
+
+    entries.push_back(entry);
+
+    if(header.symmetric && entry.row != entry.col)
+    {
+        std::swap(entry.row, entry.col);
+        entries.push_back(entry);
+    }
+
+    return 0;
+}
+
+/*!
+  Streams the part of the MatrixMarket file that is assigned to this process.
+  The data section of the file is split into equally sized byte ranges and
+  each process parses all lines that start within its range.
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int ParseMatrixMarketEntries(const char* filename,
+                                    const MatrixMarketHeader& header,
+                                    int rank,
+                                    int size,
+                                    std::vector<MatrixMarketEntry>& entries)
+{
+    int fd = open(filename, O_RDONLY);
+
+    if(fd < 0)
+    {
+        return -1;
+    }
+
+    long long data_size = header.file_size - header.data_offset;
+    long long begin = header.data_offset + data_size * rank / size;
+    long long end = header.data_offset + data_size * (rank + 1) / size;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, begin, end - begin, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    // Expected number of entries
+    entries.reserve((header.symmetric ? 2 : 1) * header.nnz / size + 1);
+
+    std::vector<char> buffer(MTX_CHUNK_SIZE);
+    std::string pending;
+
+    // File offset of the first byte of pending
+    long long line_start = begin;
+
+    // Lines that start before begin belong to the previous process
+    bool skip_first = false;
+    if(begin > header.data_offset)
+    {
+        char c;
+        if(pread(fd, &c, 1, begin - 1) != 1)
+        {
+            close(fd);
+            return -1;
+        }
+
+        skip_first = (c != '\n');
+    }
+
+    int ierr = 0;
+    long long pos = begin;
+
+    while(ierr == 0 && line_start < end && pos < header.file_size)
+    {
+        ssize_t nread = pread(fd, buffer.data(), MTX_CHUNK_SIZE, pos);
+
+        if(nread <= 0)
+        {
+            ierr = -1;
+            break;
+        }
+
+        const char* chunk = buffer.data();
+        const char* chunk_end = chunk + nread;
+        const char* cur = chunk;
+
+        while(cur < chunk_end && line_start < end)
+        {
+            const char* nl = static_cast<const char*>(memchr(cur, '\n', chunk_end - cur));
+
+            if(nl == NULL)
+            {
+                // Incomplete line, continue with the next chunk
+                pending.append(cur, chunk_end - cur);
+                break;
+            }
+
+            long long line_length = pending.size() + (nl - cur) + 1;
+
+            if(skip_first)
+            {
+                skip_first = false;
+            }
+            else if(pending.empty())
+            {
+                ierr |= ParseMatrixMarketLine(cur, nl, header, entries);
+            }
+            else
+            {
+                pending.append(cur, nl - cur);
+                ierr |= ParseMatrixMarketLine(pending.data(), pending.data() + pending.size(), header, entries);
+            }
+
+            line_start += line_length;
+            pending.clear();
+            cur = nl + 1;
+        }
+
+        pos += nread;
+    }
+
+    // Last line of the file might not be terminated
+    if(ierr == 0 && !pending.empty() && !skip_first && line_start < end)
+    {
+        ierr |= ParseMatrixMarketLine(pending.data(), pending.data() + pending.size(), header, entries);
+    }
+
+    close(fd);
+
+    return ierr;
+}
+
+/*!
+  Sends each entry to the process that owns its row.
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int DistributeMatrixMarketEntries(const global_int_t* rowBlockOffsets,
+                                         int size,
+                                         std::vector<MatrixMarketEntry>& entries)
+{
+#ifndef HPCG_NO_MPI
+    if(size == 1)
+    {
+        return 0;
+    }
+
+    // Sort by row, such that entries for each process are contiguous
+    std::sort(entries.begin(), entries.end());
+
+    std::vector<int> sendcounts(size, 0);
+    std::vector<int> recvcounts(size, 0);
+    std::vector<int> sdispls(size + 1, 0);
+    std::vector<int> rdispls(size + 1, 0);
+
+    int dest = 0;
+    for(size_t i = 0; i < entries.size(); ++i)
+    {
+        while(entries[i].row >= rowBlockOffsets[dest + 1])
+        {
+            ++dest;
+        }
+
+        ++sendcounts[dest];
+    }
+
+    MPI_Alltoall(sendcounts.data(), 1, MPI_INT, recvcounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+
+    for(int i = 0; i < size; ++i)
+    {
+        sdispls[i + 1] = sdispls[i] + sendcounts[i];
+        rdispls[i + 1] = rdispls[i] + recvcounts[i];
+    }
+
+    MPI_Datatype MPI_ENTRY;
+    MPI_Type_contiguous(sizeof(MatrixMarketEntry), MPI_BYTE, &MPI_ENTRY);
+    MPI_Type_commit(&MPI_ENTRY);
+
+    std::vector<MatrixMarketEntry> recv(rdispls[size]);
+
+    MPI_Alltoallv(entries.data(),
+                  sendcounts.data(),
+                  sdispls.data(),
+                  MPI_ENTRY,
+                  recv.data(),
+                  recvcounts.data(),
+                  rdispls.data(),
+                  MPI_ENTRY,
+                  MPI_COMM_WORLD);
+
+    MPI_Type_free(&MPI_ENTRY);
+
+    entries.swap(recv);
+#endif
+
+    return 0;
+}
+
+/*!
+  Copies the assembled matrix, its halo structures and vectors to the device,
+  using the same data layout as GenerateProblem and SetupHalo.
+*/
+static void CopyMatrixMarketToDevice(SparseMatrix& A, Vector* b, Vector* x, Vector* xexact)
+{
+    local_int_t m = A.localNumberOfRows;
+    local_int_t nnz_per_row = A.numberOfNonzerosPerRow;
+
+    // Diagonal offsets and row hash values for the coloring
+    std::vector<local_int_t> diag(m);
+    std::vector<local_int_t> hash(m);
+
+    for(local_int_t i = 0; i < m; ++i)
+    {
+        diag[i] = A.matrixDiagonal[i] - A.matrixValues[i];
+        hash[i] = i;
+    }
+
+    // Jones-Plassmann Luby coloring requires distinct hash values, there is no
+    // structure to exploit, so we use a random permutation
+    std::shuffle(hash.begin(), hash.end(), std::mt19937(RNG_SEED));
+
+    HIP_CHECK(deviceMalloc((void**)&A.d_mtxIndG, std::max(sizeof(double), sizeof(global_int_t)) * m * nnz_per_row));
+    HIP_CHECK(deviceMalloc((void**)&A.d_matrixValues, sizeof(double) * m * nnz_per_row));
+    HIP_CHECK(deviceMalloc((void**)&A.d_mtxIndL, sizeof(local_int_t) * m * nnz_per_row));
+    HIP_CHECK(deviceMalloc((void**)&A.d_nonzerosInRow, sizeof(char) * m));
+    HIP_CHECK(deviceMalloc((void**)&A.d_matrixDiagonal, sizeof(local_int_t) * m));
+    HIP_CHECK(deviceMalloc((void**)&A.d_rowHash, sizeof(local_int_t) * m));
+    HIP_CHECK(deviceMalloc((void**)&A.d_localToGlobalMap, sizeof(global_int_t) * m));
+
+    HIP_CHECK(hipMemcpy(A.d_mtxIndG, A.mtxIndG[0], sizeof(global_int_t) * m * nnz_per_row, hipMemcpyHostToDevice));
+    HIP_CHECK(hipMemcpy(A.d_matrixValues, A.matrixValues[0], sizeof(double) * m * nnz_per_row, hipMemcpyHostToDevice));
+    HIP_CHECK(hipMemcpy(A.d_mtxIndL, A.mtxIndL[0], sizeof(local_int_t) * m * nnz_per_row, hipMemcpyHostToDevice));
+    HIP_CHECK(hipMemcpy(A.d_nonzerosInRow, A.nonzerosInRow, sizeof(char) * m, hipMemcpyHostToDevice));
+    HIP_CHECK(hipMemcpy(A.d_matrixDiagonal, diag.data(), sizeof(local_int_t) * m, hipMemcpyHostToDevice));
+    HIP_CHECK(hipMemcpy(A.d_rowHash, hash.data(), sizeof(local_int_t) * m, hipMemcpyHostToDevice));
+    HIP_CHECK(hipMemcpy(A.d_localToGlobalMap, A.localToGlobalMap.data(), sizeof(global_int_t) * m, hipMemcpyHostToDevice));
+
+#ifndef HPCG_NO_MPI
+    if(A.geom->size > 1)
+    {
+        // Receive and send buffers on GPU and CPU, see SetupHalo
+        size_t buffer_size = ((A.totalToBeSent - 1) / (1 << 21) + 1) * (1 << 21);
+        A.recv_buffer = (double*)numa_alloc_local(sizeof(double) * buffer_size);
+        A.send_buffer = (double*)numa_alloc_local(sizeof(double) * buffer_size);
+
+        NULL_CHECK(A.recv_buffer);
+        NULL_CHECK(A.send_buffer);
+
+        HIP_CHECK(hipHostRegister(A.recv_buffer, sizeof(double) * A.totalToBeSent, hipHostRegisterDefault));
+        HIP_CHECK(hipHostRegister(A.send_buffer, sizeof(double) * A.totalToBeSent, hipHostRegisterDefault));
+
+        HIP_CHECK(deviceMalloc((void**)&A.d_send_buffer, sizeof(double) * A.totalToBeSent));
+        HIP_CHECK(deviceMalloc((void**)&A.d_elementsToSend, sizeof(local_int_t) * A.totalToBeSent));
+        HIP_CHECK(hipMemcpy(A.d_elementsToSend, A.elementsToSend, sizeof(local_int_t) * A.totalToBeSent, hipMemcpyHostToDevice));
+
+        A.recv_request = new MPI_Request[A.numberOfSendNeighbors];
+        A.send_request = new MPI_Request[A.numberOfSendNeighbors];
+    }
+#endif
+
+    // Vectors
+    if(b != NULL)
+    {
+        HIPInitializeVector(*b, m);
+        HIP_CHECK(hipMemcpy(b->d_values, b->values, sizeof(double) * m, hipMemcpyHostToDevice));
+    }
+
+    if(x != NULL)
+    {
+        HIPInitializeVector(*x, m);
+        HIP_CHECK(hipMemcpy(x->d_values, x->values, sizeof(double) * m, hipMemcpyHostToDevice));
+    }
+
+    if(xexact != NULL)
+    {
+        HIPInitializeVector(*xexact, m);
+        HIP_CHECK(hipMemcpy(xexact->d_values, xexact->values, sizeof(double) * m, hipMemcpyHostToDevice));
+    }
+}
+
+/*!
+  Reads a symmetric positive definite matrix from a MatrixMarket file and
+  builds the distributed system matrix.
+
+  The rows are distributed in contiguous blocks across all processes. Each
+  process streams an equally sized part of the file, entries are then sent to
+  the owning process, assembled in the HPCG matrix format and the halo is set
+  up using SetupHalo_ref, which handles the block row distribution through
+  Geometry::rowBlockOffsets. Finally, all data is copied to the device, such
+  that OptimizeProblem and the optimized kernels can be applied as usual.
+
+  The optimized kernels use an ELL width of 27, thus matrices with more than 27
+  non-zero entries in any row are rejected. The exact solution is set to one
+  and the right hand side is computed accordingly.
+
+  @param[in]    filename   Name of the MatrixMarket file
+  @param[inout] A          The system matrix, initialized by InitializeSparseMatrix
+  @param[out]   b          The right hand side vector
+  @param[out]   x          The initial guess, set to zero
+  @param[out]   xexact     The exact solution vector
+  @param[out]   parse_time Time spent reading and parsing the file
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see GenerateProblem
+  @see SetupHalo_ref
+*/
+int ReadMatrixMarket(const char* filename, SparseMatrix& A, Vector* b, Vector* x, Vector* xexact, double& parse_time)
+{
+    int rank = A.geom->rank;
+    int size = A.geom->size;
+
+    MatrixMarketHeader header;
+    RETURN_IF_HPCG_ERROR(BroadcastMatrixMarketHeader(filename, header));
+
+    // Block row distribution
+    A.geom->rowBlockOffsets = new global_int_t[size + 1];
+    for(int i = 0; i <= size; ++i)
+    {
+        A.geom->rowBlockOffsets[i] = header.nrows * i / size;
+    }
+
+    parse_time = mytimer();
+
+    std::vector<MatrixMarketEntry> entries;
+    int ierr = ParseMatrixMarketEntries(filename, header, rank, size, entries);
+
+    if(GlobalError(ierr))
+    {
+        if(rank == 0) fprintf(stderr, "Error: failed to parse MatrixMarket file %s\n", filename);
+        return -1;
+    }
+
+    parse_time = mytimer() - parse_time;
+
+    RETURN_IF_HPCG_ERROR(DistributeMatrixMarketEntries(A.geom->rowBlockOffsets, size, entries));
+
+    std::sort(entries.begin(), entries.end());
+
+    global_int_t first_row = A.geom->rowBlockOffsets[rank];
+    local_int_t m = A.geom->rowBlockOffsets[rank + 1] - first_row;
+    local_int_t nnz_per_row = 27;
+
+    // Allocate host structures, same layout as CopyProblemToHost
+    A.nonzerosInRow = new char[m];
+    A.mtxIndG = new global_int_t*[m];
+    A.mtxIndL = new local_int_t*[m];
+    A.matrixValues = new double*[m];
+    A.matrixDiagonal = new double*[m];
+    A.localToGlobalMap.resize(m);
+
+    A.mtxIndG[0] = (global_int_t*)hostMalloc(sizeof(global_int_t) * m * nnz_per_row);
+    A.mtxIndL[0] = (local_int_t*)hostMalloc(sizeof(local_int_t) * m * nnz_per_row);
+    A.matrixValues[0] = (double*)hostMalloc(sizeof(double) * m * nnz_per_row);
+
+    for(local_int_t i = 0; i < m; ++i)
+    {
+        A.mtxIndG[i] = A.mtxIndG[0] + i * nnz_per_row;
+        A.mtxIndL[i] = A.mtxIndL[0] + i * nnz_per_row;
+        A.matrixValues[i] = A.matrixValues[0] + i * nnz_per_row;
+        A.matrixDiagonal[i] = NULL;
+        A.nonzerosInRow[i] = 0;
+        A.localToGlobalMap[i] = first_row + i;
+        A.globalToLocalMap[first_row + i] = i;
+
+        for(local_int_t j = 0; j < nnz_per_row; ++j)
+        {
+            A.mtxIndG[i][j] = -1;
+            A.mtxIndL[i][j] = -1;
+            A.matrixValues[i][j] = 0.0;
+        }
+    }
+
+    // Assemble, duplicate entries are summed up
+    local_int_t localNumberOfNonzeros = 0;
+    ierr = 0;
+
+    for(size_t k = 0; k < entries.size() && ierr == 0; ++k)
+    {
+        local_int_t row = entries[k].row - first_row;
+        int cur = A.nonzerosInRow[row];
+
+        if(cur > 0 && A.mtxIndG[row][cur - 1] == entries[k].col)
+        {
+            A.matrixValues[row][cur - 1] += entries[k].val;
+            continue;
+        }
+
+        if(cur == nnz_per_row)
+        {
+            fprintf(stderr, "Error: row %lld has more than %d non-zero entries\n", (long long)entries[k].row + 1, nnz_per_row);
+            ierr = -1;
+            break;
+        }
+
+        A.mtxIndG[row][cur] = entries[k].col;
+        A.matrixValues[row][cur] = entries[k].val;
+
+        if(entries[k].col == entries[k].row)
+        {
+            A.matrixDiagonal[row] = &A.matrixValues[row][cur];
+        }
+
+        ++A.nonzerosInRow[row];
+        ++localNumberOfNonzeros;
+    }
+
+    std::vector<MatrixMarketEntry>().swap(entries);
+
+    for(local_int_t i = 0; i < m && ierr == 0; ++i)
+    {
+        if(A.matrixDiagonal[i] == NULL || *A.matrixDiagonal[i] <= 0.0)
+        {
+            fprintf(stderr, "Error: row %lld has no positive diagonal entry\n", (long long)first_row + i + 1);
+            ierr = -1;
+        }
+    }
+
+    if(GlobalError(ierr))
+    {
+        return -1;
+    }
+
+    global_int_t totalNumberOfNonzeros = localNumberOfNonzeros;
+#ifndef HPCG_NO_MPI
+    long long lnnz = localNumberOfNonzeros, gnnz = 0;
+    MPI_Allreduce(&lnnz, &gnnz, 1, MPI_LONG_LONG_INT, MPI_SUM, MPI_COMM_WORLD);
+    totalNumberOfNonzeros = gnnz;
+#endif
+
+    size_t titlelen = strlen(filename) + 1;
+    A.title = new char[titlelen];
+    memcpy(A.title, filename, titlelen);
+
+    A.totalNumberOfRows = header.nrows;
+    A.totalNumberOfNonzeros = totalNumberOfNonzeros;
+    A.localNumberOfRows = m;
+    A.localNumberOfColumns = m;
+    A.localNumberOfNonzeros = localNumberOfNonzeros;
+    A.numberOfNonzerosPerRow = nnz_per_row;
+    A.ell_width = nnz_per_row;
+
+    // Halo setup for the block row distribution
+    SetupHalo_ref(A);
+
+#ifndef HPCG_NO_MPI
+    // The halo exchange assumes that each process receives as many entries as
+    // it sends, which holds for structurally symmetric matrices only
+    if(GlobalError(A.numberOfExternalValues != A.totalToBeSent))
+    {
+        if(rank == 0) fprintf(stderr, "Error: matrix %s is not structurally symmetric\n", filename);
+        return -1;
+    }
+#endif
+
+    // Exact solution is one, compute right hand side accordingly
+    if(b != NULL) InitializeVector(*b, m);
+    if(x != NULL) InitializeVector(*x, m);
+    if(xexact != NULL) InitializeVector(*xexact, m);
+
+    for(local_int_t i = 0; i < m; ++i)
+    {
+        double sum = 0.0;
+        for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+        {
+            sum += A.matrixValues[i][j];
+        }
+
+        if(b != NULL) b->values[i] = sum;
+        if(x != NULL) x->values[i] = 0.0;
+        if(xexact != NULL) xexact->values[i] = 1.0;
+    }
+
+    CopyMatrixMarketToDevice(A, b, x, xexact);
+
+    return 0;
+}
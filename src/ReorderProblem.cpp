@@ -0,0 +1,408 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ReorderProblem.cpp
+
+ Space filling curve ordering of the host rows
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ReorderProblem.hpp"
+
+// Morton key, bits of z, y and x interleaved from the most significant bit
+static uint64_t MortonKey(local_int_t ix, local_int_t iy, local_int_t iz, int bits)
+{
+    uint64_t key = 0;
+
+    for(int b = bits - 1; b >= 0; --b)
+    {
+        key = (key << 1) | ((iz >> b) & 1);
+        key = (key << 1) | ((iy >> b) & 1);
+        key = (key << 1) | ((ix >> b) & 1);
+    }
+
+    return key;
+}
+
+// Hilbert key, computed from the transposed Hilbert index of J. Skilling,
+// "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004)
+static uint64_t HilbertKey(local_int_t ix, local_int_t iy, local_int_t iz, int bits)
+{
+    unsigned int X[3] = {(unsigned int)ix, (unsigned int)iy, (unsigned int)iz};
+    unsigned int M = 1u << (bits - 1);
+
+    // Inverse undo
+    for(unsigned int Q = M; Q > 1; Q >>= 1)
+    {
+        unsigned int P = Q - 1;
+
+        for(int i = 0; i < 3; ++i)
+        {
+            if(X[i] & Q)
+            {
+                X[0] ^= P;
+            }
+            else
+            {
+                unsigned int t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    // Gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+
+    unsigned int t = 0;
+
+    for(unsigned int Q = M; Q > 1; Q >>= 1)
+    {
+        if(X[2] & Q)
+        {
+            t ^= Q - 1;
+        }
+    }
+
+    for(int i = 0; i < 3; ++i)
+    {
+        X[i] ^= t;
+    }
+
+    uint64_t key = 0;
+
+    for(int b = bits - 1; b >= 0; --b)
+    {
+        for(int i = 0; i < 3; ++i)
+        {
+            key = (key << 1) | ((X[i] >> b) & 1);
+        }
+    }
+
+    return key;
+}
+
+// Position of each lexicographic row along the curve, for a grid that is
+// embedded into the smallest enclosing cube of power of two edge length
+static void CurvePermutation(const Geometry& geom, int ordering, std::vector<local_int_t>& perm)
+{
+    local_int_t nx = geom.nx;
+    local_int_t ny = geom.ny;
+    local_int_t nz = geom.nz;
+
+    int bits = 1;
+    while((1 << bits) < std::max(nx, std::max(ny, nz)))
+    {
+        ++bits;
+    }
+
+    std::vector<std::pair<uint64_t, local_int_t>> keys(nx * ny * nz);
+
+    for(local_int_t iz = 0; iz < nz; ++iz)
+    {
+        for(local_int_t iy = 0; iy < ny; ++iy)
+        {
+            for(local_int_t ix = 0; ix < nx; ++ix)
+            {
+                local_int_t row = iz * nx * ny + iy * nx + ix;
+                uint64_t key = (ordering == HPCG_ORDER_HILBERT) ? HilbertKey(ix, iy, iz, bits)
+                                                                : MortonKey(ix, iy, iz, bits);
+
+                keys[row] = std::make_pair(key, row);
+            }
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    perm.resize(keys.size());
+
+    for(size_t i = 0; i < keys.size(); ++i)
+    {
+        perm[keys[i].second] = i;
+    }
+}
+
+// Moves row i to row perm[i] and renumbers the local columns accordingly
+static void PermuteMatrix(SparseMatrix& A, const std::vector<local_int_t>& perm)
+{
+    local_int_t nrow = A.localNumberOfRows;
+    local_int_t width = 0;
+
+    // Nothing to permute on an empty subdomain
+    if(nrow <= 0)
+    {
+        return;
+    }
+
+    // numberOfNonzerosPerRow is not set by the reference problem generation
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        width = std::max(width, (local_int_t)A.nonzerosInRow[i]);
+    }
+
+    char* nonzerosInRow = new char[nrow];
+    global_int_t** mtxIndG = new global_int_t*[nrow];
+    local_int_t** mtxIndL = new local_int_t*[nrow];
+    double** matrixValues = new double*[nrow];
+    double** matrixDiagonal = new double*[nrow];
+
+#ifdef HPCG_CONTIGUOUS_ARRAYS
+    mtxIndG[0] = (global_int_t*)hostMalloc(sizeof(global_int_t) * nrow * width);
+    mtxIndL[0] = (local_int_t*)hostMalloc(sizeof(local_int_t) * nrow * width);
+    matrixValues[0] = (double*)hostMalloc(sizeof(double) * nrow * width);
+
+    for(local_int_t i = 1; i < nrow; ++i)
+    {
+        mtxIndG[i] = mtxIndG[0] + i * width;
+        mtxIndL[i] = mtxIndL[0] + i * width;
+        matrixValues[i] = matrixValues[0] + i * width;
+    }
+#endif
+
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        local_int_t row = perm[i];
+        int nnz = A.nonzerosInRow[i];
+
+#ifndef HPCG_CONTIGUOUS_ARRAYS
+        // Rows are allocated individually and keep their storage
+        mtxIndG[row] = A.mtxIndG[i];
+        mtxIndL[row] = A.mtxIndL[i];
+        matrixValues[row] = A.matrixValues[i];
+#else
+        std::copy(A.mtxIndG[i], A.mtxIndG[i] + nnz, mtxIndG[row]);
+        std::copy(A.matrixValues[i], A.matrixValues[i] + nnz, matrixValues[row]);
+#endif
+
+        for(int j = 0; j < nnz; ++j)
+        {
+            local_int_t col = A.mtxIndL[i][j];
+            mtxIndL[row][j] = (col < nrow) ? perm[col] : col;
+        }
+
+        nonzerosInRow[row] = nnz;
+        matrixDiagonal[row] = matrixValues[row] + (A.matrixDiagonal[i] - A.matrixValues[i]);
+    }
+
+#ifdef HPCG_CONTIGUOUS_ARRAYS
+    hostFree(A.mtxIndG[0]);
+    hostFree(A.mtxIndL[0]);
+    hostFree(A.matrixValues[0]);
+#endif
+
+    delete[] A.nonzerosInRow;
+    delete[] A.mtxIndG;
+    delete[] A.mtxIndL;
+    delete[] A.matrixValues;
+    delete[] A.matrixDiagonal;
+
+    A.nonzerosInRow = nonzerosInRow;
+    A.mtxIndG = mtxIndG;
+    A.mtxIndL = mtxIndL;
+    A.matrixValues = matrixValues;
+    A.matrixDiagonal = matrixDiagonal;
+
+    // Global ids of the local rows, external columns keep their local ids
+    if(A.localToGlobalMap.size() == (size_t)nrow)
+    {
+        std::vector<global_int_t> localToGlobalMap(nrow);
+
+        for(local_int_t i = 0; i < nrow; ++i)
+        {
+            localToGlobalMap[perm[i]] = A.localToGlobalMap[i];
+        }
+
+        A.localToGlobalMap.swap(localToGlobalMap);
+
+        if(!A.globalToLocalMap.empty())
+        {
+            for(local_int_t i = 0; i < nrow; ++i)
+            {
+                A.globalToLocalMap[A.localToGlobalMap[i]] = i;
+            }
+        }
+    }
+
+#ifndef HPCG_NO_MPI
+    // Send buffers are packed in unchanged order from the renumbered rows
+    for(local_int_t i = 0; i < A.totalToBeSent; ++i)
+    {
+        A.elementsToSend[i] = perm[A.elementsToSend[i]];
+    }
+#endif
+}
+
+// Moves entry i of the local part of v to perm[i], halo entries are unchanged
+static void PermuteHostVector(Vector& v, const std::vector<local_int_t>& perm)
+{
+    std::vector<double> values(v.values, v.values + perm.size());
+
+    for(size_t i = 0; i < perm.size(); ++i)
+    {
+        v.values[perm[i]] = values[i];
+    }
+}
+
+/*!
+  Reorders the local rows of the host matrices of all multigrid levels along a
+  space filling curve.
+
+  With the lexicographic ordering of the generated problem, the neighbors of a
+  row in the adjacent z planes are nx * ny rows away. Along a Morton or Hilbert
+  curve, most neighbors are close in memory for any local problem size.
+
+  Rows and local columns, the local-to-global mapping, the halo send lists,
+  the injection operators and the given vectors are renumbered consistently,
+  such that the reference kernels compute the same result up to the ordering
+  of the rows. The Gauss-Seidel smoother sweeps the rows in the new order, so
+  the convergence of the reference CG changes. The device matrices are not
+  affected.
+
+  @param[inout] A        The known system matrix, including the coarse levels
+  @param[inout] b        The right hand side, or 0
+  @param[inout] x        The initial guess, or 0
+  @param[inout] xexact   The exact solution, or 0
+  @param[in]    ordering The RowOrdering to be applied to the lexicographic rows
+
+  @return returns 0 upon success and non-zero if the rows are not in
+          lexicographic grid order
+
+  @see GenerateProblem_ref
+*/
+int ReorderProblem(SparseMatrix& A, Vector* b, Vector* x, Vector* xexact, int ordering)
+{
+    if(ordering == HPCG_ORDER_LEXICOGRAPHIC)
+    {
+        return 0;
+    }
+
+    // Permutation of each level, required in pairs for the injection operators
+    std::vector<std::vector<local_int_t>> perms;
+
+    for(SparseMatrix* M = &A; M != 0; M = M->Ac)
+    {
+        if(M->rowOrdering != HPCG_ORDER_LEXICOGRAPHIC
+           || M->localNumberOfRows != M->geom->nx * M->geom->ny * M->geom->nz)
+        {
+            return -1;
+        }
+
+        perms.push_back(std::vector<local_int_t>());
+        CurvePermutation(*M->geom, ordering, perms.back());
+    }
+
+    int level = 0;
+
+    for(SparseMatrix* M = &A; M != 0; M = M->Ac, ++level)
+    {
+        const std::vector<local_int_t>& perm = perms[level];
+
+        PermuteMatrix(*M, perm);
+
+        if(M->mgData != 0)
+        {
+            const std::vector<local_int_t>& permc = perms[level + 1];
+            local_int_t* f2cOperator = M->mgData->f2cOperator;
+            std::vector<local_int_t> f2c(f2cOperator, f2cOperator + permc.size());
+
+            for(size_t i = 0; i < permc.size(); ++i)
+            {
+                f2cOperator[permc[i]] = perm[f2c[i]];
+            }
+        }
+
+        M->rowOrdering = ordering;
+    }
+
+    if(b != 0) PermuteHostVector(*b, perms[0]);
+    if(x != 0) PermuteHostVector(*x, perms[0]);
+    if(xexact != 0) PermuteHostVector(*xexact, perms[0]);
+
+    return 0;
+}
+
+/*!
+  Locality of the host matrix: arithmetic and geometric mean of the distance
+  |i - j| of the local off-diagonal entries (i, j). The arithmetic mean is
+  dominated by the few neighbors that are far apart along a space filling
+  curve, the geometric mean reflects the typical distance.
+
+  @param[in]  A       The known system matrix
+  @param[out] mean    Average column distance
+  @param[out] geomean Geometric mean of the column distances
+*/
+void ComputeColumnDistance(const SparseMatrix& A, double& mean, double& geomean)
+{
+    local_int_t nrow = A.localNumberOfRows;
+
+    double sum = 0.0;
+    double logsum = 0.0;
+    double count = 0.0;
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp parallel for reduction(+ : sum, logsum, count)
+#endif
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+        {
+            local_int_t col = A.mtxIndL[i][j];
+
+            if(col != i && col < nrow)
+            {
+                double dist = std::abs((double)col - (double)i);
+
+                sum += dist;
+                logsum += std::log(dist);
+                count += 1.0;
+            }
+        }
+    }
+
+    mean = (count > 0.0) ? sum / count : 0.0;
+    geomean = (count > 0.0) ? std::exp(logsum / count) : 0.0;
+}
+
+// Name of a RowOrdering, as used on the command line
+const char* RowOrderingName(int ordering)
+{
+    switch(ordering)
+    {
+        case HPCG_ORDER_MORTON: return "morton";
+        case HPCG_ORDER_HILBERT: return "hilbert";
+        default: return "lexicographic";
+    }
+}
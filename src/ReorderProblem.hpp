@@ -0,0 +1,55 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ReorderProblem.hpp
+
+ Space filling curve ordering of the host rows
+ */
+
+#ifndef REORDERPROBLEM_HPP
+#define REORDERPROBLEM_HPP
+
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+
+/*!
+  Orderings of the local rows of the host matrices.
+ */
+enum RowOrdering
+{
+    HPCG_ORDER_LEXICOGRAPHIC = 0, //!< x fastest, as generated
+    HPCG_ORDER_MORTON        = 1, //!< Morton (Z-order) curve
+    HPCG_ORDER_HILBERT       = 2  //!< Hilbert curve
+};
+
+int ReorderProblem(SparseMatrix& A, Vector* b, Vector* x, Vector* xexact, int ordering);
+void ComputeColumnDistance(const SparseMatrix& A, double& mean, double& geomean);
+const char* RowOrderingName(int ordering);
+
+#endif // REORDERPROBLEM_HPP
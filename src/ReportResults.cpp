@@ -54,6 +54,9 @@
 #include "ReportResults.hpp"
 #include "OutputFile.hpp"
 #include "OptimizeProblem.hpp"
+#include "ProblemCoefficients.hpp"
+#include "ReorderProblem.hpp"
+#include "HostMemory.hpp"
 
 #ifdef HPCG_DEBUG
 #include <fstream>
@@ -93,6 +96,145 @@ double ComputeTotalGFlops(const SparseMatrix& A, int numberOfMgLevels, int numbe
     return frefnops/(times[0]+fNumberOfCgSets*(times[7]/10.0+times[9]/10.0))/1.0E9;
 }
 
+/*!
+  Adds the hardware counters of the reference kernels to the YAML document and
+  compares the measured memory traffic per nonzero with the traffic model.
+  Traffic is taken from the uncore memory controllers if readable, and
+  estimated from last level cache misses otherwise.
+
+  @param[in]    A                The known system matrix
+  @param[in]    numberOfMgLevels Number of levels in multigrid V cycle
+  @param[inout] doc              The YAML document
+*/
+static void ReportHardwareCounters(const SparseMatrix & A, int numberOfMgLevels, OutputFile & doc)
+{
+    const hipHostCounters_t& hw = profiler.GetCounters();
+
+    if(!profiler.IsEnabled() || !hw.IsAnyAvailable())
+    {
+        return;
+    }
+
+    static const int regions[2] = {PROFILE_SPMV_REF, PROFILE_SYMGS_REF};
+    static const char* names[2] = {"SpMV", "SYMGS"};
+
+    bool dram = hw.IsAvailable(PERF_DRAM_READ_BYTES);
+
+    doc.add("Hardware Counter Summary", "");
+    OutputFile* summary = doc.get("Hardware Counter Summary");
+
+    summary->add("Counters", hw.GetStatus());
+    summary->add("Traffic source", dram ? "DRAM" : "LLC misses");
+
+    const SparseMatrix* Af = &A;
+    for(int level = 0; level < numberOfMgLevels && Af != NULL; ++level)
+    {
+        double fnnz = Af->localNumberOfNonzeros;
+        double fnrow = Af->localNumberOfRows;
+
+        // Same model as the memory bandwidth model above, per call
+        double model[2];
+        model[0] = fnnz * (sizeof(double) + sizeof(local_int_t)) + 2.0 * fnrow * sizeof(double);
+        model[1] = 2.0 * model[0];
+
+        for(int i = 0; i < 2; ++i)
+        {
+            long long calls;
+            double time;
+            double counters[PERF_NUMBER_OF_COUNTERS];
+
+            if(!profiler.GetRegion(regions[i], level, calls, time, counters))
+            {
+                continue;
+            }
+
+            char key[64];
+            snprintf(key, sizeof(key), "%s level %d", names[i], level);
+
+            summary->add(key, "");
+            OutputFile* entry = summary->get(key);
+
+            entry->add("Calls", calls);
+
+            if(hw.IsAvailable(PERF_CYCLES) && hw.IsAvailable(PERF_INSTRUCTIONS))
+            {
+                entry->add("IPC", counters[PERF_INSTRUCTIONS] / counters[PERF_CYCLES]);
+            }
+
+            double bytes = -1.0;
+            if(dram)
+            {
+                bytes = counters[PERF_DRAM_READ_BYTES] + counters[PERF_DRAM_WRITE_BYTES];
+            }
+            else if(hw.IsAvailable(PERF_LLC_MISSES))
+            {
+                bytes = counters[PERF_LLC_MISSES] * 64.0;
+            }
+
+            entry->add("Model bytes per nonzero", model[i] / fnnz);
+
+            if(bytes >= 0.0)
+            {
+                entry->add("Measured bytes per nonzero", bytes / calls / fnnz);
+                entry->add("Measured GB/s", bytes / time / 1.0E9);
+            }
+        }
+
+        Af = Af->Ac;
+    }
+}
+
+/*!
+  Adds the value bytes per nonzero of the value compressed ELL format of each
+  level to the YAML document, if the format is in use. Sizes are local to rank 0.
+
+  @param[in]    A                The known system matrix
+  @param[in]    numberOfMgLevels Number of levels in multigrid V cycle
+  @param[inout] doc              The YAML document
+*/
+static void ReportValueCompression(const SparseMatrix & A, int numberOfMgLevels, OutputFile & doc)
+{
+    if(A.ell_val_dict_size == 0)
+    {
+        return;
+    }
+
+    doc.add("Value Compression", "");
+    OutputFile* summary = doc.get("Value Compression");
+
+    const SparseMatrix* Af = &A;
+    for(int level = 0; level < numberOfMgLevels && Af != NULL; ++level)
+    {
+        double fnnz = Af->localNumberOfNonzeros;
+        double entries = (double)Af->localNumberOfRows * Af->ell_width;
+
+        char key[32];
+        snprintf(key, sizeof(key), "Level %d", level);
+
+        summary->add(key, "");
+        OutputFile* entry = summary->get(key);
+
+        entry->add("Value bytes per nonzero (ELL)", entries * sizeof(double) / fnnz);
+
+        if(Af->ell_val_dict_size < 0)
+        {
+            entry->add("Storage", "full values (dictionary overflow)");
+        }
+        else
+        {
+            // Diagonal, and one index per ELL entry unless all off-diagonal values are equal
+            double bytes = Af->localNumberOfRows * sizeof(double);
+            if(Af->ell_val_idx != NULL) bytes += entries * sizeof(unsigned char);
+
+            entry->add("Storage", Af->ell_val_idx != NULL ? "dictionary" : "uniform");
+            entry->add("Distinct off-diagonal values", Af->ell_val_dict_size);
+            entry->add("Value bytes per nonzero (compressed)", bytes / fnnz);
+        }
+
+        Af = Af->Ac;
+    }
+}
+
 /*!
  Creates a YAML file and writes the information about the HPCG run, its results, and validity.
 
@@ -105,12 +247,15 @@ double ComputeTotalGFlops(const SparseMatrix& A, int numberOfMgLevels, int numbe
   @param[in] testcg_data    the data structure with the results of the CG-correctness test including pass/fail information
   @param[in] testsymmetry_data the data structure with the results of the CG symmetry test including pass/fail information
   @param[in] testnorms_data the data structure with the results of the CG norm test including pass/fail information
+  @param[in] probe_data the measured memory bandwidth, used as roofline
+  @param[inout] sections the results of the optional tests that ran, moved into the result file
   @param[in] global_failure indicates whether a failure occurred during the correctness tests of CG
 
   @see YAML_Doc
 */
 void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgSets, int refMaxIters,int optMaxIters, double times[],
-    const TestCGData & testcg_data, const TestSymmetryData & testsymmetry_data, const TestNormsData & testnorms_data, int global_failure, bool quickPath) {
+    const TestCGData & testcg_data, const TestSymmetryData & testsymmetry_data, const TestNormsData & testnorms_data,
+    const BandwidthProbeData & probe_data, ReportSections & sections, int global_failure, bool quickPath) {
 
   double minOfficialTime = 1800; // Any official benchmark result must run at least this many seconds
 
@@ -305,6 +450,9 @@ void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgS
     doc.add("Linear System Information","");
     doc.get("Linear System Information")->add("Number of Equations",A.totalNumberOfRows);
     doc.get("Linear System Information")->add("Number of Nonzero Terms",A.totalNumberOfNonzeros);
+    doc.get("Linear System Information")->add("Problem type",
+        A.geom->problem == HPCG_PROBLEM_VARCOEF ? "Variable coefficient" :
+        A.geom->problem == HPCG_PROBLEM_ANISO ? "Anisotropic" : "Reference");
 
     doc.add("Multigrid Information","");
     doc.get("Multigrid Information")->add("Number of coarse grid levels", numberOfMgLevels-1);
@@ -400,6 +548,9 @@ void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgS
     doc.get("GB/s Summary")->add("Raw Total B/W",(fnreads+fnwrites)/(times[0])/1.0E9);
     doc.get("GB/s Summary")->add("Total with convergence and optimization phase overhead",(frefnreads+frefnwrites)/(times[0]+fNumberOfCgSets*(times[7]/10.0+times[9]/10.0))/1.0E9);
 
+    ReportHardwareCounters(A, numberOfMgLevels, doc);
+    ReportValueCompression(A, numberOfMgLevels, doc);
+
 
     doc.add("GFLOP/s Summary","");
     doc.get("GFLOP/s Summary")->add("Raw DDOT",fnops_ddot/times[1]/1.0E9);
@@ -413,6 +564,71 @@ void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgS
     double totalGflops24 = frefnops/(times[0]+fNumberOfCgSets*times[7]/10.0)/1.0E9;
     doc.get("GFLOP/s Summary")->add("Total with convergence and optimization phase overhead",totalGflops);
 
+    // Roofline, the attainable performance of each kernel is bound by its arithmetic intensity times the measured triad bandwidth
+    const char * roofline_names[5] = {"DDOT", "WAXPBY", "SpMV", "MG", "Total"};
+    double roofline_ops[5] = {fnops_ddot, fnops_waxpby, fnops_sparsemv, fnops_precond, fnops};
+    double roofline_bytes[5] = {fnreads_ddot+fnwrites_ddot, fnreads_waxpby+fnwrites_waxpby, fnreads_sparsemv+fnwrites_sparsemv,
+                                fnreads_precond+fnwrites_precond, fnreads+fnwrites};
+    double roofline_times[5] = {times[1], times[2], times[3], times[5], times[0]};
+
+    doc.add("Roofline","");
+    doc.get("Roofline")->add("Probe vector length per process", probe_data.length);
+    doc.get("Roofline")->add("Measured copy B/W", probe_data.copy);
+    doc.get("Roofline")->add("Measured triad B/W", probe_data.triad);
+    doc.get("Roofline")->add("Lowest triad B/W per process", probe_data.triad_min);
+    doc.get("Roofline")->add("Rank with lowest triad B/W", probe_data.triad_min_rank);
+    doc.get("Roofline")->add("Highest triad B/W per process", probe_data.triad_max);
+    for (int i=0; i<5; ++i) {
+      double gbs = roofline_bytes[i]/roofline_times[i]/1.0E9;
+      double intensity = roofline_ops[i]/roofline_bytes[i];
+      doc.get("Roofline")->add(roofline_names[i],"");
+      doc.get("Roofline")->get(roofline_names[i])->add("GB/s", gbs);
+      doc.get("Roofline")->get(roofline_names[i])->add("Arithmetic intensity (flop/byte)", intensity);
+      doc.get("Roofline")->get(roofline_names[i])->add("GFLOP/s", roofline_ops[i]/roofline_times[i]/1.0E9);
+      doc.get("Roofline")->get(roofline_names[i])->add("Roofline GFLOP/s", intensity*probe_data.triad);
+      doc.get("Roofline")->get(roofline_names[i])->add("Percentage of measured peak B/W", gbs/probe_data.triad*100.0);
+    }
+
+    // Sections of the optional tests that ran
+    sections.addEntries(doc);
+
+    doc.add("Multicoloring","");
+    Af = &A;
+    for (int i=0; i<numberOfMgLevels; ++i) {
+      doc.get("Multicoloring")->add("Grid Level",i);
+      doc.get("Multicoloring")->add("Ordering", Af->tile_rows > 0 ? "Block" : "Point");
+      doc.get("Multicoloring")->add("Rows per block", (long long)(Af->tile_rows > 0 ? Af->tile_rows : 1));
+      doc.get("Multicoloring")->add("Number of colors", Af->nblocks);
+      Af = Af->Ac;
+    }
+
+    // Locality of the host reference matrices, only present with verification
+    if (A.mtxIndL != 0) {
+      doc.add("Host Ordering","");
+      doc.get("Host Ordering")->add("Ordering", RowOrderingName(A.rowOrdering));
+      Af = &A;
+      for (int i=0; i<numberOfMgLevels; ++i) {
+        double mean, geomean;
+        ComputeColumnDistance(*Af, mean, geomean);
+        doc.get("Host Ordering")->add("Grid Level",i);
+        doc.get("Host Ordering")->add("Average column distance", mean);
+        doc.get("Host Ordering")->add("Geometric mean column distance", geomean);
+        Af = Af->Ac;
+      }
+    }
+
+    // Page sizes the live large host arrays ended up with
+    HostMemoryStats hm;
+    GetHostMemoryStats(hm);
+    doc.add("Host Memory","");
+    doc.get("Host Memory")->add("Page policy", HostPagePolicyName(hm.policy));
+    for (int i=0; i<HPCG_PAGES_NUMBER_OF_POLICIES; ++i) {
+      std::string name = std::string("GB (") + HostPagePolicyName(i) + ")";
+      doc.get("Host Memory")->add(name, hm.bytes[i]/1.0E9);
+    }
+    doc.get("Host Memory")->add("THP granted GB", hm.thp_bytes/1.0E9);
+    doc.get("Host Memory")->add("Fallbacks", hm.fallbacks);
+
     doc.add("User Optimization Overheads","");
     doc.get("User Optimization Overheads")->add("Optimization phase time (sec)", (times[7]));
     doc.get("User Optimization Overheads")->add("Optimization phase time vs reference SpMV+MG time", times[7]/times[8]);
@@ -428,6 +644,11 @@ void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgS
 #endif
     doc.add("Final Summary","");
     bool isValidRun = (testcg_data.count_fail==0) && (testsymmetry_data.count_fail==0) && (testnorms_data.pass) && (!global_failure);
+    // Official results require the reference problem in its generated ordering,
+    // as the reference tolerance depends on the order of the host Gauss-Seidel sweep
+    const char * nonOfficialReason = NULL;
+    if (A.geom->problem != HPCG_PROBLEM_LAPLACE) nonOfficialReason = "non-reference problem type";
+    else if (A.rowOrdering != HPCG_ORDER_LEXICOGRAPHIC) nonOfficialReason = "reordered host reference problem";
     if (isValidRun) {
       doc.get("Final Summary")->add("HPCG result is VALID with a GFLOP/s rating of", totalGflops);
       doc.get("Final Summary")->add("HPCG 2.4 rating for historical reasons is", totalGflops24);
@@ -446,7 +667,11 @@ void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgS
       if (!A.isWaxpbyOptimized) {
         doc.get("Final Summary")->add("Reference version of ComputeWAXPBY used","Performance results are most likely suboptimal");
       }
-      if (times[0]>=minOfficialTime) {
+      if (nonOfficialReason != NULL) {
+        doc.get("Final Summary")->add("Results are valid but not official, computed for a", nonOfficialReason);
+        doc.get("Final Summary")->add("Please review the YAML file contents","You may NOT submit these results for consideration.");
+      }
+      else if (times[0]>=minOfficialTime) {
         doc.get("Final Summary")->add("Please upload results from the YAML file contents to","http://hpcg-benchmark.org");
       }
       else {
@@ -463,7 +688,12 @@ void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgS
       doc.get("Final Summary")->add("Please review the YAML file contents","You may NOT submit these results for consideration.");
     }
 
+    profiler.Report(doc);
+    cg_timer.Report(doc);
+    kernel_config.Report(doc);
+
     std::string yaml = doc.generate();
+    doc.generateJSON();
 #ifdef HPCG_DEBUG
     HPCG_fout << yaml;
 #endif
@@ -480,6 +710,10 @@ void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgS
     {
         printf("\n*** WARNING *** INVALID RUN\n");
     }
+    else if(nonOfficialReason != NULL)
+    {
+        printf("\n*** WARNING *** NOT AN OFFICIAL RUN, computed for a %s\n", nonOfficialReason);
+    }
 
     printf("\n");
     printf("DDOT   = %7.1lf GFlop/s (%7.1lf GB/s)   %7.1lf GFlop/s per process (%7.1lf GB/s per process)\n",
@@ -512,6 +746,136 @@ void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgS
            (frefnreads + frefnwrites) / (times[0] + fNumberOfCgSets * (times[7] / 10.0 + times[9] / 10.0)) / 1e9,
            totalGflops / A.geom->size,
            (frefnreads + frefnwrites) / (times[0] + fNumberOfCgSets * (times[7] / 10.0 + times[9] / 10.0)) / 1e9 / A.geom->size);
+
+    printf("\nRoofline (measured triad %0.1lf GB/s, lowest process %0.1lf GB/s on rank %d)\n",
+           probe_data.triad,
+           probe_data.triad_min,
+           probe_data.triad_min_rank);
+    for(int i = 0; i < 5; ++i)
+    {
+        double gbs = roofline_bytes[i] / roofline_times[i] / 1e9;
+
+        printf("%-6s = %7.1lf GB/s   %5.1lf%% of peak   %6.3lf flop/byte\n",
+               roofline_names[i],
+               gbs,
+               gbs / probe_data.triad * 100.0,
+               roofline_ops[i] / roofline_bytes[i]);
+    }
+
+    sections.printSummary();
+
+    profiler.Print();
+  }
+  return;
+}
+
+/*!
+ Creates a YAML file and writes the performance of SpMV and CG for a matrix that
+ has been imported from a MatrixMarket file. The preconditioner is a single
+ symmetric Gauss-Seidel sweep, since there is no multigrid hierarchy.
+
+  @param[in] A                 The imported system matrix
+  @param[in] numberOfSpmvCalls Number of timed SpMV calls
+  @param[in] spmv_time         Total time of all timed SpMV calls
+  @param[in] numberOfCgSets    Number of CG runs performed
+  @param[in] maxIters          Number of preconditioned CG iterations performed per run
+  @param[in] times             Vector of cumulative timings for each of the phases of a preconditioned CG iteration
+  @param[in] parse_time        Time spent reading the MatrixMarket file
+  @param[in] scaled_residual   Scaled residual of the last CG run
+
+  @see ReportResults
+*/
+void ReportMatrixMarketResults(const SparseMatrix & A, int numberOfSpmvCalls, double spmv_time, int numberOfCgSets, int maxIters,
+    double times[], double parse_time, double scaled_residual) {
+
+  if (A.geom->rank==0) { // Only PE 0 needs to compute and report timing results
+
+    double fnrow = A.totalNumberOfRows;
+    double fnnz = A.totalNumberOfNonzeros;
+    double fNumberOfCgSets = numberOfCgSets;
+    double fniters = fNumberOfCgSets * (double) maxIters;
+
+    // SpMV benchmark
+    double fspmv_ops = numberOfSpmvCalls * 2.0 * fnnz;
+    double fspmv_bytes = numberOfSpmvCalls * (fnnz * (sizeof(double) + sizeof(local_int_t)) + 2.0 * fnrow * sizeof(double));
+
+    // CG, same model as ReportResults with a single level preconditioner
+    double fnops_ddot = (3.0*fniters+fNumberOfCgSets)*2.0*fnrow;
+    double fnops_waxpby = (3.0*fniters+fNumberOfCgSets)*2.0*fnrow;
+    double fnops_sparsemv = (fniters+fNumberOfCgSets)*2.0*fnnz;
+    double fnops_precond = fniters*4.0*fnnz;
+    double fnops = fnops_ddot+fnops_waxpby+fnops_sparsemv+fnops_precond;
+
+    double fnreads = (3.0*fniters+fNumberOfCgSets)*2.0*fnrow*sizeof(double); // DDOT
+    fnreads += (3.0*fniters+fNumberOfCgSets)*2.0*fnrow*sizeof(double); // WAXPBY
+    fnreads += (fniters+fNumberOfCgSets)*(fnnz*(sizeof(double)+sizeof(local_int_t)) + fnrow*sizeof(double)); // SpMV
+    fnreads += fniters*(2.0*fnnz*(sizeof(double)+sizeof(local_int_t)) + fnrow*sizeof(double)); // SYMGS
+
+    double fnwrites = (3.0*fniters+fNumberOfCgSets)*fnrow*sizeof(double); // WAXPBY
+    fnwrites += (fniters+fNumberOfCgSets)*fnrow*sizeof(double); // SpMV
+    fnwrites += fniters*fnrow*sizeof(double); // SYMGS
+
+    OutputFile doc("HPCG-MatrixMarket", "3.1");
+
+    doc.add("Machine Summary","");
+    doc.get("Machine Summary")->add("Distributed Processes",A.geom->size);
+    doc.get("Machine Summary")->add("Threads per processes",A.geom->numThreads);
+
+    doc.add("Linear System Information","");
+    doc.get("Linear System Information")->add("Matrix",A.title);
+    doc.get("Linear System Information")->add("Number of Equations",A.totalNumberOfRows);
+    doc.get("Linear System Information")->add("Number of Nonzero Terms",A.totalNumberOfNonzeros);
+
+    doc.add("Benchmark Time Summary","");
+    doc.get("Benchmark Time Summary")->add("Parse phase",parse_time);
+    doc.get("Benchmark Time Summary")->add("Setup phase",times[9]);
+    doc.get("Benchmark Time Summary")->add("Optimization phase",times[7]);
+    doc.get("Benchmark Time Summary")->add("SpMV",spmv_time);
+    doc.get("Benchmark Time Summary")->add("CG",times[0]);
+
+    doc.add("GB/s Summary","");
+    doc.get("GB/s Summary")->add("SpMV",fspmv_bytes/spmv_time/1.0E9);
+    doc.get("GB/s Summary")->add("CG",(fnreads+fnwrites)/times[0]/1.0E9);
+
+    doc.add("GFLOP/s Summary","");
+    doc.get("GFLOP/s Summary")->add("SpMV",fspmv_ops/spmv_time/1.0E9);
+    doc.get("GFLOP/s Summary")->add("CG",fnops/times[0]/1.0E9);
+
+    doc.add("Final Summary","");
+    doc.get("Final Summary")->add("Number of CG sets",numberOfCgSets);
+    doc.get("Final Summary")->add("Iterations per CG set",maxIters);
+    doc.get("Final Summary")->add("Scaled residual",scaled_residual);
+
+    profiler.Report(doc);
+    cg_timer.Report(doc);
+    kernel_config.Report(doc);
+
+    std::string yaml = doc.generate();
+    doc.generateJSON();
+#ifdef HPCG_DEBUG
+    HPCG_fout << yaml;
+#endif
+
+    // Print some numbers to screen
+    printf("\nMatrix: %s\n", A.title);
+    printf("Rows: %lld  Non-zeros: %lld\n", (long long)A.totalNumberOfRows, (long long)A.totalNumberOfNonzeros);
+    printf("\nParse Time: %0.2lf sec\n", parse_time);
+    printf("Setup Time: %0.2lf sec\n", times[9]);
+    printf("Optimization Time: %0.2lf sec\n", times[7]);
+    printf("\n");
+    printf("SpMV   = %7.1lf GFlop/s (%7.1lf GB/s)   %7.1lf GFlop/s per process (%7.1lf GB/s per process)\n",
+           fspmv_ops / spmv_time / 1e9,
+           fspmv_bytes / spmv_time / 1e9,
+           fspmv_ops / spmv_time / 1e9 / A.geom->size,
+           fspmv_bytes / spmv_time / 1e9 / A.geom->size);
+    printf("CG     = %7.1lf GFlop/s (%7.1lf GB/s)   %7.1lf GFlop/s per process (%7.1lf GB/s per process)\n",
+           fnops / times[0] / 1e9,
+           (fnreads + fnwrites) / times[0] / 1e9,
+           fnops / times[0] / 1e9 / A.geom->size,
+           (fnreads + fnwrites) / times[0] / 1e9 / A.geom->size);
+    printf("\nScaled residual after %d iterations: %e\n", maxIters, scaled_residual);
+
+    profiler.Print();
   }
   return;
 }
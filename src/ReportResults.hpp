@@ -47,9 +47,14 @@
 #include "TestCG.hpp"
 #include "TestSymmetry.hpp"
 #include "TestNorms.hpp"
+#include "BandwidthProbe.hpp"
+#include "ReportSections.hpp"
 
 double ComputeTotalGFlops(const SparseMatrix& A, int numberOfMgLevels, int numberOfCgSets, int refMaxIters, int optMaxIters, double times[]);
 void ReportResults(const SparseMatrix & A, int numberOfMgLevels, int numberOfCgSets, int refMaxIters, int optMaxIters, double times[],
-    const TestCGData & testcg_data, const TestSymmetryData & testsymmetry_data, const TestNormsData & testnorms_data, int global_failure, bool quickPath);
+    const TestCGData & testcg_data, const TestSymmetryData & testsymmetry_data, const TestNormsData & testnorms_data,
+    const BandwidthProbeData & probe_data, ReportSections & sections, int global_failure, bool quickPath);
+void ReportMatrixMarketResults(const SparseMatrix & A, int numberOfSpmvCalls, double spmv_time, int numberOfCgSets, int maxIters,
+    double times[], double parse_time, double scaled_residual);
 
 #endif // REPORTRESULTS_HPP
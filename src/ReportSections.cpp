@@ -0,0 +1,124 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ReportSections.cpp
+
+ Results of the optional tests, collected for the report
+ */
+
+#include <cassert>
+#include <cstdarg>
+#include <cstdio>
+
+#include "ReportSections.hpp"
+
+ReportSections::ReportSections()
+    : current(-1)
+{
+    for(int i = 0; i < REPORT_SECTIONS; ++i)
+    {
+        sections[i].entries = NULL;
+    }
+}
+
+ReportSections::~ReportSections()
+{
+    for(int i = 0; i < REPORT_SECTIONS; ++i)
+    {
+        delete sections[i].entries;
+    }
+}
+
+/*!
+  Starts the section of a test.
+
+  @param[in] id   The position of the section in the report
+  @param[in] name The key of the section in the result file
+
+  @return Returns the element of the entries of the section
+*/
+OutputFile* ReportSections::add(ReportSectionId id, const std::string& name)
+{
+    assert(sections[id].entries == NULL);
+
+    sections[id].entries = OutputFile::allocKeyVal(name, "");
+    sections[id].summary.clear();
+    current = id;
+
+    return sections[id].entries;
+}
+
+/*!
+  Appends text to the summary of the section started last. The summary is
+  printed as is, thus each line ends with a newline.
+
+  @param[in] format The printf format, followed by its arguments
+*/
+void ReportSections::print(const char* format, ...)
+{
+    assert(current >= 0);
+
+    char line[1024];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    sections[current].summary += line;
+}
+
+/*!
+  Adds the entries of all sections to the result file, which deletes them from
+  then on.
+
+  @param[inout] doc The result file the sections are added to
+*/
+void ReportSections::addEntries(OutputFile& doc)
+{
+    for(int i = 0; i < REPORT_SECTIONS; ++i)
+    {
+        if(sections[i].entries != NULL)
+        {
+            doc.add(sections[i].entries);
+            sections[i].entries = NULL;
+        }
+    }
+}
+
+void ReportSections::printSummary(void) const
+{
+    for(int i = 0; i < REPORT_SECTIONS; ++i)
+    {
+        if(!sections[i].summary.empty())
+        {
+            printf("\n%s", sections[i].summary.c_str());
+        }
+    }
+}
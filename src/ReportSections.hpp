@@ -0,0 +1,89 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ReportSections.hpp
+
+ Results of the optional tests, collected for the report
+ */
+
+#ifndef REPORTSECTIONS_HPP
+#define REPORTSECTIONS_HPP
+
+#include <string>
+
+#include "OutputFile.hpp"
+
+//! Sections of the optional tests, in the order they appear in the report
+enum ReportSectionId
+{
+    REPORT_MULTI_RHS,        //!< multiple right hand side CG, see TestMultiRHS
+    REPORT_COMPRESSED_ELL,   //!< index compressed ELL format, see TestCompressedELL
+    REPORT_FLOAT_VALUES,     //!< single precision matrix values, see TestFloatValues
+    REPORT_LEVEL_SCHEDULE,   //!< level scheduled host smoother, see TestLevelSchedule
+    REPORT_NUMA_DOMAINS,     //!< host SpMV on NUMA domains, see TestNumaDomains
+    REPORT_TASK_RUNTIME,     //!< host V-cycle and CG on task graphs, see TestTaskRuntime
+    REPORT_PERSISTENT_CG,    //!< host CG on one persistent thread team, see TestPersistentCG
+    REPORT_REPRODUCIBLE_DOT, //!< binned dot products, see TestReproducibleDot
+    REPORT_SECTIONS          //!< number of sections
+};
+
+struct ReportSection_STRUCT
+{
+    OutputFile* entries; //!< entries of the result file keyed by the name of the test, NULL if it did not run
+    std::string summary; //!< lines printed after the performance results
+};
+typedef struct ReportSection_STRUCT ReportSection;
+
+/*!
+  The results of the optional tests. Each test that has been enabled fills its
+  section with its entries of the result file and its summary, ReportResults
+  writes the sections in the order of their ids after the fixed sections.
+ */
+class ReportSections
+{
+public:
+    ReportSections();
+    ~ReportSections();
+
+    //! Starts a section and returns the element of its entries, which the test fills
+    OutputFile* add(ReportSectionId id, const std::string& name);
+    //! Appends printf formatted text to the summary of the section started last
+    void print(const char* format, ...);
+
+    //! Moves the entries of all sections into doc
+    void addEntries(OutputFile& doc);
+    //! Prints the summaries of all sections
+    void printSummary(void) const;
+
+private:
+    ReportSection sections[REPORT_SECTIONS];
+    int current; //!< id of the section started last, -1 if none
+};
+
+#endif // REPORTSECTIONS_HPP
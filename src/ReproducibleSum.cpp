@@ -0,0 +1,271 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ReproducibleSum.cpp
+
+ Reproducible dot product on the host and reduction of binned sums across ranks
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <cassert>
+#include <cstring>
+
+#include "mytimer.hpp"
+#include "ReproducibleSum.hpp"
+
+// Products per block of the host dot product
+#define HPCG_REPRO_HOST_BLOCK 256
+
+static bool reproducible_dot = false;
+
+/*!
+  Selects binned summation for the dot products of both the reference and the
+  optimized CG from now on.
+
+  @param[in] enabled true for binned summation, false for plain summation
+*/
+void SetReproducibleDot(bool enabled)
+{
+    reproducible_dot = enabled;
+}
+
+bool GetReproducibleDot(void)
+{
+    return reproducible_dot;
+}
+
+#ifndef HPCG_NO_MPI
+static void MergeReproducibleSums(void* in, void* inout, int* len, MPI_Datatype*)
+{
+    const ReproducibleSum* a = reinterpret_cast<const ReproducibleSum*>(in);
+    ReproducibleSum* b       = reinterpret_cast<ReproducibleSum*>(inout);
+
+    for(int i = 0; i < *len; ++i)
+    {
+        ReproducibleMerge(b[i], a[i]);
+    }
+}
+
+/*!
+  Sums the binned sums of all ranks. As merging is exact, the result does not
+  depend on the reduction tree of the MPI library.
+
+  @param[inout] sum  The sum of this rank on entry, the global sum on exit
+  @param[in]    comm The communicator
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int AllreduceReproducibleSum(ReproducibleSum& sum, MPI_Comm comm)
+{
+    static MPI_Datatype type = MPI_DATATYPE_NULL;
+    static MPI_Op op         = MPI_OP_NULL;
+
+    if(op == MPI_OP_NULL)
+    {
+        MPI_Type_contiguous(sizeof(ReproducibleSum), MPI_BYTE, &type);
+        MPI_Type_commit(&type);
+        MPI_Op_create(MergeReproducibleSums, 1, &op);
+    }
+
+    ReproducibleSum local = sum;
+
+    return MPI_Allreduce(&local, &sum, 1, type, op, comm) != MPI_SUCCESS;
+}
+#endif
+
+/*!
+  Adds the products x[i] * y[i] of a block to the accumulator. The leading bin
+  is raised to the largest product first, such that the products are split into
+  the bins without a range check and the loop vectorizes. A product deposited
+  below the leading bin of the block has zero digits in the bins above its own,
+  so the bins are the same as if the products were deposited one at a time.
+  Blocks with products out of range are deposited one at a time.
+*/
+static void ReproducibleDepositBlock(ReproducibleAccumulator& acc,
+                                     local_int_t m,
+                                     const double* __restrict__ x,
+                                     const double* __restrict__ y)
+{
+    static_assert(HPCG_REPRO_FOLD == 3, "the block deposit unrolls three bins");
+
+    double p[HPCG_REPRO_HOST_BLOCK];
+    long long vmax = 0;
+
+    // Largest magnitude by the bits of the products, inf and nan compare above all finite values
+#ifndef HPCG_NO_OPENMP
+#pragma omp simd reduction(max : vmax)
+#endif
+    for(local_int_t i = 0; i < m; ++i)
+    {
+        p[i] = x[i] * y[i];
+
+        long long bits = ReproducibleBits(p[i]) & 0x7fffffffffffffffLL;
+        vmax           = (bits > vmax) ? bits : vmax;
+    }
+
+#if defined(__FAST_MATH__)
+    // Value-changing optimizations may cancel the shifts below
+    bool scalar = true;
+#else
+    bool scalar = vmax >= ReproducibleBits(ldexp(1.0, 32 * HPCG_REPRO_MAX_BIN - 1043));
+#endif
+
+    if(scalar)
+    {
+        for(local_int_t i = 0; i < m; ++i)
+        {
+            ReproducibleDeposit(acc, p[i]);
+        }
+
+        return;
+    }
+
+    if(vmax >= ReproducibleBits(acc.limit))
+    {
+        double v;
+        memcpy(&v, &vmax, sizeof(v));
+
+        ReproducibleRaise(acc, v);
+    }
+
+    const double s0 = acc.shift[0];
+    const double s1 = acc.shift[1];
+    const double s2 = acc.shift[2];
+
+    const long long z0 = ReproducibleBits(s0);
+    const long long z1 = ReproducibleBits(s1);
+    const long long z2 = ReproducibleBits(s2);
+
+    long long b0 = 0;
+    long long b1 = 0;
+    long long b2 = 0;
+
+    // Same rounding as ReproducibleDeposit, s - shift is the digit times the unit exactly
+#ifndef HPCG_NO_OPENMP
+#pragma omp simd reduction(+ : b0, b1, b2)
+#endif
+    for(local_int_t i = 0; i < m; ++i)
+    {
+        double v = p[i];
+        double s = v + s0;
+
+        b0 += ReproducibleBits(s) - z0;
+        v -= s - s0;
+        s = v + s1;
+        b1 += ReproducibleBits(s) - z1;
+        v -= s - s1;
+        s = v + s2;
+        b2 += ReproducibleBits(s) - z2;
+    }
+
+    acc.bin[0] += b0;
+    acc.bin[1] += b1;
+    acc.bin[2] += b2;
+}
+
+/*!
+  Computes the dot product of two vectors with binned summation. Each thread
+  accumulates its rows, the exact sums of the threads and ranks are merged and
+  rounded once at the end, such that the result is the same for any number of
+  threads and ranks.
+
+  @param[in]  n              The number of vector elements on this rank
+  @param[in]  x, y           The input vectors
+  @param[out] result         The dot product
+  @param[out] time_allreduce The time of the reduction across ranks is added
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see ComputeDotProduct_ref
+*/
+int ComputeReproducibleDotProduct_host(local_int_t n,
+                                       const Vector& x,
+                                       const Vector& y,
+                                       double& result,
+                                       double& time_allreduce)
+{
+    assert(x.localLength >= n);
+    assert(y.localLength >= n);
+
+    const double* xv = x.values;
+    const double* yv = y.values;
+
+    ReproducibleSum sum;
+    ReproducibleClear(sum);
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp parallel
+#endif
+    {
+        ReproducibleAccumulator acc;
+        ReproducibleInitialize(acc);
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp for nowait
+#endif
+        for(local_int_t i = 0; i < n; i += HPCG_REPRO_HOST_BLOCK)
+        {
+            local_int_t m = (n - i < HPCG_REPRO_HOST_BLOCK) ? n - i : HPCG_REPRO_HOST_BLOCK;
+
+            ReproducibleDepositBlock(acc, m, xv + i, yv + i);
+        }
+
+        ReproducibleSum local;
+        ReproducibleFinalize(acc, local);
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp critical
+#endif
+        ReproducibleMerge(sum, local);
+    }
+
+#ifndef HPCG_NO_MPI
+    double t0 = mytimer();
+    int ierr  = AllreduceReproducibleSum(sum, MPI_COMM_WORLD);
+    time_allreduce += mytimer() - t0;
+
+    if(ierr)
+    {
+        return ierr;
+    }
+#else
+    (void)time_allreduce;
+#endif
+
+    result = ReproducibleValue(sum);
+
+    return 0;
+}
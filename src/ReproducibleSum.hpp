@@ -0,0 +1,308 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file ReproducibleSum.hpp
+
+ Binned summation of double precision values, whose result does not depend on
+ the order of the summands nor on how they are split across threads, thread
+ blocks and ranks
+ */
+
+#ifndef REPRODUCIBLESUM_HPP
+#define REPRODUCIBLESUM_HPP
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__HIPCC__)
+#include <hip/hip_runtime.h>
+#endif
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#include "Vector.hpp"
+#include "hpcg.hpp"
+
+// Number of bins an accumulator keeps, starting at its leading bin
+#define HPCG_REPRO_FOLD 3
+
+// Largest bin index, products of at least 2^973 are out of range
+#define HPCG_REPRO_MAX_BIN 63
+
+// Grid of the device kernels, the partial sums of the blocks fill the workspace
+#define HPCG_REPRO_BLOCKS 128
+#define HPCG_REPRO_BLOCKSIZE 256
+
+/*!
+  Bin j collects the parts of the summands that are integer multiples of its
+  unit 2^(32 j - 1074) and smaller than 2^31 units in magnitude. A summand is
+  split into its bins by rounding to the unit of each bin in turn, starting at
+  the bin of the largest summand seen so far, the leading bin. Parts that fall
+  below the HPCG_REPRO_FOLD bins kept are dropped. In the end, the leading bin
+  is the bin of the largest summand for any split of the summands, so are the
+  dropped parts, and the integer bin sums are exact, such that the result is the
+  same for any split and order.
+
+  The sum of a bin is stored as carry * 2^32 + primary with the primary part in
+  [-2^31, 2^31), which keeps the representation unique and leaves room to add
+  the sums of many threads and ranks without overflow.
+ */
+struct ReproducibleSum
+{
+    long long top;                         //!< index of the leading bin
+    long long carry[HPCG_REPRO_FOLD];      //!< high part of bins top, top - 1, ...
+    long long primary[HPCG_REPRO_FOLD];    //!< low part of bins top, top - 1, ...
+    double special;                        //!< sum of the summands out of range (inf, nan)
+};
+
+/*!
+  Accumulator of a single thread. The bins are plain integers, which holds up
+  to 2^31 summands.
+ */
+struct ReproducibleAccumulator
+{
+    int top;                           //!< index of the leading bin
+    double limit;                      //!< summands at least this large raise the leading bin
+    double shift[HPCG_REPRO_FOLD];     //!< 1.5 * 2^52 units of each bin, rounds to the unit
+    double unit[HPCG_REPRO_FOLD];      //!< unit of each bin
+    long long bin[HPCG_REPRO_FOLD];    //!< bins top, top - 1, ... in units
+    double special;                    //!< sum of the summands out of range
+};
+
+HPCG_HOST_DEVICE inline long long ReproducibleBits(double x)
+{
+#if defined(__HIP_DEVICE_COMPILE__)
+    return __double_as_longlong(x);
+#else
+    long long bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+#endif
+}
+
+HPCG_HOST_DEVICE inline void ReproducibleSetTop(ReproducibleAccumulator& acc, int top)
+{
+    acc.top   = top;
+    acc.limit = ldexp(1.0, 32 * top - 1043);
+
+    for(int k = 0; k < HPCG_REPRO_FOLD; ++k)
+    {
+        acc.shift[k] = ldexp(1.5, 32 * (top - k) - 1022);
+        acc.unit[k]  = ldexp(1.0, 32 * (top - k) - 1074);
+    }
+}
+
+HPCG_HOST_DEVICE inline void ReproducibleClear(ReproducibleSum& sum)
+{
+    sum.top = HPCG_REPRO_FOLD - 1;
+
+    for(int k = 0; k < HPCG_REPRO_FOLD; ++k)
+    {
+        sum.carry[k]   = 0;
+        sum.primary[k] = 0;
+    }
+
+    sum.special = 0.0;
+}
+
+HPCG_HOST_DEVICE inline void ReproducibleInitialize(ReproducibleAccumulator& acc)
+{
+    ReproducibleSetTop(acc, HPCG_REPRO_FOLD - 1);
+
+    for(int k = 0; k < HPCG_REPRO_FOLD; ++k)
+    {
+        acc.bin[k] = 0;
+    }
+
+    acc.special = 0.0;
+}
+
+/*!
+  Moves the leading bin up to the bin of v, dropping the bins that fall out of
+  the accumulator. Returns false if v is out of range and has been added to the
+  special sum instead.
+ */
+HPCG_HOST_DEVICE inline bool ReproducibleRaise(ReproducibleAccumulator& acc, double v)
+{
+    if(!(fabs(v) < ldexp(1.0, 32 * HPCG_REPRO_MAX_BIN - 1043)))
+    {
+        acc.special += v;
+        return false;
+    }
+
+    // Smallest bin j with |v| < 2^(32 j - 1043)
+    int top = (ilogb(v) + 1075) >> 5;
+
+    if(top > acc.top)
+    {
+        int d = top - acc.top;
+
+        for(int k = HPCG_REPRO_FOLD - 1; k >= 0; --k)
+        {
+            acc.bin[k] = (k >= d) ? acc.bin[k - d] : 0;
+        }
+
+        ReproducibleSetTop(acc, top);
+    }
+
+    return true;
+}
+
+/*!
+  Adds v to the accumulator. Each bin rounds the remainder to its unit by adding
+  its shift, the bits of the rounded value minus the bits of the shift are the
+  digit of the bin. The digit is taken from the remainder in integer arithmetic,
+  such that value-changing optimizations cannot cancel the shift.
+ */
+HPCG_HOST_DEVICE inline void ReproducibleDeposit(ReproducibleAccumulator& acc, double v)
+{
+#if defined(__clang__)
+    // The device code is built with -ffast-math, which may reassociate the sums
+#pragma float_control(precise, on)
+#endif
+
+    if(!(fabs(v) < acc.limit) && !ReproducibleRaise(acc, v))
+    {
+        return;
+    }
+
+    for(int k = 0; k < HPCG_REPRO_FOLD; ++k)
+    {
+        double s        = v + acc.shift[k];
+        long long digit = ReproducibleBits(s) - ReproducibleBits(acc.shift[k]);
+
+        acc.bin[k] += digit;
+        v -= (double)digit * acc.unit[k];
+    }
+}
+
+HPCG_HOST_DEVICE inline void ReproducibleFinalize(const ReproducibleAccumulator& acc,
+                                                  ReproducibleSum& sum)
+{
+    sum.top = acc.top;
+
+    for(int k = 0; k < HPCG_REPRO_FOLD; ++k)
+    {
+        sum.carry[k]   = (acc.bin[k] + (1LL << 31)) >> 32;
+        sum.primary[k] = acc.bin[k] - sum.carry[k] * (1LL << 32);
+    }
+
+    sum.special = acc.special;
+}
+
+/*!
+  Adds the sum b to the sum a. The result is exact and thus associative and
+  commutative.
+ */
+HPCG_HOST_DEVICE inline void ReproducibleMerge(ReproducibleSum& a, const ReproducibleSum& b)
+{
+    // Move the leading bin of a up to the one of b
+    if(b.top > a.top)
+    {
+        long long d = b.top - a.top;
+
+        for(int k = HPCG_REPRO_FOLD - 1; k >= 0; --k)
+        {
+            a.carry[k]   = (k >= d) ? a.carry[k - d] : 0;
+            a.primary[k] = (k >= d) ? a.primary[k - d] : 0;
+        }
+
+        a.top = b.top;
+    }
+
+    long long d = a.top - b.top;
+
+    for(int k = d; k < HPCG_REPRO_FOLD; ++k)
+    {
+        long long primary = a.primary[k] + b.primary[k - d];
+        long long carry   = (primary + (1LL << 31)) >> 32;
+
+        a.carry[k]   = a.carry[k] + b.carry[k - d] + carry;
+        a.primary[k] = primary - carry * (1LL << 32);
+    }
+
+    a.special += b.special;
+}
+
+/*!
+  Rounds the sum to double precision. The carry of a bin has the unit of the
+  next higher bin, both are added up before rounding, from the lowest unit to
+  the highest one.
+ */
+HPCG_HOST_DEVICE inline double ReproducibleValue(const ReproducibleSum& sum)
+{
+    int exponent = 32 * (int)(sum.top - HPCG_REPRO_FOLD + 1) - 1074;
+    double value = ldexp((double)sum.primary[HPCG_REPRO_FOLD - 1], exponent);
+
+    for(int k = HPCG_REPRO_FOLD - 2; k >= 0; --k)
+    {
+        exponent += 32;
+        value += ldexp((double)(sum.primary[k] + sum.carry[k + 1]), exponent);
+    }
+
+    value += ldexp((double)sum.carry[0], exponent + 32);
+
+    return value + sum.special;
+}
+
+#if defined(__HIPCC__)
+// Merges the sums of a block into data[0]
+template <unsigned int BLOCKSIZE>
+__device__ void ReproducibleBlockReduce(unsigned int tid, ReproducibleSum* data)
+{
+    __syncthreads();
+
+    for(unsigned int s = BLOCKSIZE / 2; s > 0; s >>= 1)
+    {
+        if(tid < s)
+        {
+            ReproducibleMerge(data[tid], data[tid + s]);
+        }
+
+        __syncthreads();
+    }
+}
+#endif
+
+void SetReproducibleDot(bool enabled);
+bool GetReproducibleDot(void);
+
+#ifndef HPCG_NO_MPI
+int AllreduceReproducibleSum(ReproducibleSum& sum, MPI_Comm comm);
+#endif
+
+int ComputeReproducibleDotProduct_host(local_int_t n,
+                                       const Vector& x,
+                                       const Vector& y,
+                                       double& result,
+                                       double& time_allreduce);
+
+#endif // REPRODUCIBLESUM_HPP
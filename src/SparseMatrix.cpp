@@ -118,6 +118,7 @@ __global__ void kernel_replace_diagonal(local_int_t m,
                                         local_int_t ell_width,
                                         const local_int_t* __restrict__ ell_col_ind,
                                         double* __restrict__ ell_val,
+                                        float* __restrict__ ell_val_f32,
                                         double* __restrict__ inv_diag)
 {
     local_int_t row = blockIdx.x * BLOCKSIZE + threadIdx.x;
@@ -139,6 +140,12 @@ __global__ void kernel_replace_diagonal(local_int_t m,
             if(col == row)
             {
                 ell_val[idx] = diag;
+
+                if(ell_val_f32 != NULL)
+                {
+                    ell_val_f32[idx] = static_cast<float>(diag);
+                }
+
                 break;
             }
         }
@@ -160,7 +167,17 @@ void HIPReplaceMatrixDiagonal(SparseMatrix& A, const Vector& diagonal)
         A.ell_width,
         A.ell_col_ind,
         A.ell_val,
+        A.ell_val_f32,
         A.inv_diag);
+
+    // Diagonal of the value compressed format
+    if(A.ell_diag != NULL)
+    {
+        HIP_CHECK(hipMemcpy(A.ell_diag,
+                            diagonal.d_values,
+                            sizeof(double) * A.localNumberOfRows,
+                            hipMemcpyDeviceToDevice));
+    }
 }
 
 template <unsigned int BLOCKSIZEX, unsigned int BLOCKSIZEY>
@@ -405,3 +422,32 @@ void ExtractDiagonal(SparseMatrix& A)
         A.diag_idx,
         A.inv_diag);
 }
+
+template <unsigned int BLOCKSIZE>
+__launch_bounds__(BLOCKSIZE)
+__global__ void kernel_to_single_precision(local_int_t size,
+                                           const double* __restrict__ in,
+                                           float* __restrict__ out)
+{
+    local_int_t gid = blockIdx.x * BLOCKSIZE + threadIdx.x;
+
+    if(gid >= size)
+    {
+        return;
+    }
+
+    out[gid] = static_cast<float>(in[gid]);
+}
+
+void ConvertToSinglePrecision(SparseMatrix& A)
+{
+    local_int_t size = A.ell_width * A.localNumberOfRows;
+
+    // Values are rounded once, accumulation stays in double precision
+    HIP_CHECK(deviceMalloc((void**)&A.ell_val_f32, sizeof(float) * size));
+
+    kernel_to_single_precision<1024><<<(size - 1) / 1024 + 1, 1024>>>(
+        size,
+        A.ell_val,
+        A.ell_val_f32);
+}
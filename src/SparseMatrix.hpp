@@ -55,12 +55,14 @@
 #endif
 
 #include <vector>
+#include <atomic>
 #include <cassert>
 #include <hip/hip_runtime_api.h>
 
 #include "utils.hpp"
 #include "Geometry.hpp"
 #include "Vector.hpp"
+#include "HostMemory.hpp"
 #include "MGData.hpp"
 #if __cplusplus < 201103L
 // for C++03
@@ -88,6 +90,7 @@ struct SparseMatrix_STRUCT {
   double ** matrixDiagonal; //!< values of matrix diagonal entries
   GlobalToLocalMap globalToLocalMap; //!< global-to-local mapping
   std::vector< global_int_t > localToGlobalMap; //!< local-to-global mapping
+  int rowOrdering; //!< ordering of the local rows, see RowOrdering
   mutable bool isDotProductOptimized;
   mutable bool isSpmvOptimized;
   mutable bool isMgOptimized;
@@ -98,8 +101,19 @@ struct SparseMatrix_STRUCT {
    */
   mutable struct SparseMatrix_STRUCT * Ac; // Coarse grid matrix
   mutable MGData * mgData; // Pointer to the coarse level data for this fine matrix
+  int level; //!< Multigrid level of this matrix, 0 is the finest level
   void * optimizationData;  // pointer that can be used to store implementation-specific data
 
+  // Host level schedule of the natural ordering, see LevelSchedule.hpp
+  bool useLevelSchedule; //!< Build the level schedule in OptimizeProblem
+  local_int_t numberOfLowerLevels; //!< number of levels of the lower triangular dependency graph
+  local_int_t numberOfUpperLevels; //!< number of levels of the upper triangular dependency graph
+  local_int_t * lowerLevelPtr; //!< offsets of the lower levels into lowerLevelRows, 0 if not built
+  local_int_t * lowerLevelRows; //!< rows sorted by lower level
+  local_int_t * upperLevelPtr; //!< offsets of the upper levels into upperLevelRows
+  local_int_t * upperLevelRows; //!< rows sorted by upper level
+  std::atomic<int> * rowSweeps; //!< number of completed sweeps of each row, for point-to-point synchronization
+
 #ifndef HPCG_NO_MPI
   local_int_t numberOfExternalValues; //!< number of entries that are external to this process
   int numberOfSendNeighbors; //!< number of neighboring processes that will be send local data
@@ -144,6 +158,21 @@ struct SparseMatrix_STRUCT {
   local_int_t* ell_col_ind; //!< ELL column indices
   double* ell_val; //!< ELL values
 
+  // Index compressed ELL arrays, see CompressELL
+  unsigned short* ell_col_rel; //!< ELL column offsets to the chunk base, NULL if not compressed
+  local_int_t* ell_col_base; //!< Column base of each chunk of rows and ELL column
+  local_int_t ell_escapes; //!< Number of entries whose column is read from ell_col_ind
+
+  // Value compressed ELL arrays, see CompressValues
+  unsigned char* ell_val_idx; //!< Dictionary index of each off-diagonal entry, NULL if all are equal
+  double* ell_val_dict; //!< Distinct off-diagonal values, NULL if not compressed
+  double* ell_diag; //!< Diagonal values
+  int ell_val_dict_size; //!< Number of dictionary values, 0 if not compressed, -1 if the dictionary overflowed
+
+  // Single precision ELL values, see ConvertToSinglePrecision
+  float* ell_val_f32; //!< ELL values in single precision, NULL if stored in double only
+  bool useFloatValues; //!< Build ell_val_f32 during OptimizeProblem
+
   local_int_t* diag_idx; //!< Index to diagonal value in ell_val
   double* inv_diag; //!< Inverse diagonal values
 
@@ -153,6 +182,8 @@ struct SparseMatrix_STRUCT {
   local_int_t* sizes; //!< Number of rows of independent sets
   local_int_t* offsets; //!< Pointer to the first row of each independent set
   local_int_t* perm; //!< Permutation obtained by independent set
+  local_int_t tile_rows; //!< Rows of each block of a block coloring, 0 for point coloring
+  bool useBlockColoring; //!< Color blocks of grid points during OptimizeProblem, see BlockColoring
 };
 typedef struct SparseMatrix_STRUCT SparseMatrix;
 
@@ -203,12 +234,31 @@ inline void InitializeSparseMatrix(SparseMatrix & A, Geometry * geom) {
   A.halo_col_ind = NULL;
   A.halo_val = NULL;
 #endif
+  A.rowOrdering = 0; // Lexicographic, as generated
   A.mgData = 0; // Fine-to-coarse grid transfer initially not defined.
+  A.useLevelSchedule = false;
+  A.numberOfLowerLevels = 0;
+  A.numberOfUpperLevels = 0;
+  A.lowerLevelPtr = 0;
+  A.lowerLevelRows = 0;
+  A.upperLevelPtr = 0;
+  A.upperLevelRows = 0;
+  A.rowSweeps = 0;
   A.Ac =0;
+  A.level = 0;
 
   A.ell_width = 0;
   A.ell_col_ind = NULL;
   A.ell_val = NULL;
+  A.ell_col_rel = NULL;
+  A.ell_col_base = NULL;
+  A.ell_escapes = 0;
+  A.ell_val_idx = NULL;
+  A.ell_val_dict = NULL;
+  A.ell_diag = NULL;
+  A.ell_val_dict_size = 0;
+  A.ell_val_f32 = NULL;
+  A.useFloatValues = false;
   A.diag_idx = NULL;
   A.inv_diag = NULL;
 
@@ -217,12 +267,17 @@ inline void InitializeSparseMatrix(SparseMatrix & A, Geometry * geom) {
   A.sizes = NULL;
   A.offsets = NULL;
   A.perm = NULL;
+  A.d_localToGlobalMap = NULL;
+  A.tile_rows = 0;
+  A.useBlockColoring = false;
 
   return;
 }
 
 void ConvertToELL(SparseMatrix& A);
 void ExtractDiagonal(SparseMatrix& A);
+void ConvertToSinglePrecision(SparseMatrix& A);
+void DeleteLevelSchedule(SparseMatrix& A);
 
 /*!
   Copy values from matrix diagonal into user-provided vector.
@@ -270,9 +325,9 @@ inline void DeleteMatrix(SparseMatrix & A) {
     delete [] A.mtxIndL[i];
   }
 #else
-  delete [] A.matrixValues[0];
-  delete [] A.mtxIndG[0];
-  delete [] A.mtxIndL[0];
+  if (A.matrixValues) hostFree(A.matrixValues[0]);
+  if (A.mtxIndG) hostFree(A.mtxIndG[0]);
+  if (A.mtxIndL) hostFree(A.mtxIndL[0]);
 #endif
   if (A.title)                  delete [] A.title;
   if (A.nonzerosInRow)             delete [] A.nonzerosInRow;
@@ -312,13 +367,20 @@ inline void DeleteMatrix(SparseMatrix & A) {
   if (A.geom!=0) { DeleteGeometry(*A.geom); delete A.geom; A.geom = 0;}
   if (A.Ac!=0) { DeleteMatrix(*A.Ac); delete A.Ac; A.Ac = 0;} // Delete coarse matrix
   if (A.mgData!=0) { DeleteMGData(*A.mgData); delete A.mgData; A.mgData = 0;} // Delete MG data
-
-  HIP_CHECK(deviceFree(A.ell_col_ind));
-  HIP_CHECK(deviceFree(A.ell_val));
-  HIP_CHECK(deviceFree(A.diag_idx));
-  HIP_CHECK(deviceFree(A.inv_diag));
-  HIP_CHECK(deviceFree(A.perm));
-  HIP_CHECK(deviceFree(A.d_localToGlobalMap));
+  DeleteLevelSchedule(A);
+
+  if(A.ell_col_ind) HIP_CHECK(deviceFree(A.ell_col_ind));
+  if(A.ell_val) HIP_CHECK(deviceFree(A.ell_val));
+  if(A.ell_col_rel) HIP_CHECK(deviceFree(A.ell_col_rel));
+  if(A.ell_col_base) HIP_CHECK(deviceFree(A.ell_col_base));
+  if(A.ell_val_idx) HIP_CHECK(deviceFree(A.ell_val_idx));
+  if(A.ell_val_dict) HIP_CHECK(deviceFree(A.ell_val_dict));
+  if(A.ell_diag) HIP_CHECK(deviceFree(A.ell_diag));
+  if(A.ell_val_f32) HIP_CHECK(deviceFree(A.ell_val_f32));
+  if(A.diag_idx) HIP_CHECK(deviceFree(A.diag_idx));
+  if(A.inv_diag) HIP_CHECK(deviceFree(A.inv_diag));
+  if(A.perm) HIP_CHECK(deviceFree(A.perm));
+  if(A.d_localToGlobalMap) HIP_CHECK(deviceFree(A.d_localToGlobalMap));
 
   delete[] A.sizes;
   delete[] A.offsets;
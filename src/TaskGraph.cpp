@@ -0,0 +1,959 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TaskGraph.cpp
+
+ Dependency graph of chunked host tasks of the multigrid V-cycle and the CG
+ iteration
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#include "ExchangeHalo.hpp"
+#endif
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "TaskGraph.hpp"
+
+// Access history of the entries of one array
+struct TrackedArray
+{
+    std::vector<int> lastWriter; // last task writing each entry, -1 if none
+    std::vector<int> readers;    // list of the tasks reading each entry since, -1 if empty
+};
+
+struct TaskDependencyTracker
+{
+    std::map<const double*, TrackedArray> arrays; // accessed arrays by address
+    std::vector<int> readerTask;                  // task of each reader list node
+    std::vector<int> readerNext;                  // next node of each reader list node
+    int freeReader;                               // first unused reader list node, -1 if none
+    std::vector<int> mark;                        // last task that added each task as predecessor
+    std::vector<int> predecessors;                // predecessors of the current task
+    std::vector<std::pair<int, int> > edges;      // (predecessor, successor) of all tasks
+    int current;                                  // task whose accesses are recorded
+    int lastMaster;                               // last task running on the calling thread, -1 if none
+};
+
+static TrackedArray& Track(TaskDependencyTracker& t, const double* array, local_int_t length)
+{
+    TrackedArray& a = t.arrays[array];
+
+    if((local_int_t)a.lastWriter.size() < length)
+    {
+        a.lastWriter.resize(length, -1);
+        a.readers.resize(length, -1);
+    }
+
+    return a;
+}
+
+static inline void AddPredecessor(TaskDependencyTracker& t, int task)
+{
+    if(task >= 0 && task != t.current && t.mark[task] != t.current)
+    {
+        t.mark[task] = t.current;
+        t.predecessors.push_back(task);
+    }
+}
+
+// Reads of a task have to be recorded before its writes
+static inline void Read(TaskDependencyTracker& t, TrackedArray& a, local_int_t i)
+{
+    AddPredecessor(t, a.lastWriter[i]);
+
+    int head = a.readers[i];
+
+    if(head >= 0 && t.readerTask[head] == t.current)
+    {
+        return;
+    }
+
+    int node = t.freeReader;
+
+    if(node >= 0)
+    {
+        t.freeReader = t.readerNext[node];
+    }
+    else
+    {
+        node = t.readerTask.size();
+        t.readerTask.push_back(0);
+        t.readerNext.push_back(0);
+    }
+
+    t.readerTask[node] = t.current;
+    t.readerNext[node] = head;
+    a.readers[i] = node;
+}
+
+static inline void Write(TaskDependencyTracker& t, TrackedArray& a, local_int_t i)
+{
+    AddPredecessor(t, a.lastWriter[i]);
+
+    int node = a.readers[i];
+
+    while(node >= 0)
+    {
+        int next = t.readerNext[node];
+
+        AddPredecessor(t, t.readerTask[node]);
+
+        t.readerNext[node] = t.freeReader;
+        t.freeReader = node;
+
+        node = next;
+    }
+
+    a.readers[i] = -1;
+    a.lastWriter[i] = t.current;
+}
+
+// Appends a task, whose accesses are recorded until EndTask
+static void BeginTask(HostTaskGraph& graph, const HostTask& task, bool master)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    t.current = graph.tasks.size();
+    t.predecessors.clear();
+    t.mark.push_back(-1);
+
+    graph.tasks.push_back(task);
+    graph.masterOnly.push_back(master);
+
+    // MPI calls are issued in program order, identical on all processes
+    if(master)
+    {
+        AddPredecessor(t, t.lastMaster);
+        t.lastMaster = t.current;
+    }
+}
+
+static void EndTask(HostTaskGraph& graph)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    graph.numberOfPredecessors.push_back(t.predecessors.size());
+
+    for(size_t i = 0; i < t.predecessors.size(); ++i)
+    {
+        t.edges.push_back(std::make_pair(t.predecessors[i], t.current));
+    }
+}
+
+static HostTask NewTask(int kind, const SparseMatrix* A)
+{
+    HostTask task;
+
+    task.kind = kind;
+    task.begin = 0;
+    task.end = 0;
+    task.rows = NULL;
+    task.A = A;
+    task.v = NULL;
+    task.x = NULL;
+    task.y = NULL;
+    task.w = NULL;
+    task.beta = NULL;
+    task.sign = 1.0;
+    task.index = 0;
+
+    return task;
+}
+
+// Rows of each task of a sweep over n rows, such that each thread gets about
+// the given number of tasks
+static local_int_t ChunkRows(const HostTaskGraph& graph, local_int_t n, int tasksPerThread)
+{
+    long long parts = (long long)tasksPerThread * graph.numberOfThreads;
+    local_int_t rows = (local_int_t)((n + parts - 1) / parts);
+
+    rows = std::max(rows, (local_int_t)HPCG_TASK_MIN_ROWS);
+    rows = std::min(rows, graph.rowsPerTask);
+
+    return std::max(rows, (local_int_t)1);
+}
+
+// Zero, copy and WAXPBY of the first n entries
+static void AddVectorTasks(HostTaskGraph& graph,
+                           int kind,
+                           const SparseMatrix& A,
+                           local_int_t n,
+                           const Vector* x,
+                           const Vector* y,
+                           Vector& w,
+                           const double* beta,
+                           double sign)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    local_int_t rows = ChunkRows(graph, n, 4);
+
+    for(local_int_t begin = 0; begin < n; begin += rows)
+    {
+        HostTask task = NewTask(kind, &A);
+
+        task.begin = begin;
+        task.end = std::min(begin + rows, n);
+        task.x = x ? x->values : NULL;
+        task.y = y ? y->values : NULL;
+        task.w = w.values;
+        task.beta = beta;
+        task.sign = sign;
+
+        BeginTask(graph, task, false);
+
+        if(beta)
+        {
+            Read(t, Track(t, beta, 1), 0);
+        }
+
+        for(int k = 0; k < 2; ++k)
+        {
+            const Vector* in = (k == 0) ? x : y;
+
+            if(in)
+            {
+                TrackedArray& a = Track(t, in->values, in->localLength);
+
+                for(local_int_t i = task.begin; i < task.end; ++i)
+                {
+                    Read(t, a, i);
+                }
+            }
+        }
+
+        TrackedArray& out = Track(t, w.values, w.localLength);
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            Write(t, out, i);
+        }
+
+        EndTask(graph);
+    }
+}
+
+// Halo exchange of x on the calling thread, a no-op without MPI
+static void AddHaloTask(HostTaskGraph& graph, const SparseMatrix& A, Vector& x)
+{
+#ifndef HPCG_NO_MPI
+    TaskDependencyTracker& t = *graph.tracker;
+
+    HostTask task = NewTask(HPCG_TASK_EXCHANGE_HALO, &A);
+    task.v = &x;
+
+    BeginTask(graph, task, true);
+
+    TrackedArray& a = Track(t, x.values, x.localLength);
+
+    for(local_int_t i = 0; i < A.totalToBeSent; ++i)
+    {
+        Read(t, a, A.elementsToSend[i]);
+    }
+
+    for(local_int_t i = A.localNumberOfRows; i < A.localNumberOfColumns; ++i)
+    {
+        Write(t, a, i);
+    }
+
+    EndTask(graph);
+#else
+    (void)graph;
+    (void)A;
+    (void)x;
+#endif
+}
+
+static void AddSPMVTasks(HostTaskGraph& graph, const SparseMatrix& A, Vector& x, Vector& y)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    AddHaloTask(graph, A, x);
+
+    local_int_t nrow = A.localNumberOfRows;
+    local_int_t rows = ChunkRows(graph, nrow, 4);
+
+    for(local_int_t begin = 0; begin < nrow; begin += rows)
+    {
+        HostTask task = NewTask(HPCG_TASK_SPMV, &A);
+
+        task.begin = begin;
+        task.end = std::min(begin + rows, nrow);
+        task.x = x.values;
+        task.w = y.values;
+
+        BeginTask(graph, task, false);
+
+        TrackedArray& in = Track(t, x.values, x.localLength);
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+            {
+                Read(t, in, A.mtxIndL[i][j]);
+            }
+        }
+
+        TrackedArray& out = Track(t, y.values, y.localLength);
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            Write(t, out, i);
+        }
+
+        EndTask(graph);
+    }
+}
+
+// Gauss-Seidel update of the rows of a task, reading the row neighbors and r
+static void AddSweepTask(HostTaskGraph& graph, HostTask& task, const Vector& r, Vector& x)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    const SparseMatrix& A = *task.A;
+
+    BeginTask(graph, task, false);
+
+    TrackedArray& rhs = Track(t, r.values, r.localLength);
+    TrackedArray& sol = Track(t, x.values, x.localLength);
+
+    for(local_int_t k = task.begin; k < task.end; ++k)
+    {
+        local_int_t i = task.rows ? task.rows[k] : k;
+
+        Read(t, rhs, i);
+
+        for(int j = 0; j < A.nonzerosInRow[i]; ++j)
+        {
+            Read(t, sol, A.mtxIndL[i][j]);
+        }
+    }
+
+    for(local_int_t k = task.begin; k < task.end; ++k)
+    {
+        Write(t, sol, task.rows ? task.rows[k] : k);
+    }
+
+    EndTask(graph);
+}
+
+/*
+  Symmetric Gauss-Seidel in the order of ComputeSYMGS_ref. With a level
+  schedule, the tasks hold rows of one level each, and a task only waits for
+  the tasks holding its neighbors. Otherwise, consecutive rows form a chain of
+  tasks, which overlaps with the work before and after the sweep only.
+*/
+static void AddSYMGSTasks(HostTaskGraph& graph, const SparseMatrix& A, const Vector& r, Vector& x)
+{
+    AddHaloTask(graph, A, x);
+
+    local_int_t nrow = A.localNumberOfRows;
+
+    HostTask task = NewTask(HPCG_TASK_SYMGS_FORWARD, &A);
+    task.x = r.values;
+    task.w = x.values;
+
+    if(A.lowerLevelPtr != 0)
+    {
+        task.rows = A.lowerLevelRows;
+
+        for(local_int_t level = 0; level < A.numberOfLowerLevels; ++level)
+        {
+            local_int_t first = A.lowerLevelPtr[level];
+            local_int_t last = A.lowerLevelPtr[level + 1];
+            local_int_t rows = ChunkRows(graph, last - first, 1);
+
+            for(task.begin = first; task.begin < last; task.begin += rows)
+            {
+                task.end = std::min(task.begin + rows, last);
+                AddSweepTask(graph, task, r, x);
+            }
+        }
+
+        task.kind = HPCG_TASK_SYMGS_BACKWARD;
+        task.rows = A.upperLevelRows;
+
+        for(local_int_t level = 0; level < A.numberOfUpperLevels; ++level)
+        {
+            local_int_t first = A.upperLevelPtr[level];
+            local_int_t last = A.upperLevelPtr[level + 1];
+            local_int_t rows = ChunkRows(graph, last - first, 1);
+
+            for(task.begin = first; task.begin < last; task.begin += rows)
+            {
+                task.end = std::min(task.begin + rows, last);
+                AddSweepTask(graph, task, r, x);
+            }
+        }
+
+        return;
+    }
+
+    local_int_t rows = ChunkRows(graph, nrow, 4);
+    local_int_t chunks = (nrow + rows - 1) / rows;
+
+    for(local_int_t c = 0; c < chunks; ++c)
+    {
+        task.begin = c * rows;
+        task.end = std::min(task.begin + rows, nrow);
+        AddSweepTask(graph, task, r, x);
+    }
+
+    task.kind = HPCG_TASK_SYMGS_BACKWARD;
+
+    for(local_int_t c = chunks - 1; c >= 0; --c)
+    {
+        task.begin = c * rows;
+        task.end = std::min(task.begin + rows, nrow);
+        AddSweepTask(graph, task, r, x);
+    }
+}
+
+static void AddRestrictionTasks(HostTaskGraph& graph, const SparseMatrix& A, const Vector& rf)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    const Vector& Axf = *A.mgData->Axf;
+    Vector& rc = *A.mgData->rc;
+    const local_int_t* f2c = A.mgData->f2cOperator;
+
+    local_int_t nc = rc.localLength;
+    local_int_t rows = ChunkRows(graph, nc, 4);
+
+    for(local_int_t begin = 0; begin < nc; begin += rows)
+    {
+        HostTask task = NewTask(HPCG_TASK_RESTRICTION, &A);
+
+        task.begin = begin;
+        task.end = std::min(begin + rows, nc);
+        task.x = rf.values;
+        task.y = Axf.values;
+        task.w = rc.values;
+
+        BeginTask(graph, task, false);
+
+        TrackedArray& fine = Track(t, rf.values, rf.localLength);
+        TrackedArray& prod = Track(t, Axf.values, Axf.localLength);
+        TrackedArray& coarse = Track(t, rc.values, rc.localLength);
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            Read(t, fine, f2c[i]);
+            Read(t, prod, f2c[i]);
+        }
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            Write(t, coarse, i);
+        }
+
+        EndTask(graph);
+    }
+}
+
+static void AddProlongationTasks(HostTaskGraph& graph, const SparseMatrix& Af, Vector& xf)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    const Vector& xc = *Af.mgData->xc;
+    const local_int_t* f2c = Af.mgData->f2cOperator;
+
+    local_int_t nc = Af.mgData->rc->localLength;
+    local_int_t rows = ChunkRows(graph, nc, 4);
+
+    for(local_int_t begin = 0; begin < nc; begin += rows)
+    {
+        HostTask task = NewTask(HPCG_TASK_PROLONGATION, &Af);
+
+        task.begin = begin;
+        task.end = std::min(begin + rows, nc);
+        task.x = xc.values;
+        task.w = xf.values;
+
+        BeginTask(graph, task, false);
+
+        TrackedArray& coarse = Track(t, xc.values, xc.localLength);
+        TrackedArray& fine = Track(t, xf.values, xf.localLength);
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            Read(t, coarse, i);
+            Read(t, fine, f2c[i]);
+        }
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            Write(t, fine, f2c[i]);
+        }
+
+        EndTask(graph);
+    }
+}
+
+// Partial dot products of the chunks, summed in chunk order by a single task
+static void AddDotTasks(HostTaskGraph& graph,
+                        const SparseMatrix& A,
+                        local_int_t n,
+                        const Vector& x,
+                        const Vector& y,
+                        double* result)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    local_int_t rows = ChunkRows(graph, n, 4);
+    local_int_t chunks = (n + rows - 1) / rows;
+
+    graph.partials.push_back(std::vector<double>(std::max(chunks, (local_int_t)1), 0.0));
+    double* partial = graph.partials.back().data();
+
+    for(local_int_t c = 0; c < chunks; ++c)
+    {
+        HostTask task = NewTask(HPCG_TASK_DOT_PARTIAL, &A);
+
+        task.begin = c * rows;
+        task.end = std::min(task.begin + rows, n);
+        task.x = x.values;
+        task.y = y.values;
+        task.w = partial;
+        task.index = c;
+
+        BeginTask(graph, task, false);
+
+        TrackedArray& a = Track(t, x.values, x.localLength);
+        TrackedArray& b = Track(t, y.values, y.localLength);
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            Read(t, a, i);
+            Read(t, b, i);
+        }
+
+        Write(t, Track(t, partial, chunks), c);
+
+        EndTask(graph);
+    }
+
+    HostTask task = NewTask(HPCG_TASK_DOT_REDUCE, &A);
+
+    task.end = chunks;
+    task.x = partial;
+    task.w = result;
+
+#ifndef HPCG_NO_MPI
+    BeginTask(graph, task, true);
+#else
+    BeginTask(graph, task, false);
+#endif
+
+    TrackedArray& p = Track(t, partial, chunks);
+
+    for(local_int_t c = 0; c < chunks; ++c)
+    {
+        Read(t, p, c);
+    }
+
+    Write(t, Track(t, result, 1), 0);
+
+    EndTask(graph);
+}
+
+static void AddDivideTask(HostTaskGraph& graph,
+                          const SparseMatrix& A,
+                          const double* x,
+                          const double* y,
+                          double* w)
+{
+    TaskDependencyTracker& t = *graph.tracker;
+
+    HostTask task = NewTask(HPCG_TASK_DIVIDE, &A);
+
+    task.x = x;
+    task.y = y;
+    task.w = w;
+
+    BeginTask(graph, task, false);
+
+    Read(t, Track(t, x, 1), 0);
+    Read(t, Track(t, y, 1), 0);
+    Write(t, Track(t, w, 1), 0);
+
+    EndTask(graph);
+}
+
+/*!
+  Starts an empty task graph.
+
+  @param[out] graph           The task graph
+  @param[in]  rowsPerTask     The largest number of rows of a task
+  @param[in]  numberOfThreads The number of threads running the graph, sweeps are split into a few tasks per thread
+*/
+void InitializeTaskGraph(HostTaskGraph& graph, local_int_t rowsPerTask, int numberOfThreads)
+{
+    graph.numberOfThreads = std::max(numberOfThreads, 1);
+    graph.rowsPerTask = std::max(rowsPerTask, (local_int_t)1);
+    graph.tasks.clear();
+    graph.masterOnly.clear();
+    graph.numberOfPredecessors.clear();
+    graph.successorPtr.clear();
+    graph.successors.clear();
+    graph.roots.clear();
+    graph.partials.clear();
+
+    graph.tracker = new TaskDependencyTracker;
+    graph.tracker->freeReader = -1;
+    graph.tracker->current = -1;
+    graph.tracker->lastMaster = -1;
+}
+
+/*!
+  Appends the tasks of a multigrid V-cycle, computing the same x as
+  ComputeMG_ref.
+
+  @param[inout] graph The task graph, not yet finalized
+  @param[in]    A     The known system matrix, including its coarse levels
+  @param[in]    r     The input vector
+  @param[inout] x     The result of the V-cycle, must stay alive as long as the graph
+
+  @see ComputeMG_ref
+*/
+void AddMGTasks(HostTaskGraph& graph, const SparseMatrix& A, const Vector& r, Vector& x)
+{
+    AddVectorTasks(graph, HPCG_TASK_ZERO, A, x.localLength, NULL, NULL, x, NULL, 1.0);
+
+    if(A.mgData == 0)
+    {
+        AddSYMGSTasks(graph, A, r, x);
+        return;
+    }
+
+    for(int i = 0; i < A.mgData->numberOfPresmootherSteps; ++i)
+    {
+        AddSYMGSTasks(graph, A, r, x);
+    }
+
+    AddSPMVTasks(graph, A, x, *A.mgData->Axf);
+    AddRestrictionTasks(graph, A, r);
+    AddMGTasks(graph, *A.Ac, *A.mgData->rc, *A.mgData->xc);
+    AddProlongationTasks(graph, A, x);
+
+    for(int i = 0; i < A.mgData->numberOfPostsmootherSteps; ++i)
+    {
+        AddSYMGSTasks(graph, A, r, x);
+    }
+}
+
+/*!
+  Appends the tasks of one preconditioned CG iteration, computing the same
+  vectors as an iteration of CG_ref up to the summation order of the dot
+  products. The partial dot products are summed in a fixed order, thus the
+  result does not depend on the number of threads.
+
+  @param[inout] graph   The task graph, not yet finalized
+  @param[in]    A       The known system matrix, including its coarse levels
+  @param[inout] data    The CG vectors
+  @param[inout] x       The approximate solution
+  @param[inout] scalars The scalars of the iteration, see HostTaskScalar. HPCG_TASK_OLDRTZ has to be set before each iteration but the first.
+  @param[in]    first   True for the first iteration, which copies the direction instead of updating it
+
+  @see CG_ref
+*/
+void AddCGIterationTasks(HostTaskGraph& graph,
+                         const SparseMatrix& A,
+                         CGData& data,
+                         Vector& x,
+                         double* scalars,
+                         bool first)
+{
+    local_int_t nrow = A.localNumberOfRows;
+
+    AddMGTasks(graph, A, data.r, data.z);
+
+    AddDotTasks(graph, A, nrow, data.r, data.z, &scalars[HPCG_TASK_RTZ]);
+
+    if(first)
+    {
+        AddVectorTasks(graph, HPCG_TASK_COPY, A, data.z.localLength, &data.z, NULL, data.p, NULL, 1.0);
+    }
+    else
+    {
+        AddDivideTask(graph, A, &scalars[HPCG_TASK_RTZ], &scalars[HPCG_TASK_OLDRTZ], &scalars[HPCG_TASK_BETA]);
+        AddVectorTasks(graph, HPCG_TASK_WAXPBY, A, nrow, &data.z, &data.p, data.p, &scalars[HPCG_TASK_BETA], 1.0);
+    }
+
+    AddSPMVTasks(graph, A, data.p, data.Ap);
+    AddDotTasks(graph, A, nrow, data.p, data.Ap, &scalars[HPCG_TASK_PAP]);
+    AddDivideTask(graph, A, &scalars[HPCG_TASK_RTZ], &scalars[HPCG_TASK_PAP], &scalars[HPCG_TASK_ALPHA]);
+
+    AddVectorTasks(graph, HPCG_TASK_WAXPBY, A, nrow, &x, &data.p, x, &scalars[HPCG_TASK_ALPHA], 1.0);
+    AddVectorTasks(graph, HPCG_TASK_WAXPBY, A, nrow, &data.r, &data.Ap, data.r, &scalars[HPCG_TASK_ALPHA], -1.0);
+
+    AddDotTasks(graph, A, nrow, data.r, data.r, &scalars[HPCG_TASK_RR]);
+}
+
+/*!
+  Converts the recorded dependencies into the successor lists the runtime
+  releases tasks from. No tasks can be added afterwards.
+
+  @param[inout] graph The task graph
+*/
+void FinalizeTaskGraph(HostTaskGraph& graph)
+{
+    TaskDependencyTracker* t = graph.tracker;
+
+    if(t == NULL)
+    {
+        return;
+    }
+
+    int ntasks = graph.tasks.size();
+
+    graph.successorPtr.assign(ntasks + 1, 0);
+    graph.successors.resize(t->edges.size());
+
+    for(size_t e = 0; e < t->edges.size(); ++e)
+    {
+        ++graph.successorPtr[t->edges[e].first + 1];
+    }
+
+    for(int i = 0; i < ntasks; ++i)
+    {
+        graph.successorPtr[i + 1] += graph.successorPtr[i];
+    }
+
+    // Edges are ordered by successor, thus successors are released in program order
+    std::vector<int> fill(graph.successorPtr.begin(), graph.successorPtr.end() - 1);
+
+    for(size_t e = 0; e < t->edges.size(); ++e)
+    {
+        graph.successors[fill[t->edges[e].first]++] = t->edges[e].second;
+    }
+
+    for(int i = 0; i < ntasks; ++i)
+    {
+        if(graph.numberOfPredecessors[i] == 0)
+        {
+            graph.roots.push_back(i);
+        }
+    }
+
+    delete t;
+    graph.tracker = NULL;
+}
+
+// Gauss-Seidel update of a single row, identical to ComputeSYMGS_ref
+static inline void UpdateRow(const SparseMatrix& A, const double* rv, double* xv, local_int_t i)
+{
+    const double* currentValues = A.matrixValues[i];
+    const local_int_t* currentColIndices = A.mtxIndL[i];
+    int currentNumberOfNonzeros = A.nonzerosInRow[i];
+    double currentDiagonal = A.matrixDiagonal[i][0];
+    double sum = rv[i];
+
+    for(int j = 0; j < currentNumberOfNonzeros; ++j)
+    {
+        sum -= currentValues[j] * xv[currentColIndices[j]];
+    }
+
+    // Remove diagonal contribution from the loop above
+    sum += xv[i] * currentDiagonal;
+
+    xv[i] = sum / currentDiagonal;
+}
+
+/*!
+  Runs a single task.
+
+  @param[in] task The task
+*/
+void ExecuteTask(const HostTask& task)
+{
+    const SparseMatrix& A = *task.A;
+
+    const double* xv = task.x;
+    const double* yv = task.y;
+    double* wv = task.w;
+
+    switch(task.kind)
+    {
+    case HPCG_TASK_ZERO:
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            wv[i] = 0.0;
+        }
+        break;
+
+    case HPCG_TASK_COPY:
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            wv[i] = xv[i];
+        }
+        break;
+
+    case HPCG_TASK_WAXPBY:
+    {
+        // Same rounding as ComputeWAXPBY_ref with alpha = 1 and beta = sign * beta
+        double beta = task.sign * task.beta[0];
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            wv[i] = xv[i] + beta * yv[i];
+        }
+        break;
+    }
+
+    case HPCG_TASK_SPMV:
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            double sum = 0.0;
+            const double* cur_vals = A.matrixValues[i];
+            const local_int_t* cur_inds = A.mtxIndL[i];
+            const int cur_nnz = A.nonzerosInRow[i];
+
+            for(int j = 0; j < cur_nnz; ++j)
+            {
+                sum += cur_vals[j] * xv[cur_inds[j]];
+            }
+
+            wv[i] = sum;
+        }
+        break;
+
+    case HPCG_TASK_SYMGS_FORWARD:
+        for(local_int_t k = task.begin; k < task.end; ++k)
+        {
+            UpdateRow(A, xv, wv, task.rows ? task.rows[k] : k);
+        }
+        break;
+
+    case HPCG_TASK_SYMGS_BACKWARD:
+        // Rows of a level are independent, contiguous rows are swept backwards
+        if(task.rows)
+        {
+            for(local_int_t k = task.begin; k < task.end; ++k)
+            {
+                UpdateRow(A, xv, wv, task.rows[k]);
+            }
+        }
+        else
+        {
+            for(local_int_t i = task.end - 1; i >= task.begin; --i)
+            {
+                UpdateRow(A, xv, wv, i);
+            }
+        }
+        break;
+
+    case HPCG_TASK_RESTRICTION:
+    {
+        const local_int_t* f2c = A.mgData->f2cOperator;
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            wv[i] = xv[f2c[i]] - yv[f2c[i]];
+        }
+        break;
+    }
+
+    case HPCG_TASK_PROLONGATION:
+    {
+        const local_int_t* f2c = A.mgData->f2cOperator;
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            wv[f2c[i]] += xv[i];
+        }
+        break;
+    }
+
+    case HPCG_TASK_DOT_PARTIAL:
+    {
+        double sum = 0.0;
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            sum += xv[i] * yv[i];
+        }
+
+        wv[task.index] = sum;
+        break;
+    }
+
+    case HPCG_TASK_DOT_REDUCE:
+    {
+        double sum = 0.0;
+
+        for(local_int_t i = task.begin; i < task.end; ++i)
+        {
+            sum += xv[i];
+        }
+
+#ifndef HPCG_NO_MPI
+        double global_sum = 0.0;
+        MPI_Allreduce(&sum, &global_sum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        sum = global_sum;
+#endif
+
+        wv[0] = sum;
+        break;
+    }
+
+    case HPCG_TASK_DIVIDE:
+        wv[0] = xv[0] / yv[0];
+        break;
+
+    case HPCG_TASK_EXCHANGE_HALO:
+#ifndef HPCG_NO_MPI
+        ExchangeHalo(A, *task.v);
+#endif
+        break;
+    }
+}
+
+/*!
+  Releases the task graph.
+
+  @param[inout] graph The task graph
+*/
+void DeleteTaskGraph(HostTaskGraph& graph)
+{
+    delete graph.tracker;
+    graph.tracker = NULL;
+
+    graph.tasks.clear();
+    graph.masterOnly.clear();
+    graph.numberOfPredecessors.clear();
+    graph.successorPtr.clear();
+    graph.successors.clear();
+    graph.roots.clear();
+    graph.partials.clear();
+}
@@ -0,0 +1,138 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TaskGraph.hpp
+
+ Dependency graph of chunked host tasks of the multigrid V-cycle and the CG
+ iteration
+ */
+
+#ifndef TASKGRAPH_HPP
+#define TASKGRAPH_HPP
+
+#include <deque>
+#include <vector>
+
+#include "SparseMatrix.hpp"
+#include "CGData.hpp"
+#include "Vector.hpp"
+
+//! Default largest number of rows of a task
+#define HPCG_TASK_ROWS 4096
+
+//! Smallest number of rows of a task, unless the level has fewer rows
+#define HPCG_TASK_MIN_ROWS 128
+
+/*!
+  Operation of a task, applied to the rows [begin, end) of its operands
+*/
+enum HostTaskKind
+{
+    HPCG_TASK_ZERO = 0,       //!< w = 0
+    HPCG_TASK_COPY,           //!< w = x
+    HPCG_TASK_WAXPBY,         //!< w = x + sign * beta * y
+    HPCG_TASK_SPMV,           //!< w = A * x
+    HPCG_TASK_SYMGS_FORWARD,  //!< forward Gauss-Seidel sweep on x with right hand side y
+    HPCG_TASK_SYMGS_BACKWARD, //!< backward Gauss-Seidel sweep on x with right hand side y
+    HPCG_TASK_RESTRICTION,    //!< coarse residual of the fine residual x and Axf y
+    HPCG_TASK_PROLONGATION,   //!< fine correction of the coarse solution x
+    HPCG_TASK_DOT_PARTIAL,    //!< w[index] = x' * y
+    HPCG_TASK_DOT_REDUCE,     //!< w[0] = sum of the partial dot products x[begin, end)
+    HPCG_TASK_DIVIDE,         //!< w[0] = x[0] / y[0]
+    HPCG_TASK_EXCHANGE_HALO,  //!< halo exchange of v
+    HPCG_TASK_NUMBER_OF_KINDS
+};
+
+/*!
+  Scalars of the CG iteration, shared by the graphs of all iterations
+*/
+enum HostTaskScalar
+{
+    HPCG_TASK_RTZ = 0,  //!< r' * z of the current iteration
+    HPCG_TASK_OLDRTZ,   //!< r' * z of the previous iteration
+    HPCG_TASK_PAP,      //!< p' * Ap
+    HPCG_TASK_ALPHA,    //!< step length
+    HPCG_TASK_BETA,     //!< direction update
+    HPCG_TASK_RR,       //!< r' * r, the squared residual norm
+    HPCG_TASK_NUMBER_OF_SCALARS
+};
+
+struct HostTask_STRUCT
+{
+    int kind;                //!< operation, see HostTaskKind
+    local_int_t begin;       //!< first row, or first index into rows
+    local_int_t end;         //!< one past the last row
+    const local_int_t* rows; //!< rows of a smoother level, NULL for contiguous rows
+    const SparseMatrix* A;   //!< matrix of the rows
+    Vector* v;               //!< vector of the halo exchange
+    const double* x;         //!< first input
+    const double* y;         //!< second input
+    double* w;               //!< output
+    const double* beta;      //!< scalar factor of y
+    double sign;             //!< sign of beta
+    local_int_t index;       //!< slot of a partial dot product
+};
+typedef struct HostTask_STRUCT HostTask;
+
+struct TaskDependencyTracker;
+
+/*!
+  Tasks in sequential program order. A task depends on every earlier task that
+  writes an entry it reads or writes, or reads an entry it writes, thus running
+  the tasks in any order consistent with the dependencies gives the results of
+  the sequential order.
+*/
+struct HostTaskGraph_STRUCT
+{
+    int numberOfThreads;                       //!< number of threads the chunk sizes are chosen for
+    local_int_t rowsPerTask;                   //!< largest number of rows of a task
+    std::vector<HostTask> tasks;               //!< tasks in program order
+    std::vector<char> masterOnly;              //!< tasks that call MPI and run on the calling thread
+    std::vector<int> numberOfPredecessors;     //!< number of tasks each task waits for
+    std::vector<int> successorPtr;             //!< offsets of the successors of each task
+    std::vector<int> successors;               //!< tasks released by the completion of each task
+    std::vector<int> roots;                    //!< tasks without predecessors
+    std::deque<std::vector<double> > partials; //!< partial dot products of each reduction
+    TaskDependencyTracker* tracker;            //!< access history while tasks are added, NULL once finalized
+};
+typedef struct HostTaskGraph_STRUCT HostTaskGraph;
+
+void InitializeTaskGraph(HostTaskGraph& graph, local_int_t rowsPerTask, int numberOfThreads);
+void AddMGTasks(HostTaskGraph& graph, const SparseMatrix& A, const Vector& r, Vector& x);
+void AddCGIterationTasks(HostTaskGraph& graph,
+                         const SparseMatrix& A,
+                         CGData& data,
+                         Vector& x,
+                         double* scalars,
+                         bool first);
+void FinalizeTaskGraph(HostTaskGraph& graph);
+void ExecuteTask(const HostTask& task);
+void DeleteTaskGraph(HostTaskGraph& graph);
+
+#endif // TASKGRAPH_HPP
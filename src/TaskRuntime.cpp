@@ -0,0 +1,397 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TaskRuntime.cpp
+
+ Work stealing runtime of the host task graphs
+ */
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+#include "TaskRuntime.hpp"
+#include "mytimer.hpp"
+
+#define HPCG_CACHE_LINE 64
+
+// Failed attempts to find a task before a thread yields its core
+#define HPCG_TASK_SPIN 256
+
+/*
+  Ready tasks of one thread (Chase and Lev). The owner pushes and pops at the
+  bottom without locking, other threads steal from the top. The queue holds
+  at most all tasks of a graph, thus it never wraps onto live entries.
+*/
+struct TaskDeque
+{
+    std::atomic<long long> top;
+    char pad0[HPCG_CACHE_LINE - sizeof(std::atomic<long long>)];
+    std::atomic<long long> bottom;
+    char pad1[HPCG_CACHE_LINE - sizeof(std::atomic<long long>)];
+    std::atomic<int>* buffer;
+    long long mask;
+    double busy;     // time in tasks
+    long long tasks; // tasks run
+    long long steals;
+    char pad2[HPCG_CACHE_LINE];
+};
+
+struct TaskRuntimeState
+{
+    int capacity;                // tasks the queues and counters are sized for
+    TaskDeque* deques;           // queue of each thread
+    std::atomic<int>* pending;   // predecessors of each task not yet completed
+    std::atomic<int> remaining;  // tasks not yet completed
+    char pad0[HPCG_CACHE_LINE];
+    std::atomic<int> masterTask; // ready task for the calling thread, -1 if none
+    char pad1[HPCG_CACHE_LINE];
+};
+
+static inline void Push(TaskDeque& q, int task)
+{
+    long long b = q.bottom.load(std::memory_order_relaxed);
+
+    q.buffer[b & q.mask].store(task, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    q.bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+static inline int Pop(TaskDeque& q)
+{
+    long long b = q.bottom.load(std::memory_order_relaxed) - 1;
+
+    q.bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    long long t = q.top.load(std::memory_order_relaxed);
+
+    if(t > b)
+    {
+        q.bottom.store(b + 1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    int task = q.buffer[b & q.mask].load(std::memory_order_relaxed);
+
+    // Last entry, thieves may race for it
+    if(t == b)
+    {
+        if(!q.top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            task = -1;
+        }
+
+        q.bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return task;
+}
+
+static inline int Steal(TaskDeque& q)
+{
+    long long t = q.top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long b = q.bottom.load(std::memory_order_acquire);
+
+    if(t >= b)
+    {
+        return -1;
+    }
+
+    int task = q.buffer[t & q.mask].load(std::memory_order_relaxed);
+
+    if(!q.top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return -1;
+    }
+
+    return task;
+}
+
+static void FreeState(TaskRuntimeState* state, int numberOfThreads)
+{
+    if(state == NULL)
+    {
+        return;
+    }
+
+    for(int i = 0; i < numberOfThreads; ++i)
+    {
+        delete[] state->deques[i].buffer;
+    }
+
+    delete[] state->deques;
+    delete[] state->pending;
+    delete state;
+}
+
+// Sizes the queues and counters for a graph of the given number of tasks
+static void Reserve(HostTaskRuntime& runtime, int ntasks)
+{
+    if(runtime.state != NULL && runtime.state->capacity >= ntasks)
+    {
+        return;
+    }
+
+    FreeState(runtime.state, runtime.numberOfThreads);
+
+    long long capacity = 1;
+    while(capacity < ntasks)
+    {
+        capacity <<= 1;
+    }
+
+    TaskRuntimeState* state = new TaskRuntimeState;
+
+    state->capacity = ntasks;
+    state->deques = new TaskDeque[runtime.numberOfThreads];
+    state->pending = new std::atomic<int>[ntasks];
+
+    for(int i = 0; i < runtime.numberOfThreads; ++i)
+    {
+        state->deques[i].buffer = new std::atomic<int>[capacity];
+        state->deques[i].mask = capacity - 1;
+    }
+
+    runtime.state = state;
+}
+
+// Runs and steals tasks until all tasks of the graph are complete
+static void Worker(TaskRuntimeState& s, int nthreads, const HostTaskGraph& graph, int tid, bool execute)
+{
+    TaskDeque& own = s.deques[tid];
+
+    unsigned int seed = 2654435761u * (tid + 1);
+    int idle = 0;
+
+    while(s.remaining.load(std::memory_order_acquire) > 0)
+    {
+        int task = -1;
+
+        if(tid == 0 && s.masterTask.load(std::memory_order_relaxed) >= 0)
+        {
+            task = s.masterTask.exchange(-1, std::memory_order_acq_rel);
+        }
+
+        if(task < 0)
+        {
+            task = Pop(own);
+        }
+
+        if(task < 0 && nthreads > 1)
+        {
+            // Random victim other than the calling thread
+            seed = seed * 1103515245u + 12345u;
+            int victim = (tid + 1 + (seed >> 8) % (nthreads - 1)) % nthreads;
+
+            task = Steal(s.deques[victim]);
+
+            if(task >= 0)
+            {
+                ++own.steals;
+            }
+        }
+
+        if(task < 0)
+        {
+            // Give up the core to a preempted thread holding the tasks
+            if(++idle >= HPCG_TASK_SPIN)
+            {
+                std::this_thread::yield();
+                idle = 0;
+            }
+
+            continue;
+        }
+
+        idle = 0;
+
+        if(execute)
+        {
+            mytimer_ticks_t t0 = mytimer_ticks();
+            ExecuteTask(graph.tasks[task]);
+            own.busy += mytimer_seconds(mytimer_ticks() - t0);
+        }
+
+        ++own.tasks;
+
+        // The last completed predecessor makes a task ready
+        for(int k = graph.successorPtr[task]; k < graph.successorPtr[task + 1]; ++k)
+        {
+            int next = graph.successors[k];
+
+            if(s.pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                if(graph.masterOnly[next])
+                {
+                    s.masterTask.store(next, std::memory_order_release);
+                }
+                else
+                {
+                    Push(own, next);
+                }
+            }
+        }
+
+        s.remaining.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+/*!
+  Initializes a runtime with one queue per OpenMP thread.
+
+  @param[out] runtime The runtime
+*/
+void InitializeTaskRuntime(HostTaskRuntime& runtime)
+{
+#ifndef HPCG_NO_OPENMP
+    runtime.numberOfThreads = omp_get_max_threads();
+#else
+    runtime.numberOfThreads = 1;
+#endif
+    runtime.state = NULL;
+
+    ResetTaskRuntimeStats(runtime);
+}
+
+/*!
+  Runs all tasks of a graph. Ready tasks are queued by the thread that
+  completed their last predecessor and run in last in, first out order, such
+  that a thread continues with the data it just produced. A thread with an
+  empty queue steals the oldest task of a random other thread. Tasks calling
+  MPI run on the calling thread only.
+
+  @param[inout] runtime The runtime
+  @param[in]    graph   The finalized task graph
+  @param[in]    execute False to release the tasks without running them, which measures the overhead of the runtime
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int RunTaskGraph(HostTaskRuntime& runtime, const HostTaskGraph& graph, bool execute)
+{
+    assert(graph.tracker == NULL);
+
+    int ntasks = graph.tasks.size();
+    int nthreads = runtime.numberOfThreads;
+
+    if(ntasks == 0)
+    {
+        return 0;
+    }
+
+    Reserve(runtime, ntasks);
+
+    TaskRuntimeState& s = *runtime.state;
+
+    for(int i = 0; i < ntasks; ++i)
+    {
+        s.pending[i].store(graph.numberOfPredecessors[i], std::memory_order_relaxed);
+    }
+
+    for(int i = 0; i < nthreads; ++i)
+    {
+        s.deques[i].top.store(0, std::memory_order_relaxed);
+        s.deques[i].bottom.store(0, std::memory_order_relaxed);
+        s.deques[i].busy = 0.0;
+        s.deques[i].tasks = 0;
+        s.deques[i].steals = 0;
+    }
+
+    s.remaining.store(ntasks, std::memory_order_relaxed);
+    s.masterTask.store(-1, std::memory_order_relaxed);
+
+    // Roots are dealt round robin
+    for(size_t i = 0; i < graph.roots.size(); ++i)
+    {
+        int task = graph.roots[i];
+
+        if(graph.masterOnly[task])
+        {
+            s.masterTask.store(task, std::memory_order_relaxed);
+        }
+        else
+        {
+            Push(s.deques[i % nthreads], task);
+        }
+    }
+
+    double t0 = mytimer();
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp parallel num_threads(nthreads)
+    {
+        Worker(s, nthreads, graph, omp_get_thread_num(), execute);
+    }
+#else
+    Worker(s, nthreads, graph, 0, execute);
+#endif
+
+    runtime.time += mytimer() - t0;
+    ++runtime.numberOfRuns;
+
+    for(int i = 0; i < nthreads; ++i)
+    {
+        runtime.busy += s.deques[i].busy;
+        runtime.tasks += s.deques[i].tasks;
+        runtime.steals += s.deques[i].steals;
+    }
+
+    return 0;
+}
+
+/*!
+  Clears the accumulated statistics of the runtime.
+
+  @param[inout] runtime The runtime
+*/
+void ResetTaskRuntimeStats(HostTaskRuntime& runtime)
+{
+    runtime.numberOfRuns = 0;
+    runtime.time = 0.0;
+    runtime.busy = 0.0;
+    runtime.tasks = 0;
+    runtime.steals = 0;
+}
+
+/*!
+  Releases the queues of the runtime.
+
+  @param[inout] runtime The runtime
+*/
+void DeleteTaskRuntime(HostTaskRuntime& runtime)
+{
+    FreeState(runtime.state, runtime.numberOfThreads);
+    runtime.state = NULL;
+}
@@ -0,0 +1,59 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TaskRuntime.hpp
+
+ Work stealing runtime of the host task graphs
+ */
+
+#ifndef TASKRUNTIME_HPP
+#define TASKRUNTIME_HPP
+
+#include "TaskGraph.hpp"
+
+struct TaskRuntimeState;
+
+struct HostTaskRuntime_STRUCT
+{
+    int numberOfThreads;     //!< number of threads, each owning a queue of ready tasks
+    int numberOfRuns;        //!< number of graph runs since the last reset
+    double time;             //!< accumulated time of the runs in seconds
+    double busy;             //!< accumulated time of all threads in tasks in seconds
+    long long tasks;         //!< number of tasks run
+    long long steals;        //!< number of tasks taken from the queue of another thread
+    TaskRuntimeState* state; //!< queues and dependency counters
+};
+typedef struct HostTaskRuntime_STRUCT HostTaskRuntime;
+
+void InitializeTaskRuntime(HostTaskRuntime& runtime);
+int RunTaskGraph(HostTaskRuntime& runtime, const HostTaskGraph& graph, bool execute);
+void ResetTaskRuntimeStats(HostTaskRuntime& runtime);
+void DeleteTaskRuntime(HostTaskRuntime& runtime);
+
+#endif // TASKRUNTIME_HPP
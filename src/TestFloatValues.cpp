@@ -0,0 +1,197 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestFloatValues.cpp
+
+ Convergence of CG with single precision matrix values
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "utils.hpp"
+#include "mytimer.hpp"
+#include "CG.hpp"
+#include "TestFloatValues.hpp"
+
+// Adds the iteration counts, residuals and times of both solves to the report
+static void ReportFloatValues(const FloatValuesTestData& fp32_data, ReportSections& sections)
+{
+    std::string levels;
+    for(int level = 0; (fp32_data.levels >> level) != 0; ++level)
+    {
+        if(fp32_data.levels & (1 << level))
+        {
+            levels += (levels.empty() ? "" : ",") + std::to_string(level);
+        }
+    }
+
+    OutputFile* report = sections.add(REPORT_FLOAT_VALUES, "Float Values");
+
+    report->add("Levels", levels);
+    report->add("Iterations (single precision values)", fp32_data.fp32_niters);
+    report->add("Iterations (double precision values)", fp32_data.fp64_niters);
+    report->add("Iteration count change", fp32_data.fp32_niters - fp32_data.fp64_niters);
+    report->add("Scaled residual (single precision values)", fp32_data.fp32_residual);
+    report->add("Scaled residual (double precision values)", fp32_data.fp64_residual);
+    report->add("Solve time (single precision values)", fp32_data.fp32_time);
+    report->add("Solve time (double precision values)", fp32_data.fp64_time);
+
+    sections.print("Single precision values: %+d iterations (%d vs %d), %0.2lfx solve time\n",
+                   fp32_data.fp32_niters - fp32_data.fp64_niters,
+                   fp32_data.fp32_niters,
+                   fp32_data.fp64_niters,
+                   fp32_data.fp64_time > 0.0 ? fp32_data.fp32_time / fp32_data.fp64_time : 0.0);
+}
+
+/*!
+  Solves the system to the given tolerance once with the single precision
+  matrix values of all converted levels, and once with the double precision
+  values, to report the change of the iteration count caused by the rounded
+  matrix values. Accumulation is performed in double precision in both cases.
+
+  @param[inout] A         The known system matrix, including its coarse levels
+  @param[inout] data      The data structure with all necessary CG vectors
+  @param[in]    b         The known right hand side vector
+  @param[inout] x         The solution vector, overwritten
+  @param[in]    maxIters  The maximum number of CG iterations of each solve
+  @param[in]    tolerance The scaled residual to be reached
+  @param[inout] sections  The iteration counts and residuals of both solves are added
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int TestFloatValues(SparseMatrix& A,
+                    CGData& data,
+                    const Vector& b,
+                    Vector& x,
+                    int maxIters,
+                    double tolerance,
+                    ReportSections& sections)
+{
+    FloatValuesTestData fp32_data;
+    fp32_data.levels = 0;
+    fp32_data.fp32_niters = 0;
+    fp32_data.fp64_niters = 0;
+    fp32_data.fp32_residual = 0.0;
+    fp32_data.fp64_residual = 0.0;
+    fp32_data.fp32_time = 0.0;
+    fp32_data.fp64_time = 0.0;
+
+    std::vector<float*> ell_val_f32;
+
+    int level = 0;
+    for(SparseMatrix* M = &A; M != NULL; M = M->Ac, ++level)
+    {
+        ell_val_f32.push_back(M->ell_val_f32);
+
+        if(M->ell_val_f32 != NULL)
+        {
+            fp32_data.levels |= 1 << level;
+        }
+    }
+
+    if(fp32_data.levels == 0)
+    {
+        return 0;
+    }
+
+    int err_count = 0;
+
+    for(int precision = 0; precision < 2; ++precision)
+    {
+        // Second solve falls back to the double precision values
+        if(precision == 1)
+        {
+            for(SparseMatrix* M = &A; M != NULL; M = M->Ac)
+            {
+                M->ell_val_f32 = NULL;
+            }
+        }
+
+        int niters = 0;
+        double normr = 0.0;
+        double normr0 = 0.0;
+        double times[10] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+        HIPZeroVector(x);
+
+        HIP_CHECK(hipDeviceSynchronize());
+#ifndef HPCG_NO_MPI
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+        double t0 = mytimer();
+
+        err_count += CG(A, data, b, x, maxIters, tolerance, niters, normr, normr0, times, true, false) != 0;
+
+        HIP_CHECK(hipDeviceSynchronize());
+#ifndef HPCG_NO_MPI
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+        double time = mytimer() - t0;
+
+        if(precision == 0)
+        {
+            fp32_data.fp32_niters = niters;
+            fp32_data.fp32_residual = normr / normr0;
+            fp32_data.fp32_time = time;
+        }
+        else
+        {
+            fp32_data.fp64_niters = niters;
+            fp32_data.fp64_residual = normr / normr0;
+            fp32_data.fp64_time = time;
+        }
+    }
+
+    // Restore the single precision values
+    level = 0;
+    for(SparseMatrix* M = &A; M != NULL; M = M->Ac, ++level)
+    {
+        M->ell_val_f32 = ell_val_f32[level];
+    }
+
+    ReportFloatValues(fp32_data, sections);
+
+    if(A.geom->rank == 0)
+    {
+        printf("\nSingle precision values: %d iterations (%d with double), scaled residual %le (%le)\n",
+               fp32_data.fp32_niters,
+               fp32_data.fp64_niters,
+               fp32_data.fp32_residual,
+               fp32_data.fp64_residual);
+    }
+
+    return err_count;
+}
@@ -0,0 +1,63 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestFloatValues.hpp
+
+ Convergence of CG with single precision matrix values
+ */
+
+#ifndef TESTFLOATVALUES_HPP
+#define TESTFLOATVALUES_HPP
+
+#include "SparseMatrix.hpp"
+#include "CGData.hpp"
+#include "ReportSections.hpp"
+#include "Vector.hpp"
+
+struct FloatValuesTestData_STRUCT
+{
+    int levels;            //!< bit mask of the levels with single precision values
+    int fp32_niters;       //!< CG iterations to reach the tolerance with single precision values
+    int fp64_niters;       //!< CG iterations to reach the tolerance with double precision values
+    double fp32_residual;  //!< scaled residual of the solve with single precision values
+    double fp64_residual;  //!< scaled residual of the solve with double precision values
+    double fp32_time;      //!< time of the solve with single precision values in seconds
+    double fp64_time;      //!< time of the solve with double precision values in seconds
+};
+typedef struct FloatValuesTestData_STRUCT FloatValuesTestData;
+
+int TestFloatValues(SparseMatrix& A,
+                    CGData& data,
+                    const Vector& b,
+                    Vector& x,
+                    int maxIters,
+                    double tolerance,
+                    ReportSections& sections);
+
+#endif // TESTFLOATVALUES_HPP
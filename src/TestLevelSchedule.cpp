@@ -0,0 +1,185 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestLevelSchedule.cpp
+
+ Convergence and time of the level scheduled host smoother
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <cstdio>
+#include <vector>
+
+#include "mytimer.hpp"
+#include "CG_ref.hpp"
+#include "TestLevelSchedule.hpp"
+
+// Runs the reference CG and returns its time in seconds
+static double TimeReferenceCG(SparseMatrix& A,
+                              CGData& data,
+                              const Vector& b,
+                              Vector& x,
+                              int maxIters,
+                              double tolerance,
+                              int& niters,
+                              double& scaled_residual,
+                              int& ierr)
+{
+    double normr = 0.0;
+    double normr0 = 0.0;
+    double times[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    ZeroVector(x);
+
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+    double t0 = mytimer();
+
+    ierr = CG_ref(A, data, b, x, maxIters, tolerance, niters, normr, normr0, times, true, false);
+
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    scaled_residual = normr / normr0;
+
+    return mytimer() - t0;
+}
+
+// Adds the iteration counts and times of both smoothers to the report
+static void ReportLevelSchedule(const LevelScheduleTestData& ls_data, ReportSections& sections)
+{
+    OutputFile* report = sections.add(REPORT_LEVEL_SCHEDULE, "Level Schedule");
+
+    report->add("Host threads", ls_data.nthreads);
+    report->add("Levels", (long long)ls_data.nlevels);
+    report->add("Average rows per level", (double)ls_data.nrows / ls_data.nlevels);
+    report->add("Iterations (level schedule)", ls_data.level_niters);
+    report->add("Iterations (multicoloring)", ls_data.colored_niters);
+    report->add("Scaled residual (level schedule)", ls_data.level_residual);
+    report->add("Host CG time (level schedule)", ls_data.level_time);
+    report->add("Host CG time (sequential)", ls_data.sequential_time);
+    report->add("Speedup vs sequential", ls_data.sequential_time / ls_data.level_time);
+
+    sections.print("Level scheduled SYMGS: %d iterations vs %d with multicoloring, %0.2lfx host CG speedup on %d threads\n",
+                   ls_data.level_niters,
+                   ls_data.colored_niters,
+                   ls_data.level_time > 0.0 ? ls_data.sequential_time / ls_data.level_time : 0.0,
+                   ls_data.nthreads);
+}
+
+/*!
+  Solves the system with the host reference CG to the given tolerance, once
+  with the level scheduled and once with the sequential smoother, and relates
+  the iteration count of the natural ordering to the one of the multicolored
+  optimized solver.
+
+  @param[inout] A            The known system matrix, including its coarse levels
+  @param[inout] data         The data structure with all necessary CG vectors
+  @param[in]    b            The known right hand side vector
+  @param[inout] x            The solution vector, overwritten
+  @param[in]    maxIters     The maximum number of CG iterations of each solve
+  @param[in]    tolerance    The scaled residual to be reached
+  @param[in]    coloredIters The number of iterations of the optimized solver to reach the tolerance
+  @param[inout] sections     The iteration counts and times are added
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int TestLevelSchedule(SparseMatrix& A,
+                      CGData& data,
+                      const Vector& b,
+                      Vector& x,
+                      int maxIters,
+                      double tolerance,
+                      int coloredIters,
+                      ReportSections& sections)
+{
+    if(A.lowerLevelPtr == 0)
+    {
+        return 0;
+    }
+
+    LevelScheduleTestData ls_data;
+
+    ls_data.nrows = A.localNumberOfRows;
+    ls_data.nlevels = A.numberOfLowerLevels;
+    ls_data.colored_niters = coloredIters;
+
+#ifndef HPCG_NO_OPENMP
+    ls_data.nthreads = omp_get_max_threads();
+#else
+    ls_data.nthreads = 1;
+#endif
+
+    int ierr = 0;
+    int err_count = 0;
+    int niters = 0;
+    double scaled_residual = 0.0;
+
+    ls_data.level_time = TimeReferenceCG(A, data, b, x, maxIters, tolerance, ls_data.level_niters, ls_data.level_residual, ierr);
+    err_count += ierr != 0;
+
+    // Temporarily fall back to the sequential smoother
+    std::vector<local_int_t*> lowerLevelPtr;
+    for(SparseMatrix* M = &A; M != 0; M = M->Ac)
+    {
+        lowerLevelPtr.push_back(M->lowerLevelPtr);
+        M->lowerLevelPtr = 0;
+    }
+
+    ls_data.sequential_time = TimeReferenceCG(A, data, b, x, maxIters, tolerance, niters, scaled_residual, ierr);
+    err_count += ierr != 0;
+
+    size_t level = 0;
+    for(SparseMatrix* M = &A; M != 0; M = M->Ac)
+    {
+        M->lowerLevelPtr = lowerLevelPtr[level++];
+    }
+
+    ReportLevelSchedule(ls_data, sections);
+
+    if(A.geom->rank == 0)
+    {
+        printf("\nLevel scheduled SYMGS: %d iterations (%d with multicoloring), %d levels, %0.2lfx vs sequential\n",
+               ls_data.level_niters,
+               ls_data.colored_niters,
+               (int)ls_data.nlevels,
+               ls_data.level_time > 0.0 ? ls_data.sequential_time / ls_data.level_time : 0.0);
+    }
+
+    return err_count;
+}
@@ -0,0 +1,65 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestLevelSchedule.hpp
+
+ Convergence and time of the level scheduled host smoother
+ */
+
+#ifndef TESTLEVELSCHEDULE_HPP
+#define TESTLEVELSCHEDULE_HPP
+
+#include "SparseMatrix.hpp"
+#include "CGData.hpp"
+#include "ReportSections.hpp"
+#include "Vector.hpp"
+
+struct LevelScheduleTestData_STRUCT
+{
+    local_int_t nrows;       //!< number of rows of the finest level
+    local_int_t nlevels;     //!< number of lower triangular levels of the finest level
+    int nthreads;            //!< number of host threads
+    int level_niters;        //!< CG iterations with the level scheduled smoother
+    int colored_niters;      //!< CG iterations with the multicolored smoother
+    double level_residual;   //!< scaled residual with the level scheduled smoother
+    double level_time;       //!< CG time with the level scheduled smoother in seconds
+    double sequential_time;  //!< CG time with the sequential smoother in seconds
+};
+typedef struct LevelScheduleTestData_STRUCT LevelScheduleTestData;
+
+int TestLevelSchedule(SparseMatrix& A,
+                      CGData& data,
+                      const Vector& b,
+                      Vector& x,
+                      int maxIters,
+                      double tolerance,
+                      int coloredIters,
+                      ReportSections& sections);
+
+#endif // TESTLEVELSCHEDULE_HPP
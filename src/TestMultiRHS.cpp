@@ -0,0 +1,234 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestMultiRHS.cpp
+
+ Throughput measurement of the multiple right hand side CG solve
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+
+#include "utils.hpp"
+#include "mytimer.hpp"
+#include "MultiCG.hpp"
+#include "ReportResults.hpp"
+#include "TestMultiRHS.hpp"
+
+// Number of timed solves per block size, the best one is reported
+#define MULTI_RHS_NTIMES 3
+
+// Adds the throughput of every block size to the report
+static void ReportMultiRHS(const MultiRHSTestData& mrhs_data, ReportSections& sections)
+{
+    OutputFile* report = sections.add(REPORT_MULTI_RHS, "Multi-RHS");
+
+    report->add("Iterations per solve", mrhs_data.niters);
+    sections.print("Multi-RHS CG (%d iterations per solve)\n", mrhs_data.niters);
+
+    for(int i = 0; i < MULTI_RHS_TESTS; ++i)
+    {
+        char name[32];
+        sprintf(name, "k=%d", mrhs_data.numberOfVectors[i]);
+
+        report->add(name, "");
+        OutputFile* k = report->get(name);
+
+        if(mrhs_data.skipped[i])
+        {
+            k->add("Skipped", "insufficient device memory");
+            sections.print("k = %2d   skipped\n", mrhs_data.numberOfVectors[i]);
+            continue;
+        }
+
+        k->add("Time (sec)", mrhs_data.time[i]);
+        k->add("GFLOP/s", mrhs_data.gflops[i]);
+        if(!mrhs_data.skipped[0])
+        {
+            k->add("Speedup vs k=1", mrhs_data.gflops[i] / mrhs_data.gflops[0]);
+        }
+        k->add("Max scaled residual", mrhs_data.residual[i]);
+        k->add("Max relative deviation from k=1 residual", mrhs_data.deviation[i]);
+
+        sections.print("k = %2d   %7.1lf GFlop/s   %5.2lfx vs k = 1   max scaled residual %le\n",
+                       mrhs_data.numberOfVectors[i],
+                       mrhs_data.gflops[i],
+                       mrhs_data.skipped[0] ? 0.0 : mrhs_data.gflops[i] / mrhs_data.gflops[0],
+                       mrhs_data.residual[i]);
+    }
+}
+
+/*!
+  Solves blocks of 1, 2, 4, 8 and 16 right hand sides with a fixed number of
+  CG iterations and measures the aggregate throughput of each block size.
+
+  Right hand side j of a block is (j + 1) b, so the scaled residuals of all
+  right hand sides have to match the one of the single right hand side solve.
+  Block sizes whose vectors do not fit into device memory are skipped.
+
+  @param[in]    A                The known system matrix, including its coarse levels
+  @param[in]    numberOfMgLevels Number of levels in multigrid V cycle
+  @param[in]    b                The known right hand side vector
+  @param[in]    maxIters         The number of CG iterations of every solve
+  @param[inout] sections         The measured throughput of every block size is added
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int TestMultiRHS(const SparseMatrix& A,
+                 int numberOfMgLevels,
+                 const Vector& b,
+                 int maxIters,
+                 ReportSections& sections)
+{
+    int rank = A.geom->rank;
+
+    MultiRHSTestData mrhs_data;
+    mrhs_data.niters = maxIters;
+
+    double reference = 0.0;
+
+    for(int t = 0; t < MULTI_RHS_TESTS; ++t)
+    {
+        int nrhs = 1 << t;
+
+        mrhs_data.numberOfVectors[t] = nrhs;
+        mrhs_data.skipped[t] = false;
+        mrhs_data.time[t] = 0.0;
+        mrhs_data.gflops[t] = 0.0;
+        mrhs_data.residual[t] = 0.0;
+        mrhs_data.deviation[t] = 0.0;
+
+        MultiRHSData data;
+        MultiVector B;
+        MultiVector X;
+
+        B.d_values = NULL;
+        X.d_values = NULL;
+
+        // Blocks are allocated outside of the memory pool
+        int failed = HIPInitializeMultiRHSData(A, nrhs, data) != hipSuccess;
+        failed = failed || HIPInitializeMultiVector(B, A.localNumberOfRows, nrhs) != hipSuccess;
+        failed = failed || HIPInitializeMultiVector(X, A.localNumberOfRows, nrhs) != hipSuccess;
+
+        // Clear the allocation error
+        if(failed) hipGetLastError();
+
+#ifndef HPCG_NO_MPI
+        int local_failed = failed;
+        MPI_Allreduce(&local_failed, &failed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+#endif
+
+        if(failed == 0)
+        {
+            ComputeMultiRHSFill(b, B);
+
+            double best = DBL_MAX;
+            double normr[MAX_MULTI_RHS];
+            double normr0[MAX_MULTI_RHS];
+            double time_allreduce = 0.0;
+            int niters = 0;
+
+            for(int n = 0; n < MULTI_RHS_NTIMES; ++n)
+            {
+                HIPZeroMultiVector(X);
+
+                HIP_CHECK(hipDeviceSynchronize());
+#ifndef HPCG_NO_MPI
+                MPI_Barrier(MPI_COMM_WORLD);
+#endif
+                double t0 = mytimer();
+
+                RETURN_IF_HPCG_ERROR(MultiCG(A, data, B, X, maxIters, 0.0, niters, normr, normr0, time_allreduce));
+
+                HIP_CHECK(hipDeviceSynchronize());
+#ifndef HPCG_NO_MPI
+                MPI_Barrier(MPI_COMM_WORLD);
+#endif
+                best = std::min(best, mytimer() - t0);
+            }
+
+            if(nrhs == 1)
+            {
+                reference = normr[0] / normr0[0];
+            }
+
+            for(int j = 0; j < nrhs; ++j)
+            {
+                double scaled = normr[j] / normr0[j];
+
+                mrhs_data.residual[t] = std::max(mrhs_data.residual[t], scaled);
+
+                if(reference > 0.0)
+                {
+                    mrhs_data.deviation[t] = std::max(mrhs_data.deviation[t], std::abs(scaled - reference) / reference);
+                }
+            }
+
+            // Flops of nrhs CG sets without the optimization phase overhead
+            double times[10] = {best, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+            mrhs_data.time[t] = best;
+            mrhs_data.gflops[t] = ComputeTotalGFlops(A, numberOfMgLevels, nrhs, niters, niters, times);
+        }
+        else
+        {
+            mrhs_data.skipped[t] = true;
+        }
+
+        HIPDeleteMultiVector(B);
+        HIPDeleteMultiVector(X);
+        HIPDeleteMultiRHSData(data);
+
+        if(rank == 0)
+        {
+            if(mrhs_data.skipped[t])
+            {
+                printf("Multi-RHS k = %2d    skipped (insufficient device memory)\n", nrhs);
+            }
+            else
+            {
+                printf("Multi-RHS k = %2d    %7.4lf GFlop/s    speedup %5.2lfx    max scaled residual %le\n",
+                       nrhs,
+                       mrhs_data.gflops[t],
+                       mrhs_data.gflops[0] > 0.0 ? mrhs_data.gflops[t] / mrhs_data.gflops[0] : 0.0,
+                       mrhs_data.residual[t]);
+            }
+        }
+    }
+
+    ReportMultiRHS(mrhs_data, sections);
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestMultiRHS.hpp
+
+ Throughput measurement of the multiple right hand side CG solve
+ */
+
+#ifndef TESTMULTIRHS_HPP
+#define TESTMULTIRHS_HPP
+
+#include "ReportSections.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+
+//! Number of measured block sizes, 1, 2, 4, ..., 16 right hand sides
+#define MULTI_RHS_TESTS 5
+
+struct MultiRHSTestData_STRUCT
+{
+    int niters; //!< number of CG iterations of every solve
+
+    int numberOfVectors[MULTI_RHS_TESTS]; //!< number of right hand sides of each measurement
+    bool skipped[MULTI_RHS_TESTS];        //!< true if the blocks did not fit into device memory
+    double time[MULTI_RHS_TESTS];         //!< best time of a solve in seconds
+    double gflops[MULTI_RHS_TESTS];       //!< aggregate GFLOP/s of all right hand sides
+    double residual[MULTI_RHS_TESTS];     //!< largest scaled residual of all right hand sides
+    double deviation[MULTI_RHS_TESTS];    //!< largest relative deviation of a scaled residual from the single right hand side solve
+};
+typedef struct MultiRHSTestData_STRUCT MultiRHSTestData;
+
+int TestMultiRHS(const SparseMatrix& A,
+                 int numberOfMgLevels,
+                 const Vector& b,
+                 int maxIters,
+                 ReportSections& sections);
+
+#endif // TESTMULTIRHS_HPP
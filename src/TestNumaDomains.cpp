@@ -0,0 +1,223 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestNumaDomains.cpp
+
+ Bandwidth of the host SpMV on NUMA domains against flat OpenMP
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+
+#include "mytimer.hpp"
+#include "ComputeSPMV_ref.hpp"
+#include "ExchangeHalo.hpp"
+#include "NumaDomains.hpp"
+#include "TestNumaDomains.hpp"
+
+// Memory traffic model of the reference SpMV, see ComputeSPMV_ref
+static double SpmvBytes(double nnz, double nrows)
+{
+    return nnz * (sizeof(double) + sizeof(local_int_t)) + 2.0 * nrows * sizeof(double);
+}
+
+// Adds the decomposition and the bandwidths of both variants to the report
+static void ReportNumaDomains(const NumaDomainsTestData& nd_data, ReportSections& sections)
+{
+    OutputFile* report = sections.add(REPORT_NUMA_DOMAINS, "NUMA Domains");
+
+    report->add("Host threads", nd_data.nthreads);
+    report->add("Domains", nd_data.ndomains);
+    report->add("NUMA nodes", nd_data.nnodes);
+    report->add("npx", nd_data.npx);
+    report->add("npy", nd_data.npy);
+    report->add("npz", nd_data.npz);
+    for(int d = 0; d < nd_data.ndomains; ++d)
+    {
+        report->add("Domain", d);
+        report->add("NUMA node", nd_data.node[d]);
+        report->add("Rows", (long long)nd_data.nrows[d]);
+        report->add("Boundary rows", (long long)nd_data.nboundary[d]);
+        report->add("SpMV bandwidth (GB/s)", nd_data.bandwidth[d]);
+    }
+    report->add("SpMV calls", nd_data.ncalls);
+    report->add("SpMV bandwidth (GB/s, NUMA domains)", nd_data.numa_bandwidth);
+    report->add("SpMV bandwidth (GB/s, flat OpenMP)", nd_data.flat_bandwidth);
+    report->add("Speedup vs flat OpenMP", nd_data.flat_time / nd_data.numa_time);
+
+    sections.print("NUMA domains SpMV: %0.2lf GB/s vs %0.2lf GB/s flat OpenMP (%0.2lfx) with %d domains on %d nodes\n",
+                   nd_data.numa_bandwidth,
+                   nd_data.flat_bandwidth,
+                   nd_data.flat_time / nd_data.numa_time,
+                   nd_data.ndomains,
+                   nd_data.nnodes);
+}
+
+/*!
+  Times the host SpMV of the finest level, once with flat OpenMP on the arrays
+  of the reference matrix and once on a decomposition into NUMA domains, and
+  checks that both products are identical.
+
+  @param[in]    A               The known system matrix, the host arrays are required
+  @param[in]    b               The vector to multiply
+  @param[in]    numberOfDomains The number of domains, 0 for one per NUMA node
+  @param[inout] sections        The decomposition and bandwidths are added
+
+  @return Returns zero on success and the number of differing rows otherwise.
+*/
+int TestNumaDomains(SparseMatrix& A, const Vector& b, int numberOfDomains, ReportSections& sections)
+{
+    NumaDomainsTestData nd_data;
+    NumaDomains nd;
+
+    if(SetupNumaDomains(A, numberOfDomains, nd) != 0)
+    {
+        return 0;
+    }
+
+    local_int_t nrow = A.localNumberOfRows;
+
+    Vector x;
+    Vector y_flat;
+    Vector y_numa;
+
+    InitializeVector(x, A.localNumberOfColumns);
+    InitializeVector(y_flat, nrow);
+    InitializeVector(y_numa, nrow);
+
+    ZeroVector(x);
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        x.values[i] = b.values[i];
+    }
+
+    CopyToNumaDomains(nd, x);
+
+    // About one second of flat SpMVs, the same count on all processes
+    double t0 = mytimer();
+    ComputeSPMV_ref(A, x, y_flat);
+    double t_calib = mytimer() - t0;
+
+#ifndef HPCG_NO_MPI
+    double t_local = t_calib;
+    MPI_Allreduce(&t_local, &t_calib, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+
+    int ncalls = std::max(10, std::min(1000, (int)(1.0 / std::max(t_calib, 1.0e-6))));
+
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+    t0 = mytimer();
+
+    for(int i = 0; i < ncalls; ++i)
+    {
+        ComputeSPMV_ref(A, x, y_flat);
+    }
+
+    nd_data.flat_time = (mytimer() - t0) / ncalls;
+
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+    t0 = mytimer();
+
+    for(int i = 0; i < ncalls; ++i)
+    {
+#ifndef HPCG_NO_MPI
+        ExchangeHalo(A, x);
+#endif
+        ComputeSPMV_numa(nd, x);
+    }
+
+    nd_data.numa_time = (mytimer() - t0) / ncalls;
+
+    // Rows are summed in the same order, the products are bitwise identical
+    CopyFromNumaDomains(nd, y_numa);
+
+    int err_count = 0;
+    for(local_int_t i = 0; i < nrow; ++i)
+    {
+        err_count += y_flat.values[i] != y_numa.values[i];
+    }
+
+    double bytes = SpmvBytes(A.localNumberOfNonzeros, nrow);
+
+    nd_data.ndomains = nd.numberOfDomains;
+    nd_data.nnodes = nd.numberOfNodes;
+    nd_data.npx = nd.npx;
+    nd_data.npy = nd.npy;
+    nd_data.npz = nd.npz;
+    nd_data.nthreads = nd.numberOfThreads;
+    nd_data.ncalls = ncalls;
+    nd_data.flat_bandwidth = bytes / nd_data.flat_time / 1.0e9;
+    nd_data.numa_bandwidth = bytes / nd_data.numa_time / 1.0e9;
+
+    nd_data.node.resize(nd.numberOfDomains);
+    nd_data.nrows.resize(nd.numberOfDomains);
+    nd_data.nboundary.resize(nd.numberOfDomains);
+    nd_data.bandwidth.resize(nd.numberOfDomains);
+
+    for(int d = 0; d < nd.numberOfDomains; ++d)
+    {
+        const NumaDomain& D = nd.domain[d];
+
+        nd_data.node[d] = D.node;
+        nd_data.nrows[d] = D.numberOfRows;
+        nd_data.nboundary[d] = D.numberOfBoundaryRows;
+        nd_data.bandwidth[d] = (D.time > 0.0) ? SpmvBytes(D.numberOfNonzeros, D.numberOfRows) * ncalls / D.time / 1.0e9 : 0.0;
+    }
+
+    ReportNumaDomains(nd_data, sections);
+
+    if(A.geom->rank == 0)
+    {
+        printf("\nNUMA domains SpMV: %d domains on %d nodes, %0.2lf GB/s vs %0.2lf GB/s flat OpenMP (%0.2lfx)\n",
+               nd_data.ndomains,
+               nd_data.nnodes,
+               nd_data.numa_bandwidth,
+               nd_data.flat_bandwidth,
+               nd_data.flat_time / nd_data.numa_time);
+    }
+
+    DeleteNumaDomains(nd);
+    DeleteVector(x);
+    DeleteVector(y_flat);
+    DeleteVector(y_numa);
+
+    return err_count;
+}
@@ -0,0 +1,66 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestNumaDomains.hpp
+
+ Bandwidth of the host SpMV on NUMA domains against flat OpenMP
+ */
+
+#ifndef TESTNUMADOMAINS_HPP
+#define TESTNUMADOMAINS_HPP
+
+#include <vector>
+
+#include "ReportSections.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+
+struct NumaDomainsTestData_STRUCT
+{
+    int ndomains;                       //!< number of domains
+    int nnodes;                         //!< number of NUMA nodes of the domains, 0 if unknown
+    int npx;                            //!< number of domains in x direction
+    int npy;                            //!< number of domains in y direction
+    int npz;                            //!< number of domains in z direction
+    int nthreads;                       //!< number of host threads
+    int ncalls;                         //!< number of timed SpMVs of each variant
+    std::vector<int> node;              //!< NUMA node of each domain, -1 if unknown
+    std::vector<local_int_t> nrows;     //!< number of rows of each domain
+    std::vector<local_int_t> nboundary; //!< number of rows of each domain referencing ghost entries
+    std::vector<double> bandwidth;      //!< SpMV bandwidth of each team in GB/s
+    double flat_time;                   //!< time per SpMV with flat OpenMP in seconds
+    double numa_time;                   //!< time per SpMV on the domains in seconds
+    double flat_bandwidth;              //!< SpMV bandwidth with flat OpenMP in GB/s
+    double numa_bandwidth;              //!< SpMV bandwidth on the domains in GB/s
+};
+typedef struct NumaDomainsTestData_STRUCT NumaDomainsTestData;
+
+int TestNumaDomains(SparseMatrix& A, const Vector& b, int numberOfDomains, ReportSections& sections);
+
+#endif // TESTNUMADOMAINS_HPP
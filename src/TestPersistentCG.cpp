@@ -0,0 +1,186 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestPersistentCG.cpp
+
+ Time of the host CG on one persistent thread team against a parallel region
+ per kernel
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <cstdio>
+
+#include "mytimer.hpp"
+#include "CG_ref.hpp"
+#include "CG_persistent.hpp"
+#include "TestPersistentCG.hpp"
+
+static void Barrier(void)
+{
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+}
+
+// Parallel regions of a V-cycle of ComputeMG_ref starting at A
+static int ForkJoinsMG(const SparseMatrix& A)
+{
+    // The sequential smoother runs outside of a parallel region
+    int symgs = (A.lowerLevelPtr != 0) ? 1 : 0;
+
+    if(A.mgData == 0)
+    {
+        return symgs;
+    }
+
+    // SpMV, restriction and prolongation
+    return (A.mgData->numberOfPresmootherSteps + A.mgData->numberOfPostsmootherSteps) * symgs + 3
+           + ForkJoinsMG(*A.Ac);
+}
+
+// Adds the iteration counts, times and synchronization counts of both solvers to the report
+static void ReportPersistentCG(const PersistentCGTestData& pcg_data, ReportSections& sections)
+{
+    OutputFile* report = sections.add(REPORT_PERSISTENT_CG, "Persistent CG");
+
+    report->add("Host threads", pcg_data.nthreads);
+    report->add("CG iterations (fork/join)", pcg_data.fork_join_niters);
+    report->add("CG iterations (persistent)", pcg_data.persistent_niters);
+    report->add("Scaled residual (persistent)", pcg_data.persistent_residual);
+    report->add("Parallel regions per iteration (fork/join)", pcg_data.fork_joins_per_iteration);
+    report->add("Barriers per iteration (persistent)", pcg_data.barriers_per_iteration);
+    report->add("Time per iteration (fork/join)", pcg_data.fork_join_time / pcg_data.fork_join_niters);
+    report->add("Time per iteration (persistent)", pcg_data.persistent_time / pcg_data.persistent_niters);
+    report->add("Speedup vs fork/join", pcg_data.fork_join_time / pcg_data.persistent_time);
+
+    sections.print("Persistent CG: %0.2lfx host CG speedup vs fork/join with %0.1lf barriers vs %d parallel regions per iteration\n",
+                   pcg_data.persistent_time > 0.0 ? pcg_data.fork_join_time / pcg_data.persistent_time : 0.0,
+                   pcg_data.barriers_per_iteration,
+                   pcg_data.fork_joins_per_iteration);
+}
+
+/*!
+  Solves the system with the host reference CG to the given tolerance, once
+  with a parallel region per kernel (CG_ref) and once with all kernels run by
+  one persistent thread team (CG_persistent), and counts the parallel regions
+  of an iteration of the former and the barriers of the latter.
+
+  @param[inout] A         The known system matrix, including its coarse levels
+  @param[inout] data      The data structure with all necessary CG vectors
+  @param[in]    b         The known right hand side vector
+  @param[inout] x         The solution vector, overwritten
+  @param[in]    maxIters  The maximum number of CG iterations of each solve
+  @param[in]    tolerance The scaled residual to be reached
+  @param[inout] sections  The iteration counts, times and synchronization counts are added
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int TestPersistentCG(SparseMatrix& A,
+                     CGData& data,
+                     const Vector& b,
+                     Vector& x,
+                     int maxIters,
+                     double tolerance,
+                     ReportSections& sections)
+{
+    // Both solvers run on the host reference data
+    if(A.mtxIndL == 0)
+    {
+        return 0;
+    }
+
+    PersistentCGTestData pcg_data;
+
+#ifndef HPCG_NO_OPENMP
+    pcg_data.nthreads = omp_get_max_threads();
+
+    // Dot products, vector updates and SpMV of an iteration
+    pcg_data.fork_joins_per_iteration = ForkJoinsMG(A) + 7;
+#else
+    pcg_data.nthreads = 1;
+    pcg_data.fork_joins_per_iteration = 0;
+#endif
+
+    int ierr = 0;
+    int err_count = 0;
+    double normr = 0.0;
+    double normr0 = 0.0;
+    double times[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    ZeroVector(x);
+
+    Barrier();
+    double t0 = mytimer();
+
+    ierr = CG_ref(A, data, b, x, maxIters, tolerance, pcg_data.fork_join_niters, normr, normr0, times, true, false);
+    err_count += ierr != 0;
+
+    Barrier();
+    pcg_data.fork_join_time = mytimer() - t0;
+
+    long long barriers = 0;
+
+    ZeroVector(x);
+
+    Barrier();
+    t0 = mytimer();
+
+    ierr = CG_persistent(A, data, b, x, maxIters, tolerance, pcg_data.persistent_niters, normr, normr0, barriers);
+    err_count += ierr != 0;
+
+    Barrier();
+    pcg_data.persistent_time = mytimer() - t0;
+    pcg_data.persistent_residual = normr / normr0;
+
+    // Including the barriers of the initial residual
+    pcg_data.barriers_per_iteration
+        = (pcg_data.persistent_niters > 0) ? (double)barriers / pcg_data.persistent_niters : 0.0;
+
+    ReportPersistentCG(pcg_data, sections);
+
+    if(A.geom->rank == 0)
+    {
+        printf("\nPersistent CG: %d iterations (%d fork/join), %0.1lf barriers vs %d parallel regions per iteration, "
+               "%0.2lfx vs fork/join\n",
+               pcg_data.persistent_niters,
+               pcg_data.fork_join_niters,
+               pcg_data.barriers_per_iteration,
+               pcg_data.fork_joins_per_iteration,
+               pcg_data.persistent_time > 0.0 ? pcg_data.fork_join_time / pcg_data.persistent_time : 0.0);
+    }
+
+    return err_count;
+}
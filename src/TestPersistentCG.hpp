@@ -0,0 +1,65 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestPersistentCG.hpp
+
+ Time of the host CG on one persistent thread team against a parallel region
+ per kernel
+ */
+
+#ifndef TESTPERSISTENTCG_HPP
+#define TESTPERSISTENTCG_HPP
+
+#include "SparseMatrix.hpp"
+#include "CGData.hpp"
+#include "ReportSections.hpp"
+#include "Vector.hpp"
+
+struct PersistentCGTestData_STRUCT
+{
+    int nthreads;                     //!< number of host threads
+    int fork_join_niters;             //!< CG iterations with a parallel region per kernel
+    int persistent_niters;            //!< CG iterations on the persistent team
+    double persistent_residual;       //!< scaled residual on the persistent team
+    double fork_join_time;            //!< CG time with a parallel region per kernel in seconds
+    double persistent_time;           //!< CG time on the persistent team in seconds
+    int fork_joins_per_iteration;     //!< parallel regions of an iteration of CG_ref
+    double barriers_per_iteration;    //!< barriers of the team per iteration
+};
+typedef struct PersistentCGTestData_STRUCT PersistentCGTestData;
+
+int TestPersistentCG(SparseMatrix& A,
+                     CGData& data,
+                     const Vector& b,
+                     Vector& x,
+                     int maxIters,
+                     double tolerance,
+                     ReportSections& sections);
+
+#endif // TESTPERSISTENTCG_HPP
@@ -0,0 +1,271 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestReproducibleDot.cpp
+
+ Bit reproducibility and cost of the binned dot products
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#ifndef HPCG_NO_OPENMP
+#include <omp.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "mytimer.hpp"
+#include "CG_ref.hpp"
+#include "ComputeDotProduct.hpp"
+#include "ComputeDotProduct_ref.hpp"
+#include "ReproducibleSum.hpp"
+#include "TestReproducibleDot.hpp"
+
+// Dot products of each timed set
+#define REPRO_DOT_CALLS 100
+
+// Iterations of the reference CG whose residuals are compared
+#define REPRO_CG_ITERS 10
+
+// Largest overhead of a binned over a plain dot product that meets the target
+#define REPRO_OVERHEAD_TARGET 0.2
+
+static void Barrier(void)
+{
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+}
+
+static void SetThreads(int nthreads)
+{
+#ifndef HPCG_NO_OPENMP
+    omp_set_num_threads(nthreads);
+#endif
+}
+
+static bool SameBits(double a, double b)
+{
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// Seconds per dot product b'b on the device or the host, including the reduction across ranks
+static double TimeDot(local_int_t n, const Vector& b, bool device)
+{
+    double result         = 0.0;
+    double time_allreduce = 0.0;
+    bool isOptimized      = true;
+
+    Barrier();
+    double t0 = mytimer();
+
+    for(int i = 0; i < REPRO_DOT_CALLS; ++i)
+    {
+        if(device)
+        {
+            ComputeDotProduct(n, b, b, result, time_allreduce, isOptimized);
+        }
+        else
+        {
+            ComputeDotProduct_ref(n, b, b, result, time_allreduce);
+        }
+    }
+
+    Barrier();
+
+    return (mytimer() - t0) / REPRO_DOT_CALLS;
+}
+
+// Adds the results as exact bit patterns, the times and the overheads to the report
+static void ReportReproducibleDot(const ReproducibleDotTestData& rd_data, ReportSections& sections)
+{
+    OutputFile* report = sections.add(REPORT_REPRODUCIBLE_DOT, "Reproducible DDOT");
+
+    // Exact bit patterns, for comparison across runs with other thread and rank counts
+    char hex[32];
+    snprintf(hex, sizeof(hex), "%a", rd_data.device_dot);
+
+    report->add("Device b'b", std::string(hex));
+    report->add("Device time per DDOT (plain)", rd_data.device_time);
+    report->add("Device time per DDOT (reproducible)", rd_data.device_repro_time);
+    report->add("Overhead target", REPRO_OVERHEAD_TARGET);
+    report->add("Device overhead", rd_data.device_repro_time / rd_data.device_time - 1.0);
+    report->add("Device overhead within target",
+              rd_data.device_repro_time <= (1.0 + REPRO_OVERHEAD_TARGET) * rd_data.device_time ? "PASSED" : "FAILED");
+
+    sections.print("Reproducible DDOT: %0.1lf%% overhead on the device",
+                   rd_data.device_time > 0.0 ? 100.0 * (rd_data.device_repro_time / rd_data.device_time - 1.0) : 0.0);
+
+    if(rd_data.host)
+    {
+        report->add("Host threads", rd_data.nthreads);
+        snprintf(hex, sizeof(hex), "%a", rd_data.host_dot);
+        report->add("Host b'b", std::string(hex));
+        report->add("Host b'b for 1 to all threads", rd_data.host_identical ? "PASSED" : "FAILED");
+        snprintf(hex, sizeof(hex), "%a", rd_data.cg_residual);
+        report->add("Reference CG iterations", rd_data.cg_niters);
+        report->add("Reference CG residual", std::string(hex));
+        report->add("Reference CG residual for 1 and all threads", rd_data.cg_identical ? "PASSED" : "FAILED");
+        report->add("Host time per DDOT (plain)", rd_data.host_time);
+        report->add("Host time per DDOT (reproducible)", rd_data.host_repro_time);
+        report->add("Host overhead", rd_data.host_repro_time / rd_data.host_time - 1.0);
+        report->add("Host overhead within target",
+                  rd_data.host_repro_time <= (1.0 + REPRO_OVERHEAD_TARGET) * rd_data.host_time ? "PASSED" : "FAILED");
+
+        sections.print(", %0.1lf%% on the host, %sbit-identical for 1 to %d threads",
+                       rd_data.host_time > 0.0 ? 100.0 * (rd_data.host_repro_time / rd_data.host_time - 1.0) : 0.0,
+                       rd_data.host_identical && rd_data.cg_identical ? "" : "NOT ",
+                       rd_data.nthreads);
+    }
+
+    sections.print(" (target %0.0lf%%)\n", 100.0 * REPRO_OVERHEAD_TARGET);
+}
+
+/*!
+  Times the device and host dot products with plain and with binned summation.
+  On the host reference data, computes b'b with every number of threads up to
+  the maximum and runs a fixed number of reference CG iterations with one and
+  with all threads, expecting bit-identical results. The binned summation is
+  left enabled or disabled as on entry.
+
+  @param[inout] A        The known system matrix, including its coarse levels
+  @param[inout] data     The data structure with all necessary CG vectors
+  @param[in]    b        The known right hand side vector
+  @param[inout] x        The solution vector, overwritten
+  @param[inout] sections The results and times are added
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+int TestReproducibleDot(SparseMatrix& A,
+                        CGData& data,
+                        const Vector& b,
+                        Vector& x,
+                        ReportSections& sections)
+{
+    ReproducibleDotTestData rd_data;
+
+    local_int_t n = A.localNumberOfRows;
+    bool repro    = GetReproducibleDot();
+
+    int err_count         = 0;
+    double time_allreduce = 0.0;
+    bool isOptimized      = true;
+
+    SetReproducibleDot(false);
+    rd_data.device_time = TimeDot(n, b, true);
+
+    SetReproducibleDot(true);
+    rd_data.device_repro_time = TimeDot(n, b, true);
+
+    err_count += ComputeDotProduct(n, b, b, rd_data.device_dot, time_allreduce, isOptimized) != 0;
+
+    // The host checks run on the reference data
+    rd_data.host = A.mtxIndL != 0;
+
+    if(rd_data.host)
+    {
+#ifndef HPCG_NO_OPENMP
+        rd_data.nthreads = omp_get_max_threads();
+#else
+        rd_data.nthreads = 1;
+#endif
+
+        SetReproducibleDot(false);
+        rd_data.host_time = TimeDot(n, b, false);
+
+        SetReproducibleDot(true);
+        rd_data.host_repro_time = TimeDot(n, b, false);
+
+        err_count += ComputeDotProduct_ref(n, b, b, rd_data.host_dot, time_allreduce) != 0;
+
+        rd_data.host_identical = true;
+
+        for(int nthreads = 1; nthreads <= rd_data.nthreads; ++nthreads)
+        {
+            double dot = 0.0;
+
+            SetThreads(nthreads);
+            err_count += ComputeDotProduct_ref(n, b, b, dot, time_allreduce) != 0;
+
+            rd_data.host_identical &= SameBits(dot, rd_data.host_dot);
+        }
+
+        // Residuals of the reference CG with one and with all threads
+        double normr[2] = {0.0, 0.0};
+
+        for(int pass = 0; pass < 2; ++pass)
+        {
+            int niters    = 0;
+            double normr0 = 0.0;
+            double times[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+            SetThreads(pass == 0 ? 1 : rd_data.nthreads);
+            ZeroVector(x);
+
+            int ierr = CG_ref(
+                A, data, b, x, REPRO_CG_ITERS, 0.0, niters, normr[pass], normr0, times, true, false);
+            err_count += ierr != 0;
+
+            rd_data.cg_niters = niters;
+        }
+
+        SetThreads(rd_data.nthreads);
+
+        rd_data.cg_identical = SameBits(normr[0], normr[1]);
+        rd_data.cg_residual  = normr[1];
+    }
+
+    SetReproducibleDot(repro);
+
+    ReportReproducibleDot(rd_data, sections);
+
+    if(A.geom->rank == 0)
+    {
+        printf("\nReproducible DDOT: %0.2lfx the time of plain summation on the device",
+               rd_data.device_time > 0.0 ? rd_data.device_repro_time / rd_data.device_time : 0.0);
+
+        if(rd_data.host)
+        {
+            bool identical = rd_data.host_identical && rd_data.cg_identical;
+
+            printf(", %0.2lfx on the host, %sbit-identical for 1 to %d threads",
+                   rd_data.host_time > 0.0 ? rd_data.host_repro_time / rd_data.host_time : 0.0,
+                   identical ? "" : "NOT ",
+                   rd_data.nthreads);
+        }
+
+        printf("\n");
+    }
+
+    return err_count;
+}
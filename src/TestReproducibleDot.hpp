@@ -0,0 +1,66 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestReproducibleDot.hpp
+
+ Bit reproducibility and cost of the binned dot products
+ */
+
+#ifndef TESTREPRODUCIBLEDOT_HPP
+#define TESTREPRODUCIBLEDOT_HPP
+
+#include "SparseMatrix.hpp"
+#include "CGData.hpp"
+#include "ReportSections.hpp"
+#include "Vector.hpp"
+
+struct ReproducibleDotTestData_STRUCT
+{
+    bool host;                  //!< true if the host checks ran on the reference data
+    int nthreads;               //!< largest number of host threads
+    int cg_niters;              //!< iterations of the reference CG that are compared
+    bool host_identical;        //!< host b'b bit-identical for 1 to nthreads threads
+    bool cg_identical;          //!< reference CG residual bit-identical for 1 and nthreads threads
+    double host_dot;            //!< host b'b, the same for any number of threads and ranks
+    double device_dot;          //!< device b'b, the same for any number of ranks
+    double cg_residual;         //!< residual norm of the reference CG after cg_niters iterations
+    double host_time;           //!< time of a plain host dot product in seconds
+    double host_repro_time;     //!< time of a binned host dot product in seconds
+    double device_time;         //!< time of a plain device dot product in seconds
+    double device_repro_time;   //!< time of a binned device dot product in seconds
+};
+typedef struct ReproducibleDotTestData_STRUCT ReproducibleDotTestData;
+
+int TestReproducibleDot(SparseMatrix& A,
+                        CGData& data,
+                        const Vector& b,
+                        Vector& x,
+                        ReportSections& sections);
+
+#endif // TESTREPRODUCIBLEDOT_HPP
@@ -0,0 +1,287 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestTaskRuntime.cpp
+
+ Time of the host V-cycle and CG as task graphs against a parallel region per
+ kernel
+ */
+
+#ifndef HPCG_NO_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+
+#include "mytimer.hpp"
+#include "CG_ref.hpp"
+#include "CG_tasks.hpp"
+#include "ComputeMG_ref.hpp"
+#include "TaskGraph.hpp"
+#include "TaskRuntime.hpp"
+#include "TestTaskRuntime.hpp"
+
+static void Barrier(void)
+{
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+}
+
+// About a quarter second of V-cycles, the same count on all processes
+static int CalibrateCalls(double t_calib)
+{
+#ifndef HPCG_NO_MPI
+    double t_local = t_calib;
+    MPI_Allreduce(&t_local, &t_calib, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+
+    return std::max(5, std::min(1000, (int)(0.25 / std::max(t_calib, 1.0e-6))));
+}
+
+// Adds the V-cycle and CG times of both variants and the runtime statistics to the report
+static void ReportTaskRuntime(const TaskRuntimeTestData& tr_data, ReportSections& sections)
+{
+    OutputFile* report = sections.add(REPORT_TASK_RUNTIME, "Task Runtime");
+
+    report->add("Host threads", tr_data.nthreads);
+    report->add("Rows per task", (long long)tr_data.rowsPerTask);
+    for(size_t l = 0; l < tr_data.ntasks.size(); ++l)
+    {
+        report->add("Grid Level", (int)l);
+        report->add("V-cycle tasks", tr_data.ntasks[l]);
+        report->add("V-cycle calls", tr_data.ncalls[l]);
+        report->add("V-cycle time (fork/join)", tr_data.fork_join_time[l]);
+        report->add("V-cycle time (tasks)", tr_data.task_time[l]);
+        report->add("V-cycle runtime overhead", tr_data.overhead_time[l]);
+        report->add("Steals per V-cycle", tr_data.steals[l]);
+        report->add("Speedup vs fork/join", tr_data.fork_join_time[l] / tr_data.task_time[l]);
+    }
+    report->add("CG iterations (fork/join)", tr_data.fork_join_niters);
+    report->add("CG iterations (tasks)", tr_data.task_niters);
+    report->add("Scaled residual (tasks)", tr_data.task_residual);
+    report->add("Host CG time (fork/join)", tr_data.fork_join_cg_time);
+    report->add("Host CG time (tasks)", tr_data.task_cg_time);
+    report->add("Busy fraction", tr_data.busy_fraction);
+    report->add("CG speedup vs fork/join", tr_data.fork_join_cg_time / tr_data.task_cg_time);
+
+    sections.print("Task runtime: %0.2lfx host CG speedup vs fork/join with %d iterations (%d) on %d threads\n",
+                   tr_data.task_cg_time > 0.0 ? tr_data.fork_join_cg_time / tr_data.task_cg_time : 0.0,
+                   tr_data.task_niters,
+                   tr_data.fork_join_niters,
+                   tr_data.nthreads);
+}
+
+/*!
+  Times the host V-cycle starting at each multigrid level, once with
+  ComputeMG_ref and once as a task graph, and the graph once more without
+  running its tasks, which gives the overhead of the runtime. The V-cycles
+  have to give identical results. Then, the system is solved to the given
+  tolerance with CG_ref and with CG on task graphs.
+
+  @param[inout] A           The known system matrix, including its coarse levels
+  @param[inout] data        The data structure with all necessary CG vectors
+  @param[in]    b           The known right hand side vector
+  @param[inout] x           The solution vector, overwritten
+  @param[in]    maxIters    The maximum number of CG iterations of each solve
+  @param[in]    tolerance   The scaled residual to be reached
+  @param[in]    rowsPerTask The largest number of rows of a task, 0 for the default
+  @param[inout] sections    The times, iteration counts and runtime statistics are added
+
+  @return Returns zero on success and the number of differing V-cycle results otherwise.
+*/
+int TestTaskRuntime(SparseMatrix& A,
+                    CGData& data,
+                    const Vector& b,
+                    Vector& x,
+                    int maxIters,
+                    double tolerance,
+                    local_int_t rowsPerTask,
+                    ReportSections& sections)
+{
+    // The graphs run on the host reference data
+    if(A.mtxIndL == 0)
+    {
+        return 0;
+    }
+
+    TaskRuntimeTestData tr_data;
+
+    if(rowsPerTask <= 0)
+    {
+        rowsPerTask = HPCG_TASK_ROWS;
+    }
+
+    HostTaskRuntime runtime;
+    InitializeTaskRuntime(runtime);
+
+    tr_data.nthreads = runtime.numberOfThreads;
+    tr_data.rowsPerTask = rowsPerTask;
+    tr_data.ntasks.clear();
+    tr_data.ncalls.clear();
+    tr_data.fork_join_time.clear();
+    tr_data.task_time.clear();
+    tr_data.overhead_time.clear();
+    tr_data.steals.clear();
+
+    int err_count = 0;
+
+    // Inputs of the coarse levels, as restricted by a V-cycle on the finest level
+    Vector x_ref;
+    InitializeVector(x_ref, A.localNumberOfColumns);
+    ComputeMG_ref(A, b, x_ref);
+    DeleteVector(x_ref);
+
+    const Vector* r = &b;
+
+    for(SparseMatrix* M = &A; M != 0; M = M->Ac)
+    {
+        Vector x_task;
+
+        InitializeVector(x_ref, M->localNumberOfColumns);
+        InitializeVector(x_task, M->localNumberOfColumns);
+
+        HostTaskGraph graph;
+        InitializeTaskGraph(graph, rowsPerTask, runtime.numberOfThreads);
+        AddMGTasks(graph, *M, *r, x_task);
+        FinalizeTaskGraph(graph);
+
+        double t0 = mytimer();
+        ComputeMG_ref(*M, *r, x_ref);
+        int ncalls = CalibrateCalls(mytimer() - t0);
+
+        Barrier();
+        t0 = mytimer();
+
+        for(int i = 0; i < ncalls; ++i)
+        {
+            ComputeMG_ref(*M, *r, x_ref);
+        }
+
+        tr_data.fork_join_time.push_back((mytimer() - t0) / ncalls);
+
+        RunTaskGraph(runtime, graph, true);
+        ResetTaskRuntimeStats(runtime);
+
+        Barrier();
+        t0 = mytimer();
+
+        for(int i = 0; i < ncalls; ++i)
+        {
+            RunTaskGraph(runtime, graph, true);
+        }
+
+        tr_data.task_time.push_back((mytimer() - t0) / ncalls);
+        tr_data.steals.push_back((double)runtime.steals / ncalls);
+
+        // Dependencies only, no task runs
+        Barrier();
+        t0 = mytimer();
+
+        for(int i = 0; i < ncalls; ++i)
+        {
+            RunTaskGraph(runtime, graph, false);
+        }
+
+        tr_data.overhead_time.push_back((mytimer() - t0) / ncalls);
+        tr_data.ntasks.push_back(graph.tasks.size());
+        tr_data.ncalls.push_back(ncalls);
+
+        // Every task reads the values of the sequential order, the results are bitwise identical
+        for(local_int_t i = 0; i < M->localNumberOfRows; ++i)
+        {
+            err_count += x_ref.values[i] != x_task.values[i];
+        }
+
+        DeleteTaskGraph(graph);
+        DeleteVector(x_ref);
+        DeleteVector(x_task);
+
+        if(M->mgData != 0)
+        {
+            r = M->mgData->rc;
+        }
+    }
+
+    DeleteTaskRuntime(runtime);
+
+    // Whole solves, both from a zero initial guess
+    int niters = 0;
+    double normr = 0.0;
+    double normr0 = 0.0;
+    double times[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    ZeroVector(x);
+
+    Barrier();
+    double t0 = mytimer();
+
+    int ierr = CG_ref(A, data, b, x, maxIters, tolerance, niters, normr, normr0, times, true, false);
+    err_count += ierr != 0;
+
+    Barrier();
+    tr_data.fork_join_cg_time = mytimer() - t0;
+    tr_data.fork_join_niters = niters;
+
+    HostTaskCG cg;
+    SetupTaskCG(cg, A, data, x, rowsPerTask);
+
+    ZeroVector(x);
+
+    Barrier();
+    t0 = mytimer();
+
+    ierr = CG_tasks(cg, A, data, b, x, maxIters, tolerance, tr_data.task_niters, normr, normr0);
+    err_count += ierr != 0;
+
+    Barrier();
+    tr_data.task_cg_time = mytimer() - t0;
+    tr_data.task_residual = normr / normr0;
+    tr_data.busy_fraction = (cg.runtime.time > 0.0)
+                                ? cg.runtime.busy / (cg.runtime.time * cg.runtime.numberOfThreads)
+                                : 0.0;
+
+    DeleteTaskCG(cg);
+
+    ReportTaskRuntime(tr_data, sections);
+
+    if(A.geom->rank == 0)
+    {
+        printf("\nTask runtime: CG %d iterations (%d fork/join), %0.2lfx vs fork/join, "
+               "fine V-cycle %0.2lfx with %0.1lf%% runtime overhead\n",
+               tr_data.task_niters,
+               tr_data.fork_join_niters,
+               tr_data.task_cg_time > 0.0 ? tr_data.fork_join_cg_time / tr_data.task_cg_time : 0.0,
+               tr_data.task_time[0] > 0.0 ? tr_data.fork_join_time[0] / tr_data.task_time[0] : 0.0,
+               tr_data.task_time[0] > 0.0 ? 100.0 * tr_data.overhead_time[0] / tr_data.task_time[0] : 0.0);
+    }
+
+    return err_count;
+}
@@ -0,0 +1,74 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file TestTaskRuntime.hpp
+
+ Time of the host V-cycle and CG as task graphs against a parallel region per
+ kernel
+ */
+
+#ifndef TESTTASKRUNTIME_HPP
+#define TESTTASKRUNTIME_HPP
+
+#include <vector>
+
+#include "SparseMatrix.hpp"
+#include "CGData.hpp"
+#include "ReportSections.hpp"
+#include "Vector.hpp"
+
+struct TaskRuntimeTestData_STRUCT
+{
+    int nthreads;                        //!< number of host threads
+    local_int_t rowsPerTask;             //!< largest number of rows of a task
+    std::vector<int> ntasks;             //!< number of tasks of the V-cycle starting at each level
+    std::vector<int> ncalls;             //!< number of timed V-cycles starting at each level
+    std::vector<double> fork_join_time;  //!< time per V-cycle of ComputeMG_ref in seconds
+    std::vector<double> task_time;       //!< time per V-cycle of the task graph in seconds
+    std::vector<double> overhead_time;   //!< time per V-cycle of the graph without its tasks in seconds
+    std::vector<double> steals;          //!< stolen tasks per V-cycle
+    int fork_join_niters;                //!< CG iterations with a parallel region per kernel
+    int task_niters;                     //!< CG iterations with task graphs
+    double task_residual;                //!< scaled residual with task graphs
+    double fork_join_cg_time;            //!< CG time with a parallel region per kernel in seconds
+    double task_cg_time;                 //!< CG time with task graphs in seconds
+    double busy_fraction;                //!< fraction of the thread time of the task graph CG spent in tasks
+};
+typedef struct TaskRuntimeTestData_STRUCT TaskRuntimeTestData;
+
+int TestTaskRuntime(SparseMatrix& A,
+                    CGData& data,
+                    const Vector& b,
+                    Vector& x,
+                    int maxIters,
+                    double tolerance,
+                    local_int_t rowsPerTask,
+                    ReportSections& sections);
+
+#endif // TESTTASKRUNTIME_HPP
@@ -55,6 +55,7 @@
 
 #include "utils.hpp"
 #include "Geometry.hpp"
+#include "HostMemory.hpp"
 
 struct Vector_STRUCT {
   local_int_t localLength;  //!< length of local portion of the vector
@@ -77,7 +78,7 @@ typedef struct Vector_STRUCT Vector;
  */
 inline void InitializeVector(Vector & v, local_int_t localLength) {
   v.localLength = localLength;
-  v.values = new double[localLength];
+  v.values = (double*)hostMalloc(sizeof(double) * localLength);
   v.optimizationData = 0;
   return;
 }
@@ -175,7 +176,7 @@ inline void HIPCopyVector(const Vector& v, Vector& w)
  */
 inline void DeleteVector(Vector & v) {
 
-  delete [] v.values;
+  hostFree(v.values);
   v.localLength = 0;
   return;
 }
@@ -12,6 +12,34 @@
 // ***************************************************
 //@HEADER
 
+/* ************************************************************************
+ * Modifications (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
 /*!
  @file WriteProblem.cpp
 
@@ -19,7 +47,23 @@
  */
 
 #include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <hip/hip_runtime_api.h>
+
 #include "WriteProblem.hpp"
+#include "ComputeSPMV.hpp"
+#include "ComputeSYMGS.hpp"
+
+// Sections of the binary dump start on a page boundary and data is streamed
+// through a pinned, page aligned staging buffer. This keeps the file layout
+// compatible with O_DIRECT readers and avoids a full host copy of the matrix.
+#define DUMP_ALIGNMENT 4096
+#define DUMP_CHUNK_SIZE (64 << 20)
+#define DUMP_VERSION 1
 
 
 /*!
@@ -90,3 +134,244 @@ int WriteProblem( const Geometry & geom, const SparseMatrix & A,
   fclose(fb);
   return 0;
 }
+
+struct DumpSection {
+  std::string name; //!< name of the section
+  const char * dtype; //!< element type, i4, i8 or f8
+  size_t count; //!< number of elements
+  size_t offset; //!< byte offset of the section in the binary file
+};
+
+template<class T>
+static const char * DumpIntType() { return sizeof(T) == 8 ? "i8" : "i4"; }
+
+/*!
+  Appends a section to an open binary dump file.
+
+  @param[in]    fd       File descriptor of the binary dump
+  @param[inout] offset   On entry, the current end of file; on exit, the end of file after the section has been written
+  @param[inout] sections Section table, the new section is appended
+  @param[in]    name     Name of the section
+  @param[in]    dtype    Element type of the section
+  @param[in]    elsize   Size of each element in bytes
+  @param[in]    count    Number of elements
+  @param[in]    ptr      Pointer to the data
+  @param[in]    device   True if ptr is a device pointer
+  @param[in]    staging  Pinned host buffer of DUMP_CHUNK_SIZE bytes
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int WriteDumpSection(int fd, size_t & offset, std::vector<DumpSection> & sections,
+    const char * name, const char * dtype, size_t elsize, size_t count,
+    const void * ptr, bool device, char * staging) {
+
+  DumpSection section;
+  section.name = name;
+  section.dtype = dtype;
+  section.count = count;
+  section.offset = (offset + DUMP_ALIGNMENT - 1) / DUMP_ALIGNMENT * DUMP_ALIGNMENT;
+  sections.push_back(section);
+
+  size_t bytes = elsize * count;
+  const char * src = reinterpret_cast<const char *>(ptr);
+
+  for (size_t done = 0; done < bytes; ) {
+    size_t chunk = bytes - done < DUMP_CHUNK_SIZE ? bytes - done : DUMP_CHUNK_SIZE;
+    const char * buf = src + done;
+    if (device) {
+      RETURN_IF_HIP_ERROR(hipMemcpy(staging, buf, chunk, hipMemcpyDeviceToHost));
+      buf = staging;
+    }
+    for (size_t written = 0; written < chunk; ) {
+      ssize_t ret = pwrite(fd, buf + written, chunk - written, section.offset + done + written);
+      if (ret <= 0) return -1;
+      written += ret;
+    }
+    done += chunk;
+  }
+
+  offset = section.offset + bytes;
+  return 0;
+}
+
+/*!
+  Dumps a single multigrid level of the optimized problem in binary format.
+
+  @param[in] A       The system matrix of this level
+  @param[in] b       The right hand side vector (fine level only, may be NULL)
+  @param[in] xexact  The exact solution vector (fine level only, may be NULL)
+  @param[in] level   The multigrid level
+  @param[in] prefix  File name prefix
+  @param[in] staging Pinned host buffer of DUMP_CHUNK_SIZE bytes
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int WriteLevelBinary(const SparseMatrix & A, const Vector * b, const Vector * xexact,
+    int level, const char * prefix, char * staging) {
+
+  const Geometry & geom = *A.geom;
+  local_int_t nrow = A.localNumberOfRows;
+  local_int_t ncol = A.localNumberOfColumns;
+
+  char binname[1024], jsonname[1024];
+  snprintf(binname, sizeof(binname), "%s_l%d_r%d.bin", prefix, level, geom.rank);
+  snprintf(jsonname, sizeof(jsonname), "%s_l%d_r%d.json", prefix, level, geom.rank);
+
+  // Probe the optimized kernels, so the reader can verify its own results
+  // against the live run: y = A * x and z = SYMGS(r, z0)
+  Vector x, y, r, z0, z;
+  HIPInitializeVector(x, ncol);
+  HIPInitializeVector(y, nrow);
+  HIPInitializeVector(r, nrow);
+  HIPInitializeVector(z0, ncol);
+  HIPInitializeVector(z, ncol);
+
+  HIPFillRandomVector(x);
+  HIPFillRandomVector(r);
+  HIPFillRandomVector(z0);
+
+  ComputeSPMV(A, x, y);
+  // SYMGS refreshes the halo of z, so z0 is copied afterwards to record the
+  // exchanged values as well
+  HIPCopyVector(z0, z);
+  ComputeSYMGS(A, r, z);
+  HIP_CHECK(hipMemcpy(z0.d_values + nrow, z.d_values + nrow, sizeof(double) * (ncol - nrow), hipMemcpyDeviceToDevice));
+  HIP_CHECK(hipDeviceSynchronize());
+
+  int fd = open(binname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    HIPDeleteVector(x);
+    HIPDeleteVector(y);
+    HIPDeleteVector(r);
+    HIPDeleteVector(z0);
+    HIPDeleteVector(z);
+    return -1;
+  }
+
+  std::vector<DumpSection> sections;
+  size_t offset = 0;
+  int ierr = 0;
+
+  const char * lt = DumpIntType<local_int_t>();
+  const char * gt = DumpIntType<global_int_t>();
+  size_t ell_size = (size_t)A.ell_width * nrow;
+
+  ierr |= WriteDumpSection(fd, offset, sections, "ell_col_ind", lt, sizeof(local_int_t), ell_size, A.ell_col_ind, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "ell_val", "f8", sizeof(double), ell_size, A.ell_val, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "inv_diag", "f8", sizeof(double), nrow, A.inv_diag, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "diag_idx", lt, sizeof(local_int_t), nrow, A.diag_idx, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "perm", lt, sizeof(local_int_t), nrow, A.perm, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "local_to_global", gt, sizeof(global_int_t), nrow, A.d_localToGlobalMap, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "sizes", lt, sizeof(local_int_t), A.nblocks, A.sizes, false, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "offsets", lt, sizeof(local_int_t), A.nblocks, A.offsets, false, staging);
+
+#ifndef HPCG_NO_MPI
+  if (geom.size > 1) {
+    ierr |= WriteDumpSection(fd, offset, sections, "neighbors", "i4", sizeof(int), A.numberOfSendNeighbors, A.neighbors, false, staging);
+    ierr |= WriteDumpSection(fd, offset, sections, "receive_length", lt, sizeof(local_int_t), A.numberOfSendNeighbors, A.receiveLength, false, staging);
+    ierr |= WriteDumpSection(fd, offset, sections, "send_length", lt, sizeof(local_int_t), A.numberOfSendNeighbors, A.sendLength, false, staging);
+    ierr |= WriteDumpSection(fd, offset, sections, "elements_to_send", lt, sizeof(local_int_t), A.totalToBeSent, A.elementsToSend, false, staging);
+    ierr |= WriteDumpSection(fd, offset, sections, "halo_row_ind", lt, sizeof(local_int_t), A.halo_rows, A.halo_row_ind, true, staging);
+    ierr |= WriteDumpSection(fd, offset, sections, "halo_col_ind", lt, sizeof(local_int_t), (size_t)A.ell_width * A.halo_rows, A.halo_col_ind, true, staging);
+    ierr |= WriteDumpSection(fd, offset, sections, "halo_val", "f8", sizeof(double), (size_t)A.ell_width * A.halo_rows, A.halo_val, true, staging);
+  }
+#endif
+
+  if (b != 0) ierr |= WriteDumpSection(fd, offset, sections, "b", "f8", sizeof(double), nrow, b->d_values, true, staging);
+  if (xexact != 0) ierr |= WriteDumpSection(fd, offset, sections, "xexact", "f8", sizeof(double), nrow, xexact->d_values, true, staging);
+
+  ierr |= WriteDumpSection(fd, offset, sections, "spmv_x", "f8", sizeof(double), ncol, x.d_values, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "spmv_y", "f8", sizeof(double), nrow, y.d_values, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "symgs_r", "f8", sizeof(double), nrow, r.d_values, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "symgs_x0", "f8", sizeof(double), ncol, z0.d_values, true, staging);
+  ierr |= WriteDumpSection(fd, offset, sections, "symgs_x1", "f8", sizeof(double), ncol, z.d_values, true, staging);
+
+  if (close(fd)) ierr = -1;
+
+  HIPDeleteVector(x);
+  HIPDeleteVector(y);
+  HIPDeleteVector(r);
+  HIPDeleteVector(z0);
+  HIPDeleteVector(z);
+
+  if (ierr) return -1;
+
+  // Small JSON header describing the binary layout
+  FILE * fh = fopen(jsonname, "w");
+  if (! fh) return -1;
+
+  const char * basename = strrchr(binname, '/');
+  basename = basename ? basename + 1 : binname;
+
+  fprintf(fh, "{\n");
+  fprintf(fh, "  \"format\": \"rochpcg-dump\",\n");
+  fprintf(fh, "  \"version\": %d,\n", DUMP_VERSION);
+  fprintf(fh, "  \"binary\": \"%s\",\n", basename);
+  fprintf(fh, "  \"level\": %d,\n", level);
+  fprintf(fh, "  \"rank\": %d,\n", geom.rank);
+  fprintf(fh, "  \"size\": %d,\n", geom.size);
+  fprintf(fh, "  \"nx\": %d, \"ny\": %d, \"nz\": %d,\n", geom.nx, geom.ny, geom.nz);
+  fprintf(fh, "  \"npx\": %d, \"npy\": %d, \"npz\": %d,\n", geom.npx, geom.npy, geom.npz);
+  fprintf(fh, "  \"ipx\": %d, \"ipy\": %d, \"ipz\": %d,\n", geom.ipx, geom.ipy, geom.ipz);
+  fprintf(fh, "  \"total_rows\": %lld,\n", (long long)A.totalNumberOfRows);
+  fprintf(fh, "  \"total_nonzeros\": %lld,\n", (long long)A.totalNumberOfNonzeros);
+  fprintf(fh, "  \"local_rows\": %lld,\n", (long long)nrow);
+  fprintf(fh, "  \"local_columns\": %lld,\n", (long long)ncol);
+  fprintf(fh, "  \"local_nonzeros\": %lld,\n", (long long)A.localNumberOfNonzeros);
+  fprintf(fh, "  \"ell_width\": %d,\n", (int)A.ell_width);
+  fprintf(fh, "  \"nblocks\": %d,\n", A.nblocks);
+  fprintf(fh, "  \"ublocks\": %d,\n", A.ublocks);
+  fprintf(fh, "  \"sections\": [\n");
+  for (size_t i = 0; i < sections.size(); ++i) {
+    fprintf(fh, "    {\"name\": \"%s\", \"dtype\": \"%s\", \"count\": %zu, \"offset\": %zu}%s\n",
+        sections[i].name.c_str(), sections[i].dtype, sections[i].count, sections[i].offset,
+        i + 1 < sections.size() ? "," : "");
+  }
+  fprintf(fh, "  ]\n");
+  fprintf(fh, "}\n");
+
+  return fclose(fh) ? -1 : 0;
+}
+
+/*!
+  Routine to dump the optimized problem of all multigrid levels in binary format.
+
+  Every process writes its own files, one pair per multigrid level:
+   - <prefix>_l<level>_r<rank>.bin contains the ELL matrix, the multicoloring,
+     the halo metadata and vectors, each section aligned to 4 KiB
+   - <prefix>_l<level>_r<rank>.json describes the layout of the binary file
+
+  Additionally, the results of one optimized SpMV and SYMGS call on random
+  vectors are stored, such that rochpcg-dumpreader can recompute and compare
+  them offline.
+
+  @param[in] A      The known system matrix, after OptimizeProblem
+  @param[in] b      The known right hand side vector
+  @param[in] xexact Generated exact solution
+  @param[in] prefix File name prefix, may include a directory
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+  @see WriteProblem
+  @see OptimizeProblem
+*/
+int WriteProblemBinary(const SparseMatrix & A, const Vector & b, const Vector & xexact, const char * prefix) {
+
+  char * staging = NULL;
+  RETURN_IF_HIP_ERROR(hipHostMalloc((void**)&staging, DUMP_CHUNK_SIZE));
+
+  int ierr = 0;
+  int level = 0;
+  for (const SparseMatrix * cur = &A; cur != 0; cur = cur->Ac, ++level) {
+    ierr |= WriteLevelBinary(*cur,
+                             level == 0 ? &b : 0,
+                             level == 0 ? &xexact : 0,
+                             level,
+                             prefix,
+                             staging);
+  }
+
+  RETURN_IF_HIP_ERROR(hipHostFree(staging));
+
+  return ierr;
+}
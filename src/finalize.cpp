@@ -64,6 +64,10 @@ HPCG_Finalize(void) {
   // Free workspace
   HIP_CHECK(deviceFree(workspace));
 
+  // Release profiling events
+  HIP_CHECK(profiler.Clear());
+  HIP_CHECK(cg_timer.Clear());
+
 #ifdef HPCG_MEMMGMT
   // Clear allocator
   HIP_CHECK(allocator.Clear());
@@ -0,0 +1,77 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file hip_runtime_api.h
+
+ Host declarations of the HIP runtime entry points referenced by the host
+ reference kernels, used to build rochpcg-bench without ROCm. There is no
+ device, every call fails with hipErrorNoDevice.
+ */
+
+#ifndef HOST_HIP_RUNTIME_API_H
+#define HOST_HIP_RUNTIME_API_H
+
+#include <cstddef>
+
+typedef enum hipError_t
+{
+    hipSuccess            = 0,
+    hipErrorInvalidValue  = 1,
+    hipErrorOutOfMemory   = 2,
+    hipErrorNoDevice      = 100
+} hipError_t;
+
+typedef enum hipMemcpyKind
+{
+    hipMemcpyHostToHost     = 0,
+    hipMemcpyHostToDevice   = 1,
+    hipMemcpyDeviceToHost   = 2,
+    hipMemcpyDeviceToDevice = 3,
+    hipMemcpyDefault        = 4
+} hipMemcpyKind;
+
+typedef struct ihipStream_t* hipStream_t;
+typedef struct ihipEvent_t* hipEvent_t;
+
+hipError_t hipMalloc(void** ptr, size_t size);
+hipError_t hipFree(void* ptr);
+hipError_t hipMemset(void* dst, int value, size_t size);
+hipError_t hipMemcpy(void* dst, const void* src, size_t size, hipMemcpyKind kind);
+hipError_t hipHostUnregister(void* ptr);
+
+hipError_t hipEventCreate(hipEvent_t* event);
+hipError_t hipEventDestroy(hipEvent_t event);
+hipError_t hipEventRecord(hipEvent_t event, hipStream_t stream = 0);
+hipError_t hipEventSynchronize(hipEvent_t event);
+hipError_t hipEventElapsedTime(float* ms, hipEvent_t start, hipEvent_t stop);
+
+hipError_t hipDeviceReset(void);
+const char* hipGetErrorString(hipError_t error);
+
+#endif // HOST_HIP_RUNTIME_API_H
@@ -0,0 +1,106 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file hip_runtime_host.cpp
+
+ HIP runtime entry points without a device, see hip/hip_runtime_api.h
+ */
+
+#include <hip/hip_runtime_api.h>
+
+hipError_t hipMalloc(void** ptr, size_t)
+{
+    *ptr = NULL;
+    return hipErrorNoDevice;
+}
+
+hipError_t hipFree(void* ptr)
+{
+    return ptr == NULL ? hipSuccess : hipErrorInvalidValue;
+}
+
+hipError_t hipMemset(void*, int, size_t)
+{
+    return hipErrorNoDevice;
+}
+
+hipError_t hipMemcpy(void*, const void*, size_t, hipMemcpyKind)
+{
+    return hipErrorNoDevice;
+}
+
+hipError_t hipHostUnregister(void*)
+{
+    return hipErrorNoDevice;
+}
+
+hipError_t hipEventCreate(hipEvent_t* event)
+{
+    *event = NULL;
+    return hipErrorNoDevice;
+}
+
+hipError_t hipEventDestroy(hipEvent_t)
+{
+    return hipErrorNoDevice;
+}
+
+hipError_t hipEventRecord(hipEvent_t, hipStream_t)
+{
+    return hipErrorNoDevice;
+}
+
+hipError_t hipEventSynchronize(hipEvent_t)
+{
+    return hipErrorNoDevice;
+}
+
+hipError_t hipEventElapsedTime(float* ms, hipEvent_t, hipEvent_t)
+{
+    *ms = 0.0f;
+    return hipErrorNoDevice;
+}
+
+hipError_t hipDeviceReset(void)
+{
+    return hipSuccess;
+}
+
+const char* hipGetErrorString(hipError_t error)
+{
+    switch(error)
+    {
+    case hipSuccess: return "hipSuccess";
+    case hipErrorInvalidValue: return "hipErrorInvalidValue";
+    case hipErrorOutOfMemory: return "hipErrorOutOfMemory";
+    case hipErrorNoDevice: return "hipErrorNoDevice";
+    }
+
+    return "unknown error";
+}
@@ -52,6 +52,15 @@
 #include <fstream>
 #include "Geometry.hpp"
 
+// Marks functions that are shared between host and device code
+#ifndef HPCG_HOST_DEVICE
+#if defined(__HIPCC__)
+#define HPCG_HOST_DEVICE __host__ __device__
+#else
+#define HPCG_HOST_DEVICE
+#endif
+#endif
+
 extern std::ofstream HPCG_fout;
 
 struct HPCG_Params_STRUCT {
@@ -71,6 +80,28 @@ struct HPCG_Params_STRUCT {
   int device; //!< HIP device
   bool verify; //!< Do reference verification
   double tol; //!< Exit tolerance if verification is skipped
+  const char * dump; //!< File name prefix for the binary problem dump, NULL if disabled
+  const char * mtx; //!< MatrixMarket file to be used instead of the generated problem, NULL if disabled
+  int problem; //!< Type of the generated problem, see ProblemType
+  bool profile; //!< Collect per kernel and per level timings during the benchmark phase
+  int timing; //!< Timing mode of the CG sections, see CGTimingMode
+  const char * stream; //!< File name of the NDJSON stream of per CG set records, NULL if disabled
+  bool multirhs; //!< Measure the multiple right hand side CG solve after the benchmark phase
+  int sweepCount; //!< Number of local problem sizes of a sweep, 0 if disabled
+  int * sweepSizes; //!< Local dimensions nx, ny, nz of each problem size of the sweep
+  bool tune; //!< Tune the kernel launch configurations if the tuning database has no entry
+  const char * tunedb; //!< File name of the tuning database
+  bool compressell; //!< Use the index compressed ELL format for SpMV and SYMGS
+  bool compressvalues; //!< Store the off-diagonal values as indices into a value dictionary
+  int fp32levels; //!< Bit mask of the multigrid levels that store their matrix values in single precision
+  bool levelschedule; //!< Compare the level scheduled host smoother against the multicolored solver
+  bool blockcoloring; //!< Color blocks of grid points instead of single points
+  int hostorder; //!< Ordering of the rows of the host reference problem, see RowOrdering
+  int numadomains; //!< Number of NUMA domains of the host SpMV comparison, 0 for one per node, negative if disabled
+  int hostpages; //!< Page size policy of the large host arrays, see HostPagePolicy
+  bool persistentcg; //!< Compare the host CG on one persistent thread team against a parallel region per kernel
+  bool reprodot; //!< Binned dot products, independent of the number of threads and ranks
+  int taskrows; //!< Largest number of rows of a host task, 0 for the default, negative if the task runtime comparison is disabled
 };
 /*!
   HPCG_Params is a shorthand for HPCG_Params_STRUCT
@@ -57,7 +57,10 @@ const char* NULLDEVICE="/dev/null";
 #include <ctime>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include <fstream>
 #include <iostream>
@@ -67,11 +70,19 @@ const char* NULLDEVICE="/dev/null";
 #include "hpcg.hpp"
 
 #include "ReadHpcgDat.hpp"
+#include "ReadMatrixMarket.hpp"
+#include "ProblemCoefficients.hpp"
+#include "ReorderProblem.hpp"
+#include "HostMemory.hpp"
+#include "ReproducibleSum.hpp"
 
 hipStream_t stream_interior;
 hipStream_t stream_halo;
 void* workspace;
 hipAllocator_t allocator;
+hipProfiler_t profiler;
+hipCGTimer_t cg_timer;
+hipKernelConfig_t kernel_config;
 
 std::ofstream HPCG_fout; //!< output file stream for logging activities during HPCG run
 
@@ -83,6 +94,98 @@ startswith(const char * s, const char * prefix) {
   return 1;
 }
 
+/*!
+  Parses the problem sizes of a sweep. The specification is a comma separated
+  list of sizes, each given as N (cube), NXxNYxNZ or as range FIRST:LAST[:STEP]
+  of cubes with a default step of 8.
+
+  @param[in]  spec   the sweep specification
+  @param[out] params sweepCount and sweepSizes are set on success
+
+  @return returns 0 upon success and non-zero if the specification is invalid
+*/
+static int
+ParseSweep(const char * spec, HPCG_Params & params) {
+  std::vector<int> sizes;
+
+  const char * item = spec;
+  while (*item != '\0') {
+    const char * end = strchr(item, ',');
+    std::string str = end != NULL ? std::string(item, end - item) : std::string(item);
+
+    int nx, ny, nz, first, last, step = 8;
+    char c;
+    if (sscanf(str.c_str(), "%dx%dx%d%c", &nx, &ny, &nz, &c) == 3) {
+      sizes.push_back(nx);
+      sizes.push_back(ny);
+      sizes.push_back(nz);
+    } else if (sscanf(str.c_str(), "%d:%d:%d%c", &first, &last, &step, &c) == 3 ||
+               sscanf(str.c_str(), "%d:%d%c", &first, &last, &c) == 2) {
+      if (step <= 0 || last < first) return 1;
+      for (int n = first; n <= last; n += step) {
+        sizes.push_back(n);
+        sizes.push_back(n);
+        sizes.push_back(n);
+      }
+    } else if (sscanf(str.c_str(), "%d%c", &nx, &c) == 1) {
+      sizes.push_back(nx);
+      sizes.push_back(nx);
+      sizes.push_back(nx);
+    } else {
+      return 1;
+    }
+
+    if (end == NULL) break;
+    item = end + 1;
+  }
+
+  // Four multigrid levels require local dimensions divisible by 8
+  for (size_t i = 0; i < sizes.size(); ++i)
+    if (sizes[i] < 16 || sizes[i] % 8 != 0) return 1;
+
+  if (sizes.empty()) return 1;
+
+  params.sweepCount = sizes.size() / 3;
+  params.sweepSizes = new int[sizes.size()];
+  for (size_t i = 0; i < sizes.size(); ++i) params.sweepSizes[i] = sizes[i];
+
+  return 0;
+}
+
+/*!
+  Parses the multigrid levels that store their matrix values in single
+  precision. The specification is either "all" or a comma separated list of
+  level numbers, 0 being the finest level.
+
+  @param[in]  spec   the level specification
+  @param[out] levels bit mask of the selected levels
+
+  @return returns 0 upon success and non-zero if the specification is invalid
+*/
+static int
+ParseLevels(const char * spec, int & levels) {
+  if (strcmp(spec, "all") == 0) {
+    levels = ~0;
+    return 0;
+  }
+
+  levels = 0;
+
+  const char * item = spec;
+  for (;;) {
+    char * end;
+    long level = strtol(item, &end, 10);
+    if (end == item || level < 0 || level > 30 || (*end != ',' && *end != '\0')) return 1;
+
+    levels |= 1 << level;
+
+    if (*end == '\0') break;
+    item = end + 1;
+  }
+
+  return 0;
+}
+
 __global__ void kernel_warmup()
 {
 }
@@ -110,7 +213,28 @@ HPCG_Init(int * argc_p, char ** *argv_p, HPCG_Params & params) {
   char fname[80];
   int i, j, *iparams;
   bool verify = true;
+  bool profile = false;
+  bool multirhs = false;
+  const char * sweep = NULL;
+  bool tune = false;
+  const char * tunedb = "rochpcg-tuning.db";
+  bool compressell = false;
+  bool compressvalues = false;
+  const char * fp32values = NULL;
+  bool levelschedule = false;
+  bool blockcoloring = false;
+  bool persistentcg = false;
+  bool reprodot = false;
+  int numadomains = -1;
+  int taskrows = -1;
   double fparam = 0.0;
+  const char * dump = NULL;
+  const char * mtx = NULL;
+  const char * problem = "laplace";
+  const char * hostorder = "lexicographic";
+  const char * hostpages = "default";
+  const char * timing = "barrier";
+  const char * stream = NULL;
   char cparams[][8] = {"--nx=", "--ny=", "--nz=", "--rt=", "--pz=", "--zl=", "--zu=", "--npx=", "--npy=", "--npz=", "--dev="};
   time_t rawtime;
   tm * ptm;
@@ -136,6 +260,52 @@ HPCG_Init(int * argc_p, char ** *argv_p, HPCG_Params & params) {
     if(startswith(argv[i], "--tol="))
       if(sscanf(argv[i]+strlen("--tol="), "%lf", &fparam))
         verify = false;
+    if(startswith(argv[i], "--dump="))
+      dump = argv[i] + strlen("--dump=");
+    if(startswith(argv[i], "--mtx="))
+      mtx = argv[i] + strlen("--mtx=");
+    if(startswith(argv[i], "--profile"))
+      profile = true;
+    if(startswith(argv[i], "--problem="))
+      problem = argv[i] + strlen("--problem=");
+    if(startswith(argv[i], "--timing="))
+      timing = argv[i] + strlen("--timing=");
+    if(startswith(argv[i], "--stream="))
+      stream = argv[i] + strlen("--stream=");
+    if(startswith(argv[i], "--multi-rhs"))
+      multirhs = true;
+    if(startswith(argv[i], "--sweep="))
+      sweep = argv[i] + strlen("--sweep=");
+    if(startswith(argv[i], "--tune-db="))
+      tunedb = argv[i] + strlen("--tune-db=");
+    else if(strcmp(argv[i], "--tune") == 0)
+      tune = true;
+    if(startswith(argv[i], "--compress-ell"))
+      compressell = true;
+    if(startswith(argv[i], "--compress-values"))
+      compressvalues = true;
+    if(startswith(argv[i], "--fp32-values="))
+      fp32values = argv[i] + strlen("--fp32-values=");
+    if(startswith(argv[i], "--level-schedule"))
+      levelschedule = true;
+    if(startswith(argv[i], "--block-coloring"))
+      blockcoloring = true;
+    if(startswith(argv[i], "--persistent-cg"))
+      persistentcg = true;
+    if(startswith(argv[i], "--repro-dot"))
+      reprodot = true;
+    if(startswith(argv[i], "--host-order="))
+      hostorder = argv[i] + strlen("--host-order=");
+    if(startswith(argv[i], "--host-pages="))
+      hostpages = argv[i] + strlen("--host-pages=");
+    if(startswith(argv[i], "--numa-domains="))
+      sscanf(argv[i]+strlen("--numa-domains="), "%d", &numadomains);
+    else if(strcmp(argv[i], "--numa-domains") == 0)
+      numadomains = 0;
+    if(startswith(argv[i], "--tasks="))
+      sscanf(argv[i]+strlen("--tasks="), "%d", &taskrows);
+    else if(strcmp(argv[i], "--tasks") == 0)
+      taskrows = 0;
   }
 
   // Check if --rt was specified on the command line
@@ -180,6 +350,66 @@ HPCG_Init(int * argc_p, char ** *argv_p, HPCG_Params & params) {
   params.device = iparams[10];
   params.verify = verify;
   params.tol    = fparam;
+  params.dump   = dump;
+  params.mtx    = mtx;
+  params.profile = profile;
+  params.stream = stream;
+  params.multirhs = multirhs;
+  params.sweepCount = 0;
+  params.sweepSizes = NULL;
+  params.tune = tune;
+  params.tunedb = tunedb;
+  params.compressell = compressell;
+  params.compressvalues = compressvalues;
+  params.fp32levels = 0;
+  params.levelschedule = levelschedule;
+  params.blockcoloring = blockcoloring;
+  params.numadomains = numadomains;
+  params.taskrows = taskrows;
+  params.persistentcg = persistentcg;
+  params.reprodot = reprodot;
+
+  if(strcmp(problem, "laplace") == 0)      params.problem = HPCG_PROBLEM_LAPLACE;
+  else if(strcmp(problem, "varcoef") == 0) params.problem = HPCG_PROBLEM_VARCOEF;
+  else if(strcmp(problem, "aniso") == 0)   params.problem = HPCG_PROBLEM_ANISO;
+  else
+  {
+    fprintf(stderr, "Error: unknown problem type %s (expected laplace, varcoef or aniso)\n", problem);
+    exit(1);
+  }
+
+  if(strcmp(hostorder, "lexicographic") == 0) params.hostorder = HPCG_ORDER_LEXICOGRAPHIC;
+  else if(strcmp(hostorder, "morton") == 0)   params.hostorder = HPCG_ORDER_MORTON;
+  else if(strcmp(hostorder, "hilbert") == 0)  params.hostorder = HPCG_ORDER_HILBERT;
+  else
+  {
+    fprintf(stderr, "Error: unknown host ordering %s (expected lexicographic, morton or hilbert)\n", hostorder);
+    exit(1);
+  }
+
+  if(strcmp(hostpages, "default") == 0)  params.hostpages = HPCG_PAGES_DEFAULT;
+  else if(strcmp(hostpages, "thp") == 0) params.hostpages = HPCG_PAGES_THP;
+  else if(strcmp(hostpages, "2m") == 0)  params.hostpages = HPCG_PAGES_2M;
+  else if(strcmp(hostpages, "1g") == 0)  params.hostpages = HPCG_PAGES_1G;
+  else
+  {
+    fprintf(stderr, "Error: unknown host page policy %s (expected default, thp, 2m or 1g)\n", hostpages);
+    exit(1);
+  }
+
+  // All host arrays allocated from here on follow the page policy
+  SetHostPagePolicy(params.hostpages);
+
+  // Dot products of both CG variants use binned summation from here on
+  SetReproducibleDot(params.reprodot);
+
+  if(strcmp(timing, "barrier") == 0)     params.timing = CG_TIMING_BARRIER;
+  else if(strcmp(timing, "events") == 0) params.timing = CG_TIMING_EVENTS;
+  else
+  {
+    fprintf(stderr, "Error: unknown timing mode %s (expected barrier or events)\n", timing);
+    exit(1);
+  }
 
 #ifndef HPCG_NO_MPI
   MPI_Comm_rank( MPI_COMM_WORLD, &params.comm_rank );
@@ -189,6 +419,67 @@ HPCG_Init(int * argc_p, char ** *argv_p, HPCG_Params & params) {
   params.comm_size = 1;
 #endif
 
+  // The memory pool is sized for the largest dimensions of all problem sizes of a sweep
+  if(sweep != NULL)
+  {
+    if(ParseSweep(sweep, params) != 0)
+    {
+      if(params.comm_rank == 0) fprintf(stderr, "Error: invalid sweep %s (expected N, NXxNYxNZ or FIRST:LAST[:STEP] with multiples of 8 >= 16)\n", sweep);
+      exit(1);
+    }
+
+    params.nx = params.ny = params.nz = 0;
+    for(i = 0; i < params.sweepCount; ++i)
+    {
+      params.nx = std::max(params.nx, (local_int_t)params.sweepSizes[3 * i + 0]);
+      params.ny = std::max(params.ny, (local_int_t)params.sweepSizes[3 * i + 1]);
+      params.nz = std::max(params.nz, (local_int_t)params.sweepSizes[3 * i + 2]);
+    }
+  }
+
+  if(fp32values != NULL && ParseLevels(fp32values, params.fp32levels) != 0)
+  {
+    if(params.comm_rank == 0) fprintf(stderr, "Error: invalid level list %s (expected all or a comma separated list of levels)\n", fp32values);
+    exit(1);
+  }
+
+  // The task graph, persistent and multi right hand side CG sum their dot
+  // products in their own order, without binned summation
+  if(params.reprodot && (params.taskrows >= 0 || params.persistentcg || params.multirhs))
+  {
+    if(params.comm_rank == 0) fprintf(stderr, "Error: --repro-dot cannot be combined with --tasks, --persistent-cg or --multi-rhs\n");
+    exit(1);
+  }
+
+  // The block colored smoother reads plain column indices and values and the
+  // multiple right hand side sweeps require point coloring
+  if(params.blockcoloring && (params.compressell || params.compressvalues || params.multirhs))
+  {
+    if(params.comm_rank == 0) fprintf(stderr, "Error: --block-coloring cannot be combined with --compress-ell, --compress-values or --multi-rhs\n");
+    exit(1);
+  }
+
+  // For imported matrices, the local grid dimensions are only used to size
+  // the device memory pool, thus pick the smallest cube that holds the local rows
+  if(params.mtx != NULL)
+  {
+    global_int_t mtx_nrows = 0;
+    global_int_t mtx_nnz = 0;
+
+    if(ReadMatrixMarketHeader(params.mtx, mtx_nrows, mtx_nnz) != 0)
+    {
+      if(params.comm_rank == 0) fprintf(stderr, "Error: cannot read MatrixMarket file %s\n", params.mtx);
+      exit(1);
+    }
+
+    global_int_t local_rows = (mtx_nrows - 1) / params.comm_size + 1;
+
+    int n = 16;
+    while((global_int_t)n * n * n < local_rows) n += 8;
+
+    params.nx = params.ny = params.nz = n;
+  }
+
   // Simple device management
   int ndevs = 0;
   HIP_CHECK(hipGetDeviceCount(&ndevs));
@@ -226,7 +517,18 @@ HPCG_Init(int * argc_p, char ** *argv_p, HPCG_Params & params) {
 #endif
 
   // Allocate device workspace
-  HIP_CHECK(deviceMalloc((void**)&workspace, sizeof(local_int_t) * 1024));
+  HIP_CHECK(deviceMalloc((void**)&workspace, sizeof(double) * 1024));
+
+#ifdef HPCG_MEMMGMT
+  // Everything allocated from here on belongs to a single problem
+  allocator.Checkpoint();
+#endif
+
+  // Initialize profiler, regions are recorded only if enabled
+  HIP_CHECK(profiler.Initialize(params.profile));
+
+  // Initialize CG section timer
+  HIP_CHECK(cg_timer.Initialize(params.timing));
 
 #ifdef HPCG_NO_OPENMP
   params.numThreads = 1;
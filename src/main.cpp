@@ -55,7 +55,10 @@
 
 #include <fstream>
 #include <iostream>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <ctime>
 #ifdef HPCG_DETAILED_DEBUG
 using std::cin;
 #endif
@@ -76,6 +79,7 @@ using std::endl;
 #include "OptimizeProblem.hpp"
 #include "WriteProblem.hpp"
 #include "ReportResults.hpp"
+#include "ReadMatrixMarket.hpp"
 #include "mytimer.hpp"
 #include "ComputeSPMV_ref.hpp"
 #include "ComputeMG_ref.hpp"
@@ -89,66 +93,228 @@ using std::endl;
 #include "TestCG.hpp"
 #include "TestSymmetry.hpp"
 #include "TestNorms.hpp"
+#include "BandwidthProbe.hpp"
+#include "TestMultiRHS.hpp"
+#include "Autotune.hpp"
+#include "CompressELL.hpp"
+#include "CompressValues.hpp"
+#include "TestFloatValues.hpp"
+#include "TestLevelSchedule.hpp"
+#include "TestNumaDomains.hpp"
+#include "TestTaskRuntime.hpp"
+#include "TestPersistentCG.hpp"
+#include "TestReproducibleDot.hpp"
+#include "ReorderProblem.hpp"
 #include "Version.hpp"
+#include "ComputeSPMV.hpp"
 
 /*!
-  Main driver program: Construct synthetic problem, run V&V tests, compute benchmark parameters, run benchmark, report results.
+  Append one record of the benchmark phase to the NDJSON stream and flush it,
+  such that the progress of the run can be followed while it is running.
+
+  @param[in] stream          The open stream file
+  @param[in] geom            The geometry of the problem, its local dimensions identify the problem size of a sweep
+  @param[in] set             Index of the CG set (starting at 1)
+  @param[in] numberOfCgSets  Total number of CG sets of the benchmark phase
+  @param[in] gflops          GFlop/s of all CG sets so far
+  @param[in] scaled_residual Scaled residual of this CG set
+  @param[in] set_time        Time of this CG set in seconds
+  @param[in] elapsed         Time of all CG sets so far in seconds
+*/
+static void WriteStreamRecord(FILE * stream, const Geometry & geom, int set, int numberOfCgSets, double gflops,
+    double scaled_residual, double set_time, double elapsed) {
 
-  @param[in]  argc Standard argument count.  Should equal 1 (no arguments passed in) or 4 (nx, ny, nz passed in)
-  @param[in]  argv Standard argument array.  If argc==1, argv is unused.  If argc==4, argv[1], argv[2], argv[3] will be interpreted as nx, ny, nz, resp.
+  fprintf(stream, "{\"nx\":%d,\"ny\":%d,\"nz\":%d,\"set\":%d,\"sets\":%d,\"gflops\":%.6e,\"gflops_per_process\":%.6e,",
+          (int)geom.nx, (int)geom.ny, (int)geom.nz, set, numberOfCgSets, gflops, gflops / geom.size);
 
-  @return Returns zero on success and a non-zero value otherwise.
+  // NaN and infinity are not valid JSON numbers
+  if (std::isfinite(scaled_residual)) fprintf(stream, "\"scaled_residual\":%.17e,", scaled_residual);
+  else fprintf(stream, "\"scaled_residual\":null,");
+
+  fprintf(stream, "\"set_time\":%.6e,\"elapsed\":%.6e}\n", set_time, elapsed);
+  fflush(stream);
+}
 
+/*!
+  Summary of the benchmark for one problem size
 */
-int main(int argc, char * argv[]) {
+struct BenchmarkResult {
+  local_int_t nx; //!< local dimension in x direction
+  local_int_t ny; //!< local dimension in y direction
+  local_int_t nz; //!< local dimension in z direction
+  global_int_t equations; //!< global number of equations
+  int numberOfCgSets; //!< number of timed CG sets
+  double gflops; //!< GFlop/s rating including convergence and optimization phase overhead
+  double setup_time; //!< problem setup time in seconds
+  double optimization_time; //!< optimization phase time in seconds
+  double benchmark_time; //!< time of all timed CG sets in seconds
+  double wall_time; //!< wall time of the whole run of this size in seconds
+  bool valid; //!< true if all validation tests passed
+  int ierr; //!< error code of the run
+};
 
-#ifndef HPCG_NO_MPI
-  MPI_Init(&argc, &argv);
-#endif
+/*!
+  Append the summary of one problem size of a sweep as NDJSON record and flush it.
 
-  HPCG_Params params;
+  @param[in] sweep  The open sweep file
+  @param[in] result The summary of the problem size
+*/
+static void WriteSweepRecord(FILE * sweep, const BenchmarkResult & result) {
+
+  fprintf(sweep, "{\"nx\":%d,\"ny\":%d,\"nz\":%d,\"equations\":%lld,\"cg_sets\":%d,\"gflops\":%.6e,",
+          (int)result.nx, (int)result.ny, (int)result.nz, (long long)result.equations, result.numberOfCgSets, result.gflops);
+  fprintf(sweep, "\"setup_time\":%.6e,\"optimization_time\":%.6e,\"benchmark_time\":%.6e,\"wall_time\":%.6e,",
+          result.setup_time, result.optimization_time, result.benchmark_time, result.wall_time);
+  fprintf(sweep, "\"valid\":%s,\"error\":%d}\n", result.valid ? "true" : "false", result.ierr);
+  fflush(sweep);
+}
 
-  HPCG_Init(&argc, &argv, params);
+/*!
+  Driver for matrices imported from a MatrixMarket file: read and distribute the
+  matrix, optimize it, then time SpMV and CG preconditioned by a single symmetric
+  Gauss-Seidel sweep. Reference validation is skipped, as it relies on the
+  structure of the generated problem.
 
-  // Check if QuickPath option is enabled.
-  // If the running time is set to zero, we minimize all paths through the program
-  bool quickPath = (params.runningTime==0);
+  @param[in] params The parameters of this run, params.mtx contains the file name
 
-  int size = params.comm_size, rank = params.comm_rank; // Number of MPI processes, My process ID
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int RunMatrixMarket(const HPCG_Params & params) {
+
+  int size = params.comm_size, rank = params.comm_rank;
+  int ierr = 0;
+
+  // The geometry is only required for the process layout
+  Geometry * geom = new Geometry;
+  GenerateGeometry(size, rank, params.numThreads, params.pz, params.zl, params.zu, params.nx, params.ny, params.nz, params.npx, params.npy, params.npz, geom);
+
+  std::vector< double > times(10,0.0);
+
+  if(rank == 0) printf("\nReading MatrixMarket file %s ...\n", params.mtx);
+
+  double setup_time = mytimer();
+
+  SparseMatrix A;
+  InitializeSparseMatrix(A, geom);
+
+  Vector b, x, xexact;
+  double parse_time = 0.0;
+  ierr = ReadMatrixMarket(params.mtx, A, &b, &x, &xexact, parse_time);
+  if (ierr) {
+    DeleteMatrix(A); // Also deletes the geometry
+    return ierr;
+  }
+
+  times[9] = mytimer() - setup_time;
+
+  if(rank == 0) printf("\nSetup Phase took %0.2lf sec (%0.2lf sec parsing)\n", times[9], parse_time);
+
+  CGData data;
+  A.useFloatValues = params.fp32levels & 1;
 
-  // Print rocHPCG version and device
-  if(rank == 0)
   {
-    printf("rocHPCG version: %d.%d.%d-%s (based on hpcg-3.1)\n",
-           __ROCHPCG_VER_MAJOR,
-           __ROCHPCG_VER_MINOR,
-           __ROCHPCG_VER_PATCH,
-           TO_STR(__ROCHPCG_VER_TWEAK));
+    ScopedTimer timer(times[7]);
+    OptimizeProblem(A, data, b, x, xexact);
   }
 
+  HIP_CHECK(deviceFree(A.d_nonzerosInRow));
+  HIP_CHECK(deviceFree(A.d_matrixDiagonal));
+
+  if(rank == 0) printf("\nOptimization Phase took %0.2lf sec\n", times[7]);
+
+  // SpMV timing phase
+  Vector x_overlap, y;
+  HIPInitializeVector(x_overlap, A.localNumberOfColumns);
+  HIPInitializeVector(y, A.localNumberOfRows);
+  HIPZeroVector(x_overlap);
+  HIP_CHECK(hipMemcpy(x_overlap.d_values, xexact.d_values, sizeof(double) * A.localNumberOfRows, hipMemcpyDeviceToDevice));
+
+  int numberOfSpmvCalls = params.runningTime == 0 ? 1 : 100;
+
+  ComputeSPMV(A, x_overlap, y); // Warm up
+  HIP_CHECK(hipDeviceSynchronize());
 #ifndef HPCG_NO_MPI
   MPI_Barrier(MPI_COMM_WORLD);
 #endif
 
-  hipDeviceProp_t prop;
-  hipGetDeviceProperties(&prop, params.device);
-  printf("Using HIP device (%d): %s (%lu MB global memory)\n",
-         params.device,
-         prop.name,
-         (prop.totalGlobalMem >> 20));
+  int err_count = 0;
+  double spmv_time = 0.0;
+  {
+    ScopedTimer timer(spmv_time);
+    for (int i=0; i< numberOfSpmvCalls; ++i) {
+      ierr = ComputeSPMV(A, x_overlap, y);
+      if (ierr) {
+        HPCG_fout << "Error in call to SpMV: " << ierr << ".\n" << endl;
+        ++err_count;
+      }
+    }
+    HIP_CHECK(hipDeviceSynchronize());
+#ifndef HPCG_NO_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+  }
 
-#ifdef HPCG_DETAILED_DEBUG
-  if (size < 100 && rank==0) HPCG_fout << "Process "<<rank<<" of "<<size<<" is alive with " << params.numThreads << " threads." <<endl;
+  // CG timing phase, run for the requested amount of time
+  int maxIters = 50;
+  int niters = 0;
+  double normr = 0.0;
+  double normr0 = 0.0;
+  double tolerance = 0.0; // Force maxIters iterations
+  int numberOfCgSets = 0;
 
-  if (rank==0) {
-    char c;
-    std::cout << "Press key to continue"<< std::endl;
-    std::cin.get(c);
-  }
+  if(rank == 0) printf("\nStarting Benchmarking Phase ...\n\n");
+
+  HIP_CHECK(profiler.Reset());
+
+  do {
+    HIPZeroVector(x);
+    ierr = CG( A, data, b, x, maxIters, tolerance, niters, normr, normr0, &times[0], true, false);
+    if (ierr) {
+      HPCG_fout << "Error in call to CG: " << ierr << ".\n" << endl;
+      ++err_count;
+    }
+    ++numberOfCgSets;
+
+    // All processes have to agree on the number of CG sets
+    double elapsed = times[0];
 #ifndef HPCG_NO_MPI
-  MPI_Barrier(MPI_COMM_WORLD);
-#endif
+    MPI_Allreduce(&times[0], &elapsed, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
 #endif
+    if (elapsed >= params.runningTime) break;
+  } while (true);
+
+  ReportMatrixMarketResults(A, numberOfSpmvCalls, spmv_time, numberOfCgSets, maxIters, &times[0], parse_time, normr / normr0);
+
+  // Clean up
+  DeleteMatrix(A);
+  HIPDeleteCGData(data);
+  DeleteVector(x);
+  DeleteVector(b);
+  DeleteVector(xexact);
+  HIPDeleteVector(x);
+  HIPDeleteVector(b);
+  HIPDeleteVector(xexact);
+  HIPDeleteVector(x_overlap);
+  HIPDeleteVector(y);
+
+  return err_count;
+}
+
+/*!
+  Runs the benchmark for the generated problem of local dimensions params.nx,
+  params.ny and params.nz: setup, reference phases, optimization, validation,
+  timed CG sets and report.
+
+  @param[in]  params    The parameters of this run
+  @param[in]  quickPath If true, all repetitive sections are executed only once
+  @param[in]  stream    The NDJSON stream of per CG set records, NULL if disabled
+  @param[out] result    The summary of the run
+
+  @return Returns zero on success and a non-zero value otherwise.
+*/
+static int RunBenchmark(const HPCG_Params & params, bool quickPath, FILE * stream, BenchmarkResult & result) {
+
+  int size = params.comm_size, rank = params.comm_rank; // Number of MPI processes, My process ID
 
   local_int_t nx,ny,nz;
   nx = (local_int_t)params.nx;
@@ -171,6 +337,7 @@ int main(int argc, char * argv[]) {
   // Construct the geometry and linear system
   Geometry * geom = new Geometry;
   GenerateGeometry(size, rank, params.numThreads, params.pz, params.zl, params.zu, nx, ny, nz, params.npx, params.npy, params.npz, geom);
+  geom->problem = params.problem;
 
   ierr = CheckAspectRatio(0.125, geom->npx, geom->npy, geom->npz, "process grid", rank==0);
   if (ierr)
@@ -228,6 +395,10 @@ int main(int argc, char * argv[]) {
        curx = 0;
        curxexact = 0;
     }
+
+    // Space filling curve ordering of the host rows
+    ierr = ReorderProblem(A, &b, &x, &xexact, params.hostorder);
+    if (ierr) HPCG_fout << "Error in call to ReorderProblem: " << ierr << ".\n" << endl;
   }
     else
     {
@@ -277,17 +448,19 @@ int main(int argc, char * argv[]) {
 
   int numberOfCalls = 10;
   if (quickPath) numberOfCalls = 1; //QuickPath means we do on one call of each block of repetitive code
-  double t_begin = mytimer();
-  if(params.verify)
   {
-    for (int i=0; i< numberOfCalls; ++i) {
-      ierr = ComputeSPMV_ref(A, x_overlap, b_computed); // b_computed = A*x_overlap
-      if (ierr) HPCG_fout << "Error in call to SpMV: " << ierr << ".\n" << endl;
-      ierr = ComputeMG_ref(A, b_computed, x_overlap); // b_computed = Minv*y_overlap
-      if (ierr) HPCG_fout << "Error in call to MG: " << ierr << ".\n" << endl;
+    ScopedTimer timer(times[8]);
+    if(params.verify)
+    {
+      for (int i=0; i< numberOfCalls; ++i) {
+        ierr = ComputeSPMV_ref(A, x_overlap, b_computed); // b_computed = A*x_overlap
+        if (ierr) HPCG_fout << "Error in call to SpMV: " << ierr << ".\n" << endl;
+        ierr = ComputeMG_ref(A, b_computed, x_overlap); // b_computed = Minv*y_overlap
+        if (ierr) HPCG_fout << "Error in call to MG: " << ierr << ".\n" << endl;
+      }
     }
   }
-  times[8] = (mytimer() - t_begin)/((double) numberOfCalls);  // Total time divided by number of calls.
+  times[8] /= (double) numberOfCalls;  // Total time divided by number of calls.
 #ifdef HPCG_DEBUG
   if (rank==0) HPCG_fout << "Total SpMV+MG timing phase execution time in main (sec) = " << mytimer() - t1 << endl;
 #endif
@@ -331,11 +504,41 @@ int main(int argc, char * argv[]) {
     refTolerance = params.tol;
   }
 
+  // Levels that keep a single precision copy of their matrix values
+  curLevelMatrix = &A;
+  for (int level = 0; level < numberOfMgLevels; ++level) {
+    curLevelMatrix->useFloatValues = (params.fp32levels >> level) & 1;
+    curLevelMatrix->useLevelSchedule = params.verify && params.levelschedule; // Requires the host matrices
+    curLevelMatrix->useBlockColoring = params.blockcoloring;
+    curLevelMatrix = curLevelMatrix->Ac;
+  }
+
   // Call user-tunable set up function.
-  double t7 = mytimer();
-  OptimizeProblem(A, data, b, x, xexact);
-  t7 = mytimer() - t7;
-  times[7] = t7;
+  {
+    ScopedTimer timer(times[7]);
+    OptimizeProblem(A, data, b, x, xexact);
+
+    // 16-bit column indices of all levels
+    if(params.compressell)
+    {
+      ierr = CompressELL(A);
+      if (ierr) HPCG_fout << "Error in call to CompressELL: " << ierr << ".\n" << endl;
+    }
+
+    // Dictionary of the off-diagonal values of all levels
+    if(params.compressvalues)
+    {
+      ierr = CompressValues(A);
+      if (ierr) HPCG_fout << "Error in call to CompressValues: " << ierr << ".\n" << endl;
+    }
+
+    // Kernel launch configuration, the tuning time is part of the optimization phase
+    if(params.tune)
+    {
+      ierr = Autotune(A, data, params.tunedb);
+      if (ierr) HPCG_fout << "Error in call to Autotune: " << ierr << ".\n" << endl;
+    }
+  }
 #ifdef HPCG_DEBUG
   if (rank==0) HPCG_fout << "Total problem setup time in main (sec) = " << mytimer() - t1 << endl;
 #endif
@@ -346,6 +549,29 @@ int main(int argc, char * argv[]) {
   if (geom->size == 1) WriteProblem(*geom, A, b, x, xexact);
 #endif
 
+  // Binary dump of the optimized problem for offline analysis
+  if(params.dump != NULL)
+  {
+    if(rank == 0) printf("\nWriting binary problem dump to %s_*\n", params.dump);
+
+    ierr = WriteProblemBinary(A, b, xexact, params.dump);
+    if (ierr) HPCG_fout << "Error in call to WriteProblemBinary: " << ierr << ".\n" << endl;
+  }
+
+  // Attainable memory bandwidth on the benchmark vectors, for the roofline report
+  BandwidthProbeData probe_data;
+  ierr = BandwidthProbe(A, data, probe_data);
+  if (ierr) HPCG_fout << "Error in call to BandwidthProbe: " << ierr << ".\n" << endl;
+
+  if(rank == 0) printf("\nMeasured memory bandwidth: copy %0.1lf GB/s, triad %0.1lf GB/s\n", probe_data.copy, probe_data.triad);
+
+  // Results of the optional tests, each test that runs adds its section
+  ReportSections sections;
+
+  // Index traffic and throughput of the compressed against the plain ELL format
+  ierr = TestCompressedELL(A, data, sections);
+  if (ierr) HPCG_fout << "Error in call to TestCompressedELL: " << ierr << ".\n" << endl;
+
   //////////////////////////////
   // Validation Testing Phase //
   //////////////////////////////
@@ -423,6 +649,73 @@ int main(int argc, char * argv[]) {
       HPCG_fout << "Failed to reduce the residual " << tolerance_failures << " times." << endl;
   }
 
+  // Iteration count with single against double precision matrix values
+  ierr = TestFloatValues(A, data, b, x, optMaxIters, refTolerance, sections);
+  if (ierr) HPCG_fout << "Error in call to TestFloatValues: " << ierr << ".\n" << endl;
+
+  // Natural ordering convergence of the level scheduled host smoother against multicoloring
+  ierr = TestLevelSchedule(A, data, b, x, optMaxIters, refTolerance, optNiters, sections);
+  if (ierr) HPCG_fout << "Error in call to TestLevelSchedule: " << ierr << ".\n" << endl;
+
+  // Host SpMV bandwidth on NUMA domains against flat OpenMP
+  if (params.numadomains >= 0) {
+    ierr = TestNumaDomains(A, b, params.numadomains, sections);
+    if (ierr) HPCG_fout << "Error in call to TestNumaDomains: " << ierr << ".\n" << endl;
+  }
+
+  // Host V-cycle and CG as work stealing task graphs against fork/join
+  if (params.taskrows >= 0) {
+    ierr = TestTaskRuntime(A, data, b, x, optMaxIters, refTolerance, params.taskrows, sections);
+    if (ierr) HPCG_fout << "Error in call to TestTaskRuntime: " << ierr << ".\n" << endl;
+  }
+
+  // Host CG on one persistent thread team against a parallel region per kernel
+  if (params.persistentcg) {
+    ierr = TestPersistentCG(A, data, b, x, optMaxIters, refTolerance, sections);
+    if (ierr) HPCG_fout << "Error in call to TestPersistentCG: " << ierr << ".\n" << endl;
+  }
+
+  // Bit reproducibility and cost of the binned dot products
+  if (params.reprodot) {
+    ierr = TestReproducibleDot(A, data, b, x, sections);
+    if (ierr) HPCG_fout << "Error in call to TestReproducibleDot: " << ierr << ".\n" << endl;
+  }
+
+  // In event timing mode, measure the cost of the synchronizing timers by
+  // alternating CG sets of identical work in both modes
+  if(cg_timer.GetMode() == CG_TIMING_EVENTS)
+  {
+    double mode_times[2] = {0.0, 0.0};
+
+    for (int i=0; i< numberOfCalls; ++i) {
+      for (int mode=CG_TIMING_BARRIER; mode<=CG_TIMING_EVENTS; ++mode) {
+        std::vector< double > mode_set_times(10,0.0);
+
+        cg_timer.SetMode(mode);
+        HIPZeroVector(x);
+        ierr = CG( A, data, b, x, optNiters, 0.0, niters, normr, normr0, &mode_set_times[0], true, false);
+        if (ierr) HPCG_fout << "Error in call to CG: " << ierr << ".\n" << endl;
+
+        mode_times[mode] += mode_set_times[0];
+      }
+    }
+
+#ifndef HPCG_NO_MPI
+    double local_mode_times[2] = {mode_times[0], mode_times[1]};
+    MPI_Allreduce(local_mode_times, mode_times, 2, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+
+    // Raw rates of the CG sets, without optimization and setup penalty
+    std::vector< double > barrier_times(10,0.0);
+    std::vector< double > event_times(10,0.0);
+    barrier_times[0] = mode_times[CG_TIMING_BARRIER];
+    event_times[0] = mode_times[CG_TIMING_EVENTS];
+
+    cg_timer.SetComparison(ComputeTotalGFlops(A, numberOfMgLevels, numberOfCalls, optNiters, optNiters, &barrier_times[0]),
+                           ComputeTotalGFlops(A, numberOfMgLevels, numberOfCalls, optNiters, optNiters, &event_times[0]));
+    if(rank == 0) cg_timer.Print();
+  }
+
   ///////////////////////////////
   // Optimized CG Timing Phase //
   ///////////////////////////////
@@ -477,8 +770,12 @@ int main(int argc, char * argv[]) {
            total_runtime);
   }
 
+  // Profile the benchmark phase only
+  HIP_CHECK(profiler.Reset());
+
   for (int i=0; i< numberOfCgSets; ++i) {
     HIPZeroVector(x); // Zero out x
+    double set_start = times[0];
     ierr = CG( A, data, b, x, optMaxIters, optTolerance, niters, normr, normr0, &times[0], true, false);
     if (ierr) HPCG_fout << "Error in call to CG: " << ierr << ".\n" << endl;
     if (rank==0) HPCG_fout << "Call [" << i << "] Scaled Residual [" << normr/normr0 << "]" << endl;
@@ -496,6 +793,11 @@ int main(int argc, char * argv[]) {
                (int)((double)(i + 1) / numberOfCgSets * 100.0),
                c,
                total_runtime - times[0] > 0.0 ? total_runtime - times[0] : 0.0);
+
+        if(stream != NULL)
+        {
+            WriteStreamRecord(stream, *A.geom, i + 1, numberOfCgSets, gflops, normr / normr0, times[0] - set_start, times[0]);
+        }
     }
 
     testnorms_data.values[i] = normr/normr0; // Record scaled residual from this run
@@ -513,12 +815,32 @@ int main(int argc, char * argv[]) {
   // Test Norm Results
   ierr = TestNorms(testnorms_data);
 
+  // Throughput of blocks of right hand sides sharing the matrix sweeps
+  if (params.multirhs) {
+    if(rank == 0) printf("\nMulti-RHS Phase ...\n");
+
+    ierr = TestMultiRHS(A, numberOfMgLevels, b, optMaxIters, sections);
+    if (ierr) HPCG_fout << "Error in call to TestMultiRHS: " << ierr << ".\n" << endl;
+  }
+
   ////////////////////
   // Report Results //
   ////////////////////
 
   // Report results to YAML file
-  ReportResults(A, numberOfMgLevels, numberOfCgSets, refMaxIters, optMaxIters, &times[0], testcg_data, testsymmetry_data, testnorms_data, global_failure, quickPath);
+  ReportResults(A, numberOfMgLevels, numberOfCgSets, refMaxIters, optMaxIters, &times[0], testcg_data, testsymmetry_data, testnorms_data, probe_data, sections, global_failure, quickPath);
+
+  // Summary of this problem size
+  result.nx = nx;
+  result.ny = ny;
+  result.nz = nz;
+  result.equations = A.totalNumberOfRows;
+  result.numberOfCgSets = numberOfCgSets;
+  result.gflops = ComputeTotalGFlops(A, numberOfMgLevels, numberOfCgSets, refMaxIters, optMaxIters, &times[0]);
+  result.setup_time = times[9];
+  result.optimization_time = times[7];
+  result.benchmark_time = times[0];
+  result.valid = params.verify && (testcg_data.count_fail==0) && (testsymmetry_data.count_fail==0) && (testnorms_data.pass) && (!global_failure);
 
   // Clean up
   if(params.verify)
@@ -534,12 +856,191 @@ int main(int argc, char * argv[]) {
     HIPDeleteVector(xexact);
     DeleteVector(x_overlap);
     DeleteVector(b_computed);
-    delete [] testnorms_data.values;
   }
   else
   {
     printf("\n*** WARNING *** THIS IS NOT A VALID RUN ***\n");
   }
+  delete [] testnorms_data.values;
+
+  return 0;
+}
+
+/*!
+  Main driver program: Construct synthetic problem, run V&V tests, compute benchmark parameters, run benchmark, report results.
+
+  @param[in]  argc Standard argument count.  Should equal 1 (no arguments passed in) or 4 (nx, ny, nz passed in)
+  @param[in]  argv Standard argument array.  If argc==1, argv is unused.  If argc==4, argv[1], argv[2], argv[3] will be interpreted as nx, ny, nz, resp.
+
+  @return Returns zero on success and a non-zero value otherwise.
+
+*/
+int main(int argc, char * argv[]) {
+
+#ifndef HPCG_NO_MPI
+  MPI_Init(&argc, &argv);
+#endif
+
+  HPCG_Params params;
+
+  HPCG_Init(&argc, &argv, params);
+
+  // Check if QuickPath option is enabled.
+  // If the running time is set to zero, we minimize all paths through the program
+  bool quickPath = (params.runningTime==0);
+
+  int rank = params.comm_rank; // My process ID
+
+  // Print rocHPCG version and device
+  if(rank == 0)
+  {
+    printf("rocHPCG version: %d.%d.%d-%s (based on hpcg-3.1)\n",
+           __ROCHPCG_VER_MAJOR,
+           __ROCHPCG_VER_MINOR,
+           __ROCHPCG_VER_PATCH,
+           TO_STR(__ROCHPCG_VER_TWEAK));
+  }
+
+  // Imported matrices bypass the generated benchmark problem
+  if(params.mtx != NULL)
+  {
+    int ierr = RunMatrixMarket(params);
+
+    HPCG_Finalize();
+#ifndef HPCG_NO_MPI
+    MPI_Finalize();
+#endif
+    return ierr;
+  }
+
+#ifndef HPCG_NO_MPI
+  MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+  hipDeviceProp_t prop;
+  hipGetDeviceProperties(&prop, params.device);
+  printf("Using HIP device (%d): %s (%lu MB global memory)\n",
+         params.device,
+         prop.name,
+         (prop.totalGlobalMem >> 20));
+
+#ifdef HPCG_DETAILED_DEBUG
+  if (params.comm_size < 100 && rank==0) HPCG_fout << "Process "<<rank<<" of "<<params.comm_size<<" is alive with " << params.numThreads << " threads." <<endl;
+  if (rank==0) HPCG_fout << "Timer source: " << mytimer_source() << endl;
+
+  if (rank==0) {
+    char c;
+    std::cout << "Press key to continue"<< std::endl;
+    std::cin.get(c);
+  }
+#ifndef HPCG_NO_MPI
+  MPI_Barrier(MPI_COMM_WORLD);
+#endif
+#endif
+
+  // Stream of per CG set records, written as the run progresses
+  FILE * stream = NULL;
+  if (rank == 0 && params.stream != NULL) {
+    stream = fopen(params.stream, "w");
+    if (stream == NULL) fprintf(stderr, "Warning: cannot open stream file %s\n", params.stream);
+  }
+
+  int ierr = 0;  // Used to check return codes on function calls
+  BenchmarkResult result;
+
+  if (params.sweepCount == 0) {
+    ierr = RunBenchmark(params, quickPath, stream, result);
+  } else {
+#ifndef HPCG_MEMMGMT
+    // Runs without verification do not release their device data, which is reclaimed by resetting the memory pool
+    if (!params.verify) {
+      if (rank == 0) fprintf(stderr, "Error: sweeps without verification require the memory management module (OPT_MEMMGMT)\n");
+      if (stream != NULL) fclose(stream);
+      HPCG_Finalize();
+#ifndef HPCG_NO_MPI
+      MPI_Finalize();
+#endif
+      return 1;
+    }
+#endif
+
+    // One record per problem size, written as the sweep progresses
+    FILE * sweep = NULL;
+    if (rank == 0) {
+      char fname[80];
+      time_t rawtime;
+      time(&rawtime);
+      tm * ptm = localtime(&rawtime);
+      sprintf(fname, "HPCG-Sweep_3.1_%04d-%02d-%02d_%02d-%02d-%02d.ndjson",
+              ptm->tm_year + 1900, ptm->tm_mon+1, ptm->tm_mday, ptm->tm_hour, ptm->tm_min, ptm->tm_sec);
+      sweep = fopen(fname, "w");
+      if (sweep == NULL) fprintf(stderr, "Warning: cannot open sweep file %s\n", fname);
+      else printf("\nWriting sweep results to %s\n", fname);
+    }
+
+    std::vector< BenchmarkResult > results(params.sweepCount);
+    double sweep_time = 0.0;
+    {
+      ScopedTimer timer(sweep_time);
+
+      for (int i=0; i< params.sweepCount; ++i) {
+        HPCG_Params size_params = params;
+        size_params.nx = params.sweepSizes[3*i+0];
+        size_params.ny = params.sweepSizes[3*i+1];
+        size_params.nz = params.sweepSizes[3*i+2];
+
+        if (rank == 0) printf("\n========== Sweep size %d / %d: %d x %d x %d ==========\n",
+                              i + 1, params.sweepCount, (int)size_params.nx, (int)size_params.ny, (int)size_params.nz);
+
+#ifdef HPCG_MEMMGMT
+        // Reuse the memory pool of the previous problem size
+        if (i > 0) HIP_CHECK(allocator.Reset());
+#endif
+
+        int size_ierr = 0;
+        {
+          ScopedTimer timer(results[i].wall_time);
+          size_ierr = RunBenchmark(size_params, quickPath, stream, results[i]);
+        }
+        results[i].ierr = size_ierr;
+        if (size_ierr) ierr = size_ierr;
+
+        if (size_ierr) {
+          // Size was rejected before the setup phase
+          results[i].nx = size_params.nx;
+          results[i].ny = size_params.ny;
+          results[i].nz = size_params.nz;
+          results[i].equations = 0;
+          results[i].numberOfCgSets = 0;
+          results[i].gflops = 0.0;
+          results[i].setup_time = results[i].optimization_time = results[i].benchmark_time = 0.0;
+          results[i].valid = false;
+        }
+
+        if (sweep != NULL) WriteSweepRecord(sweep, results[i]);
+      }
+    }
+
+    if (sweep != NULL) fclose(sweep);
+
+    if (rank == 0) {
+      printf("\nSweep Summary (%d sizes in %0.1lf sec)\n", params.sweepCount, sweep_time);
+      printf("%6s %6s %6s   %14s   %10s   %8s   %s\n", "nx", "ny", "nz", "Equations", "GFlop/s", "Time", "Result");
+      for (int i=0; i< params.sweepCount; ++i) {
+        printf("%6d %6d %6d   %14lld   %10.2lf   %8.1lf   %s\n",
+               (int)results[i].nx, (int)results[i].ny, (int)results[i].nz,
+               (long long)results[i].equations,
+               results[i].gflops,
+               results[i].wall_time,
+               results[i].ierr ? "ERROR" : (results[i].valid ? "VALID" : "INVALID"));
+      }
+    }
+
+    delete [] params.sweepSizes;
+  }
+
+  if (stream != NULL) fclose(stream);
+
 
   HPCG_Finalize();
 
@@ -547,5 +1048,5 @@ int main(int argc, char * argv[]) {
 #ifndef HPCG_NO_MPI
   MPI_Finalize();
 #endif
-  return 0;
+  return ierr;
 }
@@ -12,44 +12,128 @@
 // ***************************************************
 //@HEADER
 
-/////////////////////////////////////////////////////////////////////////
+/* ************************************************************************
+ * Modifications (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
 
-// Function to return time in seconds.
-// If compiled with no flags, return CPU time (user and system).
-// If compiled with -DWALL, returns elapsed time.
+/*!
+ @file mytimer.cpp
 
-/////////////////////////////////////////////////////////////////////////
+ Monotonic timers used throughout HPCG. By default, CLOCK_MONOTONIC_RAW is
+ used, which is not subject to NTP adjustments and has nanosecond resolution.
+ If compiled with -DHPCG_TSC_TIMER on x86-64, the time stamp counter is read
+ instead, provided the CPU reports an invariant TSC. Its rate is calibrated
+ against CLOCK_MONOTONIC_RAW on first use.
+ */
 
-#ifndef HPCG_NO_MPI
-#include <mpi.h>
+#include <time.h>
 
-double mytimer(void) {
-  return MPI_Wtime();
-}
+#include "mytimer.hpp"
 
-#elif !defined(HPCG_NO_OPENMP)
+#if defined(HPCG_TSC_TIMER) && !defined(__x86_64__)
+#undef HPCG_TSC_TIMER
+#endif
 
-// If this routine is compiled with HPCG_NO_MPI defined and not compiled with HPCG_NO_OPENMP then use the OpenMP timer
-#include <omp.h>
-double mytimer(void) {
-  return omp_get_wtime();
+#ifdef HPCG_TSC_TIMER
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+// Duration of the TSC calibration in nanoseconds
+#define TSC_CALIBRATION_NS 20000000
+
+struct TimerClock {
+  bool tsc; //!< true if the TSC is used
+  double seconds_per_tick; //!< length of a tick in seconds
+  mytimer_ticks_t start; //!< timestamp of the first call to mytimer
+};
+
+static inline mytimer_ticks_t monotonic_raw_ticks(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return (mytimer_ticks_t) ts.tv_sec * 1000000000ull + (mytimer_ticks_t) ts.tv_nsec;
 }
-#else
 
-#include <cstdlib>
-#include <sys/time.h>
-#include <sys/resource.h>
-double mytimer(void) {
-  struct timeval tp;
-  static long start=0, startu;
-  if (!start) {
-    gettimeofday(&tp, NULL);
-    start = tp.tv_sec;
-    startu = tp.tv_usec;
-    return 0.0;
+#ifdef HPCG_TSC_TIMER
+// The TSC can only be used if it ticks at constant rate, regardless of frequency scaling and sleep states
+static bool has_invariant_tsc(void) {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+  return (edx >> 8) & 1;
+}
+#endif
+
+static TimerClock calibrate_clock(void) {
+  TimerClock clock;
+  clock.tsc = false;
+  clock.seconds_per_tick = 1.0e-9;
+  clock.start = monotonic_raw_ticks();
+
+#ifdef HPCG_TSC_TIMER
+  if (has_invariant_tsc()) {
+    mytimer_ticks_t ns0 = monotonic_raw_ticks();
+    mytimer_ticks_t tsc0 = __rdtsc();
+    mytimer_ticks_t ns1;
+    do {
+      ns1 = monotonic_raw_ticks();
+    } while (ns1 - ns0 < TSC_CALIBRATION_NS);
+    mytimer_ticks_t tsc1 = __rdtsc();
+
+    clock.tsc = true;
+    clock.seconds_per_tick = (double) (ns1 - ns0) * 1.0e-9 / (double) (tsc1 - tsc0);
+    clock.start = tsc1;
   }
-  gettimeofday(&tp, NULL);
-  return ((double) (tp.tv_sec - start)) + (tp.tv_usec-startu)/1000000.0 ;
+#endif
+
+  return clock;
 }
 
+// Initialized on first use, thread safe
+static const TimerClock & get_clock(void) {
+  static const TimerClock clock = calibrate_clock();
+  return clock;
+}
+
+mytimer_ticks_t mytimer_ticks(void) {
+#ifdef HPCG_TSC_TIMER
+  if (get_clock().tsc) return __rdtsc();
 #endif
+  return monotonic_raw_ticks();
+}
+
+double mytimer_seconds(mytimer_ticks_t ticks) {
+  return (double) ticks * get_clock().seconds_per_tick;
+}
+
+double mytimer(void) {
+  const TimerClock & clock = get_clock();
+  return (double) (mytimer_ticks() - clock.start) * clock.seconds_per_tick;
+}
+
+const char * mytimer_source(void) {
+  return get_clock().tsc ? "TSC" : "CLOCK_MONOTONIC_RAW";
+}
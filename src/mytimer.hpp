@@ -12,7 +12,70 @@
 // ***************************************************
 //@HEADER
 
+/* ************************************************************************
+ * Modifications (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file mytimer.hpp
+
+ Monotonic timers used throughout HPCG
+ */
+
 #ifndef MYTIMER_HPP
 #define MYTIMER_HPP
+
+#include <stdint.h>
+
+//! Raw timestamp, nanoseconds of CLOCK_MONOTONIC_RAW or TSC cycles
+typedef uint64_t mytimer_ticks_t;
+
+//! Returns the elapsed time in seconds since the first call
 double mytimer(void);
+
+//! Returns a raw timestamp, cheaper than mytimer()
+mytimer_ticks_t mytimer_ticks(void);
+
+//! Converts a difference of raw timestamps to seconds
+double mytimer_seconds(mytimer_ticks_t ticks);
+
+//! Returns the name of the clock source in use
+const char * mytimer_source(void);
+
+/*!
+  Adds the time spent in its scope, in seconds, to the given accumulator.
+ */
+class ScopedTimer {
+public:
+  explicit ScopedTimer(double & t) : t_(t), start_(mytimer_ticks()) {}
+  ~ScopedTimer() { t_ += mytimer_seconds(mytimer_ticks() - start_); }
+private:
+  double & t_;
+  mytimer_ticks_t start_;
+};
+
 #endif // MYTIMER_HPP
@@ -0,0 +1,883 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+
+/*!
+ @file rochpcg_bench.cpp
+
+ Google Benchmark driver for the host reference kernels and setup routines.
+ Every benchmark is instantiated for the problem sizes of the rocHPCG test
+ suite and reports bytes/s (memory traffic model as used by the profiler)
+ and rows/s. The coarse levels of the multigrid hierarchy are generated on
+ the host, such that no GPU is required.
+
+ Usage: rochpcg-bench [--benchmark_filter=<regex>] [--benchmark_format=json]
+                      [--benchmark_out=<file>] ...
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "hpcg.hpp"
+#include "utils.hpp"
+#include "Geometry.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+#include "MGData.hpp"
+#include "GenerateGeometry.hpp"
+#include "GenerateProblem_ref.hpp"
+#include "SetupHalo_ref.hpp"
+#include "ComputeSPMV_ref.hpp"
+#include "ComputeSYMGS_ref.hpp"
+#include "LevelSchedule.hpp"
+#include "ReorderProblem.hpp"
+#include "NumaDomains.hpp"
+#include "HostMemory.hpp"
+#include "ComputeMG_ref.hpp"
+#include "ComputeRestriction_ref.hpp"
+#include "ComputeProlongation_ref.hpp"
+#include "ComputeWAXPBY_ref.hpp"
+#include "ComputeDotProduct_ref.hpp"
+#include "ReproducibleSum.hpp"
+#include "PerfCounters.hpp"
+#include "CGData.hpp"
+#include "CG_ref.hpp"
+#include "CG_persistent.hpp"
+#include "TaskGraph.hpp"
+#include "TaskRuntime.hpp"
+
+// Globals that are referenced by the reference routines
+hipProfiler_t profiler;
+std::ofstream HPCG_fout;
+
+// Number of levels including the finest, as in main.cpp
+static const int numberOfMgLevels = 4;
+
+// Problem sizes, identical to rochpcg_dim_range of the test suite
+static const int dim_range[][3] = {{ 16,  16,  16},
+                                   { 32,  32,  32},
+                                   { 48,  48,  48},
+                                   { 64,  64,  64},
+                                   { 80,  80,  80},
+                                   { 96,  96,  96},
+                                   {104, 104, 104},
+                                   {112, 112, 112},
+                                   {120, 120, 120},
+                                   {128, 128, 128},
+                                   {256, 256, 256},
+                                   {280, 280, 280},
+                                   {288, 288, 288}};
+
+static Geometry* BenchGeometry(local_int_t nx, local_int_t ny, local_int_t nz)
+{
+    Geometry* geom = new Geometry;
+    GenerateGeometry(1, 0, 1, 0, 0, 0, nx, ny, nz, 1, 1, 1, geom);
+
+    return geom;
+}
+
+// Host counterpart of GenerateCoarseProblem(), the optimized routine builds
+// the coarse levels on the device
+static void GenerateCoarseProblem_host(SparseMatrix& Af)
+{
+    local_int_t nxf = Af.geom->nx;
+    local_int_t nyf = Af.geom->ny;
+    local_int_t nzf = Af.geom->nz;
+
+    assert(nxf % 2 == 0);
+    assert(nyf % 2 == 0);
+    assert(nzf % 2 == 0);
+
+    local_int_t nxc = nxf / 2;
+    local_int_t nyc = nyf / 2;
+    local_int_t nzc = nzf / 2;
+
+    local_int_t localNumberOfRows = nxc * nyc * nzc;
+    local_int_t* f2cOperator = new local_int_t[localNumberOfRows];
+
+    for(local_int_t izc = 0; izc < nzc; ++izc)
+    {
+        for(local_int_t iyc = 0; iyc < nyc; ++iyc)
+        {
+            for(local_int_t ixc = 0; ixc < nxc; ++ixc)
+            {
+                local_int_t izf = 2 * izc;
+                local_int_t iyf = 2 * iyc;
+                local_int_t ixf = 2 * ixc;
+
+                f2cOperator[izc * nxc * nyc + iyc * nxc + ixc] = izf * nxf * nyf + iyf * nxf + ixf;
+            }
+        }
+    }
+
+    Geometry* geomc = BenchGeometry(nxc, nyc, nzc);
+    geomc->problem = Af.geom->problem;
+
+    SparseMatrix* Ac = new SparseMatrix;
+    InitializeSparseMatrix(*Ac, geomc);
+    Ac->level = Af.level + 1;
+    GenerateProblem_ref(*Ac, 0, 0, 0);
+    SetupHalo_ref(*Ac);
+
+    Vector* rc = new Vector;
+    Vector* xc = new Vector;
+    Vector* Axf = new Vector;
+    InitializeVector(*rc, Ac->localNumberOfRows);
+    InitializeVector(*xc, Ac->localNumberOfColumns);
+    InitializeVector(*Axf, Af.localNumberOfColumns);
+    ZeroVector(*rc);
+    ZeroVector(*xc);
+    ZeroVector(*Axf);
+
+    Af.Ac = Ac;
+    Af.mgData = new MGData;
+    InitializeMGData(NULL, NULL, rc, xc, Axf, *Af.mgData);
+    Af.mgData->f2cOperator = f2cOperator;
+}
+
+// Host only counterpart of DeleteMatrix(), that also releases device memory
+static void DeleteMatrix_host(SparseMatrix& A)
+{
+    hostFree(A.matrixValues[0]);
+    hostFree(A.mtxIndG[0]);
+    hostFree(A.mtxIndL[0]);
+    delete[] A.nonzerosInRow;
+    delete[] A.mtxIndG;
+    delete[] A.mtxIndL;
+    delete[] A.matrixValues;
+    delete[] A.matrixDiagonal;
+
+    DeleteLevelSchedule(A);
+
+    if(A.geom != NULL)
+    {
+        DeleteGeometry(*A.geom);
+        delete A.geom;
+    }
+
+    if(A.Ac != NULL)
+    {
+        DeleteMatrix_host(*A.Ac);
+        delete A.Ac;
+    }
+
+    if(A.mgData != NULL)
+    {
+        delete[] A.mgData->f2cOperator;
+        DeleteVector(*A.mgData->rc);
+        DeleteVector(*A.mgData->xc);
+        DeleteVector(*A.mgData->Axf);
+        delete A.mgData->rc;
+        delete A.mgData->xc;
+        delete A.mgData->Axf;
+        delete A.mgData;
+    }
+
+    A.globalToLocalMap.clear();
+}
+
+// Fully set up problem of a given size, including the coarse levels
+struct BenchProblem
+{
+    local_int_t nx;
+    local_int_t ny;
+    local_int_t nz;
+    int ordering;
+    int pages;
+
+    SparseMatrix A;
+    Vector b;
+    Vector x;
+    Vector xexact;
+};
+
+static void DeleteProblem(BenchProblem& problem)
+{
+    DeleteMatrix_host(problem.A);
+    DeleteVector(problem.b);
+    DeleteVector(problem.x);
+    DeleteVector(problem.xexact);
+}
+
+// Benchmarks are registered size by size (see main), thus only the problem of
+// the current size, ordering and page policy is kept alive to bound the memory
+// footprint of large sizes. The page policy stays set for the work arrays of
+// the benchmark.
+static BenchProblem& GetProblem(const benchmark::State& state,
+                                int ordering = HPCG_ORDER_LEXICOGRAPHIC,
+                                int pages = HPCG_PAGES_DEFAULT)
+{
+    static BenchProblem* problem = NULL;
+
+    local_int_t nx = state.range(0);
+    local_int_t ny = state.range(1);
+    local_int_t nz = state.range(2);
+
+    SetHostPagePolicy(pages);
+
+    if(problem != NULL && problem->nx == nx && problem->ny == ny && problem->nz == nz
+       && problem->ordering == ordering && problem->pages == pages)
+    {
+        return *problem;
+    }
+
+    if(problem != NULL)
+    {
+        DeleteProblem(*problem);
+        delete problem;
+    }
+
+    problem = new BenchProblem;
+    problem->nx = nx;
+    problem->ny = ny;
+    problem->nz = nz;
+    problem->ordering = ordering;
+    problem->pages = pages;
+
+    InitializeSparseMatrix(problem->A, BenchGeometry(nx, ny, nz));
+    GenerateProblem_ref(problem->A, &problem->b, &problem->x, &problem->xexact);
+    SetupHalo_ref(problem->A);
+
+    // The solution vector needs space for halo values
+    DeleteVector(problem->x);
+    InitializeVector(problem->x, problem->A.localNumberOfColumns);
+    ZeroVector(problem->x);
+
+    SparseMatrix* curLevelMatrix = &problem->A;
+    for(int level = 1; level < numberOfMgLevels; ++level)
+    {
+        GenerateCoarseProblem_host(*curLevelMatrix);
+        curLevelMatrix = curLevelMatrix->Ac;
+    }
+
+    ReorderProblem(problem->A, &problem->b, &problem->x, &problem->xexact, ordering);
+
+    return *problem;
+}
+
+// Memory traffic models, matching the profiling scopes of the reference kernels
+static double SpmvBytes(const SparseMatrix& A)
+{
+    return A.localNumberOfNonzeros * (sizeof(double) + sizeof(local_int_t)) + 2.0 * A.localNumberOfRows * sizeof(double);
+}
+
+static double SymgsBytes(const SparseMatrix& A)
+{
+    return 2.0 * SpmvBytes(A);
+}
+
+static double TransferBytes(const SparseMatrix& A)
+{
+    // Injection reads f2c, two fine and writes one coarse value per coarse row
+    return A.mgData->rc->localLength * (sizeof(local_int_t) + 3.0 * sizeof(double));
+}
+
+static double MgBytes(const SparseMatrix& A)
+{
+    if(A.mgData == NULL)
+    {
+        return SymgsBytes(A);
+    }
+
+    return (A.mgData->numberOfPresmootherSteps + A.mgData->numberOfPostsmootherSteps) * SymgsBytes(A)
+           + SpmvBytes(A) + 2.0 * TransferBytes(A) + MgBytes(*A.Ac);
+}
+
+static void SetCounters(benchmark::State& state, double bytes, double rows)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(bytes * state.iterations()));
+    state.counters["rows_per_second"] = benchmark::Counter(rows * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+static void SetLocalityCounters(benchmark::State& state, const SparseMatrix& A)
+{
+    double mean;
+    double geomean;
+
+    ComputeColumnDistance(A, mean, geomean);
+
+    state.counters["column_distance"] = mean;
+    state.counters["column_distance_geomean"] = geomean;
+}
+
+// Hardware counters are opened once, on first use
+static const hipHostCounters_t& GetHostCounters(void)
+{
+    static hipHostCounters_t* counters = NULL;
+
+    if(counters == NULL)
+    {
+        counters = new hipHostCounters_t;
+        counters->Initialize();
+    }
+
+    return *counters;
+}
+
+// Huge page coverage of the live large host arrays and data TLB misses per row
+// between two counter readings, if the counter is available
+static void SetPageCounters(benchmark::State& state,
+                            const hipHostCounters_t& hw,
+                            const double* begin,
+                            const double* end,
+                            double rows)
+{
+    HostMemoryStats stats;
+    GetHostMemoryStats(stats);
+
+    double total = 0.0;
+    for(int i = 0; i < HPCG_PAGES_NUMBER_OF_POLICIES; ++i)
+    {
+        total += stats.bytes[i];
+    }
+
+    double huge = stats.bytes[HPCG_PAGES_2M] + stats.bytes[HPCG_PAGES_1G] + stats.thp_bytes;
+
+    state.counters["huge_page_fraction"] = (total > 0.0) ? huge / total : 0.0;
+    state.counters["page_fallbacks"] = stats.fallbacks;
+
+    if(hw.IsAvailable(PERF_DTLB_MISSES))
+    {
+        state.counters["dtlb_misses_per_row"]
+            = (end[PERF_DTLB_MISSES] - begin[PERF_DTLB_MISSES]) / (rows * state.iterations());
+    }
+}
+
+static void BM_GenerateProblem_ref(benchmark::State& state)
+{
+    local_int_t nx = state.range(0);
+    local_int_t ny = state.range(1);
+    local_int_t nz = state.range(2);
+
+    double rows = 0.0;
+    double bytes = 0.0;
+
+    SetHostPagePolicy(HPCG_PAGES_DEFAULT);
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        SparseMatrix A;
+        Vector b;
+        Vector x;
+        Vector xexact;
+        InitializeSparseMatrix(A, BenchGeometry(nx, ny, nz));
+        state.ResumeTiming();
+
+        GenerateProblem_ref(A, &b, &x, &xexact);
+
+        state.PauseTiming();
+        rows = A.localNumberOfRows;
+        bytes = A.localNumberOfNonzeros * (2.0 * sizeof(double) + sizeof(global_int_t) + sizeof(local_int_t))
+                + A.localNumberOfRows * (sizeof(char) + 3.0 * sizeof(double));
+        DeleteMatrix_host(A);
+        DeleteVector(b);
+        DeleteVector(x);
+        DeleteVector(xexact);
+        state.ResumeTiming();
+    }
+
+    SetCounters(state, bytes, rows);
+}
+
+static void BM_SetupHalo_ref(benchmark::State& state)
+{
+    SparseMatrix& A = GetProblem(state).A;
+
+    for(auto _ : state)
+    {
+        SetupHalo_ref(A);
+    }
+
+    SetCounters(state,
+                A.localNumberOfNonzeros * (sizeof(global_int_t) + sizeof(local_int_t)),
+                A.localNumberOfRows);
+}
+
+static void BM_ComputeSPMV_ref(benchmark::State& state, int ordering, int pages)
+{
+    BenchProblem& problem = GetProblem(state, ordering, pages);
+    SparseMatrix& A = problem.A;
+
+    const hipHostCounters_t& hw = GetHostCounters();
+
+    double begin[PERF_NUMBER_OF_COUNTERS] = {};
+    double end[PERF_NUMBER_OF_COUNTERS] = {};
+
+    Vector y;
+    InitializeVector(y, A.localNumberOfRows);
+    CopyVector(problem.xexact, problem.x);
+
+    hw.Read(begin);
+
+    for(auto _ : state)
+    {
+        ComputeSPMV_ref(A, problem.x, y);
+        benchmark::ClobberMemory();
+    }
+
+    hw.Read(end);
+
+    SetCounters(state, SpmvBytes(A), A.localNumberOfRows);
+    SetLocalityCounters(state, A);
+    SetPageCounters(state, hw, begin, end, A.localNumberOfRows);
+
+    DeleteVector(y);
+}
+
+// Private copies of the sub-boxes of the NUMA nodes, each multiplied by the
+// threads bound to its node
+static void BM_ComputeSPMV_numa(benchmark::State& state)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    NumaDomains nd;
+
+    if(SetupNumaDomains(A, 0, nd) != 0)
+    {
+        state.SkipWithError("NUMA decomposition failed");
+        return;
+    }
+
+    CopyToNumaDomains(nd, problem.xexact);
+
+    for(auto _ : state)
+    {
+        ComputeSPMV_numa(nd, problem.x);
+        benchmark::ClobberMemory();
+    }
+
+    SetCounters(state, SpmvBytes(A), A.localNumberOfRows);
+
+    state.counters["domains"] = nd.numberOfDomains;
+    state.counters["nodes"] = nd.numberOfNodes;
+
+    for(int d = 0; d < nd.numberOfDomains; ++d)
+    {
+        const NumaDomain& D = nd.domain[d];
+
+        double bytes = D.numberOfNonzeros * (sizeof(double) + sizeof(local_int_t)) + 2.0 * D.numberOfRows * sizeof(double);
+
+        state.counters["domain" + std::to_string(d) + "_bytes_per_second"] = (D.time > 0.0) ? bytes * state.iterations() / D.time : 0.0;
+    }
+
+    DeleteNumaDomains(nd);
+}
+
+static void BM_ComputeSYMGS_ref(benchmark::State& state, int ordering, int pages)
+{
+    BenchProblem& problem = GetProblem(state, ordering, pages);
+    SparseMatrix& A = problem.A;
+
+    const hipHostCounters_t& hw = GetHostCounters();
+
+    double begin[PERF_NUMBER_OF_COUNTERS] = {};
+    double end[PERF_NUMBER_OF_COUNTERS] = {};
+
+    ZeroVector(problem.x);
+
+    hw.Read(begin);
+
+    for(auto _ : state)
+    {
+        ComputeSYMGS_ref(A, problem.b, problem.x);
+        benchmark::ClobberMemory();
+    }
+
+    hw.Read(end);
+
+    SetCounters(state, SymgsBytes(A), A.localNumberOfRows);
+    SetLocalityCounters(state, A);
+    SetPageCounters(state, hw, begin, end, A.localNumberOfRows);
+}
+
+// ComputeSYMGS_ref dispatches to the level scheduled sweeps while the schedule
+// is attached, it is removed afterwards for the other benchmarks of this size
+static void BM_ComputeSYMGS_level(benchmark::State& state)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    BuildLevelSchedule(A);
+
+    double levels = A.numberOfLowerLevels;
+
+    ZeroVector(problem.x);
+
+    for(auto _ : state)
+    {
+        ComputeSYMGS_ref(A, problem.b, problem.x);
+        benchmark::ClobberMemory();
+    }
+
+    DeleteLevelSchedule(A);
+
+    SetCounters(state, SymgsBytes(A), A.localNumberOfRows);
+
+    state.counters["levels"] = levels;
+}
+
+// Gauss-Seidel update of the rows of one parity class of the grid points. For
+// the 27 point stencil the rows of a class are independent, thus the threads
+// only synchronize at the end of each class as in the multicolored smoother.
+static void SweepColor(const SparseMatrix& A, const Vector& r, Vector& x, int color)
+{
+    const local_int_t nx = A.geom->nx;
+    const local_int_t ny = A.geom->ny;
+    const local_int_t nz = A.geom->nz;
+
+    const double* rv = r.values;
+    double* xv = x.values;
+
+#ifndef HPCG_NO_OPENMP
+#pragma omp parallel for collapse(2)
+#endif
+    for(local_int_t iz = (color >> 2) & 1; iz < nz; iz += 2)
+    {
+        for(local_int_t iy = (color >> 1) & 1; iy < ny; iy += 2)
+        {
+            for(local_int_t ix = color & 1; ix < nx; ix += 2)
+            {
+                local_int_t i = iz * nx * ny + iy * nx + ix;
+
+                const double* currentValues = A.matrixValues[i];
+                const local_int_t* currentColIndices = A.mtxIndL[i];
+                int currentNumberOfNonzeros = A.nonzerosInRow[i];
+                double currentDiagonal = A.matrixDiagonal[i][0];
+                double sum = rv[i];
+
+                for(int j = 0; j < currentNumberOfNonzeros; ++j)
+                {
+                    sum -= currentValues[j] * xv[currentColIndices[j]];
+                }
+
+                sum += xv[i] * currentDiagonal;
+
+                xv[i] = sum / currentDiagonal;
+            }
+        }
+    }
+}
+
+// Host counterpart of the multicolored smoother with eight colors, the time
+// the level schedule is compared against when threads outnumber cores
+static void BM_ComputeSYMGS_colored(benchmark::State& state)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    ZeroVector(problem.x);
+
+    for(auto _ : state)
+    {
+        for(int color = 0; color < 8; ++color)
+        {
+            SweepColor(A, problem.b, problem.x, color);
+        }
+
+        for(int color = 7; color >= 0; --color)
+        {
+            SweepColor(A, problem.b, problem.x, color);
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    SetCounters(state, SymgsBytes(A), A.localNumberOfRows);
+
+    state.counters["colors"] = 8;
+}
+
+static void BM_ComputeMG_ref(benchmark::State& state)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    for(auto _ : state)
+    {
+        ComputeMG_ref(A, problem.b, problem.x);
+        benchmark::ClobberMemory();
+    }
+
+    SetCounters(state, MgBytes(A), A.localNumberOfRows);
+}
+
+// V-cycle as one task graph on the work stealing runtime, with the smoother
+// split along the level schedule if scheduled, along a chain of row chunks
+// otherwise. Without execution, the runtime releases the same graph without
+// running the tasks, which is its overhead.
+static void BM_ComputeMG_tasks(benchmark::State& state, bool scheduled, bool execute)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    if(scheduled)
+    {
+        for(SparseMatrix* M = &A; M != NULL; M = M->Ac)
+        {
+            BuildLevelSchedule(*M);
+        }
+    }
+
+    HostTaskRuntime runtime;
+    InitializeTaskRuntime(runtime);
+
+    HostTaskGraph graph;
+    InitializeTaskGraph(graph, HPCG_TASK_ROWS, runtime.numberOfThreads);
+    AddMGTasks(graph, A, problem.b, problem.x);
+    FinalizeTaskGraph(graph);
+
+    for(auto _ : state)
+    {
+        RunTaskGraph(runtime, graph, execute);
+        benchmark::ClobberMemory();
+    }
+
+    if(scheduled)
+    {
+        for(SparseMatrix* M = &A; M != NULL; M = M->Ac)
+        {
+            DeleteLevelSchedule(*M);
+        }
+    }
+
+    SetCounters(state, execute ? MgBytes(A) : 0.0, A.localNumberOfRows);
+
+    state.counters["tasks"] = graph.tasks.size();
+    state.counters["steals"] = (double)runtime.steals / runtime.numberOfRuns;
+    state.counters["busy_fraction"] = runtime.busy / (runtime.time * runtime.numberOfThreads);
+
+    DeleteTaskGraph(graph);
+    DeleteTaskRuntime(runtime);
+}
+
+// Iterations of a CG solve, to zero tolerance such that every solve runs the
+// same number of iterations
+static const int cgIterations = 10;
+
+static void BM_CG_ref(benchmark::State& state, bool repro)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    SetReproducibleDot(repro);
+
+    CGData data;
+    InitializeSparseCGData(A, data);
+
+    int niters = 0;
+    double normr = 0.0;
+    double normr0 = 0.0;
+    double times[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    for(auto _ : state)
+    {
+        ZeroVector(problem.x);
+        CG_ref(A, data, problem.b, problem.x, cgIterations, 0.0, niters, normr, normr0, times, true, false);
+        benchmark::ClobberMemory();
+    }
+
+    SetReproducibleDot(false);
+    DeleteCGData(data);
+
+    state.counters["seconds_per_iteration"] = benchmark::Counter(
+        state.iterations() * niters, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// Same solve with all kernels on one persistent thread team
+static void BM_CG_persistent(benchmark::State& state)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    CGData data;
+    InitializeSparseCGData(A, data);
+
+    int niters = 0;
+    double normr = 0.0;
+    double normr0 = 0.0;
+    long long barriers = 0;
+
+    for(auto _ : state)
+    {
+        ZeroVector(problem.x);
+        CG_persistent(A, data, problem.b, problem.x, cgIterations, 0.0, niters, normr, normr0, barriers);
+        benchmark::ClobberMemory();
+    }
+
+    DeleteCGData(data);
+
+    state.counters["seconds_per_iteration"] = benchmark::Counter(
+        state.iterations() * niters, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["barriers_per_iteration"] = (double)barriers / niters;
+}
+
+static void BM_ComputeRestriction_ref(benchmark::State& state)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    FillRandomVector(*A.mgData->Axf);
+
+    for(auto _ : state)
+    {
+        ComputeRestriction_ref(A, problem.b);
+        benchmark::ClobberMemory();
+    }
+
+    SetCounters(state, TransferBytes(A), A.mgData->rc->localLength);
+}
+
+static void BM_ComputeProlongation_ref(benchmark::State& state)
+{
+    BenchProblem& problem = GetProblem(state);
+    SparseMatrix& A = problem.A;
+
+    FillRandomVector(*A.mgData->xc);
+
+    for(auto _ : state)
+    {
+        ComputeProlongation_ref(A, problem.x);
+        benchmark::ClobberMemory();
+    }
+
+    SetCounters(state, TransferBytes(A), A.mgData->rc->localLength);
+}
+
+static void BM_ComputeWAXPBY_ref(benchmark::State& state)
+{
+    BenchProblem& problem = GetProblem(state);
+    local_int_t n = problem.A.localNumberOfRows;
+
+    Vector w;
+    InitializeVector(w, n);
+
+    for(auto _ : state)
+    {
+        ComputeWAXPBY_ref(n, 1.0, problem.b, -1.0, problem.xexact, w);
+        benchmark::ClobberMemory();
+    }
+
+    SetCounters(state, 3.0 * n * sizeof(double), n);
+
+    DeleteVector(w);
+}
+
+// Plain or binned summation, see ReproducibleSum.hpp
+static void BM_ComputeDotProduct_ref(benchmark::State& state, bool repro)
+{
+    BenchProblem& problem = GetProblem(state);
+    local_int_t n = problem.A.localNumberOfRows;
+
+    double result = 0.0;
+    double time_allreduce = 0.0;
+
+    SetReproducibleDot(repro);
+
+    for(auto _ : state)
+    {
+        ComputeDotProduct_ref(n, problem.b, problem.xexact, result, time_allreduce);
+        benchmark::DoNotOptimize(result);
+    }
+
+    SetReproducibleDot(false);
+
+    SetCounters(state, 2.0 * n * sizeof(double), n);
+}
+
+int main(int argc, char* argv[])
+{
+    benchmark::Initialize(&argc, argv);
+
+    if(benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+
+    for(size_t i = 0; i < sizeof(dim_range) / sizeof(dim_range[0]); ++i)
+    {
+        std::vector<benchmark::internal::Benchmark*> bench;
+
+        bench.push_back(benchmark::RegisterBenchmark("GenerateProblem_ref", BM_GenerateProblem_ref));
+        bench.push_back(benchmark::RegisterBenchmark("SetupHalo_ref", BM_SetupHalo_ref));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeSPMV_ref", BM_ComputeSPMV_ref, HPCG_ORDER_LEXICOGRAPHIC, HPCG_PAGES_DEFAULT));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeSPMV_numa", BM_ComputeSPMV_numa));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeSYMGS_ref", BM_ComputeSYMGS_ref, HPCG_ORDER_LEXICOGRAPHIC, HPCG_PAGES_DEFAULT));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeSYMGS_level", BM_ComputeSYMGS_level));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeSYMGS_colored", BM_ComputeSYMGS_colored));
+
+        bench.push_back(benchmark::RegisterBenchmark("ComputeMG_ref", BM_ComputeMG_ref));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeMG_tasks", BM_ComputeMG_tasks, false, true));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeMG_tasks/schedule:level", BM_ComputeMG_tasks, true, true));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeMG_tasks/empty", BM_ComputeMG_tasks, false, false));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeRestriction_ref", BM_ComputeRestriction_ref));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeProlongation_ref", BM_ComputeProlongation_ref));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeWAXPBY_ref", BM_ComputeWAXPBY_ref));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeDotProduct_ref", BM_ComputeDotProduct_ref, false));
+        bench.push_back(benchmark::RegisterBenchmark("ComputeDotProduct_ref/sum:binned", BM_ComputeDotProduct_ref, true));
+        bench.push_back(benchmark::RegisterBenchmark("CG_ref", BM_CG_ref, false));
+        bench.push_back(benchmark::RegisterBenchmark("CG_ref/sum:binned", BM_CG_ref, true));
+        bench.push_back(benchmark::RegisterBenchmark("CG_persistent", BM_CG_persistent));
+
+        // Reordered problems last, each ordering is set up once per size
+        for(int ordering = HPCG_ORDER_MORTON; ordering <= HPCG_ORDER_HILBERT; ++ordering)
+        {
+            std::string suffix = std::string("/order:") + RowOrderingName(ordering);
+
+            bench.push_back(benchmark::RegisterBenchmark(("ComputeSPMV_ref" + suffix).c_str(), BM_ComputeSPMV_ref, ordering, HPCG_PAGES_DEFAULT));
+            bench.push_back(benchmark::RegisterBenchmark(("ComputeSYMGS_ref" + suffix).c_str(), BM_ComputeSYMGS_ref, ordering, HPCG_PAGES_DEFAULT));
+        }
+
+        // Large host arrays backed by huge pages, each policy is set up once per size
+        for(int pages = HPCG_PAGES_THP; pages < HPCG_PAGES_NUMBER_OF_POLICIES; ++pages)
+        {
+            std::string suffix = std::string("/pages:") + HostPagePolicyName(pages);
+
+            bench.push_back(benchmark::RegisterBenchmark(("ComputeSPMV_ref" + suffix).c_str(), BM_ComputeSPMV_ref, HPCG_ORDER_LEXICOGRAPHIC, pages));
+            bench.push_back(benchmark::RegisterBenchmark(("ComputeSYMGS_ref" + suffix).c_str(), BM_ComputeSYMGS_ref, HPCG_ORDER_LEXICOGRAPHIC, pages));
+        }
+
+        for(size_t j = 0; j < bench.size(); ++j)
+        {
+            bench[j]->ArgNames({"nx", "ny", "nz"});
+            bench[j]->Args({dim_range[i][0], dim_range[i][1], dim_range[i][2]});
+            bench[j]->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,417 @@
+/* ************************************************************************
+ * Copyright (c) 2019-2021 Advanced Micro Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ************************************************************************ */
+
+/*!
+ @file rochpcg_dumpreader.cpp
+
+ Standalone reader for the binary problem dump written by WriteProblemBinary.
+ For each given JSON header, the corresponding binary file is mapped, SpMV and
+ SYMGS are recomputed on the host and compared against the results that were
+ recorded by the optimized kernels of the live run.
+
+ Usage: rochpcg-dumpreader [--tol=<tolerance>] <dump>_l<level>_r<rank>.json ...
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct DumpSection
+{
+    std::string name;
+    std::string dtype;
+    size_t count;
+    size_t offset;
+};
+
+struct DumpHeader
+{
+    std::string binary;
+    int level;
+    int rank;
+    int size;
+    long long local_rows;
+    long long local_columns;
+    long long local_nonzeros;
+    int ell_width;
+    int nblocks;
+    std::vector<DumpSection> sections;
+};
+
+// Minimal lookup of "key": value pairs, sufficient for the flat headers that
+// are written by WriteProblemBinary
+static const char* find_key(const char* json, const char* key)
+{
+    std::string pattern = std::string("\"") + key + "\":";
+    const char* pos = strstr(json, pattern.c_str());
+
+    if(pos == NULL)
+    {
+        return NULL;
+    }
+
+    pos += pattern.size();
+    while(*pos == ' ')
+    {
+        ++pos;
+    }
+
+    return pos;
+}
+
+static bool read_number(const char* json, const char* key, long long& value)
+{
+    const char* pos = find_key(json, key);
+    return pos != NULL && sscanf(pos, "%lld", &value) == 1;
+}
+
+static bool read_string(const char* json, const char* key, std::string& value)
+{
+    const char* pos = find_key(json, key);
+
+    if(pos == NULL || *pos != '"')
+    {
+        return false;
+    }
+
+    const char* end = strchr(pos + 1, '"');
+
+    if(end == NULL)
+    {
+        return false;
+    }
+
+    value.assign(pos + 1, end - pos - 1);
+    return true;
+}
+
+static int parse_header(const char* fname, DumpHeader& header)
+{
+    FILE* f = fopen(fname, "r");
+
+    if(f == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", fname);
+        return -1;
+    }
+
+    std::string json;
+    char buf[4096];
+    size_t n;
+    while((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    {
+        json.append(buf, n);
+    }
+    fclose(f);
+
+    std::string format;
+    long long v[8];
+    if(!read_string(json.c_str(), "format", format) || format != "rochpcg-dump"
+       || !read_string(json.c_str(), "binary", header.binary)
+       || !read_number(json.c_str(), "level", v[0])
+       || !read_number(json.c_str(), "rank", v[1])
+       || !read_number(json.c_str(), "size", v[2])
+       || !read_number(json.c_str(), "local_rows", v[3])
+       || !read_number(json.c_str(), "local_columns", v[4])
+       || !read_number(json.c_str(), "local_nonzeros", v[5])
+       || !read_number(json.c_str(), "ell_width", v[6])
+       || !read_number(json.c_str(), "nblocks", v[7]))
+    {
+        fprintf(stderr, "%s is not a valid rocHPCG dump header\n", fname);
+        return -1;
+    }
+
+    header.level          = (int)v[0];
+    header.rank           = (int)v[1];
+    header.size           = (int)v[2];
+    header.local_rows     = v[3];
+    header.local_columns  = v[4];
+    header.local_nonzeros = v[5];
+    header.ell_width      = (int)v[6];
+    header.nblocks        = (int)v[7];
+
+    // Binary file is located next to its header
+    const char* slash = strrchr(fname, '/');
+    if(slash != NULL)
+    {
+        header.binary = std::string(fname, slash - fname + 1) + header.binary;
+    }
+
+    // Sections
+    const char* pos = strstr(json.c_str(), "\"sections\":");
+    while(pos != NULL && (pos = strchr(pos, '{')) != NULL)
+    {
+        const char* end = strchr(pos, '}');
+
+        if(end == NULL)
+        {
+            break;
+        }
+
+        std::string entry(pos, end - pos + 1);
+        DumpSection section;
+        long long count, offset;
+
+        if(read_string(entry.c_str(), "name", section.name)
+           && read_string(entry.c_str(), "dtype", section.dtype)
+           && read_number(entry.c_str(), "count", count)
+           && read_number(entry.c_str(), "offset", offset))
+        {
+            section.count  = count;
+            section.offset = offset;
+            header.sections.push_back(section);
+        }
+
+        pos = end + 1;
+    }
+
+    return 0;
+}
+
+static const void* get_section(const DumpHeader& header,
+                               const char* base,
+                               const char* name,
+                               const char* dtype,
+                               size_t count)
+{
+    for(size_t i = 0; i < header.sections.size(); ++i)
+    {
+        const DumpSection& s = header.sections[i];
+
+        if(s.name == name)
+        {
+            if(s.dtype != dtype || s.count != count)
+            {
+                fprintf(stderr, "Section %s has unexpected type %s or size %zu\n", name, s.dtype.c_str(), s.count);
+                return NULL;
+            }
+
+            return base + s.offset;
+        }
+    }
+
+    fprintf(stderr, "Section %s missing in %s\n", name, header.binary.c_str());
+    return NULL;
+}
+
+static double max_rel_diff(size_t n, const double* ref, const double* val)
+{
+    double err = 0.0;
+    for(size_t i = 0; i < n; ++i)
+    {
+        double scale = std::max(std::fabs(ref[i]), 1.0);
+        err = std::max(err, std::fabs(ref[i] - val[i]) / scale);
+    }
+
+    return err;
+}
+
+/*!
+  Recomputes SpMV and SYMGS of a single dump and compares against the
+  recorded results of the live run.
+
+  @param[in] fname Name of the JSON header
+  @param[in] tol   Tolerance for the maximum relative difference
+
+  @return Returns zero if all checks pass and a non-zero value otherwise.
+*/
+static int check_dump(const char* fname, double tol)
+{
+    DumpHeader header;
+    if(parse_header(fname, header))
+    {
+        return -1;
+    }
+
+    int fd = open(header.binary.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        fprintf(stderr, "Cannot open %s\n", header.binary.c_str());
+        return -1;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) || st.st_size == 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(map == MAP_FAILED)
+    {
+        fprintf(stderr, "Cannot map %s\n", header.binary.c_str());
+        return -1;
+    }
+
+    // Matrix is streamed column slab by column slab
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    const char* base = reinterpret_cast<const char*>(map);
+
+    size_t m     = header.local_rows;
+    size_t n     = header.local_columns;
+    size_t width = header.ell_width;
+
+    const int*    ell_col_ind = (const int*)get_section(header, base, "ell_col_ind", "i4", m * width);
+    const double* ell_val     = (const double*)get_section(header, base, "ell_val", "f8", m * width);
+    const double* inv_diag    = (const double*)get_section(header, base, "inv_diag", "f8", m);
+    const double* spmv_x      = (const double*)get_section(header, base, "spmv_x", "f8", n);
+    const double* spmv_y      = (const double*)get_section(header, base, "spmv_y", "f8", m);
+    const double* symgs_r     = (const double*)get_section(header, base, "symgs_r", "f8", m);
+    const double* symgs_x0    = (const double*)get_section(header, base, "symgs_x0", "f8", n);
+    const double* symgs_x1    = (const double*)get_section(header, base, "symgs_x1", "f8", n);
+
+    if(!ell_col_ind || !ell_val || !inv_diag || !spmv_x || !spmv_y || !symgs_r || !symgs_x0 || !symgs_x1)
+    {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    // SpMV, one ELL column at a time to keep the access pattern sequential
+    std::vector<double> y(m, 0.0);
+    size_t nnz = 0;
+
+    for(size_t p = 0; p < width; ++p)
+    {
+        const int*    col = ell_col_ind + p * m;
+        const double* val = ell_val + p * m;
+
+        for(size_t i = 0; i < m; ++i)
+        {
+            if(col[i] >= 0 && (size_t)col[i] < n)
+            {
+                y[i] += val[i] * spmv_x[col[i]];
+                ++nnz;
+            }
+        }
+    }
+
+    // SYMGS, rows are stored in multicolor order, thus a sequential sweep
+    // in storage order is equivalent to the multicolored sweep
+    std::vector<double> x(symgs_x0, symgs_x0 + n);
+
+    for(size_t i = 0; i < m; ++i)
+    {
+        double sum = symgs_r[i];
+
+        for(size_t p = 0; p < width; ++p)
+        {
+            int col = ell_col_ind[p * m + i];
+
+            if(col >= 0 && (size_t)col < n && (size_t)col != i)
+            {
+                sum -= ell_val[p * m + i] * x[col];
+            }
+        }
+
+        x[i] = sum * inv_diag[i];
+    }
+
+    for(size_t i = m; i-- > 0;)
+    {
+        double sum = symgs_r[i];
+
+        for(size_t p = 0; p < width; ++p)
+        {
+            int col = ell_col_ind[p * m + i];
+
+            if(col >= 0 && (size_t)col < n && (size_t)col != i)
+            {
+                sum -= ell_val[p * m + i] * x[col];
+            }
+        }
+
+        x[i] = sum * inv_diag[i];
+    }
+
+    double err_spmv  = max_rel_diff(m, y.data(), spmv_y);
+    double err_symgs = max_rel_diff(m, x.data(), symgs_x1);
+
+    bool pass = err_spmv <= tol && err_symgs <= tol;
+
+    printf("%s: level %d rank %d/%d rows %zu cols %zu nnz %zu (%.2f MB)\n",
+           fname,
+           header.level,
+           header.rank,
+           header.size,
+           m,
+           n,
+           nnz,
+           st.st_size / 1048576.0);
+    printf("  SpMV  max rel diff %e %s\n", err_spmv, err_spmv <= tol ? "PASSED" : "FAILED");
+    printf("  SYMGS max rel diff %e %s\n", err_symgs, err_symgs <= tol ? "PASSED" : "FAILED");
+
+    if(nnz != (size_t)header.local_nonzeros)
+    {
+        printf("  WARNING: %zu ELL entries, header reports %lld nonzeros\n", nnz, header.local_nonzeros);
+    }
+
+    munmap(map, st.st_size);
+
+    return pass ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    double tol  = 1e-10;
+    int    nerr = 0;
+    int    nchk = 0;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(strncmp(argv[i], "--tol=", 6) == 0)
+        {
+            tol = atof(argv[i] + 6);
+            continue;
+        }
+
+        nerr += check_dump(argv[i], tol) != 0;
+        ++nchk;
+    }
+
+    if(nchk == 0)
+    {
+        fprintf(stderr, "Usage: %s [--tol=<tolerance>] <dump>_l<level>_r<rank>.json ...\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d of %d dumps passed\n", nchk - nerr, nchk);
+
+    return nerr != 0;
+}
@@ -33,6 +33,9 @@
 #include <hip/hip_runtime_api.h>
 
 #include "Memory.hpp"
+#include "Profiler.hpp"
+#include "CGTimer.hpp"
+#include "KernelConfig.hpp"
 
 // Streams
 extern hipStream_t stream_interior;
@@ -41,6 +44,12 @@ extern hipStream_t stream_halo;
 extern void* workspace;
 // Memory allocator
 extern hipAllocator_t allocator;
+// Profiler
+extern hipProfiler_t profiler;
+// CG section timer
+extern hipCGTimer_t cg_timer;
+// Kernel launch configuration
+extern hipKernelConfig_t kernel_config;
 
 #define RNG_SEED 0x586744
 #define MAX_COLORS 128